@@ -0,0 +1,11 @@
+#pragma once
+#include "view/IModelReader.h"
+
+//OBJ reader as it was before the hand-written parser: stringstream based and single-threaded.
+//Kept only as the reference for speed and output of CObjModelFactory, so it is not changed together with the engine. Indexes are not checked, so it needs valid files
+class CBaselineObjModelFactory : public wargameEngine::view::IModelReader
+{
+public:
+	bool ModelIsSupported(unsigned char* data, size_t size, const wargameEngine::Path& filePath) const override;
+	std::unique_ptr<wargameEngine::view::C3DModel> LoadModel(unsigned char* data, size_t size, wargameEngine::view::C3DModel const& dummyModel, const wargameEngine::Path& filePath) override;
+};
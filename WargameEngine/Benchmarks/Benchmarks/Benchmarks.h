@@ -0,0 +1,17 @@
+#pragma once
+#include <string>
+#include <vector>
+
+//Each scenario gets arguments that follow its name, prints its timings and returns process exit code
+int BenchmarkOBJ(std::vector<std::string> const& args);
+int BenchmarkCollada(std::vector<std::string> const& args);
+int BenchmarkWBM(std::vector<std::string> const& args);
+int BenchmarkIndirect(std::vector<std::string> const& args);
+int BenchmarkUniforms(std::vector<std::string> const& args);
+int BenchmarkNetwork(std::vector<std::string> const& args);
+int BenchmarkStreams(std::vector<std::string> const& args);
+int BenchmarkStreamFuzz(std::vector<std::string> const& args);
+int BenchmarkCommands(std::vector<std::string> const& args);
+int BenchmarkSaveLoad(std::vector<std::string> const& args);
+int BenchmarkTeamcolor(std::vector<std::string> const& args);
+int BenchmarkLineOfSight(std::vector<std::string> const& args);
@@ -0,0 +1,202 @@
+#include "Benchmarks.h"
+#include "MemoryStream.h"
+#include "controller/CommandMoveObject.h"
+#include "controller/CommandRotateObject.h"
+#include "model/Model.h"
+#include "model/Object.h"
+#include "Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+
+using namespace wargameEngine;
+
+namespace
+{
+constexpr size_t OBJECTS_COUNT = 5000;
+constexpr size_t COMMANDS_COUNT = 100000;
+
+typedef std::chrono::high_resolution_clock Clock;
+typedef std::unordered_map<model::ObjectHandle, model::ObjectHandle> HandleMap;
+typedef std::vector<std::pair<model::ObjectHandle, model::ObjectHandle>> HandleList;
+
+double ElapsedMilliseconds(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct sCommands
+{
+	std::vector<char> data;
+	//Every command is a separate network message, so it is translated and read on its own
+	std::vector<std::pair<size_t, size_t>> messages;
+};
+
+void FillScene(model::Model& model, bool reversed)
+{
+	for (size_t i = 0; i < OBJECTS_COUNT; ++i)
+	{
+		const size_t index = reversed ? OBJECTS_COUNT - 1 - i : i;
+		model.AddObject(std::make_shared<model::Object>(make_path(L"marine.wbm"), CVector3f(index * 2.0f, 0.0f, 0.0f), 0.0f));
+	}
+}
+
+//Commands are executed on host while they are written, so host ends in the state that clients must reach
+sCommands MakeCommands(model::Model& host)
+{
+	sCommands commands;
+	WriteMemoryStream stream(commands.data);
+	for (size_t i = 0; i < COMMANDS_COUNT; ++i)
+	{
+		auto object = host.Get3DObject((i * 7919) % OBJECTS_COUNT);
+		const size_t begin = stream.GetSize();
+		if (i % 4 == 3)
+		{
+			controller::CCommandRotateObject command(object, (i % 90) * 0.5f);
+			command.Execute();
+			command.Serialize(stream);
+		}
+		else
+		{
+			controller::CCommandMoveObject command(object, (i % 100) * 0.01f, (i % 50) * -0.02f);
+			command.Execute();
+			command.Serialize(stream);
+		}
+		commands.messages.emplace_back(begin, stream.GetSize() - begin);
+	}
+	return commands;
+}
+
+//Same steps as controller::Network::ProcessCommand: handle that follows the command type is replaced in place by the local one, then command is read and executed
+template<class Translate>
+size_t ApplyCommands(sCommands& commands, model::Model& model, Translate const& translate)
+{
+	size_t failed = 0;
+	for (auto& message : commands.messages)
+	{
+		char* data = commands.data.data() + message.first;
+		model::ObjectHandle handle;
+		memcpy(&handle, data + 1, sizeof(handle));
+		handle = translate(handle);
+		if (handle == model::INVALID_OBJECT_HANDLE)
+		{
+			++failed;
+			continue;
+		}
+		memcpy(data + 1, &handle, sizeof(handle));
+		ReadMemoryStream stream(data, message.second);
+		const unsigned char type = stream.ReadByte();
+		std::unique_ptr<controller::ICommand> command;
+		if (type == 2)
+		{
+			command = std::make_unique<controller::CCommandMoveObject>(stream, model);
+		}
+		else
+		{
+			command = std::make_unique<controller::CCommandRotateObject>(stream, model);
+		}
+		command->Execute();
+	}
+	return failed;
+}
+
+//Returns count of objects whose position or rotation differs from the same object on host
+size_t CompareScenes(model::Model& host, model::Model& client, HandleMap const& hostToClient)
+{
+	size_t mismatches = 0;
+	for (size_t i = 0; i < host.GetObjectCount(); ++i)
+	{
+		auto hostObject = host.Get3DObject(i);
+		auto it = hostToClient.find(hostObject->GetHandle());
+		auto clientObject = it != hostToClient.end() ? client.GetObjectByHandle(it->second) : nullptr;
+		if (!clientObject || clientObject->GetX() != hostObject->GetX() || clientObject->GetY() != hostObject->GetY() || clientObject->GetRotation() != hostObject->GetRotation())
+		{
+			++mismatches;
+		}
+	}
+	return mismatches;
+}
+
+//Objects are matched by their initial position, because client creates them in other order and gets other handles
+HandleMap MatchObjects(model::Model& host, model::Model& client)
+{
+	HandleMap result;
+	std::unordered_map<float, model::ObjectHandle> clientByX;
+	for (size_t i = 0; i < client.GetObjectCount(); ++i)
+	{
+		auto object = client.Get3DObject(i);
+		clientByX[object->GetX()] = object->GetHandle();
+	}
+	for (size_t i = 0; i < host.GetObjectCount(); ++i)
+	{
+		auto object = host.Get3DObject(i);
+		result[object->GetHandle()] = clientByX[object->GetX()];
+	}
+	return result;
+}
+}
+
+//Applies 100000 move and rotate commands of a host to a client scene of 5000 objects, which has other handles for the same objects.
+//Handles are translated through a hash map like controller::Network does, and through linear scans of the translation list and the model
+//like the former pointer translation did. Both clients must end in the host state
+int BenchmarkCommands(std::vector<std::string> const& args)
+{
+	bool baseline = true;
+	for (auto& arg : args)
+	{
+		if (arg == "-nobaseline")
+		{
+			baseline = false;
+		}
+	}
+	model::Model host;
+	FillScene(host, false);
+	model::Model hashed;
+	FillScene(hashed, true);
+	const HandleMap translator = MatchObjects(host, hashed);
+	const sCommands commands = MakeCommands(host);
+
+	sCommands received = commands;
+	auto start = Clock::now();
+	const size_t hashedFailed = ApplyCommands(received, hashed, [&translator](model::ObjectHandle handle) {
+		auto it = translator.find(handle);
+		return it != translator.end() ? it->second : model::INVALID_OBJECT_HANDLE;
+	});
+	const double hashedTime = ElapsedMilliseconds(start);
+	size_t mismatches = hashedFailed + CompareScenes(host, hashed, translator);
+	std::cout << COMMANDS_COUNT << " commands on " << OBJECTS_COUNT << " objects, hashed handles: " << hashedTime << " ms ("
+		<< hashedTime * 1000000.0 / COMMANDS_COUNT << " ns/command)" << std::endl;
+
+	if (baseline)
+	{
+		model::Model scanned;
+		FillScene(scanned, true);
+		const HandleList list(translator.begin(), translator.end());
+		received = commands;
+		start = Clock::now();
+		const size_t scannedFailed = ApplyCommands(received, scanned, [&list, &scanned](model::ObjectHandle handle) {
+			auto it = std::find_if(list.rbegin(), list.rend(), [handle](std::pair<model::ObjectHandle, model::ObjectHandle> const& pair) { return pair.first == handle; });
+			if (it == list.rend())
+				return model::INVALID_OBJECT_HANDLE;
+			for (size_t i = 0; i < scanned.GetObjectCount(); ++i)
+			{
+				auto object = scanned.Get3DObject(i);
+				if (object->GetHandle() == it->second)
+					return object->GetHandle();
+			}
+			return model::INVALID_OBJECT_HANDLE;
+		});
+		const double scannedTime = ElapsedMilliseconds(start);
+		mismatches += scannedFailed + CompareScenes(host, scanned, translator);
+		std::cout << "Linear scans: " << scannedTime << " ms (" << scannedTime * 1000000.0 / COMMANDS_COUNT << " ns/command)" << std::endl;
+	}
+	if (mismatches)
+	{
+		std::cout << mismatches << " objects differ from host" << std::endl;
+	}
+	return mismatches ? 1 : 0;
+}
@@ -0,0 +1,159 @@
+#include "Benchmarks.h"
+#include <GL/glew.h>
+#include "impl/OpenGLIndirectCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using wargameEngine::view::IRenderer;
+
+namespace
+{
+constexpr size_t LISTS_COUNT = 300;
+
+//GL buffer functions are replaced while benchmark runs, so it measures CPU work of the engine side and needs no context
+struct sUploadStats
+{
+	size_t calls = 0;
+	size_t bytes = 0;
+};
+sUploadStats uploadStats;
+std::vector<char> bufferContents;
+
+void GLAPIENTRY MockGenBuffers(GLsizei n, GLuint* buffers)
+{
+	std::fill(buffers, buffers + n, 1);
+}
+
+void GLAPIENTRY MockBindBuffer(GLenum, GLuint)
+{
+}
+
+void GLAPIENTRY MockDeleteBuffers(GLsizei, const GLuint*)
+{
+}
+
+void GLAPIENTRY MockBufferData(GLenum, GLsizeiptr size, const void* data, GLenum)
+{
+	++uploadStats.calls;
+	uploadStats.bytes += size;
+	bufferContents.resize(std::max(bufferContents.size(), static_cast<size_t>(size)));
+	if (data)
+	{
+		memcpy(bufferContents.data(), data, size);
+	}
+}
+
+void GLAPIENTRY MockBufferSubData(GLenum, GLintptr offset, GLsizeiptr size, const void* data)
+{
+	++uploadStats.calls;
+	uploadStats.bytes += size;
+	memcpy(bufferContents.data() + offset, data, size);
+}
+
+class CMockBufferFunctions
+{
+public:
+	CMockBufferFunctions()
+		: m_genBuffers(glGenBuffers), m_bindBuffer(glBindBuffer), m_deleteBuffers(glDeleteBuffers), m_bufferData(glBufferData), m_bufferSubData(glBufferSubData)
+	{
+		glGenBuffers = MockGenBuffers;
+		glBindBuffer = MockBindBuffer;
+		glDeleteBuffers = MockDeleteBuffers;
+		glBufferData = MockBufferData;
+		glBufferSubData = MockBufferSubData;
+	}
+	~CMockBufferFunctions()
+	{
+		glGenBuffers = m_genBuffers;
+		glBindBuffer = m_bindBuffer;
+		glDeleteBuffers = m_deleteBuffers;
+		glBufferData = m_bufferData;
+		glBufferSubData = m_bufferSubData;
+	}
+private:
+	PFNGLGENBUFFERSPROC m_genBuffers;
+	PFNGLBINDBUFFERPROC m_bindBuffer;
+	PFNGLDELETEBUFFERSPROC m_deleteBuffers;
+	PFNGLBUFFERDATAPROC m_bufferData;
+	PFNGLBUFFERSUBDATAPROC m_bufferSubData;
+};
+
+//Renderer uploaded every list to the stream buffer before commands were cached
+void UploadList(std::vector<IRenderer::IndirectDraw> const& list, GLuint buffer, std::vector<DrawElementsIndirectCommand>& commands)
+{
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer);
+	commands.clear();
+	for (auto& draw : list)
+	{
+		commands.push_back({ static_cast<GLuint>(draw.count), static_cast<GLuint>(draw.instances), static_cast<GLuint>(draw.start), 0, 0 });
+	}
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STREAM_DRAW);
+}
+
+//Scene is the same for every run, given part of lists gets one changed command every frame
+void Measure(bool cached, unsigned changesPerMille, size_t frames)
+{
+	std::mt19937 random(1);
+	std::vector<std::vector<IRenderer::IndirectDraw>> lists(LISTS_COUNT);
+	for (auto& list : lists)
+	{
+		const size_t count = 6 + random() % 25;
+		for (size_t i = 0; i < count; ++i)
+		{
+			list.push_back({ i * 900, 300 + random() % 600, 1 });
+		}
+	}
+	uploadStats = sUploadStats();
+	COpenGLIndirectCache cache;
+	GLuint buffer = 0;
+	glGenBuffers(1, &buffer);
+	std::vector<DrawElementsIndirectCommand> commands;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (size_t frame = 0; frame < frames; ++frame)
+	{
+		for (auto& list : lists)
+		{
+			if (random() % 1000 < changesPerMille)
+			{
+				list[random() % list.size()].count = 300 + random() % 600;
+			}
+			if (cached)
+			{
+				cache.Get(list, true, false);
+			}
+			else
+			{
+				UploadList(list, buffer, commands);
+			}
+		}
+		cache.EndFrame();
+	}
+	const double time = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count() / frames;
+	std::cout << (cached ? "cache, " : "upload every list, ") << changesPerMille / 10.0 << "% lists changed: " << time << " us/frame, "
+		<< uploadStats.calls / frames << " upload calls/frame, " << uploadStats.bytes / frames << " bytes/frame" << std::endl;
+}
+}
+
+//Compares uploading indirect commands of 300 draw lists every frame with COpenGLIndirectCache, when lists do not change and when 10% of them change
+int BenchmarkIndirect(std::vector<std::string> const& args)
+{
+	size_t frames = 2000;
+	for (size_t i = 0; i + 1 < args.size(); ++i)
+	{
+		if (args[i] == "-n")
+		{
+			frames = std::max(atoi(args[++i].c_str()), 1);
+		}
+	}
+	CMockBufferFunctions mock;
+	for (unsigned changesPerMille : { 0u, 100u })
+	{
+		Measure(false, changesPerMille, frames);
+		Measure(true, changesPerMille, frames);
+	}
+	return 0;
+}
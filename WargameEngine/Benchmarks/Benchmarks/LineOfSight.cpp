@@ -0,0 +1,156 @@
+#include "Benchmarks.h"
+#include "impl/PhysicsEngineBullet.h"
+#include "model/IBoundingBoxManager.h"
+#include "model/Object.h"
+#include "ThreadPool.h"
+#include "Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+using namespace wargameEngine;
+
+namespace
+{
+constexpr size_t QUERIES_COUNT = 200;
+constexpr float OBJECTS_SPACING = 3.0f;
+//Half of rays must be free, like a typical script threshold
+constexpr size_t THRESHOLD = 50;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+double ElapsedMilliseconds(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+//Every unit has the same infantry sized box
+class BoundingManager : public model::IBoundingBoxManager
+{
+public:
+	model::Bounding GetBounding(const Path& /*path*/) override
+	{
+		return model::Bounding::Box{ CVector3f(-0.5f, -0.5f, 0.0f), CVector3f(0.5f, 0.5f, 2.0f) };
+	}
+	float GetModelScale(const Path& /*path*/) override
+	{
+		return 1.0f;
+	}
+	CVector3f GetModelRotation(const Path& /*path*/) override
+	{
+		return CVector3f();
+	}
+};
+
+struct sQuery
+{
+	model::IObject* shooter;
+	model::IObject* target;
+	std::vector<IPhysicsEngine::Ray> rays;
+};
+
+//Same grid of rays from the shooter head to the target box as controller::Controller::BBoxlos builds
+std::vector<IPhysicsEngine::Ray> MakeRays(model::IObject& shooter, model::IObject& target, model::Bounding::Box const& box)
+{
+	std::vector<IPhysicsEngine::Ray> rays;
+	CVector3f origin = shooter.GetCoords();
+	origin.z += 2.0f;
+	CVector3f dir;
+	for (dir.x = box.min[0] + target.GetX(); dir.x < box.max[0] + target.GetX(); dir.x += (box.max[0] - box.min[0]) / 10.0f + 0.0001f)
+	{
+		for (dir.y = box.min[1] + target.GetY(); dir.y < box.max[1] + target.GetY(); dir.y += (box.max[1] - box.min[1]) / 10.0f + 0.0001f)
+		{
+			for (dir.z = box.min[2] + target.GetZ(); dir.z < box.max[2] + target.GetZ(); dir.z += (box.max[2] - box.min[2]) / 10.0f + 0.0001f)
+			{
+				rays.push_back({ origin, dir });
+			}
+		}
+	}
+	return rays;
+}
+}
+
+//Checks line of sight between random pairs of units standing on a grid, ray by ray with CastRay like the former controller code did,
+//and as one batch on the thread pool with CastRays, with and without early out. Batches must find the same number of free rays
+int BenchmarkLineOfSight(std::vector<std::string> const& args)
+{
+	size_t objectsCount = 2500;
+	for (size_t i = 0; i < args.size(); ++i)
+	{
+		if (args[i] == "-n" && i + 1 < args.size())
+		{
+			objectsCount = std::max(atoi(args[++i].c_str()), 2);
+		}
+	}
+	BoundingManager boundingManager;
+	//Physics engine keeps connections to object signals, so objects must outlive it
+	std::vector<std::unique_ptr<model::Object>> objects;
+	CPhysicsEngineBullet physics;
+	physics.Reset(boundingManager);
+	const size_t side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(objectsCount))));
+	for (size_t i = 0; i < objectsCount; ++i)
+	{
+		objects.push_back(std::make_unique<model::Object>(make_path(L"unit.wbm"), CVector3f((i % side) * OBJECTS_SPACING, (i / side) * OBJECTS_SPACING, 0.0f),
+			static_cast<float>(i * 37 % 360)));
+		physics.AddDynamicObject(objects.back().get(), 0.0);
+	}
+	const model::Bounding bounding = boundingManager.GetBounding(Path());
+	std::vector<sQuery> queries;
+	size_t raysCount = 0;
+	for (size_t i = 0; i < QUERIES_COUNT; ++i)
+	{
+		model::Object& shooter = *objects[(i * 7919) % objectsCount];
+		model::Object& target = *objects[(i * 104729 + 1) % objectsCount];
+		queries.push_back({ &shooter, &target, MakeRays(shooter, target, bounding.GetBox()) });
+		raysCount += queries.back().rays.size();
+	}
+
+	std::vector<size_t> serial;
+	auto start = Clock::now();
+	for (auto& query : queries)
+	{
+		const std::vector<model::IBaseObject*> exclude = { query.shooter, query.target };
+		size_t freeRays = 0;
+		for (auto& ray : query.rays)
+		{
+			if (!physics.CastRay(ray.origin, ray.dest, exclude).success)
+			{
+				++freeRays;
+			}
+		}
+		serial.push_back(freeRays);
+	}
+	const double serialTime = ElapsedMilliseconds(start);
+
+	ThreadPool threadPool;
+	size_t mismatches = 0;
+	size_t visible = 0;
+	start = Clock::now();
+	for (size_t i = 0; i < queries.size(); ++i)
+	{
+		const size_t freeRays = physics.CastRays(queries[i].rays, { queries[i].shooter, queries[i].target }, threadPool);
+		mismatches += freeRays != serial[i] ? 1 : 0;
+		visible += freeRays ? 1 : 0;
+	}
+	const double batchTime = ElapsedMilliseconds(start);
+
+	start = Clock::now();
+	for (size_t i = 0; i < queries.size(); ++i)
+	{
+		const size_t neededFreeRays = (THRESHOLD * queries[i].rays.size() + 99) / 100;
+		const size_t freeRays = physics.CastRays(queries[i].rays, { queries[i].shooter, queries[i].target }, threadPool, neededFreeRays);
+		mismatches += (freeRays >= neededFreeRays) != (serial[i] >= neededFreeRays) ? 1 : 0;
+	}
+	const double earlyOutTime = ElapsedMilliseconds(start);
+	std::cout << QUERIES_COUNT << " line of sight checks (" << raysCount << " rays) among " << objectsCount << " units, " << visible << " targets visible: serial CastRay "
+		<< serialTime << " ms, batched CastRays " << batchTime << " ms, batched with early out at " << THRESHOLD << "% " << earlyOutTime << " ms ("
+		<< threadPool.GetWorkersCount() << " workers)" << std::endl;
+	if (mismatches)
+	{
+		std::cout << mismatches << " checks differ from serial casting" << std::endl;
+	}
+	return mismatches ? 1 : 0;
+}
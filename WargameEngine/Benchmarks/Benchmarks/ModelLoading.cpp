@@ -0,0 +1,272 @@
+#include "Benchmarks.h"
+#include "BaselineOBJ.h"
+#include "view/3dModel.h"
+#include "view/ColladaModelFactory.h"
+#include "view/OBJModelFactory.h"
+#include "view/WBMModelFactory.h"
+#include "OSSpecific.h"
+#include "ThreadPool.h"
+#include "Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace wargameEngine;
+using namespace wargameEngine::view;
+
+namespace
+{
+struct sModelArgs
+{
+	std::vector<Path> files;
+	Path outputDirectory;
+	int repeats = 3;
+};
+
+//Directories are searched for files with given extensions, files are taken as is
+bool ParseModelArgs(std::vector<std::string> const& args, std::vector<Path> const& extensions, sModelArgs& result)
+{
+	auto isModel = [&extensions](Path const& path) {
+		return std::find(extensions.begin(), extensions.end(), GetExtension(path)) != extensions.end();
+	};
+	const Path separator = make_path(L"/");
+	for (size_t i = 0; i < args.size(); ++i)
+	{
+		if (args[i] == "-o" && i + 1 < args.size())
+		{
+			result.outputDirectory = make_path(args[++i]);
+			MakeDir(result.outputDirectory);
+		}
+		else if (args[i] == "-n" && i + 1 < args.size())
+		{
+			result.repeats = std::max(atoi(args[++i].c_str()), 1);
+		}
+		else
+		{
+			Path input = make_path(args[i]);
+			if (isModel(input))
+			{
+				result.files.push_back(input);
+				continue;
+			}
+			for (auto& file : GetFiles(input, make_path(L"*"), true))
+			{
+				if (isModel(file))
+				{
+					result.files.push_back(input + separator + file);
+				}
+			}
+		}
+	}
+	return !result.files.empty();
+}
+
+Path GetFileName(Path const& path)
+{
+	return path.substr(path.find_last_of(make_path(L"\\/")) + 1);
+}
+
+//Returns average milliseconds per load, model from the last load is kept
+double MeasureLoad(IModelReader& reader, std::vector<char>& data, Path const& path, int repeats, std::unique_ptr<C3DModel>& model)
+{
+	C3DModel dummyModel(1.0f, CVector3f());
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < repeats; ++i)
+	{
+		model = reader.LoadModel(reinterpret_cast<unsigned char*>(data.data()), data.size() - 1, dummyModel, path);
+	}
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / repeats;
+}
+
+double MegabytesPerSecond(size_t bytes, double milliseconds)
+{
+	return milliseconds > 0.0 ? bytes / 1048576.0 / (milliseconds / 1000.0) : 0.0;
+}
+
+void SaveOutput(C3DModel const& model, sModelArgs const& settings, Path const& file)
+{
+	if (!settings.outputDirectory.empty())
+	{
+		Path name = GetFileName(file);
+		SaveWBMModel(model, settings.outputDirectory + make_path(L"/") + name.substr(0, name.find_last_of('.')) + make_path(L".wbm"));
+	}
+}
+}
+
+//Parses OBJ files with the baseline stringstream reader and with the engine reader with and without thread pool. All results must serialize to identical WBM.
+//With -o they are also saved, so outputs of two builds can be compared
+int BenchmarkOBJ(std::vector<std::string> const& args)
+{
+	sModelArgs settings;
+	if (!ParseModelArgs(args, { make_path(L"obj") }, settings))
+	{
+		std::cout << "No OBJ files found" << std::endl;
+		return 1;
+	}
+	ThreadPool threadPool;
+	CBaselineObjModelFactory baselineReader;
+	CObjModelFactory serialReader;
+	CObjModelFactory parallelReader;
+	parallelReader.SetThreadPool(threadPool);
+	size_t totalBytes = 0;
+	double baselineTotal = 0.0;
+	double serialTotal = 0.0;
+	double parallelTotal = 0.0;
+	size_t mismatches = 0;
+	for (auto& file : settings.files)
+	{
+		std::vector<char> data = ReadFileNullTerminated(file);
+		if (data.empty())
+		{
+			std::cout << "Cannot read " << to_string(file) << std::endl;
+			return 1;
+		}
+		const size_t size = data.size() - 1;
+		std::unique_ptr<C3DModel> baselineModel;
+		std::unique_ptr<C3DModel> serialModel;
+		std::unique_ptr<C3DModel> parallelModel;
+		double baselineTime = MeasureLoad(baselineReader, data, file, settings.repeats, baselineModel);
+		double serialTime = MeasureLoad(serialReader, data, file, settings.repeats, serialModel);
+		double parallelTime = MeasureLoad(parallelReader, data, file, settings.repeats, parallelModel);
+		const std::vector<char> serialOutput = SerializeWBMModel(*serialModel);
+		bool identical = SerializeWBMModel(*baselineModel) == serialOutput && SerializeWBMModel(*parallelModel) == serialOutput;
+		if (!identical)
+		{
+			++mismatches;
+		}
+		SaveOutput(*serialModel, settings, file);
+		std::cout << to_string(file) << ": " << size << " bytes, baseline " << baselineTime << " ms (" << MegabytesPerSecond(size, baselineTime) << " MB/s), serial "
+			<< serialTime << " ms (" << MegabytesPerSecond(size, serialTime) << " MB/s), thread pool " << parallelTime << " ms (" << MegabytesPerSecond(size, parallelTime)
+			<< " MB/s)" << (identical ? "" : ", OUTPUT DIFFERS") << std::endl;
+		totalBytes += size;
+		baselineTotal += baselineTime;
+		serialTotal += serialTime;
+		parallelTotal += parallelTime;
+	}
+	std::cout << settings.files.size() << " files, " << totalBytes << " bytes. Baseline " << baselineTotal << " ms (" << MegabytesPerSecond(totalBytes, baselineTotal)
+		<< " MB/s), serial " << serialTotal << " ms (" << MegabytesPerSecond(totalBytes, serialTotal) << " MB/s), thread pool " << parallelTotal << " ms ("
+		<< MegabytesPerSecond(totalBytes, parallelTotal) << " MB/s). Different outputs: " << mismatches << std::endl;
+	return mismatches ? 1 : 0;
+}
+
+//Measures parsing of Collada files, the first load with binary cache that parses and writes the cache and loads from the cache. Cached model must serialize to the same WBM as parsed one.
+//Cache is kept in cache directory of the working directory, like engine keeps it in module folder
+int BenchmarkCollada(std::vector<std::string> const& args)
+{
+	sModelArgs settings;
+	if (!ParseModelArgs(args, { make_path(L"dae") }, settings))
+	{
+		std::cout << "No Collada files found" << std::endl;
+		return 1;
+	}
+	CColladaModelFactory parser;
+	CColladaModelFactory cachedParser(true);
+	const Path cacheDirectory = make_path(L"cache");
+	cachedParser.SetCacheDirectory(cacheDirectory);
+	double parseTotal = 0.0;
+	double missTotal = 0.0;
+	double hitTotal = 0.0;
+	size_t mismatches = 0;
+	for (auto& file : settings.files)
+	{
+		std::vector<char> data = ReadFileNullTerminated(file);
+		if (data.empty())
+		{
+			std::cout << "Cannot read " << to_string(file) << std::endl;
+			return 1;
+		}
+		for (auto& cache : GetFiles(cacheDirectory, make_path(L"*.wcol"), false))
+		{
+			RemoveFile(cacheDirectory + make_path(L"/") + cache);
+		}
+		std::unique_ptr<C3DModel> parsedModel;
+		std::unique_ptr<C3DModel> cachedModel;
+		double parseTime = MeasureLoad(parser, data, file, settings.repeats, parsedModel);
+		double missTime = MeasureLoad(cachedParser, data, file, 1, cachedModel);
+		double hitTime = MeasureLoad(cachedParser, data, file, settings.repeats, cachedModel);
+		bool identical = SerializeWBMModel(*parsedModel) == SerializeWBMModel(*cachedModel);
+		if (!identical)
+		{
+			++mismatches;
+		}
+		SaveOutput(*parsedModel, settings, file);
+		std::cout << to_string(file) << ": parse " << parseTime << " ms, cache miss " << missTime << " ms, cache hit " << hitTime << " ms"
+			<< (identical ? "" : ", CACHED MODEL DIFFERS") << std::endl;
+		parseTotal += parseTime;
+		missTotal += missTime;
+		hitTotal += hitTime;
+	}
+	std::cout << settings.files.size() << " files. Parse " << parseTotal << " ms, cache miss " << missTotal << " ms, cache hit " << hitTotal << " ms. Different outputs: " << mismatches << std::endl;
+	return mismatches ? 1 : 0;
+}
+
+//Loads OBJ and Collada files with their readers and the same models from WBM version 2 made of them in memory. Version 1 file next to the source is loaded too if there is one.
+//Model loaded from WBM must serialize to the same file again
+int BenchmarkWBM(std::vector<std::string> const& args)
+{
+	sModelArgs settings;
+	if (!ParseModelArgs(args, { make_path(L"obj"), make_path(L"dae") }, settings))
+	{
+		std::cout << "No OBJ or Collada files found" << std::endl;
+		return 1;
+	}
+	ThreadPool threadPool;
+	CObjModelFactory objReader;
+	objReader.SetThreadPool(threadPool);
+	CColladaModelFactory colladaReader;
+	colladaReader.SetThreadPool(threadPool);
+	CWBMModelFactory wbmReader;
+	double sourceTotal = 0.0;
+	double v2Total = 0.0;
+	double v1Total = 0.0;
+	size_t v1Files = 0;
+	size_t mismatches = 0;
+	for (auto& file : settings.files)
+	{
+		std::vector<char> data = ReadFileNullTerminated(file);
+		if (data.empty())
+		{
+			std::cout << "Cannot read " << to_string(file) << std::endl;
+			return 1;
+		}
+		const bool collada = GetExtension(file) == make_path(L"dae");
+		std::unique_ptr<C3DModel> sourceModel;
+		const double sourceTime = MeasureLoad(collada ? static_cast<IModelReader&>(colladaReader) : objReader, data, file, settings.repeats, sourceModel);
+		const Path wbmPath = file.substr(0, file.find_last_of('.')) + make_path(L".wbm");
+		std::vector<char> v2Data = SerializeWBMModel(*sourceModel);
+		const size_t v2Size = v2Data.size();
+		v2Data.push_back('\0');
+		std::unique_ptr<C3DModel> v2Model;
+		const double v2Time = MeasureLoad(wbmReader, v2Data, wbmPath, settings.repeats, v2Model);
+		v2Data.pop_back();
+		const bool identical = SerializeWBMModel(*v2Model) == v2Data;
+		if (!identical)
+		{
+			++mismatches;
+		}
+		std::cout << to_string(file) << ": " << (collada ? "Collada " : "OBJ ") << sourceTime << " ms, WBM v2 " << v2Size << " bytes " << v2Time << " ms";
+		//First version files start with zero version
+		std::vector<char> v1Data = ReadFileNullTerminated(wbmPath);
+		uint32_t version = 1;
+		if (v1Data.size() > sizeof(version))
+		{
+			memcpy(&version, v1Data.data(), sizeof(version));
+		}
+		if (version == 0)
+		{
+			std::unique_ptr<C3DModel> v1Model;
+			const double v1Time = MeasureLoad(wbmReader, v1Data, wbmPath, settings.repeats, v1Model);
+			std::cout << ", WBM v1 " << v1Data.size() - 1 << " bytes " << v1Time << " ms";
+			v1Total += v1Time;
+			++v1Files;
+		}
+		std::cout << (identical ? "" : ", RELOADED MODEL DIFFERS") << std::endl;
+		sourceTotal += sourceTime;
+		v2Total += v2Time;
+	}
+	std::cout << settings.files.size() << " files. Source formats " << sourceTotal << " ms, WBM v2 " << v2Total << " ms. WBM v1 " << v1Total << " ms for "
+		<< v1Files << " files. Different outputs: " << mismatches << std::endl;
+	return mismatches ? 1 : 0;
+}
@@ -0,0 +1,228 @@
+#include "Benchmarks.h"
+#include "impl/NetSocket.h"
+#include "RingBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+
+using wargameEngine::INetSocket;
+using wargameEngine::RingBuffer;
+
+namespace
+{
+constexpr size_t CLIENTS_COUNT = 32;
+//Same framing as controller::Network uses: type byte and uint32 size of the whole message
+constexpr size_t HEADER_SIZE = 5;
+constexpr size_t MAX_MESSAGE_SIZE = 64 * 1024;
+constexpr char MESSAGE_DATA = 1;
+constexpr uint32_t FLOOD_MESSAGE_SIZE = 1024 * 1024 * 1024;
+
+struct sClient
+{
+	std::unique_ptr<CNetSocket> socket;
+	INetSocket::ConnectionId connection = 0;
+	bool connected = false;
+	size_t receivedMessages = 0;
+	size_t errors = 0;
+};
+
+typedef std::chrono::high_resolution_clock Clock;
+
+//Splits received data into messages like controller::Network does, buffer grows only for messages with valid size. Returns false if peer must be dropped
+template<class Handler>
+bool ReadMessages(RingBuffer& received, size_t& peakCapacity, Handler const& handler)
+{
+	bool valid = true;
+	while (received.GetSize() >= HEADER_SIZE)
+	{
+		char header[HEADER_SIZE];
+		received.Peek(header, HEADER_SIZE);
+		uint32_t size;
+		memcpy(&size, header + 1, sizeof(uint32_t));
+		if (size < HEADER_SIZE || size > MAX_MESSAGE_SIZE)
+		{
+			valid = false;
+			break;
+		}
+		if (received.GetSize() < size)
+		{
+			received.Reserve(size);
+			break;
+		}
+		handler(received.GetContiguous(size), size);
+		received.Consume(size);
+	}
+	peakCapacity = std::max(peakCapacity, received.GetCapacity());
+	return valid;
+}
+
+void MakeMessage(std::vector<char>& message, size_t size, size_t sender)
+{
+	message.resize(size);
+	message[0] = MESSAGE_DATA;
+	const uint32_t messageSize = static_cast<uint32_t>(size);
+	memcpy(message.data() + 1, &messageSize, sizeof(messageSize));
+	std::fill(message.begin() + HEADER_SIZE, message.end(), static_cast<char>(sender));
+}
+
+void PollAll(CNetSocket& host, std::vector<sClient>& clients, CNetSocket* extra)
+{
+	host.Poll();
+	for (auto& client : clients)
+	{
+		client.socket->Poll();
+	}
+	if (extra)
+	{
+		extra->Poll();
+	}
+}
+
+template<class Predicate>
+bool PollUntil(CNetSocket& host, std::vector<sClient>& clients, CNetSocket* extra, Predicate const& isDone, double timeoutSeconds)
+{
+	const auto start = Clock::now();
+	while (!isDone())
+	{
+		if (std::chrono::duration<double>(Clock::now() - start).count() > timeoutSeconds)
+			return false;
+		PollAll(host, clients, extra);
+	}
+	return true;
+}
+}
+
+//Host relays messages of 32 clients to all other clients over loopback, like controller::Network relays commands. Messages have random size up to 64 KB.
+//One more client announces 1 GB message and must be dropped. Receive buffers of all connections must stay within the maximum message size
+int BenchmarkNetwork(std::vector<std::string> const& args)
+{
+	size_t rounds = 100;
+	for (size_t i = 0; i + 1 < args.size(); ++i)
+	{
+		if (args[i] == "-n")
+		{
+			rounds = std::max(atoi(args[++i].c_str()), 1);
+		}
+	}
+	CNetSocket host;
+	if (!host.InitHost(0))
+	{
+		std::cout << "Cannot start host" << std::endl;
+		return 1;
+	}
+	std::vector<INetSocket::ConnectionId> hostConnections;
+	size_t hostPeakCapacity = 0;
+	size_t droppedPeers = 0;
+	host.SetHandlers([&](INetSocket::ConnectionId connection) {
+		hostConnections.push_back(connection);
+	}, [&](INetSocket::ConnectionId connection, RingBuffer& received) {
+		const bool valid = ReadMessages(received, hostPeakCapacity, [&](const char* data, size_t size) {
+			INetSocket::Buffer buffer = { data, size };
+			for (auto other : hostConnections)
+			{
+				if (other != connection)
+				{
+					host.SendData(other, &buffer, 1);
+				}
+			}
+		});
+		if (!valid)
+		{
+			++droppedPeers;
+			host.Disconnect(connection);
+			hostConnections.erase(std::remove(hostConnections.begin(), hostConnections.end(), connection), hostConnections.end());
+		}
+	}, [&](INetSocket::ConnectionId connection) {
+		hostConnections.erase(std::remove(hostConnections.begin(), hostConnections.end(), connection), hostConnections.end());
+	});
+
+	std::vector<sClient> clients(CLIENTS_COUNT);
+	size_t clientPeakCapacity = 0;
+	for (size_t i = 0; i < clients.size(); ++i)
+	{
+		sClient& client = clients[i];
+		client.socket = std::make_unique<CNetSocket>();
+		client.socket->SetHandlers([&client](INetSocket::ConnectionId connection) {
+			client.connection = connection;
+			client.connected = true;
+		}, [&client, &clientPeakCapacity, i](INetSocket::ConnectionId, RingBuffer& received) {
+			ReadMessages(received, clientPeakCapacity, [&client, i](const char* data, size_t size) {
+				++client.receivedMessages;
+				const size_t sender = static_cast<unsigned char>(data[HEADER_SIZE]);
+				if (data[0] != MESSAGE_DATA || sender == i || sender >= CLIENTS_COUNT || data[size - 1] != data[HEADER_SIZE])
+				{
+					++client.errors;
+				}
+			});
+		}, [&client](INetSocket::ConnectionId) {
+			client.connected = false;
+		});
+		if (!client.socket->InitClient("127.0.0.1", host.GetPort()))
+		{
+			std::cout << "Cannot connect client" << std::endl;
+			return 1;
+		}
+	}
+	if (!PollUntil(host, clients, nullptr, [&] {
+		return hostConnections.size() == CLIENTS_COUNT && std::all_of(clients.begin(), clients.end(), [](sClient const& client) { return client.connected; });
+	}, 10.0))
+	{
+		std::cout << "Clients cannot connect to host" << std::endl;
+		return 1;
+	}
+
+	CNetSocket flooder;
+	INetSocket::ConnectionId flooderConnection = 0;
+	flooder.SetHandlers([&](INetSocket::ConnectionId connection) { flooderConnection = connection; }, [](INetSocket::ConnectionId, RingBuffer& received) {
+		received.Clear();
+	}, [](INetSocket::ConnectionId) {});
+	flooder.InitClient("127.0.0.1", host.GetPort());
+	PollUntil(host, clients, &flooder, [&] { return flooderConnection != 0; }, 10.0);
+	std::vector<char> flood(HEADER_SIZE + 64 * 1024);
+	flood[0] = MESSAGE_DATA;
+	memcpy(flood.data() + 1, &FLOOD_MESSAGE_SIZE, sizeof(FLOOD_MESSAGE_SIZE));
+	INetSocket::Buffer floodBuffer = { flood.data(), flood.size() };
+	flooder.SendData(flooderConnection, &floodBuffer, 1);
+	PollUntil(host, clients, &flooder, [&] { return droppedPeers > 0; }, 10.0);
+
+	std::mt19937 random(42);
+	std::uniform_int_distribution<size_t> sizes(HEADER_SIZE + 1, MAX_MESSAGE_SIZE);
+	std::vector<char> message;
+	size_t sentBytes = 0;
+	const auto start = Clock::now();
+	for (size_t round = 0; round < rounds; ++round)
+	{
+		for (size_t i = 0; i < clients.size(); ++i)
+		{
+			MakeMessage(message, sizes(random), i);
+			INetSocket::Buffer buffer = { message.data(), message.size() };
+			clients[i].socket->SendData(clients[i].connection, &buffer, 1);
+			sentBytes += message.size();
+		}
+		PollAll(host, clients, nullptr);
+	}
+	const size_t expected = rounds * (CLIENTS_COUNT - 1);
+	const bool delivered = PollUntil(host, clients, nullptr, [&] {
+		return std::all_of(clients.begin(), clients.end(), [expected](sClient const& client) { return client.receivedMessages >= expected; });
+	}, 60.0);
+	const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	size_t errors = 0;
+	size_t received = 0;
+	for (auto& client : clients)
+	{
+		errors += client.errors;
+		received += client.receivedMessages;
+	}
+	const double deliveredMegabytes = static_cast<double>(sentBytes) * (CLIENTS_COUNT - 1) / (1024 * 1024);
+	std::cout << CLIENTS_COUNT << " clients, " << rounds << " rounds: " << received << " of " << expected * CLIENTS_COUNT << " messages delivered in " << seconds << " s ("
+		<< deliveredMegabytes / seconds << " MB/s), peak receive buffer " << hostPeakCapacity / 1024 << " KB on host, " << clientPeakCapacity / 1024 << " KB on clients, "
+		<< droppedPeers << " flooding peer dropped" << (errors ? ", CORRUPTED MESSAGES" : "") << std::endl;
+	const bool bounded = hostPeakCapacity <= MAX_MESSAGE_SIZE && clientPeakCapacity <= MAX_MESSAGE_SIZE;
+	return delivered && errors == 0 && droppedPeers == 1 && bounded ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+#include "Benchmarks.h"
+#include "controller/SaveGame.h"
+#include "model/Model.h"
+#include "model/Object.h"
+#include "Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#ifdef _WINDOWS
+#define NOMINMAX
+#include <Windows.h>
+#include <Psapi.h>
+#pragma comment(lib, "Psapi.lib")
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+using namespace wargameEngine;
+
+namespace
+{
+constexpr size_t PROPERTIES_PER_OBJECT = 12;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+double ElapsedMilliseconds(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+//Resident memory of the process in kilobytes, current and the maximum it ever had
+struct sMemory
+{
+	size_t current = 0;
+	size_t peak = 0;
+};
+
+sMemory GetMemory()
+{
+	sMemory result;
+#ifdef _WINDOWS
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		result.current = counters.WorkingSetSize / 1024;
+		result.peak = counters.PeakWorkingSetSize / 1024;
+	}
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+	{
+		result.peak = static_cast<size_t>(usage.ru_maxrss);
+	}
+	FILE* file = fopen("/proc/self/statm", "r");
+	if (file)
+	{
+		size_t pages = 0;
+		size_t resident = 0;
+		if (fscanf(file, "%zu %zu", &pages, &resident) == 2)
+		{
+			result.current = resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) / 1024;
+		}
+		fclose(file);
+	}
+#endif
+	return result;
+}
+
+void FillModel(model::Model& model, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto object = std::make_shared<model::Object>(make_path(L"models/units/unit" + std::to_wstring(i % 20) + L".wbm"), CVector3f(i * 0.1f, i * 0.2f, 0.0f),
+			static_cast<float>(i % 360));
+		model.AddObject(object);
+		for (size_t j = 0; j < PROPERTIES_PER_OBJECT; ++j)
+		{
+			object->SetProperty(L"Property" + std::to_wstring(j), L"Value of property number " + std::to_wstring(i * j));
+		}
+	}
+	model.SetProperty(L"Turn", L"12");
+}
+}
+
+//Saves a generated scene or loads a save the same way controller::Controller does and prints time and resident memory.
+//Peak memory of a process never goes down, so saving and loading are measured by separate runs
+int BenchmarkSaveLoad(std::vector<std::string> const& args)
+{
+	size_t objectsCount = 10000;
+	std::string mode;
+	Path file;
+	for (size_t i = 0; i < args.size(); ++i)
+	{
+		if (args[i] == "-n" && i + 1 < args.size())
+		{
+			objectsCount = std::max(atoi(args[++i].c_str()), 1);
+		}
+		else if (mode.empty())
+		{
+			mode = args[i];
+		}
+		else
+		{
+			file = make_path(args[i]);
+		}
+	}
+	if ((mode != "save" && mode != "load") || file.empty())
+	{
+		std::cout << "Mode must be save or load, followed by save file" << std::endl;
+		return 1;
+	}
+	model::Model model;
+	if (mode == "save")
+	{
+		FillModel(model, objectsCount);
+		const sMemory before = GetMemory();
+		auto start = Clock::now();
+		const controller::sSaveSnapshot snapshot = controller::MakeSnapshot(model);
+		const double snapshotTime = ElapsedMilliseconds(start);
+		start = Clock::now();
+		const bool written = controller::WriteSaveGame(file, snapshot);
+		const double writeTime = ElapsedMilliseconds(start);
+		const sMemory after = GetMemory();
+		std::cout << objectsCount << " objects saved: snapshot on game thread " << snapshotTime << " ms, write " << writeTime << " ms, peak memory "
+			<< (after.peak > before.current ? after.peak - before.current : 0) << " KB above scene" << std::endl;
+		return written ? 0 : 1;
+	}
+	const sMemory before = GetMemory();
+	auto start = Clock::now();
+	controller::SaveGameReader reader(file);
+	if (!reader.IsValid())
+	{
+		std::cout << "Not a chunked save file" << std::endl;
+		return 1;
+	}
+	reader.Validate();
+	const double validateTime = ElapsedMilliseconds(start);
+	auto properties = reader.ReadProperties();
+	std::vector<controller::sSavedObject> chunk;
+	while (reader.ReadObjects(chunk))
+	{
+		for (auto& saved : chunk)
+		{
+			auto object = std::make_shared<model::Object>(make_path(saved.model), saved.coords, saved.rotation);
+			model.AddObject(object, saved.handle);
+			for (auto& property : saved.properties)
+			{
+				object->SetProperty(property.first, property.second);
+			}
+		}
+	}
+	for (auto& property : properties)
+	{
+		model.SetProperty(property.first, property.second);
+	}
+	const double loadTime = ElapsedMilliseconds(start);
+	const sMemory after = GetMemory();
+	const size_t sceneMemory = after.current > before.current ? after.current - before.current : 0;
+	const size_t peakMemory = after.peak > before.current ? after.peak - before.current : 0;
+	std::cout << model.GetObjectCount() << " objects loaded in " << loadTime << " ms (validation " << validateTime << " ms), loaded scene " << sceneMemory
+		<< " KB, peak " << peakMemory << " KB above start" << std::endl;
+	return 0;
+}
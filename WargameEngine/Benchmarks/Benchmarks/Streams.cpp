@@ -0,0 +1,381 @@
+#include "Benchmarks.h"
+#include "MemoryStream.h"
+#include "OSSpecific.h"
+#include "Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+using namespace wargameEngine;
+
+namespace
+{
+constexpr size_t OBJECTS_COUNT = 5000;
+constexpr size_t PROPERTIES_PER_OBJECT = 4;
+constexpr size_t COMMANDS_COUNT = 100000;
+constexpr float POSITION_SCALE = 1024.0f;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+double ElapsedMilliseconds(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+//Same layout as state of controller::Controller
+void WriteState(IWriteMemoryStream& stream)
+{
+	stream.WriteVarint(static_cast<uint32_t>(OBJECTS_COUNT));
+	for (size_t i = 0; i < OBJECTS_COUNT; ++i)
+	{
+		stream.WriteFloat(i * 0.5f);
+		stream.WriteFloat(i * 0.25f);
+		stream.WriteFloat(0.0f);
+		stream.WriteFloat(static_cast<float>(i % 360));
+		stream.WriteString("models/infantry/marine.wbm");
+		stream.WriteVarint(static_cast<uint32_t>(i));
+		stream.WriteVarint(static_cast<uint32_t>(PROPERTIES_PER_OBJECT));
+		for (size_t j = 0; j < PROPERTIES_PER_OBJECT; ++j)
+		{
+			stream.WriteWString(L"property" + std::to_wstring(j));
+			stream.WriteWString(std::to_wstring(i + j));
+		}
+	}
+}
+
+float ReadState(IReadMemoryStream& stream)
+{
+	float checksum = 0.0f;
+	const uint32_t count = stream.ReadVarint();
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		checksum += stream.ReadFloat() + stream.ReadFloat() + stream.ReadFloat() + stream.ReadFloat();
+		checksum += stream.ReadString().size();
+		checksum += stream.ReadVarint();
+		const uint32_t properties = stream.ReadVarint();
+		for (uint32_t j = 0; j < properties; ++j)
+		{
+			checksum += stream.ReadWString().size();
+			checksum += stream.ReadWString().size();
+		}
+	}
+	return checksum;
+}
+
+//Same layout as move command sent by controller::Network: type, object handle and quantized offset
+void WriteCommand(IWriteMemoryStream& stream, size_t index)
+{
+	stream.WriteByte(1);
+	stream.WriteVarint(static_cast<uint32_t>(index % OBJECTS_COUNT));
+	stream.WriteQuantizedFloat((index % 100) * 0.01f, POSITION_SCALE);
+	stream.WriteQuantizedFloat((index % 50) * -0.02f, POSITION_SCALE);
+}
+
+float ReadCommand(IReadMemoryStream& stream)
+{
+	float checksum = stream.ReadByte();
+	checksum += stream.ReadVarint();
+	checksum += stream.ReadQuantizedFloat(POSITION_SCALE);
+	checksum += stream.ReadQuantizedFloat(POSITION_SCALE);
+	return checksum;
+}
+
+//Fuzzed data is a sequence of tagged values, so mutations reach every read function
+enum eFuzzTag : unsigned char
+{
+	TAG_BOOL,
+	TAG_BYTE,
+	TAG_SHORT,
+	TAG_INT,
+	TAG_UNSIGNED,
+	TAG_FLOAT,
+	TAG_DOUBLE,
+	TAG_STRING,
+	TAG_WSTRING,
+	TAG_POINTER,
+	TAG_VARINT,
+	TAG_SIGNED_VARINT,
+	TAG_QUANTIZED_FLOAT,
+	TAG_DATA,
+	TAG_COUNT
+};
+
+//Returns false if data is rejected. Any other outcome than a value or an exception is a bug
+bool DecodeTagged(const char* data, size_t size)
+{
+	ReadMemoryStream stream(data, size);
+	try
+	{
+		while (stream.GetRemaining() > 0)
+		{
+			switch (stream.ReadByte() % TAG_COUNT)
+			{
+			case TAG_BOOL: stream.ReadBool(); break;
+			case TAG_BYTE: stream.ReadByte(); break;
+			case TAG_SHORT: stream.ReadShort(); break;
+			case TAG_INT: stream.ReadInt(); break;
+			case TAG_UNSIGNED: stream.ReadUnsigned(); break;
+			case TAG_FLOAT: stream.ReadFloat(); break;
+			case TAG_DOUBLE: stream.ReadDouble(); break;
+			case TAG_STRING: stream.ReadString(); break;
+			case TAG_WSTRING: stream.ReadWString(); break;
+			case TAG_POINTER: stream.ReadPointer(); break;
+			case TAG_VARINT: stream.ReadVarint(); break;
+			case TAG_SIGNED_VARINT: stream.ReadSignedVarint(); break;
+			case TAG_QUANTIZED_FLOAT: stream.ReadQuantizedFloat(POSITION_SCALE); break;
+			case TAG_DATA:
+			{
+				char buffer[16];
+				stream.ReadData(buffer, stream.ReadByte() % sizeof(buffer));
+				break;
+			}
+			}
+		}
+	}
+	catch (std::exception const&)
+	{
+		return false;
+	}
+	return true;
+}
+
+//Seeds cover edge values of every encoding. Written by -g, so corpus can be regenerated after format changes
+std::vector<std::vector<char>> MakeSeeds()
+{
+	std::vector<std::vector<char>> seeds;
+	std::vector<char> buffer;
+	auto add = [&](std::function<void(IWriteMemoryStream&)> const& write) {
+		{
+			WriteMemoryStream stream(buffer);
+			write(stream);
+		}
+		seeds.push_back(buffer);
+	};
+	add([](IWriteMemoryStream& stream) {
+		for (uint32_t value : { 0u, 1u, 127u, 128u, 16383u, 16384u, 0xFFFFFFFFu })
+		{
+			stream.WriteByte(TAG_VARINT);
+			stream.WriteVarint(value);
+		}
+	});
+	add([](IWriteMemoryStream& stream) {
+		for (int32_t value : { 0, -1, 1, -64, 64, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max() })
+		{
+			stream.WriteByte(TAG_SIGNED_VARINT);
+			stream.WriteSignedVarint(value);
+		}
+	});
+	add([](IWriteMemoryStream& stream) {
+		for (float value : { 0.0f, -0.5f, 1e9f, -1e9f, std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity() })
+		{
+			stream.WriteByte(TAG_QUANTIZED_FLOAT);
+			stream.WriteQuantizedFloat(value, POSITION_SCALE);
+			stream.WriteByte(TAG_FLOAT);
+			stream.WriteFloat(value);
+		}
+	});
+	add([](IWriteMemoryStream& stream) {
+		stream.WriteByte(TAG_STRING);
+		stream.WriteString(std::string());
+		stream.WriteByte(TAG_STRING);
+		stream.WriteString(std::string(300, 'x'));
+		stream.WriteByte(TAG_WSTRING);
+		stream.WriteWString(L"Space Marine");
+	});
+	add([](IWriteMemoryStream& stream) {
+		stream.WriteByte(TAG_BOOL);
+		stream.WriteBool(true);
+		stream.WriteByte(TAG_BYTE);
+		stream.WriteByte(0xFF);
+		stream.WriteByte(TAG_INT);
+		stream.WriteInt(-1);
+		stream.WriteByte(TAG_UNSIGNED);
+		stream.WriteUnsigned(0x80000000u);
+		stream.WriteByte(TAG_DOUBLE);
+		stream.WriteDouble(-1.5);
+		stream.WriteByte(TAG_POINTER);
+		stream.WritePointer(nullptr);
+		stream.WriteByte(TAG_DATA);
+		stream.WriteByte(4);
+		stream.WriteInt(42);
+	});
+	return seeds;
+}
+
+void Mutate(std::vector<char>& data, std::mt19937& random)
+{
+	static const unsigned char interesting[] = { 0x00, 0x01, 0x7F, 0x80, 0xFF };
+	const size_t mutations = 1 + random() % 4;
+	for (size_t i = 0; i < mutations && !data.empty(); ++i)
+	{
+		const size_t position = random() % data.size();
+		switch (random() % 5)
+		{
+		case 0://bit flip
+			data[position] ^= static_cast<char>(1 << (random() % 8));
+			break;
+		case 1:
+			data[position] = static_cast<char>(interesting[random() % sizeof(interesting)]);
+			break;
+		case 2:
+			data.resize(position);
+			break;
+		case 3:
+		{
+			const size_t length = std::min<size_t>(1 + random() % 16, data.size() - position);
+			std::vector<char> copy(data.begin() + position, data.begin() + position + length);
+			data.insert(data.begin() + random() % data.size(), copy.begin(), copy.end());
+			break;
+		}
+		default:
+			data.insert(data.begin() + position, static_cast<char>(random()));
+			break;
+		}
+	}
+}
+}
+
+//Serializes state of 5000 objects and 100000 move commands with the engine memory streams and reads them back.
+//Send buffer is reused between messages like in controller::Network, so small commands follow a big state in the same buffer
+int BenchmarkStreams(std::vector<std::string> const& args)
+{
+	size_t repeats = 20;
+	for (size_t i = 0; i + 1 < args.size(); ++i)
+	{
+		if (args[i] == "-n")
+		{
+			repeats = std::max(atoi(args[++i].c_str()), 1);
+		}
+	}
+	std::vector<char> buffer;
+	float checksum = 0.0f;
+	auto start = Clock::now();
+	for (size_t i = 0; i < repeats; ++i)
+	{
+		WriteMemoryStream stream(buffer);
+		WriteState(stream);
+	}
+	const double stateWrite = ElapsedMilliseconds(start) / repeats;
+	const size_t stateSize = buffer.size();
+	start = Clock::now();
+	for (size_t i = 0; i < repeats; ++i)
+	{
+		ReadMemoryStream stream(buffer.data(), buffer.size());
+		checksum += ReadState(stream);
+	}
+	const double stateRead = ElapsedMilliseconds(start) / repeats;
+
+	size_t commandsSize = 0;
+	start = Clock::now();
+	for (size_t i = 0; i < COMMANDS_COUNT; ++i)
+	{
+		WriteMemoryStream stream(buffer);
+		WriteCommand(stream, i);
+		commandsSize += stream.GetSize();
+	}
+	const double commandsWrite = ElapsedMilliseconds(start);
+	std::vector<char> commands;
+	{
+		WriteMemoryStream stream(commands);
+		for (size_t i = 0; i < COMMANDS_COUNT; ++i)
+		{
+			WriteCommand(stream, i);
+		}
+	}
+	start = Clock::now();
+	{
+		ReadMemoryStream stream(commands.data(), commands.size());
+		for (size_t i = 0; i < COMMANDS_COUNT; ++i)
+		{
+			checksum += ReadCommand(stream);
+		}
+	}
+	const double commandsRead = ElapsedMilliseconds(start);
+	auto megabytesPerSecond = [](size_t bytes, double milliseconds) {
+		return milliseconds > 0.0 ? bytes / 1048576.0 / (milliseconds / 1000.0) : 0.0;
+	};
+	std::cout << "State of " << OBJECTS_COUNT << " objects, " << stateSize << " bytes: write " << stateWrite << " ms (" << megabytesPerSecond(stateSize, stateWrite)
+		<< " MB/s), read " << stateRead << " ms (" << megabytesPerSecond(stateSize, stateRead) << " MB/s)" << std::endl;
+	std::cout << COMMANDS_COUNT << " commands, " << commandsSize << " bytes: write " << commandsWrite * 1000000.0 / COMMANDS_COUNT << " ns/command, read "
+		<< commandsRead * 1000000.0 / COMMANDS_COUNT << " ns/command (checksum " << checksum << ")" << std::endl;
+	return 0;
+}
+
+//Decodes randomly mutated corpus files. Reads may only return values or throw, so it is meant to be run under address sanitizer or debug heap.
+//With -g corpus directory is filled with seed files first
+int BenchmarkStreamFuzz(std::vector<std::string> const& args)
+{
+	size_t iterations = 100000;
+	Path corpus;
+	bool generate = false;
+	for (size_t i = 0; i < args.size(); ++i)
+	{
+		if (args[i] == "-n" && i + 1 < args.size())
+		{
+			iterations = std::max(atoi(args[++i].c_str()), 1);
+		}
+		else if (args[i] == "-g")
+		{
+			generate = true;
+		}
+		else
+		{
+			corpus = make_path(args[i]);
+		}
+	}
+	if (corpus.empty())
+	{
+		std::cout << "Corpus directory is not set" << std::endl;
+		return 1;
+	}
+	const Path separator = make_path(L"/");
+	if (generate)
+	{
+		MakeDir(corpus);
+		auto seeds = MakeSeeds();
+		for (size_t i = 0; i < seeds.size(); ++i)
+		{
+			WriteFile(corpus + separator + make_path(L"seed" + std::to_wstring(i) + L".bin"), seeds[i]);
+		}
+	}
+	std::vector<std::vector<char>> files;
+	for (auto& file : GetFiles(corpus, make_path(L"*"), false))
+	{
+		files.push_back(ReadFile(corpus + separator + file));
+	}
+	if (files.empty())
+	{
+		std::cout << "No corpus files found" << std::endl;
+		return 1;
+	}
+	size_t invalidSeeds = 0;
+	for (auto& file : files)
+	{
+		if (!DecodeTagged(file.data(), file.size()))
+		{
+			++invalidSeeds;
+		}
+	}
+	std::mt19937 random(7);
+	size_t rejected = 0;
+	std::vector<char> data;
+	auto start = Clock::now();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		data = files[i % files.size()];
+		Mutate(data, random);
+		if (!DecodeTagged(data.data(), data.size()))
+		{
+			++rejected;
+		}
+	}
+	const double time = ElapsedMilliseconds(start);
+	std::cout << files.size() << " corpus files, " << invalidSeeds << " of them rejected. " << iterations << " mutations decoded in " << time << " ms, " << rejected
+		<< " rejected" << std::endl;
+	return invalidSeeds ? 1 : 0;
+}
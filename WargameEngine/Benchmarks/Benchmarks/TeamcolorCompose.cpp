@@ -0,0 +1,209 @@
+#include "Benchmarks.h"
+#include "view/Image.h"
+#include "view/Teamcolor.h"
+#include "MemoryStream.h"
+#include "ThreadPool.h"
+#include "Utils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace wargameEngine;
+using namespace wargameEngine::view;
+
+namespace
+{
+constexpr size_t TEXTURES_COUNT = 50;
+constexpr size_t TEXTURE_SIZE = 256;
+constexpr size_t MASK_SIZE = 128;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+double ElapsedMilliseconds(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct sTexture
+{
+	std::vector<unsigned char> pixels;
+	std::vector<char> mask;
+};
+
+//8 bit greyscale BMP, bottom-up rows. Masks are mostly black with painted areas, like real unit masks
+std::vector<char> MakeMask(size_t seed)
+{
+	const uint32_t paletteSize = 256 * 4;
+	const uint32_t dataOffset = 14 + 40 + paletteSize;
+	std::vector<char> result;
+	WriteMemoryStream stream(result);
+	stream.WriteByte('B');
+	stream.WriteByte('M');
+	stream.WriteUnsigned(static_cast<uint32_t>(dataOffset + MASK_SIZE * MASK_SIZE));
+	stream.WriteUnsigned(0);
+	stream.WriteUnsigned(dataOffset);
+	stream.WriteUnsigned(40);
+	stream.WriteInt(static_cast<int>(MASK_SIZE));
+	stream.WriteInt(static_cast<int>(MASK_SIZE));
+	//Planes and bits per pixel, 16 bit each
+	stream.WriteUnsigned(1 | (8 << 16));
+	for (size_t i = 0; i < 6; ++i)
+	{
+		stream.WriteUnsigned(0);
+	}
+	for (uint32_t i = 0; i < 256; ++i)
+	{
+		stream.WriteUnsigned(i | (i << 8) | (i << 16));
+	}
+	for (size_t y = 0; y < MASK_SIZE; ++y)
+	{
+		for (size_t x = 0; x < MASK_SIZE; ++x)
+		{
+			const bool painted = ((x + seed * 7) / 16 + (y + seed * 3) / 24) % 3 == 0;
+			stream.WriteByte(painted ? static_cast<unsigned char>(128 + (x * 4 + y) % 128) : 0);
+		}
+	}
+	return result;
+}
+
+std::vector<sTexture> MakeTextures()
+{
+	std::vector<sTexture> textures(TEXTURES_COUNT);
+	for (size_t i = 0; i < TEXTURES_COUNT; ++i)
+	{
+		textures[i].pixels.resize(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+		for (size_t j = 0; j < textures[i].pixels.size(); ++j)
+		{
+			textures[i].pixels[j] = static_cast<unsigned char>((j * 31 + i * 17) % 251);
+		}
+		textures[i].mask = MakeMask(i);
+	}
+	return textures;
+}
+
+void MakeColor(size_t faction, unsigned char* color)
+{
+	color[0] = static_cast<unsigned char>(faction * 53);
+	color[1] = static_cast<unsigned char>(255 - faction * 29);
+	color[2] = static_cast<unsigned char>(faction * 97 + 40);
+}
+
+Image Compose(sTexture const& texture, const unsigned char* color)
+{
+	Image image(std::vector<unsigned char>(texture.pixels), TEXTURE_SIZE, TEXTURE_SIZE, 32);
+	ApplyTeamcolor(image, texture.mask, color);
+	return image;
+}
+
+uint64_t HashImage(Image const& image)
+{
+	return HashData(image.GetData(), image.GetWidth() * image.GetHeight() * image.GetBPP() / 8);
+}
+
+//Per pixel blend with the formula of the engine kernel, to check that vector code gives the same bytes
+uint64_t ComposeReference(sTexture const& texture, const unsigned char* color)
+{
+	std::vector<unsigned char> pixels = texture.pixels;
+	const unsigned char* mask = reinterpret_cast<const unsigned char*>(texture.mask.data()) + texture.mask.size() - MASK_SIZE * MASK_SIZE;
+	for (size_t y = 0; y < TEXTURE_SIZE; ++y)
+	{
+		for (size_t x = 0; x < TEXTURE_SIZE; ++x)
+		{
+			const unsigned weight = mask[(y * MASK_SIZE / TEXTURE_SIZE) * MASK_SIZE + x * MASK_SIZE / TEXTURE_SIZE];
+			for (size_t channel = 0; channel < 3; ++channel)
+			{
+				unsigned char& value = pixels[(y * TEXTURE_SIZE + x) * 4 + channel];
+				const unsigned t = value * (255u - weight) + color[channel] * weight + 128u;
+				value = static_cast<unsigned char>((t + (t >> 8)) >> 8);
+			}
+		}
+	}
+	return HashData(pixels.data(), pixels.size());
+}
+}
+
+//Composes 50 textures for 64 factions serially and on the thread pool, stores results to the teamcolor cache and loads them back like a warm start does.
+//Every result must match the per pixel reference and the cached copy
+int BenchmarkTeamcolor(std::vector<std::string> const& args)
+{
+	size_t factions = 64;
+	Path cacheDirectory;
+	for (size_t i = 0; i < args.size(); ++i)
+	{
+		if (args[i] == "-n" && i + 1 < args.size())
+		{
+			factions = std::max(atoi(args[++i].c_str()), 1);
+		}
+		else
+		{
+			cacheDirectory = make_path(args[i]);
+		}
+	}
+	if (cacheDirectory.empty())
+	{
+		std::cout << "Cache directory is not set" << std::endl;
+		return 1;
+	}
+	const std::vector<sTexture> textures = MakeTextures();
+	const size_t count = factions * TEXTURES_COUNT;
+	std::vector<unsigned char> colors(factions * 3);
+	for (size_t i = 0; i < factions; ++i)
+	{
+		MakeColor(i, &colors[i * 3]);
+	}
+	auto getColor = [&colors](size_t job) { return &colors[job / TEXTURES_COUNT * 3]; };
+	std::vector<uint64_t> reference(count);
+	auto start = Clock::now();
+	for (size_t i = 0; i < count; ++i)
+	{
+		reference[i] = ComposeReference(textures[i % TEXTURES_COUNT], getColor(i));
+	}
+	const double referenceTime = ElapsedMilliseconds(start);
+
+	std::vector<uint64_t> results(count);
+	start = Clock::now();
+	for (size_t i = 0; i < count; ++i)
+	{
+		results[i] = HashImage(Compose(textures[i % TEXTURES_COUNT], getColor(i)));
+	}
+	const double serialTime = ElapsedMilliseconds(start);
+	size_t mismatches = results == reference ? 0 : 1;
+
+	ThreadPool threadPool;
+	start = Clock::now();
+	threadPool.ParallelFor(0, count, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+		{
+			Image image = Compose(textures[i % TEXTURES_COUNT], getColor(i));
+			results[i] = HashImage(image);
+			StoreTeamcolorCache(cacheDirectory, i, image);
+		}
+	}, 1);
+	const double coldTime = ElapsedMilliseconds(start);
+	mismatches += results == reference ? 0 : 1;
+
+	std::atomic<size_t> missing(0);
+	start = Clock::now();
+	threadPool.ParallelFor(0, count, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+		{
+			Image image;
+			if (LoadTeamcolorCache(cacheDirectory, i, image))
+			{
+				results[i] = HashImage(image);
+			}
+			else
+			{
+				++missing;
+			}
+		}
+	}, 1);
+	const double warmTime = ElapsedMilliseconds(start);
+	mismatches += results == reference ? 0 : 1;
+	std::cout << factions << " factions x " << TEXTURES_COUNT << " textures " << TEXTURE_SIZE << "x" << TEXTURE_SIZE << ": per pixel reference " << referenceTime << " ms, serial compose " << serialTime
+		<< " ms, thread pool compose and store " << coldTime << " ms, warm load from cache " << warmTime << " ms (" << threadPool.GetWorkersCount() << " workers)"
+		<< (missing ? ", CACHE MISSES" : "") << (mismatches ? ", RESULTS DIFFER" : "") << std::endl;
+	return mismatches || missing ? 1 : 0;
+}
@@ -0,0 +1,200 @@
+#include "Benchmarks.h"
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include "impl/ShaderManagerOpenGL.h"
+#include "view/PerfomanceMeter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace wargameEngine::view;
+
+namespace
+{
+constexpr size_t DRAWS_COUNT = 2000;
+//Draws are sorted by material, so it changes once per several draws
+constexpr size_t DRAWS_PER_MATERIAL = 64;
+constexpr size_t MATERIALS_COUNT = 8;
+
+constexpr char plainVertexUniforms[] = "\
+uniform mat4 view_matrix;\n\
+uniform mat4 model_matrix;\n\
+uniform mat4 mvp_matrix;\n";
+constexpr char frameBlockVertexUniforms[] = "\
+layout (std140) uniform PerFrame\n\
+{\n\
+	mat4 view_matrix;\n\
+	mat4 proj_matrix;\n\
+};\n\
+uniform mat4 model_matrix;\n\
+uniform mat4 mvp_matrix;\n";
+constexpr char vertexMain[] = "\
+layout (location = 0) in vec3 Position;\n\
+out vec3 v_pos;\n\
+void main()\n\
+{\n\
+	gl_Position = mvp_matrix * vec4(Position, 1.0);\n\
+	v_pos = (view_matrix * model_matrix * vec4(Position, 1.0)).xyz;\n\
+}";
+constexpr char plainFragmentUniforms[] = "\
+struct Material\n\
+{\n\
+	vec4 ambient;\n\
+	vec4 diffuse;\n\
+	vec4 specular;\n\
+	float shininess;\n\
+};\n\
+uniform Material material;\n";
+constexpr char blockFragmentUniforms[] = "\
+layout (std140) uniform Material\n\
+{\n\
+	vec4 ambient;\n\
+	vec4 diffuse;\n\
+	vec4 specular;\n\
+	float shininess;\n\
+} material;\n";
+constexpr char fragmentMain[] = "\
+uniform vec4 color;\n\
+in vec3 v_pos;\n\
+out vec4 fragColor;\n\
+void main()\n\
+{\n\
+	fragColor = color * material.diffuse + material.ambient + material.specular * (material.shininess * length(v_pos));\n\
+}";
+
+struct sMode
+{
+	const char* name;
+	const char* vertexUniforms;
+	const char* fragmentUniforms;
+	//Color is set by name or by handle every draw, as renderer did before and after handles were added
+	bool uniformNames;
+};
+
+const sMode modes[] = {
+	{ "plain uniforms, string names", plainVertexUniforms, plainFragmentUniforms, true },
+	{ "plain uniforms, handles", plainVertexUniforms, plainFragmentUniforms, false },
+	{ "frame and material blocks", frameBlockVertexUniforms, blockFragmentUniforms, false },
+};
+
+struct sScene
+{
+	std::vector<float> modelMatrices;
+	std::vector<float> mvpMatrices;
+	float materials[MATERIALS_COUNT][4];
+	float viewMatrix[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+	float projectionMatrix[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+	float color[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	float triangle[9] = {};
+};
+
+void DrawFrames(CShaderManagerOpenGL& shaderManager, sScene const& scene, bool uniformNames, size_t frames)
+{
+	const UniformHandle colorHandle = shaderManager.GetUniformHandle("color");
+	for (size_t frame = 0; frame < frames; ++frame)
+	{
+		shaderManager.SetMatrices(nullptr, scene.viewMatrix, scene.projectionMatrix);
+		for (size_t i = 0; i < DRAWS_COUNT; ++i)
+		{
+			shaderManager.SetMatrices(&scene.modelMatrices[i * 16], nullptr, nullptr, &scene.mvpMatrices[i * 16]);
+			const float* material = scene.materials[(i / DRAWS_PER_MATERIAL) % MATERIALS_COUNT];
+			shaderManager.SetMaterial(material, material, material, material[3]);
+			if (uniformNames)
+			{
+				shaderManager.SetUniformValue("color", 4, 1, scene.color);
+			}
+			else
+			{
+				shaderManager.SetUniformValue(colorHandle, 4, 1, scene.color);
+			}
+			shaderManager.SetInputAttributes(scene.triangle, nullptr, nullptr, 3, 3);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+		}
+		shaderManager.EndFrame();
+		glFlush();
+	}
+}
+}
+
+//Submits 2000 draws per frame with own matrices and shared materials, setting uniforms by names, by handles and through uniform blocks.
+//Needs OpenGL 3.3 context, so it creates hidden GLFW window
+int BenchmarkUniforms(std::vector<std::string> const& args)
+{
+	size_t frames = 300;
+	for (size_t i = 0; i + 1 < args.size(); ++i)
+	{
+		if (args[i] == "-n")
+		{
+			frames = std::max(atoi(args[++i].c_str()), 1);
+		}
+	}
+	if (!glfwInit())
+	{
+		std::cout << "Cannot initialize GLFW" << std::endl;
+		return 1;
+	}
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "Benchmarks", NULL, NULL);
+	if (!window)
+	{
+		std::cout << "OpenGL 3.3 context is not available" << std::endl;
+		glfwTerminate();
+		return 1;
+	}
+	glfwMakeContextCurrent(window);
+	glewExperimental = GL_TRUE;
+	if (glewInit() != GLEW_OK)
+	{
+		std::cout << "Cannot initialize GLEW" << std::endl;
+		glfwTerminate();
+		return 1;
+	}
+	GLuint vao = 0;
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+
+	sScene scene;
+	scene.modelMatrices.resize(DRAWS_COUNT * 16);
+	scene.mvpMatrices.resize(DRAWS_COUNT * 16);
+	for (size_t i = 0; i < DRAWS_COUNT * 16; ++i)
+	{
+		scene.modelMatrices[i] = static_cast<float>(i % 17);
+		scene.mvpMatrices[i] = static_cast<float>(i % 13) * 0.001f;
+	}
+	for (size_t i = 0; i < MATERIALS_COUNT; ++i)
+	{
+		std::fill(scene.materials[i], scene.materials[i] + 4, i * 0.1f);
+	}
+	{
+		CShaderManagerOpenGL shaderManager;
+		//Default program stays at the bottom of the stack like in renderer, so programs of modes can be popped
+		auto defaultProgram = shaderManager.NewProgramSource("", "", "");
+		shaderManager.PushProgram(*defaultProgram);
+		for (auto& mode : modes)
+		{
+			auto program = shaderManager.NewProgramSource(std::string("#version 330 core\n") + mode.vertexUniforms + vertexMain, std::string("#version 330 core\n") + mode.fragmentUniforms + fragmentMain, "");
+			shaderManager.PushProgram(*program);
+			DrawFrames(shaderManager, scene, mode.uniformNames, std::max<size_t>(frames / 10, 1));
+			glFinish();
+			//Only errors of measured frames are reported, context and program creation may leave their own
+			glGetError();
+			PerfomanceMeter::Reset();
+			auto start = std::chrono::high_resolution_clock::now();
+			DrawFrames(shaderManager, scene, mode.uniformNames, frames);
+			const double submitTime = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+			glFinish();
+			const double frameTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / frames;
+			std::cout << mode.name << ": " << submitTime / frames / DRAWS_COUNT << " us/draw submitted, " << frameTime << " ms/frame with GPU, "
+				<< PerfomanceMeter::GetStreamedBytes() / frames / 1024 << " KB/frame streamed" << (glGetError() == GL_NO_ERROR ? "" : ", GL ERROR") << std::endl;
+			shaderManager.PopProgram();
+		}
+	}
+	glDeleteVertexArrays(1, &vao);
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,49 @@
+#include "Benchmarks.h"
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+struct sScenario
+{
+	const char* name;
+	int(*run)(std::vector<std::string> const& args);
+	const char* usage;
+};
+
+const sScenario scenarios[] = {
+	{ "obj", BenchmarkOBJ, "obj [-n repeats] [-o outputDirectory] file_or_directory..." },
+	{ "collada", BenchmarkCollada, "collada [-n repeats] [-o outputDirectory] file_or_directory..." },
+	{ "wbm", BenchmarkWBM, "wbm [-n repeats] file_or_directory..." },
+	{ "indirect", BenchmarkIndirect, "indirect [-n frames]" },
+	{ "uniforms", BenchmarkUniforms, "uniforms [-n frames]" },
+	{ "network", BenchmarkNetwork, "network [-n rounds]" },
+	{ "streams", BenchmarkStreams, "streams [-n repeats]" },
+	{ "streamfuzz", BenchmarkStreamFuzz, "streamfuzz [-n iterations] [-g] corpus_directory" },
+	{ "commands", BenchmarkCommands, "commands [-nobaseline]" },
+	{ "saveload", BenchmarkSaveLoad, "saveload [-n objects] save|load file" },
+	{ "teamcolor", BenchmarkTeamcolor, "teamcolor [-n factions] cache_directory" },
+	{ "los", BenchmarkLineOfSight, "los [-n objects]" },
+};
+}
+
+//Runs one benchmark scenario. Results are printed to standard output, so runs on different builds can be compared
+int main(int argc, char* argv[])
+{
+	if (argc > 1)
+	{
+		for (auto& scenario : scenarios)
+		{
+			if (strcmp(argv[1], scenario.name) == 0)
+			{
+				return scenario.run(std::vector<std::string>(argv + 2, argv + argc));
+			}
+		}
+	}
+	std::cout << "Usage: Benchmarks scenario [arguments]" << std::endl;
+	for (auto& scenario : scenarios)
+	{
+		std::cout << "\t" << scenario.usage << std::endl;
+	}
+	return 1;
+}
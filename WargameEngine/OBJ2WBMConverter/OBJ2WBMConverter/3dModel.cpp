@@ -1,12 +0,0 @@
-#include "3dModel.h"
-
-C3DModel::C3DModel(std::vector<CVector3f> & vertices, std::vector<CVector2f> & textureCoords, std::vector<CVector3f> & normals, std::vector<unsigned int> & indexes,
-				   CMaterialManager & materials, std::vector<sMesh> & meshes)
-{
-	m_vertices.swap(vertices);
-	m_textureCoords.swap(textureCoords);
-	m_normals.swap(normals);
-	m_indexes.swap(indexes);
-	std::swap(m_materials, materials);
-	m_meshes.swap(meshes);
-}
\ No newline at end of file
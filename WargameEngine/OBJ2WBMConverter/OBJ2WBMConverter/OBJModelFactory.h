@@ -1,5 +0,0 @@
-#include <string>
-#include "3dModel.h"
-
-C3DModel * LoadObjModel(std::string const& path);
-C3DModel * LoadColladaModel(std::string const& path);
\ No newline at end of file
@@ -1,3 +0,0 @@
-#include "3dModel.h"
-
-void SerializeToWBM(C3DModel * model, std::string const& path);
\ No newline at end of file
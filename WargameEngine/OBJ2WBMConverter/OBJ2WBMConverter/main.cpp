@@ -1,21 +1,145 @@
-#include "OBJModelFactory.h"
-#include "WBMSerializer.h"
+#include "view/3dModel.h"
+#include "view/ColladaModelFactory.h"
+#include "view/OBJModelFactory.h"
+#include "view/WBMModelFactory.h"
+#include "OSSpecific.h"
+#include "ThreadPool.h"
+#include "Utils.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <mutex>
 
-int main(int argc, char* argv[])
+using namespace wargameEngine;
+using namespace wargameEngine::view;
+
+namespace
+{
+struct sJob
+{
+	Path source;
+	Path destination;
+};
+
+bool IsSupported(Path const& path)
+{
+	Path extension = GetExtension(path);
+	return extension == make_path(L"obj") || extension == make_path(L"dae");
+}
+
+Path ReplaceExtension(Path const& path)
 {
-	if (argc != 2) return 1;
-	std::string path(argv[1]);
-	C3DModel * model;
-	if (path.substr(path.find_last_of('.') + 1) == "dae")
+	return path.substr(0, path.find_last_of('.')) + make_path(L".wbm");
+}
+
+//Output directories are created level by level, because MakeDir creates only one
+void MakeDirs(Path const& path)
+{
+	for (size_t pos = path.find_first_of(make_path(L"\\/"), 1); pos != path.npos; pos = path.find_first_of(make_path(L"\\/"), pos + 1))
 	{
-		model = LoadColladaModel(path);
+		MakeDir(path.substr(0, pos));
+	}
+	MakeDir(path);
+}
+
+void Convert(sJob const& job, ThreadPool& threadPool)
+{
+	std::vector<char> data = ReadFileNullTerminated(job.source);
+	if (data.empty())
+	{
+		throw std::runtime_error("Cannot read file");
+	}
+	std::unique_ptr<IModelReader> reader;
+	if (GetExtension(job.source) == make_path(L"dae"))
+	{
+		reader = std::make_unique<CColladaModelFactory>();
 	}
 	else
 	{
-		model = LoadObjModel(path);
+		reader = std::make_unique<CObjModelFactory>();
 	}
-	
-	path = path.substr(0, path.find_last_of('.')) + ".wbm";
-	SerializeToWBM(model, path);
-	return 0;
+	reader->SetThreadPool(threadPool);
+	C3DModel dummyModel(1.0f, CVector3f());
+	auto model = reader->LoadModel(reinterpret_cast<unsigned char*>(data.data()), data.size() - 1, dummyModel, job.source);
+	SaveWBMModel(*model, job.destination);
+}
+}
+
+//Converts OBJ and Collada models to WBM. Directories are searched for models, converted file is written next to its source unless output directory is set
+int main(int argc, char* argv[])
+{
+	Path outputDirectory;
+	bool recursive = false;
+	std::vector<Path> inputs;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-r") == 0)
+		{
+			recursive = true;
+		}
+		else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+		{
+			outputDirectory = make_path(std::string(argv[++i]));
+		}
+		else
+		{
+			inputs.push_back(make_path(std::string(argv[i])));
+		}
+	}
+	if (inputs.empty())
+	{
+		std::cout << "Usage: OBJ2WBMConverter [-r] [-o outputDirectory] file_or_directory..." << std::endl;
+		return 1;
+	}
+	const Path separator = make_path(L"/");
+	std::vector<sJob> jobs;
+	for (auto& input : inputs)
+	{
+		if (IsSupported(input))
+		{
+			Path name = input.substr(input.find_last_of(make_path(L"\\/")) + 1);
+			jobs.push_back({ input, ReplaceExtension(outputDirectory.empty() ? input : outputDirectory + separator + name) });
+			continue;
+		}
+		for (auto& file : GetFiles(input, make_path(L"*"), recursive))
+		{
+			if (IsSupported(file))
+			{
+				jobs.push_back({ input + separator + file, ReplaceExtension((outputDirectory.empty() ? input : outputDirectory) + separator + file) });
+			}
+		}
+	}
+	if (!outputDirectory.empty())
+	{
+		for (auto& job : jobs)
+		{
+			MakeDirs(job.destination.substr(0, job.destination.find_last_of(make_path(L"\\/"))));
+		}
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	std::atomic<size_t> failed(0);
+	std::mutex outputMutex;
+	ThreadPool threadPool;
+	threadPool.ParallelFor(0, jobs.size(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+		{
+			try
+			{
+				Convert(jobs[i], threadPool);
+				std::lock_guard<std::mutex> lock(outputMutex);
+				std::cout << to_string(jobs[i].destination) << std::endl;
+			}
+			catch (std::exception const& e)
+			{
+				++failed;
+				std::lock_guard<std::mutex> lock(outputMutex);
+				std::cerr << to_string(jobs[i].source) << ": " << e.what() << std::endl;
+			}
+		}
+	});
+	auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count();
+	std::cout << jobs.size() - failed << " of " << jobs.size() << " models converted in " << time << " ms" << std::endl;
+	return failed ? 1 : 0;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "IPathfinding.h"
 #include "IPhysicsEngine.h"
 #include "IScriptHandler.h"
+#include "Profiler.h"
 #include "controller/Controller.h"
 #include "model/Model.h"
 #include "view/IWindow.h"
@@ -18,6 +19,7 @@ Application::Application(Context&& context)
 	, m_asyncFileProvider(m_threadPool)
 	, m_boundingBoxManager(m_asyncFileProvider)
 {
+	Profiler::SetThreadName("Main");
 	m_view = std::make_unique<view::View>(*m_context.window, *m_context.soundPlayer, *m_context.textWriter, m_threadPool, m_asyncFileProvider,
 		m_context.imageReaders, m_context.modelReaders, m_boundingBoxManager);
 }
@@ -31,7 +33,7 @@ void Application::Run(Module&& module)
 	m_module = std::move(module);
 	m_asyncFileProvider.SetModule(m_module);
 	m_model = std::make_unique<model::Model>();
-	m_controller = std::make_unique<controller::Controller>(*m_model, *m_context.scriptHandler, *m_context.physicsEngine, *m_context.pathFinder, m_boundingBoxManager);
+	m_controller = std::make_unique<controller::Controller>(*m_model, *m_context.scriptHandler, *m_context.physicsEngine, *m_context.pathFinder, m_boundingBoxManager, m_threadPool);
 	m_view->Init(*m_model, *m_controller);
 	m_controller->Init(*m_view, m_context.socketFactory, m_asyncFileProvider.GetScriptAbsolutePath(m_module.script), m_asyncFileProvider);
 
@@ -63,4 +65,9 @@ wargameEngine::view::View& Application::GetView()
 	return *m_view;
 }
 
+wargameEngine::controller::Controller& Application::GetController()
+{
+	return *m_controller;
+}
+
 }
\ No newline at end of file
@@ -55,6 +55,7 @@ public:
 	void Run(const Path& modulePath);
 
 	view::View& GetView();
+	controller::Controller& GetController();
 
 private:
 	Context m_context;
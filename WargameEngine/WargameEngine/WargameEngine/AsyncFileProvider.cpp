@@ -1,5 +1,6 @@
 #include "AsyncFileProvider.h"
 #include "Module.h"
+#include "OSSpecific.h"
 #include "Task.h"
 #include "ThreadPool.h"
 #include "Utils.h"
@@ -12,24 +13,22 @@ class AsyncReadTask : public TaskBase
 {
 public:
 	typedef std::function<void(void*, size_t)> AsyncReadHandler;
-	AsyncReadTask(const Path& file, AsyncReadHandler const& handler, ThreadPool& threadPool)
+	AsyncReadTask(const Path& file, AsyncReadHandler const& handler, VirtualFileSystem const& fileSystem, ThreadPool& threadPool)
 		: TaskBase(threadPool)
 		, m_path(file)
 		, m_handler(handler)
+		, m_fileSystem(fileSystem)
 	{
 	}
 	virtual void Execute() override
 	{
-		std::unique_lock<std::mutex> lk(m_sync);
-		if (m_state != TaskState::QUEUED)
+		if (!StartExecution())
 		{
-			throw std::runtime_error("Task is not ready for execution");
+			return;
 		}
-		m_state = TaskState::STARTED;
-		lk.unlock();
 		try
 		{
-			m_data = ReadFile(m_path);
+			m_data = m_fileSystem.Open(m_path);
 			if (m_handler)
 			{
 				m_threadPool.RunFunc([this]() {
@@ -65,8 +64,9 @@ public:
 
 private:
 	Path m_path;
-	std::vector<char> m_data;
+	FileView m_data;
 	AsyncReadHandler m_handler;
+	VirtualFileSystem const& m_fileSystem;
 };
 
 AsyncFileProvider::AsyncFileProvider(ThreadPool& threadPool)
@@ -145,11 +145,16 @@ void AsyncFileProvider::SetModule(Module const& module)
 	m_modelDir = AppendPath(m_moduleDir, module.models);
 	m_scriptDir = m_moduleDir;
 	m_shaderDir = AppendPath(m_moduleDir, module.shaders);
+	m_fileSystem.UnmountAll();
+	for (auto& pack : GetFiles(m_moduleDir, make_path(L"*.pak"), false))
+	{
+		m_fileSystem.Mount(AppendPath(m_moduleDir, pack), m_moduleDir);
+	}
 }
 
 void AsyncFileProvider::GetTextureAsync(const Path& path, ProcessHandler const& processHandler, CompletionHandler const& completionHandler, ErrorHandler const& errorHandler, bool now)
 {
-	std::shared_ptr<AsyncReadTask> readTask = std::make_shared<AsyncReadTask>(AppendPath(m_textureDir, path), processHandler, m_threadPool);
+	std::shared_ptr<AsyncReadTask> readTask = std::make_shared<AsyncReadTask>(AppendPath(m_textureDir, path), processHandler, m_fileSystem, m_threadPool);
 	readTask->AddOnCompleteHandler(completionHandler);
 	readTask->AddOnFailHandler(errorHandler);
 	m_threadPool.AddTask(readTask);
@@ -161,7 +166,7 @@ void AsyncFileProvider::GetTextureAsync(const Path& path, ProcessHandler const&
 
 void AsyncFileProvider::GetModelAsync(const Path& path, ProcessHandler const& processHandler, CompletionHandler const& completionHandler, ErrorHandler const& errorHandler /*= ErrorHandler()*/)
 {
-	std::shared_ptr<AsyncReadTask> readTask = std::make_shared<AsyncReadTask>(AppendPath(m_modelDir, path), processHandler, m_threadPool);
+	std::shared_ptr<AsyncReadTask> readTask = std::make_shared<AsyncReadTask>(AppendPath(m_modelDir, path), processHandler, m_fileSystem, m_threadPool);
 	readTask->AddOnCompleteHandler(completionHandler);
 	readTask->AddOnFailHandler(errorHandler);
 	m_threadPool.AddTask(readTask);
@@ -191,4 +196,9 @@ Path AsyncFileProvider::GetAbsolutePath(const Path& path) const
 {
 	return AppendPath(m_moduleDir, path);
 }
+
+VirtualFileSystem const& AsyncFileProvider::GetFileSystem() const
+{
+	return m_fileSystem;
+}
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "Typedefs.h"
+#include "VirtualFileSystem.h"
 #include <functional>
 
 namespace wargameEngine
@@ -23,9 +24,11 @@ public:
 	Path GetScriptAbsolutePath(const Path& path) const;
 	Path GetShaderAbsolutePath(const Path& path) const;
 	Path GetAbsolutePath(const Path& path) const;
+	VirtualFileSystem const& GetFileSystem() const;
 
 private:
 	ThreadPool& m_threadPool;
+	VirtualFileSystem m_fileSystem;
 	Path m_workingDir;
 	Path m_moduleDir;
 	Path m_textureDir;
@@ -0,0 +1,168 @@
+#include "BenchmarkRunner.h"
+#include "Application.h"
+#include "IScriptHandler.h"
+#include "LogWriter.h"
+#include "Profiler.h"
+#include "controller/Controller.h"
+#include "impl/GameWindowNull.h"
+#include "view/Camera.h"
+#include "view/View.h"
+#include <algorithm>
+#include <fstream>
+#include <math.h>
+
+namespace wargameEngine
+{
+namespace
+{
+void WriteStats(std::ostream& stream, const char* name, std::vector<double> values, bool last)
+{
+	double mean = 0.0;
+	for (double value : values)
+	{
+		mean += value;
+	}
+	std::sort(values.begin(), values.end());
+	const size_t p95 = static_cast<size_t>(ceil(values.size() * 0.95)) - 1;
+	stream << "\t\t\"" << name << "\": { \"mean\": " << mean / values.size() << ", \"min\": " << values.front()
+		<< ", \"max\": " << values.back() << ", \"p95\": " << values[p95] << " }" << (last ? "\n" : ",\n");
+}
+}
+
+BenchmarkRunner::BenchmarkRunner(Settings const& settings, Application& application, CGameWindowNull& window, IScriptHandler& scriptHandler)
+	: m_settings(settings)
+	, m_application(application)
+	, m_window(window)
+	, m_scriptHandler(scriptHandler)
+{
+	m_frames.reserve(m_settings.frames);
+	m_window.DoOnFrame(std::bind(&BenchmarkRunner::OnFrame, this, std::placeholders::_1));
+}
+
+bool BenchmarkRunner::OnFrame(size_t frame)
+{
+	if (frame == 0)
+	{
+		Start();
+	}
+	else if (frame > m_settings.warmupFrames)
+	{
+		CollectFrame();
+	}
+	if (frame == m_settings.warmupFrames + m_settings.frames)
+	{
+		WriteResults();
+		return false;
+	}
+	UpdateCamera(frame);
+	auto actions = m_actions.equal_range(frame);
+	for (auto it = actions.first; it != actions.second; ++it)
+	{
+		it->second();
+	}
+	m_window.GetNullRenderer().ResetStats();
+	m_frameStart = std::chrono::high_resolution_clock::now();
+	return true;
+}
+
+void BenchmarkRunner::Start()
+{
+	//Module script has reset script handler already, so functions are registered right before benchmark script
+	m_application.GetController().SetFixedTimeStep(m_settings.timeStep);
+	m_scriptHandler.RegisterFunction(L"BenchmarkCamera", [this](IArguments const& args) {
+		if (args.GetCount() != 7)
+			throw std::runtime_error("7 arguments expected (frame, x, y, z, targetX, targetY, targetZ)");
+		m_cameraKeys[args.GetSizeT(1)] = { CVector3f(args.GetFloat(2), args.GetFloat(3), args.GetFloat(4)), CVector3f(args.GetFloat(5), args.GetFloat(6), args.GetFloat(7)) };
+		return nullptr;
+	});
+	m_scriptHandler.RegisterFunction(L"BenchmarkAction", [this](IArguments const& args) {
+		if (args.GetCount() != 2)
+			throw std::runtime_error("2 arguments expected (frame, function)");
+		m_actions.emplace(args.GetSizeT(1), std::bind(args.GetFunction(2), FunctionArguments()));
+		return nullptr;
+	});
+	if (!m_settings.script.empty())
+	{
+		m_scriptHandler.RunScript(m_settings.script);
+	}
+}
+
+void BenchmarkRunner::CollectFrame()
+{
+	sFrame frame;
+	frame.frameTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_frameStart).count();
+	for (size_t i = 0; i < static_cast<size_t>(view::PerfomanceMeter::Stage::Count); ++i)
+	{
+		frame.stageTimes[i] = view::PerfomanceMeter::GetStageTime(static_cast<view::PerfomanceMeter::Stage>(i));
+	}
+	frame.renderer = m_window.GetNullRenderer().GetStats();
+	m_frames.push_back(frame);
+}
+
+void BenchmarkRunner::UpdateCamera(size_t frame)
+{
+	if (m_cameraKeys.empty())
+		return;
+	auto next = m_cameraKeys.lower_bound(frame);
+	sCameraKey key;
+	if (next == m_cameraKeys.begin())
+	{
+		key = next->second;
+	}
+	else if (next == m_cameraKeys.end())
+	{
+		key = m_cameraKeys.rbegin()->second;
+	}
+	else
+	{
+		auto prev = std::prev(next);
+		const float t = static_cast<float>(frame - prev->first) / (next->first - prev->first);
+		key.position = prev->second.position + (next->second.position - prev->second.position) * t;
+		key.target = prev->second.target + (next->second.target - prev->second.target) * t;
+	}
+	m_application.GetView().GetViewport(0).GetCamera().Set(key.position, key.target);
+}
+
+void BenchmarkRunner::WriteResults() const
+{
+	if (m_frames.empty())
+	{
+		LogWriter::WriteLine("Benchmark error. No frames measured");
+		return;
+	}
+	auto collect = [this](std::function<double(sFrame const&)> const& getter) {
+		std::vector<double> values;
+		values.reserve(m_frames.size());
+		for (auto& frame : m_frames)
+		{
+			values.push_back(getter(frame));
+		}
+		return values;
+	};
+	std::ofstream file(m_settings.output);
+	file << "{\n";
+	file << "\t\"frames\": " << m_frames.size() << ",\n";
+	file << "\t\"warmup_frames\": " << m_settings.warmupFrames << ",\n";
+	file << "\t\"time_step_ms\": " << m_settings.timeStep.count() / 1000.0 << ",\n";
+	file << "\t\"cpu_ms\": {\n";
+	WriteStats(file, "frame", collect([](sFrame const& frame) { return frame.frameTime; }), false);
+	for (size_t i = 0; i < static_cast<size_t>(view::PerfomanceMeter::Stage::Count); ++i)
+	{
+		const bool last = i + 1 == static_cast<size_t>(view::PerfomanceMeter::Stage::Count);
+		WriteStats(file, view::PerfomanceMeter::GetStageName(static_cast<view::PerfomanceMeter::Stage>(i)), collect([i](sFrame const& frame) { return frame.stageTimes[i]; }), last);
+	}
+	file << "\t},\n";
+	file << "\t\"per_frame\": {\n";
+	WriteStats(file, "draws", collect([](sFrame const& frame) { return static_cast<double>(frame.renderer.draws); }), false);
+	WriteStats(file, "state_changes", collect([](sFrame const& frame) { return static_cast<double>(frame.renderer.stateChanges); }), false);
+	WriteStats(file, "buffer_uploads", collect([](sFrame const& frame) { return static_cast<double>(frame.renderer.bufferUploads); }), false);
+	WriteStats(file, "uploaded_bytes", collect([](sFrame const& frame) { return static_cast<double>(frame.renderer.uploadedBytes); }), true);
+	file << "\t}\n";
+	file << "}\n";
+	LogWriter::WriteLine("Benchmark finished. " + std::to_string(m_frames.size()) + " frames measured");
+	if (!m_settings.trace.empty() && !Profiler::SaveTrace(m_settings.trace))
+	{
+		LogWriter::WriteLine("Benchmark error. Cannot save trace");
+	}
+}
+}
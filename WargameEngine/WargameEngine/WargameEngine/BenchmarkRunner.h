@@ -0,0 +1,65 @@
+#pragma once
+#include "Typedefs.h"
+#include "view/PerfomanceMeter.h"
+#include "view/Vector3.h"
+#include "impl/NullRenderer.h"
+#include <chrono>
+#include <functional>
+#include <map>
+#include <vector>
+
+class CGameWindowNull;
+
+namespace wargameEngine
+{
+class Application;
+class IScriptHandler;
+
+//Runs module in null window for a fixed number of frames with fixed time step, so results of different runs can be compared.
+//Benchmark script runs after module script and schedules camera path and actions by frame index
+class BenchmarkRunner
+{
+public:
+	struct Settings
+	{
+		Path script;
+		Path output;
+		//Profiler zones of the last frames are saved here if it is not empty
+		Path trace;
+		size_t frames = 600;
+		//Frames run before measurement starts, so textures and models are loaded
+		size_t warmupFrames = 60;
+		std::chrono::microseconds timeStep = std::chrono::microseconds(16667);
+	};
+
+	BenchmarkRunner(Settings const& settings, Application& application, CGameWindowNull& window, IScriptHandler& scriptHandler);
+
+private:
+	struct sCameraKey
+	{
+		CVector3f position;
+		CVector3f target;
+	};
+	struct sFrame
+	{
+		double frameTime;
+		double stageTimes[static_cast<size_t>(view::PerfomanceMeter::Stage::Count)];
+		sNullRendererStats renderer;
+	};
+
+	bool OnFrame(size_t frame);
+	void Start();
+	void CollectFrame();
+	void UpdateCamera(size_t frame);
+	void WriteResults() const;
+
+	Settings m_settings;
+	Application& m_application;
+	CGameWindowNull& m_window;
+	IScriptHandler& m_scriptHandler;
+	std::map<size_t, sCameraKey> m_cameraKeys;
+	std::multimap<size_t, std::function<void()>> m_actions;
+	std::vector<sFrame> m_frames;
+	std::chrono::high_resolution_clock::time_point m_frameStart;
+};
+}
@@ -0,0 +1,143 @@
+#include "Compression.h"
+#include <algorithm>
+#include <cstdint>
+#include <string.h>
+
+namespace wargameEngine
+{
+namespace
+{
+const size_t MIN_MATCH = 4;
+//LZ4 requires last 5 bytes to be literals and last match to start at least 12 bytes before the end
+const size_t LAST_LITERALS = 5;
+const size_t MATCH_FIND_LIMIT = 12;
+const size_t MAX_OFFSET = 65535;
+const unsigned HASH_BITS = 12;
+
+uint32_t Read32(const char* data)
+{
+	uint32_t result;
+	memcpy(&result, data, sizeof(uint32_t));
+	return result;
+}
+
+uint32_t Hash(uint32_t sequence)
+{
+	return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void WriteLength(std::vector<char>& result, size_t length)
+{
+	for (; length >= 255; length -= 255)
+	{
+		result.push_back(static_cast<char>(255));
+	}
+	result.push_back(static_cast<char>(length));
+}
+
+void WriteSequence(std::vector<char>& result, const char* literals, size_t literalsCount, size_t offset, size_t matchLength)
+{
+	const size_t matchCode = matchLength - MIN_MATCH;
+	result.push_back(static_cast<char>((std::min<size_t>(literalsCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+	if (literalsCount >= 15)
+	{
+		WriteLength(result, literalsCount - 15);
+	}
+	result.insert(result.end(), literals, literals + literalsCount);
+	result.push_back(static_cast<char>(offset & 0xFF));
+	result.push_back(static_cast<char>(offset >> 8));
+	if (matchCode >= 15)
+	{
+		WriteLength(result, matchCode - 15);
+	}
+}
+
+bool ReadLength(const unsigned char* data, size_t size, size_t& position, size_t& length)
+{
+	unsigned char value;
+	do
+	{
+		if (position >= size)
+			return false;
+		value = data[position++];
+		length += value;
+	} while (value == 255);
+	return true;
+}
+}
+
+std::vector<char> CompressLZ4(const char* data, size_t size)
+{
+	std::vector<char> result;
+	result.reserve(size + size / 255 + 16);
+	std::vector<uint32_t> table(1 << HASH_BITS, 0);//position + 1, 0 for empty
+	size_t anchor = 0;
+	size_t position = 0;
+	while (position + MATCH_FIND_LIMIT <= size)
+	{
+		const uint32_t sequence = Read32(data + position);
+		uint32_t& entry = table[Hash(sequence)];
+		const size_t candidate = entry;
+		entry = static_cast<uint32_t>(position + 1);
+		if (candidate == 0 || position - (candidate - 1) > MAX_OFFSET || Read32(data + candidate - 1) != sequence)
+		{
+			++position;
+			continue;
+		}
+		const size_t match = candidate - 1;
+		size_t length = MIN_MATCH;
+		while (position + length < size - LAST_LITERALS && data[match + length] == data[position + length])
+		{
+			++length;
+		}
+		WriteSequence(result, data + anchor, position - anchor, position - match, length);
+		position += length;
+		anchor = position;
+	}
+	const size_t literalsCount = size - anchor;
+	result.push_back(static_cast<char>(std::min<size_t>(literalsCount, 15) << 4));
+	if (literalsCount >= 15)
+	{
+		WriteLength(result, literalsCount - 15);
+	}
+	result.insert(result.end(), data + anchor, data + size);
+	return result;
+}
+
+bool DecompressLZ4(const char* data, size_t size, char* result, size_t resultSize)
+{
+	auto input = reinterpret_cast<const unsigned char*>(data);
+	size_t in = 0;
+	size_t out = 0;
+	while (in < size)
+	{
+		const unsigned char token = input[in++];
+		size_t literalsCount = token >> 4;
+		if (literalsCount == 15 && !ReadLength(input, size, in, literalsCount))
+			return false;
+		if (literalsCount > size - in || literalsCount > resultSize - out)
+			return false;
+		memcpy(result + out, input + in, literalsCount);
+		in += literalsCount;
+		out += literalsCount;
+		if (in == size)
+			break;//last sequence has no match
+		if (size - in < 2)
+			return false;
+		const size_t offset = input[in] | (input[in + 1] << 8);
+		in += 2;
+		size_t length = token & 15;
+		if (length == 15 && !ReadLength(input, size, in, length))
+			return false;
+		length += MIN_MATCH;
+		if (offset == 0 || offset > out || length > resultSize - out)
+			return false;
+		//Match may overlap output, so it is copied byte by byte
+		for (size_t i = 0; i < length; ++i, ++out)
+		{
+			result[out] = result[out - offset];
+		}
+	}
+	return out == resultSize;
+}
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace wargameEngine
+{
+//Compresses data to LZ4 block format. Fast, but compression ratio is modest, so it is meant for network messages and caches
+std::vector<char> CompressLZ4(const char* data, size_t size);
+//Decompresses LZ4 block. resultSize must be exact size of uncompressed data. Returns false if data is corrupted
+bool DecompressLZ4(const char* data, size_t size, char* result, size_t resultSize);
+}
@@ -1,8 +1,10 @@
 #pragma once
+#include <cstdint>
 #include <string>
 
 namespace wargameEngine
 {
+//Reads throw std::runtime_error if there is not enough data left, so corrupted or malicious data cannot make them read outside of the buffer
 class IReadMemoryStream
 {
 public:
@@ -19,8 +21,12 @@ public:
 	virtual std::string ReadString() = 0;
 	virtual std::wstring ReadWString() = 0;
 	virtual void* ReadPointer() = 0;
+	virtual uint32_t ReadVarint() = 0;
+	virtual int32_t ReadSignedVarint() = 0;
+	virtual float ReadQuantizedFloat(float scale) = 0;
 	virtual void ReadData(void* data, size_t size) = 0;
 	virtual void Seek(size_t pos) = 0;
+	virtual size_t GetRemaining() const = 0;
 };
 
 class IWriteMemoryStream
@@ -38,5 +44,11 @@ public:
 	virtual void WriteString(std::string const& value) = 0;
 	virtual void WriteWString(std::wstring const& value) = 0;
 	virtual void WritePointer(void* value) = 0;
+	//7 bits per byte, values below 128 take one byte
+	virtual void WriteVarint(uint32_t value) = 0;
+	//Zigzag encoded varint, so small negative values are short too
+	virtual void WriteSignedVarint(int32_t value) = 0;
+	//Writes round(value * scale) as signed varint. Values out of int32 range are clamped
+	virtual void WriteQuantizedFloat(float value, float scale) = 0;
 };
-}
\ No newline at end of file
+}
@@ -1,19 +1,41 @@
 #pragma once
-#include <string>
+#include <chrono>
+#include <cstddef>
+#include <functional>
 
 namespace wargameEngine
 {
+class RingBuffer;
+
+//Non-blocking TCP endpoint. Host accepts any number of connections, client has one connection to host. Handlers are called only from Poll
 class INetSocket
 {
 public:
-	virtual ~INetSocket() {}
+	typedef unsigned ConnectionId;
+	struct Buffer
+	{
+		const char* data;
+		size_t size;
+	};
+	typedef std::function<void(ConnectionId connection)> ConnectionHandler;
+	//Handler consumes as much received data as it can, the rest is kept until more data arrives.
+	//Socket never grows received buffer, handler reserves space for messages it expects. Connection is closed if handler leaves the buffer full
+	typedef std::function<void(ConnectionId connection, RingBuffer& received)> DataHandler;
 
-	virtual void InitFromAnotherSocket(unsigned int socket, void* sockAddr) = 0;
-	virtual void InitClient(const char* ip, unsigned short port = 0) = 0;
-	virtual void InitHost(unsigned short port = 0) = 0;
+	virtual ~INetSocket() {}
 
-	virtual bool SendData(const char* data, size_t len) const = 0;
-	//Return -1 then error occurs, 0 then connection is closed by other side or number of bytes received.
-	virtual int RecieveData(char* data, size_t maxLength) = 0;
+	//Starts listening. Connections are accepted by Poll, so it never blocks
+	virtual bool InitHost(unsigned short port = 0) = 0;
+	//Starts connecting. onConnect is called by Poll when connection is established
+	virtual bool InitClient(const char* ip, unsigned short port = 0) = 0;
+	virtual void SetHandlers(ConnectionHandler const& onConnect, DataHandler const& onData, ConnectionHandler const& onDisconnect) = 0;
+	//Sends buffers one after another with a single vectored write. Only data that socket cannot take at once is copied to connection send buffer
+	virtual bool SendData(ConnectionId connection, const Buffer* buffers, size_t count) = 0;
+	//Accepts connections, reads received data, flushes send buffers and calls handlers. Waits for events no longer than timeout
+	virtual void Poll(std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) = 0;
+	virtual void Disconnect(ConnectionId connection) = 0;
+	virtual size_t GetConnectionsCount() const = 0;
+	//Returns local port, so host can be started on port 0
+	virtual unsigned short GetPort() const = 0;
 };
-}
\ No newline at end of file
+}
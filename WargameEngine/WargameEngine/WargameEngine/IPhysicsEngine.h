@@ -1,6 +1,9 @@
 #pragma once
+#include "array_view.h"
 #include "view/Vector3.h"
 #include <chrono>
+#include <cstdint>
+#include <unordered_set>
 #include <vector>
 
 namespace wargameEngine
@@ -16,6 +19,7 @@ namespace view
 {
 class IRenderer;
 }
+class ThreadPool;
 
 class IPhysicsEngine
 {
@@ -26,6 +30,13 @@ public:
 		model::IBaseObject* object = nullptr;
 		CVector3f hitPoint;
 	};
+	struct Ray
+	{
+		CVector3f origin;
+		CVector3f dest;
+	};
+	//Objects that rays pass through. Lookup is hashed, so it is cheap to exclude many objects
+	using RayFilter = std::unordered_set<const model::IBaseObject*>;
 
 	virtual ~IPhysicsEngine() {}
 
@@ -36,6 +47,10 @@ public:
 	virtual void RemoveObject(model::IBaseObject* object) = 0;
 	virtual void SetGround(model::Landscape* landscape) = 0;
 	virtual CastRayResult CastRay(CVector3f const& origin, CVector3f const& dest, std::vector<model::IBaseObject*> const& excludeObjects = std::vector<model::IBaseObject*>()) const = 0;
+	//Casts rays on threadPool workers and returns number of rays that hit nothing. Any object hit blocks the ray, closest hit is not searched.
+	//Casting stops as soon as stopAfterFreeRays free rays are found, so in that case result is not less than stopAfterFreeRays but may be less than real number.
+	//World must not be changed until function returns
+	virtual size_t CastRays(array_view<Ray> const& rays, RayFilter const& excludeObjects, ThreadPool& threadPool, size_t stopAfterFreeRays = SIZE_MAX) const = 0;
 	virtual bool TestObject(model::IBaseObject* object) const = 0;
 	virtual void Draw(view::IRenderer& renderer) const = 0; //for debug purposes
 };
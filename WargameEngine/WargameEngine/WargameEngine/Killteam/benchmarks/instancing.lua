@@ -0,0 +1,4 @@
+--Instanced drawing benchmark. Run from module folder: WargameEngine -benchmark benchmarks/instancing.lua
+--Compare draw calls and frame times with no_instancing.lua, that draws the same scene
+SetInstancingShaders("openGL/instancing.vsh", "openGL/gpu_skinning.fsh")
+RunScript("benchmarks/instancing_scene.lua")
@@ -0,0 +1,12 @@
+--Grid of the same model seen by moving camera. Used by instancing.lua and no_instancing.lua
+local count = 30
+for i = 1, count do
+	local x = -count / 2 + i - 0.5
+	for j = 1, count do
+		local y = -count / 2 + j - 0.5
+		Object:New("SM_HB.wbm", x, y, 0)
+	end
+end
+BenchmarkCamera(0, 0, -25, 20, 0, 0, 0)
+BenchmarkCamera(300, 25, 0, 15, 0, 0, 0)
+BenchmarkCamera(600, 0, 25, 20, 0, 0, 0)
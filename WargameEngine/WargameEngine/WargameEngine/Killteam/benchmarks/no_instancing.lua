@@ -0,0 +1,3 @@
+--The scene of instancing.lua drawn object by object
+SetInstancingShaders()
+RunScript("benchmarks/instancing_scene.lua")
@@ -0,0 +1,18 @@
+--Text rendering benchmark. Run from module folder: WargameEngine -benchmark benchmarks/text.lua
+--100 static texts of 100 characters (10000 glyphs) are drawn every frame, 4 of them are changed every frame
+local linesCount = 100
+local dynamicLinesCount = 4
+--Actions are registered ahead, so -frames plus -warmup should not exceed this value
+local framesCount = 10000
+local sample = string.rep("The quick brown fox jumps over the lazy dog. 0123456789 ", 2):sub(1, 100)
+local lines = {}
+for i = 1, linesCount do
+	lines[i] = UI:NewStaticText("BenchmarkText" .. i, 0, (i - 1) * 8, 20, 1000, sample)
+end
+for frame = 1, framesCount do
+	BenchmarkAction(frame, function()
+		for i = 1, dynamicLinesCount do
+			lines[i]:SetText(string.format("Frame %d line %d ", frame, i) .. sample:sub(1, 80))
+		end
+	end)
+end
@@ -201,6 +201,7 @@ else
 	SetShaders("openGL/gpu_skinning.vsh", "openGL/gpu_skinning.fsh")
 	SetParticleSystemShaders("openGL/particle.vsh", "openGL/particle.fsh")
 	SetSkyboxShaders("openGL/skybox.vsh", "openGL/skybox.fsh")
+	SetInstancingShaders("openGL/instancing.vsh", "openGL/gpu_skinning.fsh")
 end
 EnableGPUSkinning()
 --EnableVertexLightning()
@@ -1,47 +1,68 @@
 #include "MemoryStream.h"
 #include "Utils.h"
+#include <algorithm>
+#include <math.h>
+#include <stdexcept>
 #include <string.h>
 
 namespace wargameEngine
 {
-ReadMemoryStream::ReadMemoryStream(const char* data)
+namespace
+{
+const size_t MIN_CAPACITY = 64;
+//Largest float that fits int32
+const float MAX_QUANTIZED = 2147483520.0f;
+}
+
+ReadMemoryStream::ReadMemoryStream(const char* data, size_t size)
 	: m_data(data)
+	, m_size(size)
 	, m_position(0)
 {
 }
 
+const char* ReadMemoryStream::Advance(size_t size)
+{
+	if (size > m_size - m_position)
+	{
+		throw std::runtime_error("Unexpected end of memory stream");
+	}
+	const char* result = m_data + m_position;
+	m_position += size;
+	return result;
+}
+
+template<class T>
+T ReadMemoryStream::ReadValue()
+{
+	T result;
+	memcpy(&result, Advance(sizeof(T)), sizeof(T));
+	return result;
+}
+
 bool ReadMemoryStream::ReadBool()
 {
-	return m_data[m_position++] > 0 ? true : false;
+	return *Advance(1) != 0;
 }
 
 unsigned char ReadMemoryStream::ReadByte()
 {
-	return m_data[m_position++];
+	return static_cast<unsigned char>(*Advance(1));
 }
 
 short ReadMemoryStream::ReadShort()
 {
-	int16_t result;
-	memcpy(&result, &m_data[m_position], sizeof(int16_t));
-	m_position += sizeof(int16_t);
-	return result;
+	return ReadValue<int16_t>();
 }
 
 int ReadMemoryStream::ReadInt()
 {
-	int32_t result;
-	memcpy(&result, &m_data[m_position], sizeof(int32_t));
-	m_position += sizeof(int32_t);
-	return result;
+	return ReadValue<int32_t>();
 }
 
 unsigned ReadMemoryStream::ReadUnsigned()
 {
-	uint32_t result;
-	memcpy(&result, &m_data[m_position], sizeof(uint32_t));
-	m_position += sizeof(uint32_t);
-	return result;
+	return ReadValue<uint32_t>();
 }
 
 size_t ReadMemoryStream::ReadSizeT()
@@ -51,71 +72,124 @@ size_t ReadMemoryStream::ReadSizeT()
 
 float ReadMemoryStream::ReadFloat()
 {
-	float result;
-	memcpy(&result, &m_data[m_position], sizeof(float));
-	m_position += sizeof(float);
-	return result;
+	return ReadValue<float>();
 }
 
 double ReadMemoryStream::ReadDouble()
 {
-	double result;
-	memcpy(&result, &m_data[m_position], sizeof(double));
-	m_position += sizeof(double);
-	return result;
+	return ReadValue<double>();
 }
 
 std::string ReadMemoryStream::ReadString()
 {
 	size_t size = ReadSizeT();
-	std::string result(&m_data[m_position], size);
-	m_position += size;
-	return result;
+	return std::string(Advance(size), size);
 }
 
 std::wstring ReadMemoryStream::ReadWString()
 {
-	size_t size = ReadSizeT();
-	std::string result(&m_data[m_position], size);
-	m_position += size;
-	return Utf8ToWstring(result);
+	return Utf8ToWstring(ReadString());
 }
 
 void* ReadMemoryStream::ReadPointer()
 {
-	uint64_t result;
-	memcpy(&result, &m_data[m_position], sizeof(uint64_t));
-	m_position += sizeof(uint64_t);
-	return reinterpret_cast<void*>(result);
+	return reinterpret_cast<void*>(static_cast<uintptr_t>(ReadValue<uint64_t>()));
+}
+
+uint32_t ReadMemoryStream::ReadVarint()
+{
+	uint32_t result = 0;
+	for (unsigned shift = 0; shift < 35; shift += 7)
+	{
+		unsigned char byte = ReadByte();
+		if (shift == 28 && byte > 0x0F)
+			break;//does not fit 32 bits
+		result |= static_cast<uint32_t>(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			return result;
+	}
+	throw std::runtime_error("Invalid varint in memory stream");
+}
+
+int32_t ReadMemoryStream::ReadSignedVarint()
+{
+	uint32_t value = ReadVarint();
+	return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+float ReadMemoryStream::ReadQuantizedFloat(float scale)
+{
+	return ReadSignedVarint() / scale;
 }
 
 void ReadMemoryStream::ReadData(void* data, size_t size)
 {
-	memcpy(data, m_data + m_position, size);
-	m_position += size;
+	memcpy(data, Advance(size), size);
 }
 
 void ReadMemoryStream::Seek(size_t pos)
 {
+	if (pos > m_size)
+	{
+		throw std::runtime_error("Seek beyond the end of memory stream");
+	}
 	m_position = pos;
 }
 
+size_t ReadMemoryStream::GetRemaining() const
+{
+	return m_size - m_position;
+}
+
+WriteMemoryStream::WriteMemoryStream()
+	: m_buffer(m_ownBuffer)
+{
+}
+
+WriteMemoryStream::WriteMemoryStream(std::vector<char>& buffer)
+	: m_buffer(buffer)
+{
+	//Capacity is kept, but buffer is not filled up to it, so reusing a buffer of a big message does not cost its size for every small one
+	m_buffer.clear();
+}
+
+WriteMemoryStream::~WriteMemoryStream()
+{
+	m_buffer.resize(m_size);
+}
+
+char* WriteMemoryStream::Append(size_t size)
+{
+	const size_t newSize = m_size + size;
+	if (newSize > m_buffer.size())
+	{
+		//Initialized part grows geometrically within capacity too, so bytes are zeroed at most twice per message instead of on every write
+		m_buffer.resize(std::max({ newSize, m_buffer.size() * 2, MIN_CAPACITY }));
+	}
+	char* result = m_buffer.data() + m_size;
+	m_size = newSize;
+	return result;
+}
+
+template<class T>
+void WriteMemoryStream::WriteValue(T value)
+{
+	memcpy(Append(sizeof(T)), &value, sizeof(T));
+}
+
 void WriteMemoryStream::WriteBool(bool value)
 {
-	m_data.push_back(value ? 1 : 0);
+	*Append(1) = value ? 1 : 0;
 }
 
 void WriteMemoryStream::WriteByte(unsigned char value)
 {
-	m_data.push_back(value);
+	*Append(1) = static_cast<char>(value);
 }
 
 void WriteMemoryStream::WriteInt(int value)
 {
-	size_t oldSize = m_data.size();
-	m_data.resize(oldSize + sizeof(int32_t));
-	auto normalized = static_cast<int32_t>(value);
-	memcpy(&m_data[oldSize], &normalized, sizeof(int32_t));
+	WriteValue(static_cast<int32_t>(value));
 }
 
 void WriteMemoryStream::WriteSizeT(size_t value)
@@ -125,32 +199,23 @@ void WriteMemoryStream::WriteSizeT(size_t value)
 
 void WriteMemoryStream::WriteUnsigned(unsigned value)
 {
-	size_t oldSize = m_data.size();
-	m_data.resize(oldSize + sizeof(uint32_t));
-	auto normalized = static_cast<uint32_t>(value);
-	memcpy(&m_data[oldSize], &normalized, sizeof(uint32_t));
+	WriteValue(static_cast<uint32_t>(value));
 }
 
 void WriteMemoryStream::WriteFloat(float value)
 {
-	size_t oldSize = m_data.size();
-	m_data.resize(oldSize + sizeof(float));
-	memcpy(&m_data[oldSize], &value, sizeof(float));
+	WriteValue(value);
 }
 
 void WriteMemoryStream::WriteDouble(double value)
 {
-	size_t oldSize = m_data.size();
-	m_data.resize(oldSize + sizeof(double));
-	memcpy(&m_data[oldSize], &value, sizeof(double));
+	WriteValue(value);
 }
 
 void WriteMemoryStream::WriteString(std::string const& value)
 {
 	WriteSizeT(value.size());
-	size_t oldSize = m_data.size();
-	m_data.resize(oldSize + value.size());
-	memcpy(&m_data[oldSize], value.c_str(), value.size());
+	memcpy(Append(value.size()), value.c_str(), value.size());
 }
 
 void WriteMemoryStream::WriteWString(std::wstring const& value)
@@ -160,23 +225,58 @@ void WriteMemoryStream::WriteWString(std::wstring const& value)
 
 void WriteMemoryStream::WritePointer(void* value)
 {
-	size_t oldSize = m_data.size();
-	m_data.resize(oldSize + sizeof(uint64_t));
-	memcpy(&m_data[oldSize], &value, sizeof(uint64_t));
+	WriteValue(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+}
+
+void WriteMemoryStream::WriteVarint(uint32_t value)
+{
+	char bytes[5];
+	size_t count = 0;
+	while (value >= 0x80)
+	{
+		bytes[count++] = static_cast<char>(value | 0x80);
+		value >>= 7;
+	}
+	bytes[count++] = static_cast<char>(value);
+	memcpy(Append(count), bytes, count);
+}
+
+void WriteMemoryStream::WriteSignedVarint(int32_t value)
+{
+	WriteVarint((static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+}
+
+void WriteMemoryStream::WriteQuantizedFloat(float value, float scale)
+{
+	float scaled = value * scale;
+	if (!(scaled == scaled))//NaN
+		scaled = 0.0f;
+	scaled = std::max(-MAX_QUANTIZED, std::min(scaled, MAX_QUANTIZED));
+	WriteSignedVarint(static_cast<int32_t>(lroundf(scaled)));
+}
+
+void WriteMemoryStream::Clear()
+{
+	m_size = 0;
+}
+
+void WriteMemoryStream::Reserve(size_t size)
+{
+	m_buffer.reserve(size);
 }
 
 char* WriteMemoryStream::GetData()
 {
-	return m_data.data();
+	return m_buffer.data();
 }
 
 const char* WriteMemoryStream::GetData() const
 {
-	return m_data.data();
+	return m_buffer.data();
 }
 
 size_t WriteMemoryStream::GetSize() const
 {
-	return m_data.size();
+	return m_size;
+}
 }
-}
\ No newline at end of file
@@ -7,7 +7,7 @@ namespace wargameEngine
 class ReadMemoryStream : public IReadMemoryStream
 {
 public:
-	ReadMemoryStream(const char* data);
+	ReadMemoryStream(const char* data, size_t size);
 
 	bool ReadBool() override;
 	unsigned char ReadByte() override;
@@ -20,17 +20,35 @@ public:
 	std::string ReadString() override;
 	std::wstring ReadWString() override;
 	void* ReadPointer() override;
+	uint32_t ReadVarint() override;
+	int32_t ReadSignedVarint() override;
+	float ReadQuantizedFloat(float scale) override;
 	void ReadData(void* data, size_t size) override;
 	void Seek(size_t pos) override;
+	size_t GetRemaining() const override;
 
 private:
+	//Returns pointer to next size bytes and moves forward
+	const char* Advance(size_t size);
+	template<class T>
+	T ReadValue();
+
 	const char* m_data;
+	size_t m_size;
 	size_t m_position;
 };
 
 class WriteMemoryStream : public IWriteMemoryStream
 {
 public:
+	WriteMemoryStream();
+	//Writes to buffer owned by caller, so memory allocated for one message is reused by the next one. Buffer is cleared.
+	//It keeps written data when stream is destroyed
+	explicit WriteMemoryStream(std::vector<char>& buffer);
+	WriteMemoryStream(WriteMemoryStream const&) = delete;
+	WriteMemoryStream& operator=(WriteMemoryStream const&) = delete;
+	~WriteMemoryStream();
+
 	void WriteBool(bool value) override;
 	void WriteByte(unsigned char value) override;
 	void WriteInt(int value) override;
@@ -41,12 +59,26 @@ public:
 	void WriteString(std::string const& value) override;
 	void WriteWString(std::wstring const& value) override;
 	void WritePointer(void* value) override;
+	void WriteVarint(uint32_t value) override;
+	void WriteSignedVarint(int32_t value) override;
+	void WriteQuantizedFloat(float value, float scale) override;
 
+	//Allocated memory is kept
+	void Clear();
+	void Reserve(size_t size);
 	const char* GetData() const;
 	char* GetData();
 	size_t GetSize() const;
 
 private:
-	std::vector<char> m_data;
+	//Returns pointer to size bytes appended to the end of stream. Buffer grows geometrically
+	char* Append(size_t size);
+	template<class T>
+	void WriteValue(T value);
+
+	std::vector<char> m_ownBuffer;
+	//Size of buffer is the initialized part that can be written without resizing, m_size is the write position
+	std::vector<char>& m_buffer;
+	size_t m_size = 0;
 };
-}
\ No newline at end of file
+}
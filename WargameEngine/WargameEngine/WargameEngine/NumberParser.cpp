@@ -0,0 +1,196 @@
+#include "NumberParser.h"
+#include <cstdint>
+#include <locale.h>
+#include <stdlib.h>
+#include <string>
+#include <string.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+
+namespace wargameEngine
+{
+namespace
+{
+const size_t MAX_BUFFER_LENGTH = 64;
+
+bool IsWhitespace(char ch)
+{
+	return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+bool IsDigit(char ch)
+{
+	return ch >= '0' && ch <= '9';
+}
+
+//View sets user locale, but numbers in model files always use dot as decimal separator
+#ifdef _WINDOWS
+float StrToFloat(const char* text, char** end)
+{
+	static const _locale_t classicLocale = _create_locale(LC_NUMERIC, "C");
+	return _strtof_l(text, end, classicLocale);
+}
+#else
+float StrToFloat(const char* text, char** end)
+{
+	static const locale_t classicLocale = newlocale(LC_NUMERIC_MASK, "C", static_cast<locale_t>(0));
+	return strtof_l(text, end, classicLocale);
+}
+#endif
+
+//Result is exact when mantissa and power of ten are exactly representable as float, because it is rounded only once
+bool ParseFloatFast(const char* pos, const char* end, float& result)
+{
+	static const float powers[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+	const bool negative = pos < end && *pos == '-';
+	if (pos < end && (*pos == '-' || *pos == '+'))
+		++pos;
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool hasDigits = false;
+	for (; pos < end && IsDigit(*pos); ++pos, hasDigits = true)
+	{
+		if (digits == 19)
+			return false;
+		mantissa = mantissa * 10 + (*pos - '0');
+		digits += mantissa != 0;
+	}
+	if (pos < end && *pos == '.')
+	{
+		for (++pos; pos < end && IsDigit(*pos); ++pos, hasDigits = true)
+		{
+			if (digits == 19)
+				return false;
+			mantissa = mantissa * 10 + (*pos - '0');
+			digits += mantissa != 0;
+			--exponent;
+		}
+	}
+	if (!hasDigits)
+		return false;
+	if (pos < end && (*pos == 'e' || *pos == 'E'))
+	{
+		++pos;
+		const bool negativeExponent = pos < end && *pos == '-';
+		if (pos < end && (*pos == '-' || *pos == '+'))
+			++pos;
+		int value = 0;
+		const char* exponentBegin = pos;
+		for (; pos < end && IsDigit(*pos) && pos - exponentBegin < 4; ++pos)
+		{
+			value = value * 10 + (*pos - '0');
+		}
+		if (pos == exponentBegin)
+			return false;
+		exponent += negativeExponent ? -value : value;
+	}
+	if (pos != end)
+		return false;
+	if (mantissa == 0)
+	{
+		result = negative ? -0.0f : 0.0f;
+		return true;
+	}
+	while (exponent < 0 && mantissa % 10 == 0)
+	{
+		mantissa /= 10;
+		++exponent;
+	}
+	if (mantissa > (1u << 24) || exponent < -10 || exponent > 10)
+		return false;
+	float value = static_cast<float>(mantissa);
+	value = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+	result = negative ? -value : value;
+	return true;
+}
+}
+
+const char* SkipWhitespace(const char* begin, const char* end)
+{
+	while (begin < end && IsWhitespace(*begin))
+		++begin;
+	return begin;
+}
+
+const char* FindWhitespace(const char* begin, const char* end)
+{
+	while (begin < end && !IsWhitespace(*begin))
+		++begin;
+	return begin;
+}
+
+bool ParseFloat(const char* begin, const char* end, float& result)
+{
+	if (ParseFloatFast(begin, end, result))
+		return true;
+	const size_t length = end - begin;
+	if (length == 0)
+		return false;
+	char buffer[MAX_BUFFER_LENGTH];
+	std::string longBuffer;
+	const char* text = buffer;
+	if (length < MAX_BUFFER_LENGTH)
+	{
+		memcpy(buffer, begin, length);
+		buffer[length] = '\0';
+	}
+	else
+	{
+		longBuffer.assign(begin, end);
+		text = longBuffer.c_str();
+	}
+	char* parsedEnd;
+	float value = StrToFloat(text, &parsedEnd);
+	if (parsedEnd != text + length)
+		return false;
+	result = value;
+	return true;
+}
+
+bool ParseUnsigned(const char* begin, const char* end, unsigned& result)
+{
+	if (begin == end)
+		return false;
+	uint64_t value = 0;
+	for (; begin < end; ++begin)
+	{
+		if (!IsDigit(*begin))
+			return false;
+		value = value * 10 + (*begin - '0');
+		if (value > UINT32_MAX)
+			return false;
+	}
+	result = static_cast<unsigned>(value);
+	return true;
+}
+
+bool ParseFloatList(const char* begin, const char* end, std::vector<float>& result)
+{
+	for (begin = SkipWhitespace(begin, end); begin < end; begin = SkipWhitespace(begin, end))
+	{
+		const char* tokenEnd = FindWhitespace(begin, end);
+		float value;
+		if (!ParseFloat(begin, tokenEnd, value))
+			return false;
+		result.push_back(value);
+		begin = tokenEnd;
+	}
+	return true;
+}
+
+bool ParseUnsignedList(const char* begin, const char* end, std::vector<unsigned>& result)
+{
+	for (begin = SkipWhitespace(begin, end); begin < end; begin = SkipWhitespace(begin, end))
+	{
+		const char* tokenEnd = FindWhitespace(begin, end);
+		unsigned value;
+		if (!ParseUnsigned(begin, tokenEnd, value))
+			return false;
+		result.push_back(value);
+		begin = tokenEnd;
+	}
+	return true;
+}
+}
\ No newline at end of file
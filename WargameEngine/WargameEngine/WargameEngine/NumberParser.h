@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace wargameEngine
+{
+//Numbers are parsed from ranges of text, so text does not need to be null terminated
+const char* SkipWhitespace(const char* begin, const char* end);
+const char* FindWhitespace(const char* begin, const char* end);
+//Parses float that takes the whole range. Result is the same strtof gives in "C" locale. Returns false if range is not a number
+bool ParseFloat(const char* begin, const char* end, float& result);
+//Parses decimal number that takes the whole range. Returns false if range is not a number or it does not fit
+bool ParseUnsigned(const char* begin, const char* end, unsigned& result);
+//Append whitespace separated numbers to result. Return false if some of them cannot be parsed
+bool ParseFloatList(const char* begin, const char* end, std::vector<float>& result);
+bool ParseUnsignedList(const char* begin, const char* end, std::vector<unsigned>& result);
+}
\ No newline at end of file
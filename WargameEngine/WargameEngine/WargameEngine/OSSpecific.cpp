@@ -21,7 +21,7 @@ std::vector<Path> GetFiles(const Path& path, const Path& mask, bool recursive)
 			}
 			if (FindFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
 			{
-				dir.push_back(path + L"\\" + FindFileData.cFileName);
+				dir.push_back(FindFileData.cFileName);
 			}
 			else
 			{
@@ -33,20 +33,39 @@ std::vector<Path> GetFiles(const Path& path, const Path& mask, bool recursive)
 	{
 		for (size_t i = 0; i < dir.size(); ++i)
 		{
-			std::vector<Path> temp = GetFiles(dir[i], mask, recursive);
+			std::vector<Path> temp = GetFiles(path + L"\\" + dir[i], mask, recursive);
 			for (auto j = temp.begin(); j != temp.end(); ++j)
 			{
-				result.push_back(path + L"\\" + *j);
+				result.push_back(dir[i] + L"\\" + *j);
 			}
 		}
 	}
 	return result;
 }
+
+bool MakeDir(const Path& path)
+{
+	return CreateDirectoryW(path.c_str(), NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
+}
+
+bool AtomicReplaceFile(const Path& from, const Path& to)
+{
+	//rename does not overwrite existing files on Windows
+	return MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+bool RemoveFile(const Path& path)
+{
+	return DeleteFileW(path.c_str()) != 0;
+}
 }
 #else
 #include <algorithm>
+#include <cstdio>
 #include <cstring>
 #include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 namespace wargameEngine
@@ -96,7 +115,7 @@ std::vector<Path> GetFiles(const Path& path, const Path& mask, bool recursive)
 
 			if (dir->d_type == DT_DIR)
 			{
-				dirs.push_back(path + "/" + dir->d_name);
+				dirs.push_back(dir->d_name);
 			}
 			else
 			{
@@ -112,15 +131,30 @@ std::vector<Path> GetFiles(const Path& path, const Path& mask, bool recursive)
 	{
 		for (size_t i = 0; i < dirs.size(); ++i)
 		{
-			std::vector<Path> temp = GetFiles(dirs[i], mask, recursive);
-			for (auto i = temp.begin(); i != temp.end(); ++i)
+			std::vector<Path> temp = GetFiles(path + "/" + dirs[i], mask, recursive);
+			for (auto j = temp.begin(); j != temp.end(); ++j)
 			{
-				result.push_back(path + "/" + *i);
+				result.push_back(dirs[i] + "/" + *j);
 			}
 		}
 	}
 	std::sort(result.begin(), result.end());
 	return result;
 }
+
+bool MakeDir(const Path& path)
+{
+	return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool AtomicReplaceFile(const Path& from, const Path& to)
+{
+	return rename(from.c_str(), to.c_str()) == 0;
+}
+
+bool RemoveFile(const Path& path)
+{
+	return unlink(path.c_str()) == 0;
+}
 }
 #endif
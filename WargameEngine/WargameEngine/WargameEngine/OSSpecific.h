@@ -5,4 +5,9 @@ namespace wargameEngine
 {
 //TODO: replace with filesystem based function, move to Utils
 std::vector<Path> GetFiles(const Path& path, const Path& mask, bool recursive);
+//Creates one directory level. Returns true if directory exists after the call
+bool MakeDir(const Path& path);
+//Renames file over existing one in a single step, so readers see either old or new file. Used to publish files written under temporary name
+bool AtomicReplaceFile(const Path& from, const Path& to);
+bool RemoveFile(const Path& path);
 }
\ No newline at end of file
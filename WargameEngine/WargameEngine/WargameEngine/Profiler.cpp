@@ -0,0 +1,214 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace wargameEngine
+{
+namespace
+{
+//Event is written and read field by field, sequence tells if the fields belong to one event. It is event number + 1 when event is complete
+//and 0 while the slot is rewritten, so reader that sees the same number before and after copying has a whole event
+struct sEventSlot
+{
+	std::atomic<size_t> sequence{ 0 };
+	std::atomic<const char*> name{ nullptr };
+	std::atomic<long long> start{ 0 };
+	std::atomic<long long> end{ 0 };
+	std::atomic<unsigned> depth{ 0 };
+};
+
+//Power of two, so ring index is a mask of event number
+const size_t ZONE_BUFFER_SIZE = 16384;
+const size_t ZONE_BUFFER_MASK = ZONE_BUFFER_SIZE - 1;
+
+//Events are written only by its thread, other threads may read them at any time
+struct sThreadZones
+{
+	sEventSlot events[ZONE_BUFFER_SIZE];
+	std::atomic<size_t> count{ 0 };
+	unsigned depth = 0;
+	size_t id = 0;
+	//Guarded by g_zoneThreadsMutex
+	std::string name;
+	//Number of events already passed to ReadNewEvents
+	size_t read = 0;
+};
+
+std::atomic<bool> g_zonesEnabled{ true };
+std::mutex g_zoneThreadsMutex;
+//Buffers are owned here, so zones of finished threads can still be saved
+std::vector<std::shared_ptr<sThreadZones>> g_zoneThreads;
+const std::chrono::steady_clock::time_point g_zonesEpoch = std::chrono::steady_clock::now();
+//Plain pointer, so access does not need thread_local initialization guard
+thread_local sThreadZones* t_zones = nullptr;
+
+//Name is set before the buffer is visible to other threads
+sThreadZones& GetThreadZones(std::string const& name = std::string())
+{
+	if (!t_zones)
+	{
+		auto zones = std::make_shared<sThreadZones>();
+		zones->name = name;
+		std::lock_guard<std::mutex> lk(g_zoneThreadsMutex);
+		zones->id = g_zoneThreads.size();
+		g_zoneThreads.push_back(zones);
+		t_zones = zones.get();
+	}
+	return *t_zones;
+}
+
+struct sThreadInfo
+{
+	std::shared_ptr<sThreadZones> zones;
+	std::string name;
+};
+
+std::vector<sThreadInfo> GetZoneThreads()
+{
+	std::lock_guard<std::mutex> lk(g_zoneThreadsMutex);
+	std::vector<sThreadInfo> result;
+	result.reserve(g_zoneThreads.size());
+	for (auto& zones : g_zoneThreads)
+	{
+		result.push_back({ zones, zones->name });
+	}
+	return result;
+}
+
+//Returns false if the thread has overwritten the event or is writing it right now
+bool ReadEvent(sThreadZones const& zones, size_t index, Profiler::Event& event)
+{
+	const sEventSlot& slot = zones.events[index & ZONE_BUFFER_MASK];
+	const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+	if (sequence != index + 1)
+		return false;
+	event.name = slot.name.load(std::memory_order_relaxed);
+	event.start = slot.start.load(std::memory_order_relaxed);
+	event.end = slot.end.load(std::memory_order_relaxed);
+	event.depth = slot.depth.load(std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slot.sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+//Only the last buffer of events can be read, older ones are already overwritten
+size_t GetFirstKeptEvent(size_t count)
+{
+	return count > ZONE_BUFFER_SIZE ? count - ZONE_BUFFER_SIZE : 0;
+}
+}
+
+Profiler::Zone::Zone(const char* name)
+	: m_name(g_zonesEnabled.load(std::memory_order_relaxed) ? name : nullptr)
+	, m_start(0)
+	, m_depth(0)
+{
+	if (m_name)
+	{
+		m_depth = GetThreadZones().depth++;
+		m_start = GetTime();
+	}
+}
+
+Profiler::Zone::~Zone()
+{
+	if (!m_name)
+		return;
+	const long long end = GetTime();
+	sThreadZones& zones = *t_zones;
+	--zones.depth;
+	const size_t count = zones.count.load(std::memory_order_relaxed);
+	sEventSlot& slot = zones.events[count & ZONE_BUFFER_MASK];
+	slot.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.name.store(m_name, std::memory_order_relaxed);
+	slot.start.store(m_start, std::memory_order_relaxed);
+	slot.end.store(end, std::memory_order_relaxed);
+	slot.depth.store(m_depth, std::memory_order_relaxed);
+	slot.sequence.store(count + 1, std::memory_order_release);
+	zones.count.store(count + 1, std::memory_order_release);
+}
+
+void Profiler::Enable(bool enable)
+{
+	g_zonesEnabled = enable;
+}
+
+bool Profiler::IsEnabled()
+{
+	return g_zonesEnabled;
+}
+
+void Profiler::SetThreadName(std::string const& name)
+{
+	if (!t_zones)
+	{
+		GetThreadZones(name);
+		return;
+	}
+	std::lock_guard<std::mutex> lk(g_zoneThreadsMutex);
+	t_zones->name = name;
+}
+
+bool Profiler::SaveTrace(const Path& path)
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+	file << "{\"traceEvents\":[";
+	bool first = true;
+	auto separator = [&]() -> std::ostream& {
+		file << (first ? "\n" : ",\n");
+		first = false;
+		return file;
+	};
+	file.setf(std::ios::fixed);
+	file.precision(3);
+	for (auto& thread : GetZoneThreads())
+	{
+		const size_t id = thread.zones->id;
+		const std::string name = thread.name.empty() ? "Thread " + std::to_string(id) : thread.name;
+		separator() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << id << ",\"args\":{\"name\":\"" << name << "\"}}";
+		const size_t count = thread.zones->count.load(std::memory_order_acquire);
+		Event event;
+		for (size_t i = GetFirstKeptEvent(count); i < count; ++i)
+		{
+			if (!ReadEvent(*thread.zones, i, event))
+				continue;
+			separator() << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << id
+				<< ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+		}
+	}
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return file.good();
+}
+
+void Profiler::ReadNewEvents(std::function<void(Event const&)> const& handler)
+{
+	Event event;
+	for (auto& thread : GetZoneThreads())
+	{
+		sThreadZones& zones = *thread.zones;
+		const size_t count = zones.count.load(std::memory_order_acquire);
+		for (size_t i = std::max(zones.read, GetFirstKeptEvent(count)); i < count; ++i)
+		{
+			if (ReadEvent(zones, i, event))
+			{
+				handler(event);
+			}
+		}
+		zones.read = count;
+	}
+}
+
+long long Profiler::GetTime()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_zonesEpoch).count();
+}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "Typedefs.h"
+#include <functional>
+#include <string>
+
+namespace wargameEngine
+{
+//CPU profiler of nested zones. Every thread records its zones to its own ring buffer, so recording takes no locks and any thread can use it
+class Profiler
+{
+public:
+	//Scoped profiler zone. Name is stored as pointer, so it should be a string literal
+	class Zone
+	{
+	public:
+		explicit Zone(const char* name);
+		Zone(Zone const&) = delete;
+		Zone& operator=(Zone const&) = delete;
+		~Zone();
+
+	private:
+		const char* m_name;
+		long long m_start;
+		unsigned m_depth;
+	};
+
+	struct Event
+	{
+		const char* name;
+		//Nanoseconds since profiler start
+		long long start;
+		long long end;
+		unsigned depth;
+	};
+
+	//Zones are recorded by default. Disabled zones cost a flag check
+	static void Enable(bool enable);
+	static bool IsEnabled();
+	//Thread names label threads in saved traces
+	static void SetThreadName(std::string const& name);
+	//Writes zones kept in ring buffers of all threads as Chrome trace_event JSON, so trace can be opened in chrome://tracing
+	static bool SaveTrace(const Path& path);
+	//Passes zones of all threads that ended since previous call. Zones overwritten before they are read are skipped. Must be called from one thread
+	static void ReadNewEvents(std::function<void(Event const&)> const& handler);
+	//Nanoseconds since profiler start
+	static long long GetTime();
+};
+}
@@ -0,0 +1,132 @@
+#include "RingBuffer.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string.h>
+
+namespace wargameEngine
+{
+RingBuffer::RingBuffer(size_t capacity)
+	: m_data(std::make_unique<char[]>(capacity))
+	, m_capacity(capacity)
+{
+}
+
+size_t RingBuffer::GetSize() const
+{
+	return m_size;
+}
+
+size_t RingBuffer::GetCapacity() const
+{
+	return m_capacity;
+}
+
+size_t RingBuffer::GetDataSpans(Span spans[2]) const
+{
+	if (m_size == 0)
+		return 0;
+	const size_t firstSize = std::min(m_size, m_capacity - m_begin);
+	spans[0] = { m_data.get() + m_begin, firstSize };
+	if (firstSize == m_size)
+		return 1;
+	spans[1] = { m_data.get(), m_size - firstSize };
+	return 2;
+}
+
+size_t RingBuffer::GetFreeSpans(Span spans[2]) const
+{
+	const size_t freeSize = m_capacity - m_size;
+	if (freeSize == 0)
+		return 0;
+	const size_t end = (m_begin + m_size) % m_capacity;
+	const size_t firstSize = std::min(freeSize, m_capacity - end);
+	spans[0] = { m_data.get() + end, firstSize };
+	if (firstSize == freeSize)
+		return 1;
+	spans[1] = { m_data.get(), freeSize - firstSize };
+	return 2;
+}
+
+void RingBuffer::Commit(size_t size)
+{
+	if (size > m_capacity - m_size)
+		throw std::out_of_range("Ring buffer overflow");
+	m_size += size;
+}
+
+void RingBuffer::Consume(size_t size)
+{
+	if (size > m_size)
+		throw std::out_of_range("Ring buffer underflow");
+	m_size -= size;
+	m_begin = m_size == 0 ? 0 : (m_begin + size) % m_capacity;
+}
+
+void RingBuffer::Write(const char* data, size_t size)
+{
+	if (size > m_capacity - m_size)
+	{
+		Reserve(std::max(m_size + size, m_capacity * 2));
+	}
+	Span spans[2];
+	const size_t count = GetFreeSpans(spans);
+	for (size_t i = 0; i < count && size > 0; ++i)
+	{
+		const size_t chunk = std::min(size, spans[i].size);
+		memcpy(spans[i].data, data, chunk);
+		m_size += chunk;
+		data += chunk;
+		size -= chunk;
+	}
+}
+
+void RingBuffer::Peek(char* data, size_t size) const
+{
+	if (size > m_size)
+		throw std::out_of_range("Ring buffer underflow");
+	Span spans[2];
+	const size_t count = GetDataSpans(spans);
+	for (size_t i = 0; i < count && size > 0; ++i)
+	{
+		const size_t chunk = std::min(size, spans[i].size);
+		memcpy(data, spans[i].data, chunk);
+		data += chunk;
+		size -= chunk;
+	}
+}
+
+char* RingBuffer::GetContiguous(size_t size)
+{
+	if (size > m_size)
+		throw std::out_of_range("Ring buffer underflow");
+	if (m_begin + size > m_capacity)
+	{
+		std::rotate(m_data.get(), m_data.get() + m_begin, m_data.get() + m_capacity);
+		m_begin = 0;
+	}
+	return m_data.get() + m_begin;
+}
+
+void RingBuffer::Reserve(size_t size)
+{
+	if (size > m_capacity)
+	{
+		Realloc(size);
+	}
+}
+
+void RingBuffer::Clear()
+{
+	m_begin = 0;
+	m_size = 0;
+}
+
+void RingBuffer::Realloc(size_t capacity)
+{
+	auto data = std::make_unique<char[]>(capacity);
+	Peek(data.get(), m_size);
+	m_data = std::move(data);
+	m_capacity = capacity;
+	m_begin = 0;
+}
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+
+namespace wargameEngine
+{
+//Byte queue for socket data. Free and used space are available as at most two contiguous spans, so sockets can read and write them directly
+class RingBuffer
+{
+public:
+	struct Span
+	{
+		char* data;
+		size_t size;
+	};
+
+	RingBuffer(size_t capacity = 16 * 1024);
+
+	size_t GetSize() const;
+	size_t GetCapacity() const;
+	//Returns number of spans with data (0, 1 or 2)
+	size_t GetDataSpans(Span spans[2]) const;
+	//Returns number of spans with free space (0, 1 or 2)
+	size_t GetFreeSpans(Span spans[2]) const;
+	//Marks size bytes of free spans as written
+	void Commit(size_t size);
+	//Removes size bytes from the beginning
+	void Consume(size_t size);
+	void Write(const char* data, size_t size);
+	//Copies size bytes from the beginning without consuming them
+	void Peek(char* data, size_t size) const;
+	//Returns pointer to first size bytes. Data is moved only if it wraps around the end of buffer, so it is rare for messages shorter than capacity
+	char* GetContiguous(size_t size);
+	//Makes capacity at least size bytes
+	void Reserve(size_t size);
+	void Clear();
+
+private:
+	void Realloc(size_t capacity);
+
+	std::unique_ptr<char[]> m_data;
+	size_t m_capacity;
+	size_t m_begin = 0;
+	size_t m_size = 0;
+};
+}
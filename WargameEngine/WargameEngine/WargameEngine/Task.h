@@ -1,6 +1,7 @@
 #pragma once
 #include "ITask.h"
 #include "ThreadPool.h"
+#include <condition_variable>
 #include <functional>
 #include <mutex>
 
@@ -42,11 +43,21 @@ public:
 
 	void Cancel()
 	{
-		std::lock_guard<std::mutex> lk(m_sync);
-		m_state = TaskState::CANCELLED;
+		{
+			std::lock_guard<std::mutex> lk(m_sync);
+			m_state = TaskState::CANCELLED;
+		}
+		m_stateChanged.notify_all();
 		m_threadPool.RemoveTask(this);
 	}
 
+	//Blocks until task is completed, failed or cancelled. Should not be called from the main thread as completion callbacks are executed there
+	void Wait() const
+	{
+		std::unique_lock<std::mutex> lk(m_sync);
+		m_stateChanged.wait(lk, [this] { return IsFinished(m_state); });
+	}
+
 	void Queue() override
 	{
 		std::unique_lock<std::mutex> lk(m_sync);
@@ -71,8 +82,32 @@ protected:
 	}
 	void SetTaskState(TaskState state)
 	{
-		std::lock_guard<std::mutex> lk(m_sync);
-		m_state = state;
+		{
+			std::lock_guard<std::mutex> lk(m_sync);
+			m_state = state;
+		}
+		m_stateChanged.notify_all();
+	}
+
+	//Returns false if task has been cancelled before execution
+	bool StartExecution()
+	{
+		std::unique_lock<std::mutex> lk(m_sync);
+		if (m_state == TaskState::CANCELLED)
+		{
+			return false;
+		}
+		if (m_state != TaskState::QUEUED)
+		{
+			throw std::runtime_error("Task is not ready for execution");
+		}
+		m_state = TaskState::STARTED;
+		return true;
+	}
+
+	static bool IsFinished(TaskState state)
+	{
+		return state != TaskState::CREATED && state != TaskState::QUEUED && state != TaskState::STARTED;
 	}
 
 	AsyncHandler m_handler;
@@ -81,6 +116,7 @@ protected:
 	TaskState m_state;
 	ThreadPool& m_threadPool;
 	mutable std::mutex m_sync;
+	mutable std::condition_variable m_stateChanged;
 };
 
 class Task : public TaskBase
@@ -94,13 +130,10 @@ public:
 private:
 	virtual void Execute() override
 	{
-		std::unique_lock<std::mutex> lk(m_sync);
-		if (m_state != TaskState::QUEUED)
+		if (!StartExecution())
 		{
-			throw std::runtime_error("Task is not ready for execution");
+			return;
 		}
-		m_state = TaskState::STARTED;
-		lk.unlock();
 		try
 		{
 			m_handler();
@@ -1,23 +1,51 @@
 #include "ThreadPool.h"
 #include "ITask.h"
 #include "LogWriter.h"
+#include "Profiler.h"
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>
 #include <deque>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace wargameEngine
 {
+struct ThreadPool::Job
+{
+	FunctionHandler func;
+	unsigned int flags;
+	//number of unfinished dependencies plus one guard reference held while the job is being registered
+	std::atomic<size_t> dependencies;
+	std::atomic<bool> finished;
+	std::mutex continuationsMutex;
+	std::vector<JobHandle> continuations;
+};
+
 struct ThreadPool::Impl
 {
-	struct sRunFunc
+	struct sWorkItem
 	{
 		FunctionHandler func;
 		CallbackHandler callback;
+		std::weak_ptr<ITask> task;
+		JobHandle job;
 		unsigned int flags;
 	};
+	enum Lane
+	{
+		LANE_HIGH = 0,
+		LANE_NORMAL,
+		LANE_COUNT
+	};
+	struct sWorkQueue
+	{
+		std::mutex mutex;
+		std::deque<sWorkItem> lanes[LANE_COUNT];
+		std::atomic<size_t> sizes[LANE_COUNT] = {};
+	};
 	struct sTimedCallback
 	{
 		CallbackHandler function;
@@ -26,141 +54,451 @@ struct ThreadPool::Impl
 		bool executeSkipped;
 		long long addedTime;
 		long long lastTriggerTime;
-		size_t index;
+		size_t generation;
+		bool active;
 	};
+	//Timed callback handles are slot index in lower bits and slot generation in upper bits, so stale handles never remove reused slots
+	static const size_t TIMED_CALLBACK_SLOT_BITS = 20;
+	static const size_t TIMED_CALLBACK_SLOT_MASK = (1 << TIMED_CALLBACK_SLOT_BITS) - 1;
+	static const size_t TIMED_CALLBACK_GENERATION_MASK = 0x7FF;
+
+	static thread_local Impl* t_pool;
+	static thread_local size_t t_workerIndex;
 
 public:
-	void QueueFunc(sRunFunc const& func)
+	Impl()
+	{
+		if (m_maxThreads == 0)
+		{
+			m_maxThreads = 1;
+		}
+		for (size_t i = 0; i < m_maxThreads; ++i)
+		{
+			m_queues.push_back(std::make_unique<sWorkQueue>());
+		}
+		StartWorkers();
+	}
+
+	//All workers are started at once, so parallel work gets full width from the first frame and after CancelAll
+	void StartWorkers()
+	{
+		while (m_threads.size() < m_maxThreads)
+		{
+			m_threads.push_back(std::thread(std::bind(&Impl::WorkerThread, this, m_threads.size())));
+			++m_threadsCount;
+		}
+	}
+
+	static Lane GetLane(unsigned int flags)
+	{
+		return (flags & FLAG_HIGH_PRIORITY) ? LANE_HIGH : LANE_NORMAL;
+	}
+
+	bool IsWorkerThread() const
+	{
+		return t_pool == this;
+	}
+
+	//Workers push to their own queue, other threads push to the shared injection queue
+	void Push(sWorkItem&& item)
 	{
-		std::lock_guard<std::mutex> lk(m_funcMutex);
-		if (func.flags & FLAG_HIGH_PRIORITY)
+		sWorkQueue& queue = IsWorkerThread() ? *m_queues[t_workerIndex] : m_globalQueue;
+		Lane lane = GetLane(item.flags);
+		{
+			std::lock_guard<std::mutex> lk(queue.mutex);
+			queue.lanes[lane].push_back(std::move(item));
+			++queue.sizes[lane];
+		}
+		++m_pendingCount;
+		if (m_sleepingCount > 0)
 		{
-			m_funcs.push_front(func);
+			std::lock_guard<std::mutex> lk(m_conditionalMutex);
+			m_conditional.notify_one();
+		}
+	}
+
+	bool PopFrom(sWorkQueue& queue, Lane lane, bool back, sWorkItem& item)
+	{
+		if (queue.sizes[lane] == 0)
+		{
+			return false;
+		}
+		std::lock_guard<std::mutex> lk(queue.mutex);
+		auto& deque = queue.lanes[lane];
+		if (deque.empty())
+		{
+			return false;
+		}
+		if (back)
+		{
+			item = std::move(deque.back());
+			deque.pop_back();
 		}
 		else
 		{
-			m_funcs.push_back(func);
+			item = std::move(deque.front());
+			deque.pop_front();
+		}
+		--queue.sizes[lane];
+		--m_pendingCount;
+		return true;
+	}
+
+	//Own queue is used as a stack for locality, shared queue and other workers' queues are stolen from in FIFO order
+	bool Pop(sWorkItem& item)
+	{
+		bool worker = IsWorkerThread();
+		size_t self = worker ? t_workerIndex : 0;
+		for (size_t lane = 0; lane < LANE_COUNT; ++lane)
+		{
+			Lane l = static_cast<Lane>(lane);
+			if (worker && PopFrom(*m_queues[self], l, true, item))
+				return true;
+			if (PopFrom(m_globalQueue, l, false, item))
+				return true;
+			for (size_t i = 1; i <= m_queues.size(); ++i)
+			{
+				size_t victim = (self + i) % m_queues.size();
+				if (worker && victim == self)
+					continue;
+				if (PopFrom(*m_queues[victim], l, false, item))
+					return true;
+			}
+		}
+		return false;
+	}
+
+	void Execute(sWorkItem& item)
+	{
+		Profiler::Zone zone("Task");
+		if (item.job)
+		{
+			item.job->func();
+			FinishJob(item.job);
+		}
+		else if (item.func)
+		{
+			item.func();
+			if (item.callback)
+			{
+				QueueCallback(item.callback, item.flags);
+			}
+		}
+		else if (auto task = item.task.lock())
+		{
+			//expired tasks have already been removed from the pool and are skipped
+			task->Execute();
+		}
+		SignalProgress();
+	}
+
+	//Wakes threads waiting in WaitForTask or WaitForJob
+	void SignalProgress()
+	{
+		++m_progressEpoch;
+		if (m_waitingCount > 0)
+		{
+			std::lock_guard<std::mutex> lk(m_progressMutex);
+			m_progress.notify_all();
+		}
+	}
+
+	//Runs queued work or sleeps until any work item finishes or callback is queued
+	template<class Predicate>
+	void HelpUntil(Predicate const& isDone, bool runCallbacks)
+	{
+		for (;;)
+		{
+			size_t epoch = m_progressEpoch;
+			if (runCallbacks)
+			{
+				Update();
+			}
+			if (isDone() || m_cancelled)
+			{
+				return;
+			}
+			if (HelpOnce())
+			{
+				continue;
+			}
+			std::unique_lock<std::mutex> lk(m_progressMutex);
+			++m_waitingCount;
+			m_progress.wait(lk, [&] { return m_progressEpoch != epoch || m_cancelled; });
+			--m_waitingCount;
 		}
-		m_conditional.notify_one();
 	}
 
 	void RunFunc(FunctionHandler const& func, CallbackHandler const& callback, unsigned int flags)
 	{
-		QueueFunc(sRunFunc{ func, callback, flags });
+		if ((flags & FLAG_FAST_FUNCTION) && IsWorkerThread())
+		{
+			func();
+			if (callback)
+			{
+				QueueCallback(callback, flags);
+			}
+			return;
+		}
+		Push(sWorkItem{ func, callback, std::weak_ptr<ITask>(), nullptr, flags });
+	}
+
+	void ScheduleJob(JobHandle const& job)
+	{
+		if ((job->flags & FLAG_FAST_FUNCTION) && IsWorkerThread())
+		{
+			job->func();
+			FinishJob(job);
+			return;
+		}
+		Push(sWorkItem{ FunctionHandler(), CallbackHandler(), std::weak_ptr<ITask>(), job, job->flags });
 	}
 
-	void QueueCallback(CallbackHandler const& callback, unsigned int flags)
+	void FinishJob(JobHandle const& job)
 	{
-		std::lock_guard<std::mutex> lk(m_callbackMutex);
-		if (flags & FLAG_HIGH_PRIORITY)
+		std::vector<JobHandle> continuations;
 		{
-			m_callbacks.push_front(callback);
+			std::lock_guard<std::mutex> lk(job->continuationsMutex);
+			job->finished = true;
+			continuations.swap(job->continuations);
 		}
-		else
+		for (auto& continuation : continuations)
 		{
-			m_callbacks.push_back(callback);
+			if (--continuation->dependencies == 0)
+			{
+				ScheduleJob(continuation);
+			}
 		}
 	}
 
+	JobHandle RunJob(FunctionHandler const& func, std::vector<JobHandle> const& dependencies, unsigned int flags)
+	{
+		auto job = std::make_shared<Job>();
+		job->func = func;
+		job->flags = flags;
+		job->dependencies = dependencies.size() + 1;
+		job->finished = false;
+		for (auto& dependency : dependencies)
+		{
+			std::lock_guard<std::mutex> lk(dependency->continuationsMutex);
+			if (dependency->finished)
+			{
+				--job->dependencies;
+			}
+			else
+			{
+				dependency->continuations.push_back(job);
+			}
+		}
+		if (--job->dependencies == 0)
+		{
+			ScheduleJob(job);
+		}
+		return job;
+	}
+
+	bool HelpOnce()
+	{
+		sWorkItem item;
+		if (Pop(item))
+		{
+			Execute(item);
+			return true;
+		}
+		return false;
+	}
+
+	void WaitForJob(JobHandle const& job)
+	{
+		HelpUntil([&job] { return job->finished.load(); }, false);
+	}
+
+	void ParallelFor(size_t begin, size_t end, RangeHandler const& func, size_t grainSize)
+	{
+		if (begin >= end)
+		{
+			return;
+		}
+		grainSize = std::max<size_t>(grainSize, 1);
+		const size_t chunks = (end - begin + grainSize - 1) / grainSize;
+		struct sRange
+		{
+			std::atomic<size_t> next;
+			std::atomic<size_t> done;
+		};
+		auto range = std::make_shared<sRange>();
+		range->next = 0;
+		range->done = 0;
+		auto processChunks = [=]() {
+			for (;;)
+			{
+				size_t chunk = range->next++;
+				if (chunk >= chunks)
+				{
+					return;
+				}
+				size_t chunkBegin = begin + chunk * grainSize;
+				func(chunkBegin, std::min(chunkBegin + grainSize, end));
+				++range->done;
+			}
+		};
+		const size_t helpers = std::min(chunks, m_threadsCount + (IsWorkerThread() ? 0 : 1)) - 1;
+		for (size_t i = 0; i < helpers; ++i)
+		{
+			Push(sWorkItem{ processChunks, CallbackHandler(), std::weak_ptr<ITask>(), nullptr, FLAG_HIGH_PRIORITY });
+		}
+		processChunks();
+		//Every chunk is taken by now, so only chunks running on other threads are waited for. Unrelated work is not picked up here,
+		//and wait does not end on cancel, because running chunks may reference caller's stack
+		while (range->done < chunks)
+		{
+			size_t epoch = m_progressEpoch;
+			std::unique_lock<std::mutex> lk(m_progressMutex);
+			++m_waitingCount;
+			m_progress.wait(lk, [&] { return m_progressEpoch != epoch || range->done >= chunks; });
+			--m_waitingCount;
+		}
+	}
+
+	void QueueCallback(CallbackHandler const& callback, unsigned int flags)
+	{
+		{
+			std::lock_guard<std::mutex> lk(m_callbackMutex);
+			if (flags & FLAG_HIGH_PRIORITY)
+			{
+				m_callbacks.push_front(callback);
+			}
+			else
+			{
+				m_callbacks.push_back(callback);
+			}
+		}
+		SignalProgress();
+	}
+
 	void AddTask(std::shared_ptr<ITask> const& task)
 	{
-		std::lock_guard<std::mutex> lk(m_tasksMutex);
-		m_tasks.push_back(task);
 		task->Queue();
-		m_conditional.notify_one();
+		{
+			std::lock_guard<std::mutex> lk(m_tasksMutex);
+			m_storedTasks.emplace(task.get(), task);
+		}
+		Push(sWorkItem{ FunctionHandler(), CallbackHandler(), task, nullptr, 0 });
 	}
 
+	//Queued work items only hold weak references, so dropping the stored reference is enough to dequeue a task
 	void RemoveTask(ITask* task)
 	{
+		std::shared_ptr<ITask> removed;
 		std::lock_guard<std::mutex> lk(m_tasksMutex);
-		auto it = std::find_if(m_tasks.begin(), m_tasks.end(), [task](std::shared_ptr<ITask> const& taskptr) { return taskptr.get() == task; });
-		if (it != m_tasks.end())
-		{
-			m_tasks.erase(it);
-		}
-		auto it2 = std::find_if(m_storedTasks.begin(), m_storedTasks.end(), [task](std::shared_ptr<ITask> const& taskptr) { return taskptr.get() == task; });
-		if (it2 != m_storedTasks.end())
+		auto it = m_storedTasks.find(task);
+		if (it != m_storedTasks.end())
 		{
-			m_storedTasks.erase(it2);
+			removed = std::move(it->second);
+			m_storedTasks.erase(it);
 		}
 	}
 
 	void Update()
 	{
-		if ((!m_funcs.empty() || !m_tasks.empty()) && m_threads.size() < m_maxThreads)
+		if (m_threads.size() < m_maxThreads)
 		{
-			m_threads.push_back(std::thread(std::bind(&Impl::WorkerThread, this)));
+			StartWorkers();
 		}
-		while (!m_callbacks.empty())
+		Profiler::Zone zone("Thread pool callbacks");
+		for (;;)
 		{
-			if (m_callbacks.front())
-				m_callbacks.front()();
-			bool last = m_callbacks.size() == 1;
-			if (last)
-				m_callbackMutex.lock();
+			std::unique_lock<std::mutex> lk(m_callbackMutex);
+			if (m_callbacks.empty())
+			{
+				break;
+			}
+			CallbackHandler callback = std::move(m_callbacks.front());
 			m_callbacks.pop_front();
-			if (last)
-				m_callbackMutex.unlock();
+			lk.unlock();
+			if (callback)
+				callback();
 		}
 		UpdateTimedCallbacks();
 	}
 
 	void UpdateTimedCallbacks()
 	{
+		//Slots are released here and not in RemoveTimedCallback because callback may remove itself while being executed
+		for (size_t slot : m_removedTimedCallbacks)
+		{
+			m_timedCallbacks[slot].function = CallbackHandler();
+			m_freeTimedCallbacks.push_back(slot);
+		}
+		m_removedTimedCallbacks.clear();
 		long long currentTime = GetTime();
-		std::vector<size_t> callbacksToRemove;
-		for (auto& timed : m_timedCallbacks)
+		for (size_t slot = 0; slot < m_timedCallbacks.size(); ++slot)
 		{
+			auto& timed = m_timedCallbacks[slot];
+			if (!timed.active)
+				continue;
 			long long delta = currentTime - timed.lastTriggerTime;
 			if (delta >= timed.period)
 			{
 				timed.lastTriggerTime += (delta / timed.period) * timed.period;
 				long long count = timed.repeat && timed.executeSkipped ? delta / timed.period : 1;
-				for (long long i = 0; i < count; ++i)
+				for (long long i = 0; i < count && timed.active; ++i)
 				{
 					timed.function();
 				}
 				if (!timed.repeat)
 				{
-					callbacksToRemove.push_back(timed.index);
+					RemoveTimedCallback(MakeTimedCallbackHandle(slot, timed.generation));
 				}
 			}
 		}
-		for (auto index : callbacksToRemove)
-		{
-			RemoveTimedCallback(index);
-		}
+	}
+
+	static size_t MakeTimedCallbackHandle(size_t slot, size_t generation)
+	{
+		return ((generation & TIMED_CALLBACK_GENERATION_MASK) << TIMED_CALLBACK_SLOT_BITS) | slot;
 	}
 
 	size_t GetTasksAndFuncsCount()
 	{
-		m_funcMutex.lock();
-		size_t result = m_funcs.size();
-		m_funcMutex.unlock();
-		m_tasksMutex.lock();
-		result += m_tasks.size();
-		m_tasksMutex.unlock();
-		return result;
+		return m_pendingCount;
 	}
 
 	void CancelAll()
 	{
 		m_cancelled = true;
-		m_funcMutex.lock();
-		m_funcs.clear();
-		m_funcMutex.unlock();
-		m_tasksMutex.lock();
-		m_tasks.clear();
-		m_tasksMutex.unlock();
-		m_conditional.notify_all();
-		m_callbackMutex.lock();
-		m_callbacks.clear();
-		m_callbackMutex.unlock();
+		{
+			std::lock_guard<std::mutex> lk(m_conditionalMutex);
+			m_conditional.notify_all();
+		}
+		{
+			std::lock_guard<std::mutex> lk(m_progressMutex);
+			m_progress.notify_all();
+		}
+		//Workers are joined before queues are cleared, so no PopFrom can decrement pending counter after it is reset
 		for (auto& th : m_threads)
 		{
 			th.join();
 		}
 		m_threads.clear();
+		m_threadsCount = 0;
+		auto clearQueue = [](sWorkQueue& queue) {
+			std::lock_guard<std::mutex> lk(queue.mutex);
+			for (size_t lane = 0; lane < LANE_COUNT; ++lane)
+			{
+				queue.lanes[lane].clear();
+				queue.sizes[lane] = 0;
+			}
+		};
+		clearQueue(m_globalQueue);
+		for (auto& queue : m_queues)
+		{
+			clearQueue(*queue);
+		}
+		m_pendingCount = 0;
+		m_callbackMutex.lock();
+		m_callbacks.clear();
+		m_callbackMutex.unlock();
 		m_cancelled = false;
 	}
 
@@ -172,100 +510,101 @@ public:
 
 	size_t AddTimedCallback(CallbackHandler const& func, unsigned int time, bool repeat, bool executeSkipped)
 	{
-		m_timedCallbacks.push_back({ func, time, repeat, executeSkipped, GetTime(), GetTime(), m_nextTimedCallbackIndex });
-		m_nextTimedCallbackIndex++;
-		return m_timedCallbacks.back().index;
+		size_t slot;
+		if (!m_freeTimedCallbacks.empty())
+		{
+			slot = m_freeTimedCallbacks.back();
+			m_freeTimedCallbacks.pop_back();
+		}
+		else
+		{
+			slot = m_timedCallbacks.size();
+			if (slot > TIMED_CALLBACK_SLOT_MASK)
+			{
+				throw std::runtime_error("Too many timed callbacks");
+			}
+			m_timedCallbacks.push_back({ CallbackHandler(), 0, false, false, 0, 0, 0, false });
+		}
+		auto& timed = m_timedCallbacks[slot];
+		size_t generation = timed.generation + 1;
+		timed = { func, time, repeat, executeSkipped, GetTime(), GetTime(), generation, true };
+		return MakeTimedCallbackHandle(slot, generation);
 	}
 
-	void RemoveTimedCallback(size_t index)
+	void RemoveTimedCallback(size_t handle)
 	{
-		m_timedCallbacks.erase(std::find_if(m_timedCallbacks.begin(), m_timedCallbacks.end(), [=](std::deque<sTimedCallback>::value_type& callback) { return callback.index == index; }));
+		size_t slot = handle & TIMED_CALLBACK_SLOT_MASK;
+		if (slot >= m_timedCallbacks.size())
+			return;
+		auto& timed = m_timedCallbacks[slot];
+		if (!timed.active || MakeTimedCallbackHandle(slot, timed.generation) != handle)
+			return;
+		timed.active = false;
+		m_removedTimedCallbacks.push_back(slot);
 	}
 
 	void WaitForTask(ITask& task)
 	{
-		for (;;)
+		switch (task.GetState())
 		{
-			switch (task.GetState())
-			{
-			case ITask::TaskState::QUEUED:
-			case ITask::TaskState::STARTED:
-			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(1));
-				Update();
-			}
+		case ITask::TaskState::CREATED:
+			throw std::runtime_error("Invalid task state");
+		default:
 			break;
-			case ITask::TaskState::COMPLETED:
-			case ITask::TaskState::READY_FOR_DISPOSE:
-			case ITask::TaskState::CANCELLED:
-			case ITask::TaskState::FAILED:
-				return;
-			default:
-				throw std::runtime_error("Invalid task state");
-			}
 		}
+		//Completion callbacks are executed by the main thread, so waiting thread runs them as well as queued work
+		HelpUntil([&task] {
+			auto state = task.GetState();
+			return state != ITask::TaskState::QUEUED && state != ITask::TaskState::STARTED;
+		}, true);
 	}
 
-	void WorkerThread()
+	void WorkerThread(size_t index)
 	{
-		for (;;)
+		t_pool = this;
+		t_workerIndex = index;
+		Profiler::SetThreadName("Worker " + std::to_string(index));
+		while (!m_cancelled)
 		{
-			bool hasTasks = false;
+			sWorkItem item;
+			if (Pop(item))
 			{
-				std::unique_lock<std::mutex> lk(m_funcMutex);
-				if (!m_funcs.empty())
-				{
-					hasTasks = true;
-					sRunFunc func = std::move(m_funcs.front());
-					m_funcs.pop_front();
-					lk.unlock();
-					func.func();
-					if (func.callback)
-					{
-						QueueCallback(func.callback, func.flags);
-					}
-				}
-			}
-			{
-				std::unique_lock<std::mutex> lk(m_tasksMutex);
-				if (!m_tasks.empty())
-				{
-					hasTasks = true;
-					std::shared_ptr<ITask> task = m_tasks.front();
-					m_tasks.pop_front();
-					m_storedTasks.push_back(task);
-					lk.unlock();
-					task->Execute();
-				}
-			}
-			if (!hasTasks)
-			{
-				std::unique_lock<std::mutex> lk(m_conditionalMutex);
-				m_conditional.wait(lk);
-				if (m_cancelled)
-				{
-					return;
-				}
+				Execute(item);
+				continue;
 			}
+			std::unique_lock<std::mutex> lk(m_conditionalMutex);
+			++m_sleepingCount;
+			m_conditional.wait(lk, [this] { return m_pendingCount > 0 || m_cancelled; });
+			--m_sleepingCount;
 		}
 	}
 
 	std::deque<FunctionHandler> m_callbacks;
-	std::deque<sRunFunc> m_funcs;
-	std::deque<std::shared_ptr<ITask>> m_tasks;
-	std::vector<std::shared_ptr<ITask>> m_storedTasks;
+	sWorkQueue m_globalQueue;
+	std::vector<std::unique_ptr<sWorkQueue>> m_queues;
+	std::unordered_map<ITask*, std::shared_ptr<ITask>> m_storedTasks;
 	std::deque<sTimedCallback> m_timedCallbacks;
-	size_t m_nextTimedCallbackIndex = 0;
+	std::vector<size_t> m_freeTimedCallbacks;
+	std::vector<size_t> m_removedTimedCallbacks;
 	size_t m_maxThreads = std::thread::hardware_concurrency();
-	bool m_cancelled = false;
+	std::atomic<size_t> m_pendingCount = { 0 };
+	std::atomic<size_t> m_sleepingCount = { 0 };
+	std::atomic<bool> m_cancelled = { false };
+	std::atomic<size_t> m_progressEpoch = { 0 };
+	std::atomic<size_t> m_waitingCount = { 0 };
+	std::condition_variable m_progress;
+	std::mutex m_progressMutex;
 	std::vector<std::thread> m_threads;
+	std::atomic<size_t> m_threadsCount = { 0 };
 	std::condition_variable m_conditional;
 	std::mutex m_conditionalMutex;
 	std::mutex m_callbackMutex;
-	std::mutex m_funcMutex;
 	std::mutex m_tasksMutex;
 };
 
+thread_local ThreadPool::Impl* ThreadPool::Impl::t_pool = nullptr;
+thread_local size_t ThreadPool::Impl::t_workerIndex = 0;
+
 ThreadPool::ThreadPool()
 	: m_pImpl(std::make_unique<Impl>())
 {
@@ -281,6 +620,21 @@ void ThreadPool::RunFunc(FunctionHandler const& func, CallbackHandler const& cal
 	m_pImpl->RunFunc(func, callback, flags);
 }
 
+ThreadPool::JobHandle ThreadPool::RunJob(FunctionHandler const& func, std::vector<JobHandle> const& dependencies, unsigned int flags)
+{
+	return m_pImpl->RunJob(func, dependencies, flags);
+}
+
+void ThreadPool::WaitForJob(JobHandle const& job)
+{
+	m_pImpl->WaitForJob(job);
+}
+
+void ThreadPool::ParallelFor(size_t begin, size_t end, RangeHandler const& func, size_t grainSize)
+{
+	m_pImpl->ParallelFor(begin, end, func, grainSize);
+}
+
 void ThreadPool::QueueCallback(CallbackHandler const& func, unsigned int flags)
 {
 	m_pImpl->QueueCallback(func, flags);
@@ -296,6 +650,11 @@ size_t ThreadPool::GetTasksAndFuncsCount()
 	return m_pImpl->GetTasksAndFuncsCount();
 }
 
+size_t ThreadPool::GetWorkersCount() const
+{
+	return m_pImpl->m_maxThreads;
+}
+
 void ThreadPool::CancelAll()
 {
 	m_pImpl->CancelAll();
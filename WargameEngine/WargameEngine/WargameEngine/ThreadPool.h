@@ -2,6 +2,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace wargameEngine
 {
@@ -14,14 +15,25 @@ public:
 	~ThreadPool();
 	typedef std::function<void()> FunctionHandler;
 	typedef std::function<void()> CallbackHandler;
+	typedef std::function<void(size_t begin, size_t end)> RangeHandler;
+	struct Job;
+	typedef std::shared_ptr<Job> JobHandle;
 	//Runs function in thread pool. doneCallback will be called in main thread when finished
 	void RunFunc(FunctionHandler const& func, CallbackHandler const& callback = CallbackHandler(), unsigned int flags = 0);
+	//Runs function in thread pool as soon as all dependencies are finished. Returned handle can be used as a dependency for continuations
+	JobHandle RunJob(FunctionHandler const& func, std::vector<JobHandle> const& dependencies = std::vector<JobHandle>(), unsigned int flags = 0);
+	//Blocks until job is finished. Calling thread executes queued work while waiting
+	void WaitForJob(JobHandle const& job);
+	//Splits [begin, end) into chunks of grainSize and processes them in parallel. Calling thread participates and returns when all chunks are done
+	void ParallelFor(size_t begin, size_t end, RangeHandler const& func, size_t grainSize = 1);
 	//Queues function to be executed on the main thread
 	void QueueCallback(CallbackHandler const& func, unsigned int flags = 0);
 	//Runs additional working threads and queued doneCallbacks. Call from main thread as often as possible
 	void Update();
 	//Returns number of tasks and functions queued
 	size_t GetTasksAndFuncsCount();
+	//Returns maximum number of worker threads
+	size_t GetWorkersCount() const;
 	//Removes all queued operations and callbacks
 	void CancelAll();
 	//Task internal functions
@@ -32,9 +44,9 @@ public:
 	void RemoveTimedCallback(size_t index);
 	enum flags
 	{
-		//Functions with this flag will be added to the beginning of the queue, not the end
+		//Functions with this flag will be executed before any normal priority work, not after
 		FLAG_HIGH_PRIORITY = 1,
-		//Functions with this flag will be executed in the same thread as the async reading. Speedup on small functions. Has no effect when no async reading is present.
+		//Functions with this flag queued from a worker thread will be executed immediately in that thread. Speedup on small functions. Has no effect when queued from other threads.
 		FLAG_FAST_FUNCTION = 2
 	};
 	struct Impl;
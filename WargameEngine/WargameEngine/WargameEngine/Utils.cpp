@@ -1,4 +1,6 @@
 #include "Utils.h"
+#include <algorithm>
+#include <cwctype>
 #include <fstream>
 #include <iomanip>
 #include <locale>
@@ -58,6 +60,14 @@ std::wstring to_wstring(const Path& path)
 #endif
 }
 
+Path GetExtension(const Path& path)
+{
+	const size_t dotPos = path.find_last_of('.');
+	Path extension = dotPos == path.npos ? Path() : path.substr(dotPos + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), std::towlower);
+	return extension;
+}
+
 std::vector<char> ReadFile(const Path& path)
 {
 	std::vector<char> result;
@@ -72,6 +82,16 @@ std::vector<char> ReadFile(const Path& path)
 	return result;
 }
 
+std::vector<char> ReadFileNullTerminated(const Path& path)
+{
+	std::vector<char> result = ReadFile(path);
+	if (!result.empty())
+	{
+		result.push_back('\0');
+	}
+	return result;
+}
+
 void WriteFile(const Path& path, const char* data, size_t size)
 {
 	std::ofstream file(path, std::ios::binary | std::ios::out);
@@ -83,6 +103,31 @@ void WriteFile(const Path& path, const std::vector<char>& data)
 	WriteFile(path, data.data(), data.size());
 }
 
+uint64_t HashData(const void* data, size_t size, uint64_t seed)
+{
+	const uint64_t prime = 0x9E3779B97F4A7C15ull;
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = seed ^ (size * prime);
+	for (; size >= 8; size -= 8, bytes += 8)
+	{
+		uint64_t word = 0;
+		for (int i = 0; i < 8; ++i)
+		{
+			word |= static_cast<uint64_t>(bytes[i]) << (i * 8);//little endian on every platform
+		}
+		hash = (hash ^ word) * prime;
+		hash ^= hash >> 29;
+	}
+	uint64_t tail = 0;
+	for (size_t i = 0; i < size; ++i)
+	{
+		tail |= static_cast<uint64_t>(bytes[i]) << (i * 8);
+	}
+	hash = (hash ^ tail) * prime;
+	hash ^= hash >> 32;
+	return hash;
+}
+
 std::wstring ToWstring(double value, size_t precision /*= 0*/)
 {
 	std::wostringstream out;
@@ -1,5 +1,6 @@
 #pragma once
 #include "Typedefs.h"
+#include <cstdint>
 #include <vector>
 #include <fstream>
 #include <unordered_map>
@@ -9,12 +10,18 @@ namespace wargameEngine
 std::wstring Utf8ToWstring(std::string const& str);
 std::string WStringToUtf8(std::wstring const& str);
 std::vector<char> ReadFile(const Path& path);
+//Text model readers rely on null terminator after the data. It is not counted in file size, which is size of the result minus one. Empty if file cannot be read
+std::vector<char> ReadFileNullTerminated(const Path& path);
 void WriteFile(const Path& path, const char* data, size_t size);
 void WriteFile(const Path& path, std::vector<char> const& data);
+//Fast non-cryptographic hash. Used to key caches of generated data, so it has to be the same on every platform
+uint64_t HashData(const void* data, size_t size, uint64_t seed = 0);
 std::wstring ToWstring(double value, size_t precision = 0);
 std::wstring ReplaceAll(const std::wstring& text, const std::unordered_map<std::wstring, std::wstring>& replaceMap);
 std::string to_string(const Path& path);
 std::wstring to_wstring(const Path& path);
+//Extension in lower case without dot, empty if there is none
+Path GetExtension(const Path& path);
 
 #ifdef _WINDOWS
 inline Path make_path(const std::wstring& p) { return p; }
@@ -0,0 +1,369 @@
+#include "VirtualFileSystem.h"
+#include "LogWriter.h"
+#include "OSSpecific.h"
+#include "Utils.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#ifdef _WINDOWS
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace wargameEngine
+{
+namespace
+{
+const char PACK_MAGIC[4] = { 'W', 'P', 'A', 'K' };
+const uint32_t PACK_VERSION = 1;
+const uint64_t PACK_DATA_ALIGNMENT = 16;
+
+struct sPackHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t entriesCount;
+	uint64_t indexOffset;
+};
+
+size_t GetMappingGranularity()
+{
+#ifdef _WINDOWS
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwAllocationGranularity;
+#else
+	return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+}
+
+FileView::FileView(FileView&& other)
+{
+	*this = std::move(other);
+}
+
+FileView& FileView::operator=(FileView&& other)
+{
+	if (this != &other)
+	{
+		Reset();
+		std::swap(m_data, other.m_data);
+		std::swap(m_size, other.m_size);
+		std::swap(m_mapping, other.m_mapping);
+		std::swap(m_mappingSize, other.m_mappingSize);
+	}
+	return *this;
+}
+
+FileView::~FileView()
+{
+	Reset();
+}
+
+void FileView::Reset()
+{
+	if (m_mapping)
+	{
+#ifdef _WINDOWS
+		UnmapViewOfFile(m_mapping);
+#else
+		munmap(m_mapping, m_mappingSize);
+#endif
+	}
+	m_data = nullptr;
+	m_size = 0;
+	m_mapping = nullptr;
+	m_mappingSize = 0;
+}
+
+#ifdef _WINDOWS
+struct MappedFile::Impl
+{
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = NULL;
+	size_t size = 0;
+};
+
+MappedFile::MappedFile(const Path& path)
+	: m_pImpl(std::make_unique<Impl>())
+{
+	m_pImpl->file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m_pImpl->file == INVALID_HANDLE_VALUE)
+		return;
+	LARGE_INTEGER size;
+	GetFileSizeEx(m_pImpl->file, &size);
+	m_pImpl->size = static_cast<size_t>(size.QuadPart);
+	if (m_pImpl->size > 0)
+	{
+		m_pImpl->mapping = CreateFileMappingW(m_pImpl->file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if (m_pImpl->mapping)
+		CloseHandle(m_pImpl->mapping);
+	if (m_pImpl->file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_pImpl->file);
+}
+
+bool MappedFile::IsOpen() const
+{
+	return m_pImpl->file != INVALID_HANDLE_VALUE;
+}
+#else
+struct MappedFile::Impl
+{
+	int file = -1;
+	size_t size = 0;
+};
+
+MappedFile::MappedFile(const Path& path)
+	: m_pImpl(std::make_unique<Impl>())
+{
+	m_pImpl->file = open(path.c_str(), O_RDONLY);
+	if (m_pImpl->file == -1)
+		return;
+	struct stat info;
+	if (fstat(m_pImpl->file, &info) == 0)
+	{
+		m_pImpl->size = static_cast<size_t>(info.st_size);
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if (m_pImpl->file != -1)
+		close(m_pImpl->file);
+}
+
+bool MappedFile::IsOpen() const
+{
+	return m_pImpl->file != -1;
+}
+#endif
+
+size_t MappedFile::GetSize() const
+{
+	return m_pImpl->size;
+}
+
+FileView MappedFile::Map(size_t offset, size_t size) const
+{
+	FileView view;
+	if (!IsOpen() || size == 0 || offset > m_pImpl->size || size > m_pImpl->size - offset)
+		return view;
+	static const size_t granularity = GetMappingGranularity();
+	size_t alignedOffset = offset - offset % granularity;
+	size_t mappingSize = size + (offset - alignedOffset);
+#ifdef _WINDOWS
+	if (!m_pImpl->mapping)
+		return view;
+	void* mapping = MapViewOfFile(m_pImpl->mapping, FILE_MAP_COPY, static_cast<DWORD>(static_cast<uint64_t>(alignedOffset) >> 32), static_cast<DWORD>(alignedOffset & 0xFFFFFFFF), mappingSize);
+	if (!mapping)
+		return view;
+#else
+	void* mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, m_pImpl->file, static_cast<off_t>(alignedOffset));
+	if (mapping == MAP_FAILED)
+		return view;
+#endif
+	view.m_mapping = mapping;
+	view.m_mappingSize = mappingSize;
+	view.m_data = static_cast<char*>(mapping) + (offset - alignedOffset);
+	view.m_size = size;
+	return view;
+}
+
+std::string VirtualFileSystem::NormalizePath(const Path& path)
+{
+	std::string result = to_string(path);
+	for (auto& c : result)
+	{
+		if (c == '\\')
+			c = '/';
+		else if (c >= 'A' && c <= 'Z')
+			c = c - 'A' + 'a';
+	}
+	while (!result.empty() && result.back() == '/')
+	{
+		result.pop_back();
+	}
+	return result;
+}
+
+uint64_t VirtualFileSystem::HashPath(std::string const& normalizedPath)
+{
+	//FNV-1a
+	uint64_t hash = 14695981039346656037ULL;
+	for (char c : normalizedPath)
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+bool VirtualFileSystem::Mount(const Path& packPath, const Path& rootDir)
+{
+	sPack pack;
+	pack.file = std::make_unique<MappedFile>(packPath);
+	sPackHeader header;
+	FileView headerView = pack.file->Map(0, sizeof(header));
+	if (headerView.size() != sizeof(header))
+	{
+		LogWriter::WriteLine("Cannot open pack " + to_string(packPath));
+		return false;
+	}
+	memcpy(&header, headerView.data(), sizeof(header));
+	if (memcmp(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 || header.version != PACK_VERSION || header.indexOffset > pack.file->GetSize())
+	{
+		LogWriter::WriteLine("Invalid pack " + to_string(packPath));
+		return false;
+	}
+	FileView indexView = pack.file->Map(static_cast<size_t>(header.indexOffset), pack.file->GetSize() - static_cast<size_t>(header.indexOffset));
+	const char* ptr = indexView.data();
+	const char* end = ptr + indexView.size();
+	const size_t fixedSize = sizeof(uint64_t) + sizeof(sPackEntry::offset) + sizeof(sPackEntry::size) + sizeof(uint32_t);
+	//Every entry takes at least fixedSize bytes, so larger counts cannot be valid and must not be reserved
+	if (header.entriesCount > indexView.size() / fixedSize)
+	{
+		LogWriter::WriteLine("Pack index is corrupted " + to_string(packPath));
+		return false;
+	}
+	pack.index.reserve(static_cast<size_t>(header.entriesCount));
+	for (uint64_t i = 0; i < header.entriesCount; ++i)
+	{
+		uint64_t hash;
+		sPackEntry entry;
+		uint32_t nameSize;
+		if (static_cast<size_t>(end - ptr) < fixedSize)
+			break;
+		memcpy(&hash, ptr, sizeof(hash));
+		ptr += sizeof(hash);
+		memcpy(&entry.offset, ptr, sizeof(entry.offset));
+		ptr += sizeof(entry.offset);
+		memcpy(&entry.size, ptr, sizeof(entry.size));
+		ptr += sizeof(entry.size);
+		memcpy(&nameSize, ptr, sizeof(nameSize));
+		ptr += sizeof(nameSize);
+		if (static_cast<size_t>(end - ptr) < nameSize)
+			break;
+		entry.name.assign(ptr, nameSize);
+		ptr += nameSize;
+		pack.index.emplace(hash, std::move(entry));
+	}
+	if (pack.index.size() != header.entriesCount)
+	{
+		LogWriter::WriteLine("Pack index is corrupted " + to_string(packPath));
+		return false;
+	}
+	pack.root = NormalizePath(rootDir);
+	m_packs.push_back(std::move(pack));
+	return true;
+}
+
+void VirtualFileSystem::UnmountAll()
+{
+	m_packs.clear();
+}
+
+VirtualFileSystem::sPackEntry const* VirtualFileSystem::Find(const Path& path, sPack const** foundPack) const
+{
+	if (m_packs.empty())
+		return nullptr;
+	std::string normalized = NormalizePath(path);
+	for (auto& pack : m_packs)
+	{
+		std::string const* name = &normalized;
+		std::string relative;
+		if (!pack.root.empty())
+		{
+			if (normalized.size() <= pack.root.size() || normalized.compare(0, pack.root.size(), pack.root) != 0 || normalized[pack.root.size()] != '/')
+				continue;
+			relative = normalized.substr(pack.root.size() + 1);
+			name = &relative;
+		}
+		auto range = pack.index.equal_range(HashPath(*name));
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (it->second.name == *name)
+			{
+				*foundPack = &pack;
+				return &it->second;
+			}
+		}
+	}
+	return nullptr;
+}
+
+FileView VirtualFileSystem::Open(const Path& path) const
+{
+	sPack const* pack = nullptr;
+	if (auto entry = Find(path, &pack))
+	{
+		return pack->file->Map(static_cast<size_t>(entry->offset), static_cast<size_t>(entry->size));
+	}
+	MappedFile file(path);
+	return file.Map(0, file.GetSize());
+}
+
+bool VirtualFileSystem::IsPacked(const Path& path) const
+{
+	sPack const* pack = nullptr;
+	return Find(path, &pack) != nullptr;
+}
+
+size_t VirtualFileSystem::CreatePack(const Path& folder, const Path& packPath)
+{
+	std::vector<Path> files = GetFiles(folder, make_path(L"*"), true);
+	std::ofstream oFile(packPath, std::ios::binary | std::ios::out);
+	if (!oFile)
+	{
+		throw std::runtime_error("Cannot create pack " + to_string(packPath));
+	}
+	sPackHeader header;
+	memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+	header.version = PACK_VERSION;
+	header.entriesCount = 0;
+	header.indexOffset = 0;
+	oFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	uint64_t offset = sizeof(header);
+	std::vector<sPackEntry> entries;
+	const std::string packName = NormalizePath(packPath);
+	for (auto& file : files)
+	{
+		Path fullPath = folder.empty() ? file : folder + make_path(L"/") + file;
+		std::string name = NormalizePath(file);
+		if (NormalizePath(fullPath) == packName || (name.size() > 4 && name.compare(name.size() - 4, 4, ".pak") == 0))
+			continue;
+		std::vector<char> data = ReadFile(fullPath);
+		uint64_t padding = (PACK_DATA_ALIGNMENT - offset % PACK_DATA_ALIGNMENT) % PACK_DATA_ALIGNMENT;
+		static const char zeroes[PACK_DATA_ALIGNMENT] = {};
+		oFile.write(zeroes, padding);
+		offset += padding;
+		oFile.write(data.data(), data.size());
+		entries.push_back({ offset, data.size(), name });
+		offset += data.size();
+	}
+	header.entriesCount = entries.size();
+	header.indexOffset = offset;
+	for (auto& entry : entries)
+	{
+		uint64_t hash = HashPath(entry.name);
+		uint32_t nameSize = static_cast<uint32_t>(entry.name.size());
+		oFile.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+		oFile.write(reinterpret_cast<const char*>(&entry.offset), sizeof(entry.offset));
+		oFile.write(reinterpret_cast<const char*>(&entry.size), sizeof(entry.size));
+		oFile.write(reinterpret_cast<const char*>(&nameSize), sizeof(nameSize));
+		oFile.write(entry.name.data(), nameSize);
+	}
+	oFile.seekp(0);
+	oFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	return entries.size();
+}
+}
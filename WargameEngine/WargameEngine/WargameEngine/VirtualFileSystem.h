@@ -0,0 +1,83 @@
+#pragma once
+#include "Typedefs.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace wargameEngine
+{
+//Private copy-on-write view of file contents. Modifications are never written back to the file
+class FileView
+{
+public:
+	FileView() = default;
+	FileView(FileView&& other);
+	FileView& operator=(FileView&& other);
+	FileView(FileView const& other) = delete;
+	FileView& operator=(FileView const& other) = delete;
+	~FileView();
+
+	char* data() const { return m_data; }
+	size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+
+private:
+	friend class MappedFile;
+	void Reset();
+
+	char* m_data = nullptr;
+	size_t m_size = 0;
+	void* m_mapping = nullptr;
+	size_t m_mappingSize = 0;
+};
+
+//File opened for memory mapping. Stays open until destroyed, so any region can be mapped without reopening it
+class MappedFile
+{
+public:
+	MappedFile(const Path& path);
+	~MappedFile();
+
+	bool IsOpen() const;
+	size_t GetSize() const;
+	FileView Map(size_t offset, size_t size) const;
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> m_pImpl;
+};
+
+//Resolves module files from read-only pack archives first and falls back to loose files on disk, so packed modules can still be modded
+class VirtualFileSystem
+{
+public:
+	//Mounts pack archive. Packed file names are relative to rootDir. Should not be called while reads are in progress
+	bool Mount(const Path& packPath, const Path& rootDir);
+	void UnmountAll();
+	FileView Open(const Path& path) const;
+	bool IsPacked(const Path& path) const;
+
+	//Packs all files from folder (recursively) into pack archive
+	static size_t CreatePack(const Path& folder, const Path& packPath);
+	static uint64_t HashPath(std::string const& normalizedPath);
+	static std::string NormalizePath(const Path& path);
+
+private:
+	struct sPackEntry
+	{
+		uint64_t offset;
+		uint64_t size;
+		std::string name;
+	};
+	struct sPack
+	{
+		std::unique_ptr<MappedFile> file;
+		std::string root;
+		std::unordered_multimap<uint64_t, sPackEntry> index;
+	};
+	sPackEntry const* Find(const Path& path, sPack const** pack) const;
+
+	std::vector<sPack> m_packs;
+};
+}
@@ -16,7 +16,7 @@ m_oldValue(m_pObject->GetProperty(key)), m_newValue(value)
 
 CCommandChangeProperty::CCommandChangeProperty(IReadMemoryStream & stream, model::IModel& model)
 {
-	m_pObject = model.Get3DObject(reinterpret_cast<model::IObject*>(stream.ReadPointer()));
+	m_pObject = model.GetObjectByHandle(stream.ReadUnsigned());
 	m_key = stream.ReadWString();
 	m_newValue = stream.ReadWString();
 	m_oldValue = stream.ReadWString();
@@ -35,7 +35,7 @@ void CCommandChangeProperty::Rollback()
 void CCommandChangeProperty::Serialize(IWriteMemoryStream & stream) const
 {
 	stream.WriteByte(4);//This is a CCommandChangeProperty action
-	stream.WritePointer(m_pObject.get());
+	stream.WriteUnsigned(m_pObject->GetHandle());
 	stream.WriteWString(m_key);
 	stream.WriteWString(m_newValue);
 	stream.WriteWString(m_oldValue);
@@ -18,7 +18,7 @@ CCommandCreateObject::CCommandCreateObject(std::shared_ptr<model::IObject> const
 CCommandCreateObject::CCommandCreateObject(IReadMemoryStream & stream, model::IModel& model)
 	: m_model(model)
 {
-	stream.ReadPointer();//skip pointer
+	stream.ReadUnsigned();//skip handle
 	float x = stream.ReadFloat();
 	float y = stream.ReadFloat();
 	float z = stream.ReadFloat();
@@ -41,7 +41,7 @@ void CCommandCreateObject::Rollback()
 void CCommandCreateObject::Serialize(IWriteMemoryStream & stream) const
 {
 	stream.WriteByte(0);//This is a CCommandCreateObject action
-	stream.WritePointer(m_pObject.get());
+	stream.WriteUnsigned(m_pObject->GetHandle());
 	stream.WriteFloat(m_pObject->GetX());
 	stream.WriteFloat(m_pObject->GetY());
 	stream.WriteFloat(m_pObject->GetZ());
@@ -1,5 +1,6 @@
 #include "CommandDeleteObject.h"
 #include "../model/IModel.h"
+#include "../model/IObject.h"
 #include "../IMemoryStream.h"
 
 namespace wargameEngine
@@ -15,7 +16,7 @@ CCommandDeleteObject::CCommandDeleteObject(std::shared_ptr<model::IObject> objec
 CCommandDeleteObject::CCommandDeleteObject(IReadMemoryStream & stream, model::IModel& model)
 	: m_model(model)
 {
-	m_pObject = m_model.Get3DObject(reinterpret_cast<model::IBaseObject*>(stream.ReadPointer()));
+	m_pObject = m_model.GetObjectByHandle(stream.ReadUnsigned());
 }
 
 void CCommandDeleteObject::Execute()
@@ -31,7 +32,7 @@ void CCommandDeleteObject::Rollback()
 void CCommandDeleteObject::Serialize(IWriteMemoryStream & stream) const
 {
 	stream.WriteByte(1);//This is a CCommandDeleteObject action
-	stream.WritePointer(m_pObject.get());
+	stream.WriteUnsigned(m_pObject->GetHandle());
 }
 
 }
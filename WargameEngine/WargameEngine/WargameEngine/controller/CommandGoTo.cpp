@@ -18,8 +18,7 @@ CCommandGoTo::CCommandGoTo(std::shared_ptr<ObjectDecorator> object, CVector3f co
 
 CCommandGoTo::CCommandGoTo(IReadMemoryStream & stream, model::IModel & model, Controller& controller)
 {
-	auto objectPtr = reinterpret_cast<model::IObject*>(stream.ReadPointer());
-	m_object = controller.GetDecorator(model.Get3DObject(objectPtr));
+	m_object = controller.GetDecorator(model.GetObjectByHandle(stream.ReadUnsigned()));
 	float x = stream.ReadFloat();
 	float y = stream.ReadFloat();
 	m_target = { x, y, 0.0f };
@@ -41,7 +40,7 @@ void CCommandGoTo::Rollback()
 void CCommandGoTo::Serialize(IWriteMemoryStream & stream) const
 {
 	stream.WriteByte(7);//its a goto command
-	stream.WritePointer(m_object.get());
+	stream.WriteUnsigned(m_object->GetObject()->GetHandle());
 	stream.WriteFloat(m_target.x);
 	stream.WriteFloat(m_target.y);
 	stream.WriteFloat(m_speed);
@@ -14,7 +14,7 @@ CCommandMoveObject::CCommandMoveObject(std::shared_ptr<model::IObject> object, f
 
 CCommandMoveObject::CCommandMoveObject(IReadMemoryStream & stream, model::IModel& model)
 {
-	m_pObject = model.Get3DObject(reinterpret_cast<model::IObject*>(stream.ReadPointer()));
+	m_pObject = model.GetObjectByHandle(stream.ReadUnsigned());
 	m_deltaX = stream.ReadFloat();
 	m_deltaY = stream.ReadFloat();
 }
@@ -32,7 +32,7 @@ void CCommandMoveObject::Rollback()
 void CCommandMoveObject::Serialize(IWriteMemoryStream & stream) const
 {
 	stream.WriteByte(2);//This is a CCommandMoveObject action
-	stream.WritePointer(m_pObject.get());
+	stream.WriteUnsigned(m_pObject->GetHandle());
 	stream.WriteFloat(m_deltaX);
 	stream.WriteFloat(m_deltaY);
 }
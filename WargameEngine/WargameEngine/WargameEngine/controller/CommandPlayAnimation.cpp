@@ -16,7 +16,7 @@ CCommandPlayAnimation::CCommandPlayAnimation(std::shared_ptr<model::IObject> obj
 
 CCommandPlayAnimation::CCommandPlayAnimation(IReadMemoryStream & stream, model::IModel &model)
 {
-	m_object = model.Get3DObject(reinterpret_cast<model::IObject*>(stream.ReadPointer()));
+	m_object = model.GetObjectByHandle(stream.ReadUnsigned());
 	m_loopMode = static_cast<model::AnimationLoop>(stream.ReadByte());
 	m_speed = stream.ReadFloat();
 	m_animation = stream.ReadString();
@@ -34,7 +34,7 @@ void CCommandPlayAnimation::Rollback()
 void CCommandPlayAnimation::Serialize(IWriteMemoryStream & stream) const
 {
 	stream.WriteByte(6);//its a play animation
-	stream.WritePointer(m_object.get());
+	stream.WriteUnsigned(m_object->GetHandle());
 	stream.WriteByte(static_cast<unsigned char>(m_loopMode));
 	stream.WriteFloat(m_speed);
 	stream.WriteString(m_animation);
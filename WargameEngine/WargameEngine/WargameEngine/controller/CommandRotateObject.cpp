@@ -14,7 +14,7 @@ CCommandRotateObject::CCommandRotateObject(std::shared_ptr<model::IObject> objec
 
 CCommandRotateObject::CCommandRotateObject(IReadMemoryStream & stream, model::IModel& model)
 {
-	m_pObject = model.Get3DObject(reinterpret_cast<model::IObject*>(stream.ReadPointer()));
+	m_pObject = model.GetObjectByHandle(stream.ReadUnsigned());
 	m_deltaRotation = stream.ReadFloat();
 }
 
@@ -31,7 +31,7 @@ void CCommandRotateObject::Rollback()
 void CCommandRotateObject::Serialize(IWriteMemoryStream & stream) const
 {
 	stream.WriteByte(3);//This is a CCommandRotateObject action
-	stream.WritePointer(m_pObject.get());
+	stream.WriteUnsigned(m_pObject->GetHandle());
 	stream.WriteFloat(m_deltaRotation);
 }
 
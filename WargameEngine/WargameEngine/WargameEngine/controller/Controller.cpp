@@ -2,16 +2,19 @@
 #define _USE_MATH_DEFINES
 #include "../LogWriter.h"
 #include "../MemoryStream.h"
+#include "../Profiler.h"
 #include "../Utils.h"
 #include "../model/Object.h"
 #include "../model/ObjectGroup.h"
 #include "../view/IInput.h"
 #include "../view/View.h"
 #include "MovementLimiter.h"
+#include "SaveGame.h"
 #include "ScriptRegisterFunctions.h"
+#include <algorithm>
 #include <float.h>
 #include <math.h>
-#pragma warning(push)
+#pragma warning(push)
 #pragma warning(disable: 4201)
 #include <glm\gtx\quaternion.hpp>
 #include <glm\gtx\spline.hpp>
@@ -21,12 +24,20 @@ namespace wargameEngine
 {
 namespace controller
 {
-Controller::Controller(model::Model& model, IScriptHandler& scriptHandler, IPhysicsEngine& physicsEngine, IPathfinding& pathFinder, model::IBoundingBoxManager& boundingManager)
+namespace
+{
+//State streams start with this marker and a version. Streams without it start with object count and do not store handles
+const unsigned STATE_MARKER = 0xFFFFFFFF;
+const unsigned STATE_VERSION = 1;
+}
+
+Controller::Controller(model::Model& model, IScriptHandler& scriptHandler, IPhysicsEngine& physicsEngine, IPathfinding& pathFinder, model::IBoundingBoxManager& boundingManager, ThreadPool& threadPool)
 	: m_model(model)
 	, m_physicsEngine(physicsEngine)
 	, m_boundingManager(boundingManager)
 	, m_scriptHandler(scriptHandler)
 	, m_pathFinder(pathFinder)
+	, m_threadPool(threadPool)
 {
 	m_model.DoOnObjectCreation(std::bind(&IPhysicsEngine::AddDynamicObject, &m_physicsEngine, std::placeholders::_1, 0.0));
 	m_model.DoOnObjectRemove(std::bind(&IPhysicsEngine::RemoveObject, &m_physicsEngine, std::placeholders::_1));
@@ -35,6 +46,7 @@ Controller::Controller(model::Model& model, IScriptHandler& scriptHandler, IPhys
 
 Controller::~Controller()
 {
+	WaitForSave();
 	m_destroyThread = true;
 	if (m_controllerThread.get_id() != std::thread::id())
 	{
@@ -56,10 +68,10 @@ void Controller::Init(view::View& view, std::function<std::unique_ptr<INetSocket
 	m_scriptHandler.Reset();
 	RegisterModelFunctions(m_scriptHandler, m_model);
 	RegisterViewFunctions(m_scriptHandler, view, asyncFileProvider);
-	RegisterControllerFunctions(m_scriptHandler, *this, asyncFileProvider, view.GetThreadPool());
+	RegisterControllerFunctions(m_scriptHandler, *this, m_model, asyncFileProvider, view.GetThreadPool());
 	RegisterUI(m_scriptHandler, view.GetUI(), view.GetTranslationManager());
 	RegisterObject(m_scriptHandler, *this, m_model, view.GetModelManager());
-	RegisterViewport(m_scriptHandler, view);
+	RegisterViewport(m_scriptHandler, view, m_model);
 	{
 		auto lock = m_model.LockModel();
 		m_scriptHandler.RunScript(scriptPath);
@@ -71,6 +83,7 @@ void Controller::Init(view::View& view, std::function<std::unique_ptr<INetSocket
 void Controller::InitAsync(view::View& view, std::function<std::unique_ptr<INetSocket>()> const& socketFactory, const Path& scriptPath, AsyncFileProvider& asyncFileProvider)
 {
 	m_controllerThread = std::thread([this, &view, socketFactory, scriptPath, &asyncFileProvider] {
+		Profiler::SetThreadName("Controller");
 		Init(view, socketFactory, scriptPath, asyncFileProvider);
 		auto lastUpdateTime = std::chrono::high_resolution_clock::now();
 		while (!m_destroyThread)
@@ -83,7 +96,9 @@ void Controller::InitAsync(view::View& view, std::function<std::unique_ptr<INetS
 
 void Controller::Update()
 {
+	Profiler::Zone zone("Controller::Update");
 	{
+		Profiler::Zone tasksZone("Controller tasks");
 		std::unique_lock<std::mutex> lk(m_taskMutex);
 		while (!m_tasks.empty())
 		{
@@ -94,25 +109,44 @@ void Controller::Update()
 			lk.lock();
 		}
 	}
-	m_network->Update();
-	if (m_updateCallback)
-		m_updateCallback();
-	if (m_singleCallback)
 	{
-		m_singleCallback();
-		m_singleCallback = std::function<void()>();
+		Profiler::Zone networkZone("Network");
+		m_network->Update();
+	}
+	{
+		Profiler::Zone callbacksZone("Update callbacks");
+		if (m_updateCallback)
+			m_updateCallback();
+		if (m_singleCallback)
+		{
+			m_singleCallback();
+			m_singleCallback = std::function<void()>();
+		}
 	}
 	auto currentTime = std::chrono::high_resolution_clock::now();
 	auto delta = std::chrono::duration_cast<std::chrono::microseconds>(currentTime - m_lastUpdateTime);
 	m_lastUpdateTime = currentTime;
-	for (auto& decorator : m_objectDecorators)
+	if (m_fixedTimeStep.count() > 0)
 	{
-		decorator.second->Update(delta);
+		delta = m_fixedTimeStep;
 	}
-	m_model.Update(delta);
+	{
+		Profiler::Zone modelZone("Model");
+		for (auto& decorator : m_objectDecorators)
+		{
+			decorator.second->Update(delta);
+		}
+		m_model.Update(delta);
+	}
+	Profiler::Zone physicsZone("Physics");
 	m_physicsEngine.Update(delta);
 }
 
+void Controller::SetFixedTimeStep(std::chrono::microseconds timeStep)
+{
+	m_fixedTimeStep = timeStep;
+}
+
 CVector3f Controller::RayToPoint(CVector3f const& begin, CVector3f const& end, float z)
 {
 	CVector3f result;
@@ -344,48 +378,52 @@ void Controller::SelectObject(const float* begin, const float* end, bool add, bo
 		m_selectionCallback();
 }
 
-size_t Controller::BBoxlos(CVector3f const& origin, model::Bounding* target, model::IObject* shooter, model::IObject* targetObject)
+size_t Controller::BBoxlos(CVector3f const& origin, model::Bounding* target, model::IObject* shooter, model::IObject* targetObject, size_t threshold)
 {
-	size_t result = 0;
-	size_t total = 0;
 	if (target->type == model::Bounding::eType::Compound)
 	{
 		model::Bounding::Compound compound = target->GetCompound();
-		for (size_t i = 0; i < compound.items.size(); ++i)
+		const size_t items = compound.items.size();
+		if (items == 0)
+			return 0;
+		size_t result = 0;
+		for (size_t i = 0; i < items && result < threshold * items; ++i)
 		{
-			result += BBoxlos(origin, &compound.items[i], shooter, targetObject);
+			//Item can stop as soon as threshold is reached even if all the rest items are hidden
+			result += BBoxlos(origin, &compound.items[i], shooter, targetObject, std::min<size_t>(threshold * items - result, 100));
 		}
-		result /= compound.items.size();
-		total = 100;
+		return result / items;
 	}
-	else
+	model::Bounding::Box const& tarBox = target->GetBox();
+	std::vector<IPhysicsEngine::Ray> rays;
+	CVector3f dir;
+	for (dir.x = tarBox.min[0] + targetObject->GetX(); dir.x < tarBox.max[0] + targetObject->GetX(); dir.x += (tarBox.max[0] - tarBox.min[0]) / 10.0f + 0.0001f)
 	{
-		model::Bounding::Box const& tarBox = target->GetBox();
-		CVector3f dir;
-		for (dir.x = tarBox.min[0] + targetObject->GetX(); dir.x < tarBox.max[0] + targetObject->GetX(); dir.x += (tarBox.max[0] - tarBox.min[0]) / 10.0f + 0.0001f)
+		for (dir.y = tarBox.min[1] + targetObject->GetY(); dir.y < tarBox.max[1] + targetObject->GetY(); dir.y += (tarBox.max[1] - tarBox.min[1]) / 10.0f + 0.0001f)
 		{
-			for (dir.y = tarBox.min[1] + targetObject->GetY(); dir.y < tarBox.max[1] + targetObject->GetY(); dir.y += (tarBox.max[1] - tarBox.min[1]) / 10.0f + 0.0001f)
+			for (dir.z = tarBox.min[2] + targetObject->GetZ(); dir.z < tarBox.max[2] + targetObject->GetZ(); dir.z += (tarBox.max[2] - tarBox.min[2]) / 10.0f + 0.0001f)
 			{
-				for (dir.z = tarBox.min[2] + targetObject->GetZ(); dir.z < tarBox.max[2] + targetObject->GetZ(); dir.z += (tarBox.max[2] - tarBox.min[2]) / 10.0f + 0.0001f)
-				{
-					total++;
-					if (!m_physicsEngine.CastRay(origin, dir, { shooter, targetObject }).success)
-						result++;
-				}
+				rays.push_back({ origin, dir });
 			}
 		}
 	}
+	if (rays.empty())
+		return 0;
+	const size_t total = rays.size();
+	//Smallest number of free rays that gives threshold percentage
+	const size_t neededFreeRays = (threshold * total + 99) / 100;
+	const size_t result = m_physicsEngine.CastRays(rays, { shooter, targetObject }, m_threadPool, neededFreeRays);
 	return result * 100 / total;
 }
 
-size_t Controller::GetLineOfSight(model::IObject* shooter, model::IObject* target)
+size_t Controller::GetLineOfSight(model::IObject* shooter, model::IObject* target, size_t threshold)
 {
 	if (!shooter || !target)
 		return 0;
 	model::Bounding targetBound = m_boundingManager.GetBounding(target->GetPathToModel());
 	CVector3f center = shooter->GetCoords();
 	center.z += 2.0f;
-	return BBoxlos(center, &targetBound, shooter, target);
+	return BBoxlos(center, &targetBound, shooter, target, std::min<size_t>(threshold, 100));
 }
 
 void Controller::SetSelectionCallback(std::function<void()> const& onSelect)
@@ -403,8 +441,10 @@ void Controller::PackProperties(std::unordered_map<std::wstring, std::wstring> c
 	}
 }
 
-void Controller::SerializeState(IWriteMemoryStream& stream, bool hasAdresses /*= false*/) const
+void Controller::SerializeState(IWriteMemoryStream& stream) const
 {
+	stream.WriteUnsigned(STATE_MARKER);
+	stream.WriteUnsigned(STATE_VERSION);
 	size_t count = m_model.GetObjectCount();
 	stream.WriteSizeT(count);
 	for (size_t i = 0; i < count; ++i)
@@ -415,64 +455,130 @@ void Controller::SerializeState(IWriteMemoryStream& stream, bool hasAdresses /*=
 		stream.WriteFloat(object->GetZ());
 		stream.WriteFloat(object->GetRotation());
 		stream.WriteString(to_string(object->GetPathToModel()));
-		if (hasAdresses)
-		{
-			stream.WritePointer(object);
-		}
+		stream.WriteUnsigned(object->GetHandle());
 		PackProperties(object->GetAllProperties(), stream);
 	}
 	PackProperties(m_model.GetAllProperties(), stream);
 }
 
-void Controller::LoadState(IReadMemoryStream& stream, bool hasAdresses)
+void Controller::LoadState(IReadMemoryStream& stream, bool remoteHandles)
 {
 	size_t count = stream.ReadSizeT();
-	m_model.Clear();
-	for (size_t i = 0; i < count; ++i)
+	unsigned version = 0;
+	if (count == STATE_MARKER)
 	{
-		float x = stream.ReadFloat();
-		float y = stream.ReadFloat();
-		float z = stream.ReadFloat();
-		float rotation = stream.ReadFloat();
-		Path path = make_path(stream.ReadString());
-		std::shared_ptr<model::IObject> object = std::make_shared<model::Object>(path, CVector3f{ x, y, z }, rotation);
-		m_model.AddObject(object);
-		if (hasAdresses)
+		version = stream.ReadUnsigned();
+		if (version > STATE_VERSION)
 		{
-			m_network->AddAddress(object, stream.ReadPointer());
+			throw std::runtime_error("Unsupported state version " + std::to_string(version));
 		}
+		count = stream.ReadSizeT();
+	}
+	std::vector<sSavedObject> objects;
+	for (size_t i = 0; i < count; ++i)
+	{
+		sSavedObject saved;
+		saved.coords.x = stream.ReadFloat();
+		saved.coords.y = stream.ReadFloat();
+		saved.coords.z = stream.ReadFloat();
+		saved.rotation = stream.ReadFloat();
+		saved.model = stream.ReadString();
+		//Zero handle makes model assign handles sequentially, as it did for states without handles
+		saved.handle = version >= 1 ? stream.ReadUnsigned() : 0;
 		size_t propertiesCount = stream.ReadSizeT();
 		for (size_t j = 0; j < propertiesCount; ++j)
 		{
 			std::wstring first = stream.ReadWString();
 			std::wstring second = stream.ReadWString();
-			object->SetProperty(first, second);
+			saved.properties.emplace_back(std::move(first), std::move(second));
 		}
+		objects.push_back(std::move(saved));
 	}
+	std::vector<std::pair<std::wstring, std::wstring>> properties;
 	size_t globalPropertiesCount = stream.ReadSizeT();
 	for (size_t i = 0; i < globalPropertiesCount; ++i)
 	{
 		std::wstring first = stream.ReadWString();
 		std::wstring second = stream.ReadWString();
-		m_model.SetProperty(first, second);
+		properties.emplace_back(std::move(first), std::move(second));
+	}
+	ApplyState(objects, properties, remoteHandles);
+}
+
+void Controller::ApplyState(std::vector<sSavedObject> const& objects, std::vector<std::pair<std::wstring, std::wstring>> const& properties, bool remoteHandles)
+{
+	m_model.Clear();
+	AddSavedObjects(objects, remoteHandles);
+	for (auto& property : properties)
+	{
+		m_model.SetProperty(property.first, property.second);
+	}
+}
+
+void Controller::AddSavedObjects(std::vector<sSavedObject> const& objects, bool remoteHandles)
+{
+	for (auto& saved : objects)
+	{
+		auto object = std::make_shared<model::Object>(make_path(saved.model), saved.coords, saved.rotation);
+		m_model.AddObject(object, saved.handle);
+		if (remoteHandles)
+		{
+			m_network->AddRemoteObject(object, saved.handle);
+		}
+		for (auto& property : saved.properties)
+		{
+			object->SetProperty(property.first, property.second);
+		}
 	}
 }
 
 void Controller::Save(const Path& filename)
 {
-	WriteMemoryStream stream;
-	SerializeState(stream);
-	WriteFile(filename, stream.GetData(), stream.GetSize());
+	WaitForSave();
+	auto snapshot = std::make_shared<sSaveSnapshot>(MakeSnapshot(m_model));
+	m_saveJob = m_threadPool.RunJob([snapshot, filename] {
+		WriteSaveGame(filename, *snapshot);
+	});
 }
 
 void Controller::Load(const Path& filename)
 {
-	std::vector<char> data = ReadFile(filename);
-	ReadMemoryStream stream(data.data());
-	LoadState(stream);
+	WaitForSave();
+	SaveGameReader reader(filename);
+	if (!reader.IsValid())
+	{
+		//Saves made before chunked format, with or without handles
+		std::vector<char> data = ReadFile(filename);
+		ReadMemoryStream stream(data.data(), data.size());
+		LoadState(stream);
+		m_network->CallStateRecievedCallback();
+		return;
+	}
+	//Corrupted save throws before model is cleared, then objects are added chunk by chunk, so only one chunk is mapped and parsed at a time
+	reader.Validate();
+	auto properties = reader.ReadProperties();
+	m_model.Clear();
+	std::vector<sSavedObject> chunk;
+	while (reader.ReadObjects(chunk))
+	{
+		AddSavedObjects(chunk, false);
+	}
+	for (auto& property : properties)
+	{
+		m_model.SetProperty(property.first, property.second);
+	}
 	m_network->CallStateRecievedCallback();
 }
 
+void Controller::WaitForSave()
+{
+	if (m_saveJob)
+	{
+		m_threadPool.WaitForJob(m_saveJob);
+		m_saveJob.reset();
+	}
+}
+
 void Controller::TryMoveSelectedObject(std::shared_ptr<model::IObject> const& object, CVector3f const& pos)
 {
 	if (!object)
@@ -569,7 +675,6 @@ std::shared_ptr<model::IObject> Controller::CreateObject(const Path& model, floa
 {
 	std::shared_ptr<model::IObject> object = std::make_shared<model::Object>(model, CVector3f{ x, y, 0.0f }, rotation);
 	m_commandHandler.AddNewCreateObject(object, m_model);
-	m_network->AddAddressLocal(object);
 	return object;
 }
 
@@ -2,6 +2,7 @@
 #include "../IPhysicsEngine.h"
 #include "../IScriptHandler.h"
 #include "../Signal.h"
+#include "../ThreadPool.h"
 #include "../model/IBoundingBoxManager.h"
 #include "../model/Model.h"
 #include "../view/Vector3.h"
@@ -21,6 +22,7 @@ namespace wargameEngine
 {
 class IPathfinding;
 class AsyncFileProvider;
+class ThreadPool;
 
 namespace view
 {
@@ -30,6 +32,7 @@ class View;
 namespace controller
 {
 class IMoveLimiter;
+struct sSavedObject;
 
 struct MovePathNode
 {
@@ -65,14 +68,16 @@ class Controller : public IStateManager
 public:
 	typedef std::function<bool(std::shared_ptr<model::IObject> const& obj, std::wstring const& type, double x, double y, double z)> MouseButtonCallback;
 
-	Controller(model::Model& model, IScriptHandler& scriptHandler, IPhysicsEngine& physicsEngine, IPathfinding& pathFinder, model::IBoundingBoxManager& boundingManager);
+	Controller(model::Model& model, IScriptHandler& scriptHandler, IPhysicsEngine& physicsEngine, IPathfinding& pathFinder, model::IBoundingBoxManager& boundingManager, ThreadPool& threadPool);
 	~Controller();
 	void Init(view::View& view, std::function<std::unique_ptr<INetSocket>()> const& socketFactory, const Path& scriptPath, AsyncFileProvider& asyncFileProvider);
 	void InitAsync(view::View& view, std::function<std::unique_ptr<INetSocket>()> const& socketFactory, const Path& scriptPath, AsyncFileProvider& asyncFileProvider);
 	void Update();
+	//Every update advances the game by timeStep instead of elapsed time, so runs are reproducible. Zero restores real time
+	void SetFixedTimeStep(std::chrono::microseconds timeStep);
 
-	virtual void SerializeState(IWriteMemoryStream& stream, bool hasAdresses = false) const override;
-	virtual void LoadState(IReadMemoryStream& stream, bool hasAdresses = false) override;
+	virtual void SerializeState(IWriteMemoryStream& stream) const override;
+	virtual void LoadState(IReadMemoryStream& stream, bool remoteHandles = false) override;
 
 	bool OnLeftMouseDown(CVector3f const& begin, CVector3f const& end, int modifiers);
 	bool OnLeftMouseUp(CVector3f const& begin, CVector3f const& end, int modifiers);
@@ -81,7 +86,8 @@ public:
 	bool OnMouseMove(CVector3f const& begin, CVector3f const& end, int modifiers);
 	bool OnGamepadButtonStateChange(int gamepadIndex, int buttonIndex, bool newState);
 	bool OnGamepadAxisChange(int gamepadIndex, int axisIndex, double horizontal, double vertical);
-	size_t GetLineOfSight(model::IObject* shooter, model::IObject* target);
+	//Returns percentage of target visible from shooter. Casting stops once threshold is reached, so results not less than threshold are inexact
+	size_t GetLineOfSight(model::IObject* shooter, model::IObject* target, size_t threshold = 100);
 	void SetSelectionCallback(std::function<void()> const& onSelect);
 	void SetUpdateCallback(std::function<void()> const& onUpdate);
 	void SetSingleCallback(std::function<void()> const& onSingleUpdate);
@@ -89,6 +95,7 @@ public:
 	void SetRMBCallback(MouseButtonCallback const& callback);
 	void SetGamepadButtonCallback(std::function<bool(int gamepadIndex, int buttonIndex, bool newState)> const& handler);
 	void SetGamepadAxisCallback(std::function<bool(int gamepadIndex, int axisIndex, double horizontal, double vertical)> const& handler);
+	//State is serialized at once and written to file on a worker thread
 	void Save(const Path& filename);
 	void Load(const Path& filename);
 	void BindKey(unsigned char key, bool shift, bool ctrl, bool alt, std::function<void()> const& func);
@@ -127,8 +134,12 @@ private:
 	void TryMoveSelectedObject(std::shared_ptr<model::IObject> const& object, CVector3f const& pos);
 	void MoveObject(std::shared_ptr<model::IObject> const& obj, float deltaX, float deltaY);
 	void RotateObject(std::shared_ptr<model::IObject> const& obj, float deltaRot);
-	size_t BBoxlos(CVector3f const& origin, model::Bounding* target, model::IObject* shooter, model::IObject* targetObject);
+	size_t BBoxlos(CVector3f const& origin, model::Bounding* target, model::IObject* shooter, model::IObject* targetObject, size_t threshold);
 	CVector3f RayToPoint(CVector3f const& begin, CVector3f const& end, float z = 0);
+	void WaitForSave();
+	//Replaces model contents. Called only after the whole state is parsed, so corrupted state never leaves model half loaded
+	void ApplyState(std::vector<sSavedObject> const& objects, std::vector<std::pair<std::wstring, std::wstring>> const& properties, bool remoteHandles);
+	void AddSavedObjects(std::vector<sSavedObject> const& objects, bool remoteHandles);
 	static void PackProperties(std::unordered_map<std::wstring, std::wstring> const& properties, IWriteMemoryStream& stream);
 
 	model::Model& m_model;
@@ -136,6 +147,8 @@ private:
 	model::IBoundingBoxManager& m_boundingManager;
 	IScriptHandler& m_scriptHandler;
 	IPathfinding& m_pathFinder;
+	ThreadPool& m_threadPool;
+	ThreadPool::JobHandle m_saveJob;
 
 	CommandHandler m_commandHandler;
 	std::unique_ptr<Network> m_network;
@@ -146,6 +159,7 @@ private:
 	float m_selectedObjectPrevRotation = 0;
 	std::unique_ptr<CVector3f> m_rotationPosBegin;
 	std::chrono::high_resolution_clock::time_point m_lastUpdateTime;
+	std::chrono::microseconds m_fixedTimeStep = std::chrono::microseconds::zero();
 	std::map<sKeyBind, std::function<void()>> m_keyBindings;
 	std::function<void()> m_selectionCallback;
 	std::function<void()> m_updateCallback;
@@ -13,8 +13,10 @@ class IStateManager
 public:
 	virtual ~IStateManager() {};
 
-	virtual void SerializeState(IWriteMemoryStream & stream, bool hasAdresses = false) const = 0;
-	virtual void LoadState(IReadMemoryStream & stream, bool hasAdresses = false) = 0;
+	//State keeps object handles, so objects get the same handles when it is loaded
+	virtual void SerializeState(IWriteMemoryStream & stream) const = 0;
+	//Remote handles are the ones of network host. They are registered in network, so commands can refer to objects by them
+	virtual void LoadState(IReadMemoryStream & stream, bool remoteHandles = false) = 0;
 };
 }
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "Network.h"
 #include <string.h>
+#include <algorithm>
+#include "../Compression.h"
 #include "../LogWriter.h"
+#include "../RingBuffer.h"
 #include "../model/Model.h"
 #include "../model/Object.h"
 #include "CommandHandler.h"
@@ -12,15 +15,41 @@ namespace wargameEngine
 {
 namespace controller
 {
-Network::Network(IStateManager & stateManager, CommandHandler & commandHandler, model::IModel & model, SocketFactory const& socketFactory)
+namespace
+{
+enum eMessageType : unsigned char
+{
+	MESSAGE_STRING = 0,
+	MESSAGE_STATE = 1,
+	MESSAGE_COMMAND = 2,
+	MESSAGE_DELTA = 3,
+	MESSAGE_ACK = 4,
+	MESSAGE_COMPRESSED = 5,
+	MESSAGE_HELLO = 6,
+	//Command that references an object by handle of the client that created it, because host handle is not received yet
+	MESSAGE_OWN_COMMAND = 7,
+};
+//Every message starts with type byte and uint32 size of the whole message
+const size_t HEADER_SIZE = 5;
+const size_t COMPRESSION_THRESHOLD = 512;
+const size_t MAX_MESSAGE_SIZE = 64 * 1024 * 1024;
+
+//Commands that start with an object handle
+bool HasHandle(char command)
+{
+	return command == 1 || command == 2 || command == 3 || command == 4 || command == 6 || command == 7;
+}
+}
+
+Network::Network(IStateManager & stateManager, CommandHandler & commandHandler, model::Model & model, SocketFactory const& socketFactory)
 	: m_socketFactory(socketFactory)
 	, m_host(true)
-	, m_netRecievedSize(0)
-	, m_netTotalSize(0)
 	, m_stateManager(stateManager)
 	, m_commandHandler(commandHandler)
 	, m_model(model)
+	, m_replicator(model)
 {
+	m_removeConnection = m_model.DoOnObjectRemove(std::bind(&Network::OnObjectRemoved, this, std::placeholders::_1));
 }
 
 void Network::Host(unsigned short port)
@@ -31,12 +60,16 @@ void Network::Host(unsigned short port)
 		return;
 	}
 	m_socket = m_socketFactory();
-	m_socket->InitHost(port);
+	m_socket->SetHandlers(std::bind(&Network::OnConnect, this, std::placeholders::_1), std::bind(&Network::OnData, this, std::placeholders::_1, std::placeholders::_2),
+		std::bind(&Network::OnDisconnect, this, std::placeholders::_1));
 	m_host = true;
-	SendState();
+	if (!m_socket->InitHost(port))
+	{
+		m_socket.reset();
+	}
 }
 
-void Network::Client(const char * ip, unsigned short port)
+void Network::Client(const char * ip, unsigned short port, bool spectator)
 {
 	if (m_socket)
 	{
@@ -44,125 +77,339 @@ void Network::Client(const char * ip, unsigned short port)
 		return;
 	}
 	m_socket = m_socketFactory();
-	m_socket->InitClient(ip, port);
+	m_socket->SetHandlers(std::bind(&Network::OnConnect, this, std::placeholders::_1), std::bind(&Network::OnData, this, std::placeholders::_1, std::placeholders::_2),
+		std::bind(&Network::OnDisconnect, this, std::placeholders::_1));
 	m_host = false;
+	m_spectator = spectator;
+	if (!m_socket->InitClient(ip, port))
+	{
+		Stop();
+	}
 }
 
 void Network::Stop()
 {
+	if (m_updating)
+	{
+		//Socket cannot be destroyed while it calls handlers
+		m_stopRequested = true;
+		return;
+	}
 	m_socket.reset();
 	m_host = true;
-	m_netData.clear();
-	m_netRecievedSize = 0;
-	m_netTotalSize = 0;
+	m_spectator = false;
+	m_stopRequested = false;
+	m_peers.clear();
 }
 
 void Network::Update()
 {
 	if (!m_socket) return;
-	int result;
-	if (!m_netData.empty())
+	m_updating = true;
+	m_socket->Poll();
+	m_updating = false;
+	if (m_stopRequested || (!m_host && m_socket->GetConnectionsCount() == 0))
 	{
-		result = m_socket->RecieveData(m_netData.data() + m_netRecievedSize, m_netTotalSize - m_netRecievedSize);
-		m_netRecievedSize += result;
+		Stop();
+		return;
+	}
+	if (m_host)
+	{
+		SendDeltas();
+	}
+}
+
+void Network::OnConnect(ConnectionId connection)
+{
+	m_peers[connection] = sPeer();
+	if (m_host)
+	{
+		//Peer may join a game in progress, so it starts with full state
+		SendState(connection);
 	}
 	else
 	{
-		char data[128];
-		result = m_socket->RecieveData(data, 128);
-		if (result > 0)
+		WriteMemoryStream hello;
+		hello.WriteByte(MESSAGE_HELLO);
+		hello.WriteSizeT(0);
+		hello.WriteBool(m_spectator);
+		Send(hello, connection);
+	}
+}
+
+void Network::OnData(ConnectionId connection, RingBuffer& received)
+{
+	while (received.GetSize() >= HEADER_SIZE && !m_stopRequested)
+	{
+		char header[HEADER_SIZE];
+		received.Peek(header, HEADER_SIZE);
+		uint32_t size;
+		memcpy(&size, header + 1, sizeof(uint32_t));
+		if (size < HEADER_SIZE || size > MAX_MESSAGE_SIZE)
+		{
+			LogWriter::WriteLine("Net error. Invalid data received.");
+			m_socket->Disconnect(connection);
+			OnDisconnect(connection);
+			return;
+		}
+		if (received.GetSize() < size)
+		{
+			//Rest of the message will be received right after its beginning
+			received.Reserve(size);
+			return;
+		}
+		try
 		{
-			m_netTotalSize = ReadMemoryStream(data + 1).ReadSizeT();
-			m_netData.resize(m_netTotalSize);
-			m_netRecievedSize = result;
-			memcpy(m_netData.data(), data, result);
+			ProcessMessage(received.GetContiguous(size), size, connection);
 		}
+		catch (std::exception const& e)
+		{
+			LogWriter::WriteLine(std::string("Net error. Invalid data received. ") + e.what());
+			m_socket->Disconnect(connection);
+			OnDisconnect(connection);
+			return;
+		}
+		if (m_peers.find(connection) == m_peers.end())
+			return;//disconnected while message was processed
+		received.Consume(size);
 	}
-	if (result == 0)
+}
+
+void Network::OnDisconnect(ConnectionId connection)
+{
+	if (m_peers.erase(connection))
 	{
-		m_socket.reset();
+		LogWriter::WriteLine("Net OK. Peer is disconnected.");
 	}
-	if (!m_netData.empty() && m_netRecievedSize >= m_netTotalSize && m_netRecievedSize > 4)
+}
+
+void Network::OnObjectRemoved(model::IObject* object)
+{
+	const model::ObjectHandle handle = object->GetHandle();
+	if (!m_host)
 	{
-		ReadMemoryStream stream(m_netData.data());
-		unsigned char type = stream.ReadByte();
-		if (type == 0) //string
+		RemoveRemoteObject(handle);
+		return;
+	}
+	for (auto& peer : m_peers)
+	{
+		auto it = peer.second.ownHandles.find(handle);
+		if (it != peer.second.ownHandles.end())
 		{
-			auto message = stream.ReadWString();
-			if (m_stringRecievedCallback)
-			{
-				m_stringRecievedCallback(message);
-			}
-			LogWriter::WriteLine(L"String received:" + message);
+			peer.second.objects.erase(it->second);
+			peer.second.ownHandles.erase(it);
 		}
-		else if (type == 1) //state
+	}
+}
+
+void Network::ProcessMessage(char* message, size_t size, ConnectionId connection)
+{
+	ReadMemoryStream stream(message, size);
+	unsigned char type = stream.ReadByte();
+	stream.ReadUnsigned();//skip size
+	const bool spectator = m_peers[connection].spectator;
+	if (type == MESSAGE_STRING)
+	{
+		auto text = stream.ReadWString();
+		if (m_stringRecievedCallback)
 		{
-			char state[30];
-			sprintf(state, "State Received. Size=%zu.", m_netRecievedSize);
-			LogWriter::WriteLine(state);
-			m_stateManager.LoadState(stream);
-			if (m_stateRecievedCallback) m_stateRecievedCallback();
+			m_stringRecievedCallback(text);
 		}
-		else if (type == 2) //command
+		LogWriter::WriteLine(L"String received:" + text);
+		if (m_host)
 		{
-			stream.ReadUnsigned();//skip size
-			char command = m_netData[5];//read without moving forward
-			switch (command)
-			{
-			case 1://DeleteObject, remove from translator
+			Relay(message, size, connection);
+		}
+	}
+	else if (type == MESSAGE_HELLO)
+	{
+		m_peers[connection].spectator = stream.ReadBool();
+		LogWriter::WriteLine(m_peers[connection].spectator ? "Net OK. Spectator joined." : "Net OK. Player joined.");
+	}
+	else if (type == MESSAGE_STATE)
+	{
+		if (m_host && spectator)
+		{
+			LogWriter::WriteLine("Net error. Spectator cannot change state.");
+			return;
+		}
+		LogWriter::WriteLine("State Received. Size=" + std::to_string(size) + ".");
+		m_translator.clear();
+		m_remoteHandles.clear();
+		m_stateManager.LoadState(stream, true);
+		m_replicator.ReadSnapshot(stream);
+		if (m_host)
+		{
+			//Host uses handles of the sender now, so peers need a fresh snapshot
+			m_translator.clear();
+			m_remoteHandles.clear();
+			for (auto& peer : m_peers)
 			{
-				uint64_t address;
-				memcpy(&address, m_netData.data() + 6, sizeof(uint64_t));
-				void * addressPtr = reinterpret_cast<void*>(address);
-				uint64_t translated = reinterpret_cast<uint64_t>(m_translator.at(addressPtr));
-				memcpy(m_netData.data() + 6, &translated, sizeof(uint64_t));
-				m_translator.erase(addressPtr);
-				LogWriter::WriteLine("DeleteObject received");
-			}break;
-			case 2://MoveObject
-			case 3://RotateObject
-			case 4://ChangeProperty
-			case 6://PlayAnimation
-			case 7://GoTo
-			{//replace address
-				uint64_t address;
-				memcpy(&address, m_netData.data() + 6, sizeof(uint64_t));
-				uint64_t translated = reinterpret_cast<uint64_t>(m_translator.at(reinterpret_cast<void*>(address)));
-				memcpy(m_netData.data() + 6, &translated, sizeof(uint64_t));
-				LogWriter::WriteLine("Action received");
-			}break;
-			case 0://CreateObject
-			case 5://ChangeGlobalProperty
-				break;
-			default:
+				peer.second.objects.clear();
+				peer.second.ownHandles.clear();
+			}
+			SendState();
+		}
+		if (m_stateRecievedCallback) m_stateRecievedCallback();
+	}
+	else if (type == MESSAGE_COMMAND || (type == MESSAGE_OWN_COMMAND && m_host))
+	{
+		if (m_host && spectator)
+		{
+			LogWriter::WriteLine("Net error. Spectator cannot send actions.");
+			return;
+		}
+		ProcessCommand(message, size, connection);
+	}
+	else if (type == MESSAGE_DELTA && !m_host)
+	{
+		uint32_t sequence = m_replicator.ReadDelta(stream, [this](model::ObjectHandle handle, model::ObjectHandle ownHandle) -> model::IObject* {
+			if (ownHandle != model::INVALID_OBJECT_HANDLE)
 			{
-				LogWriter::WriteLine("Net error. Unknown action.");
-			}break;
+				//Object created by this peer is known by host handle from now on
+				auto object = m_model.GetObjectByHandle(ownHandle);
+				if (object)
+				{
+					AddRemoteObject(object, handle);
+				}
+				return object.get();
 			}
-			m_commandHandler.ReadCommandFromStream(stream, m_model);
-			if (command == 0)//CreateObject, add to translator
+			auto it = m_translator.find(handle);
+			return it != m_translator.end() ? m_model.GetObjectByHandle(it->second).get() : nullptr;
+		}, [this](std::shared_ptr<model::IObject> const& object, model::ObjectHandle handle) {
+			AddRemoteObject(object, handle);
+		}, [this](model::IObject* object) {
+			RemoveRemoteObject(object->GetHandle());
+		});
+		WriteMemoryStream ack;
+		ack.WriteByte(MESSAGE_ACK);
+		ack.WriteSizeT(0);
+		ack.WriteUnsigned(sequence);
+		Send(ack, connection);
+	}
+	else if (type == MESSAGE_ACK && m_host)
+	{
+		sPeer& peer = m_peers[connection];
+		peer.baseline = std::max(peer.baseline, stream.ReadUnsigned());
+		uint32_t baseline = peer.baseline;
+		for (auto& pair : m_peers)
+		{
+			if (pair.second.synchronized)
 			{
-				uint64_t address;
-				memcpy(&address, m_netData.data() + 6, sizeof(uint64_t));
-				m_translator[reinterpret_cast<void*>(address)] = m_model.Get3DObject(m_model.GetObjectCount() - 1).get();
-				LogWriter::WriteLine("CreateObject received");
+				baseline = std::min(baseline, pair.second.baseline);
 			}
 		}
+		m_replicator.ForgetRemovedObjects(baseline);
+	}
+	else if (type == MESSAGE_COMPRESSED)
+	{
+		//Decompressed size is validated before allocation, and compressed messages are never nested
+		const size_t decompressedSize = size < HEADER_SIZE + sizeof(uint32_t) ? 0 : stream.ReadUnsigned();
+		if (decompressedSize < HEADER_SIZE || decompressedSize > MAX_MESSAGE_SIZE)
+		{
+			LogWriter::WriteLine("Net error. Corrupted compressed data received.");
+			return;
+		}
+		std::vector<char> decompressed(decompressedSize);
+		if (!DecompressLZ4(message + HEADER_SIZE + sizeof(uint32_t), size - HEADER_SIZE - sizeof(uint32_t), decompressed.data(), decompressed.size())
+			|| static_cast<unsigned char>(decompressed[0]) == MESSAGE_COMPRESSED)
+		{
+			LogWriter::WriteLine("Net error. Corrupted compressed data received.");
+			return;
+		}
+		ProcessMessage(decompressed.data(), decompressed.size(), connection);
+	}
+	else
+	{
+		LogWriter::WriteLine("Net error. Invalid data received.");
+	}
+}
+
+void Network::ProcessCommand(char* message, size_t size, ConnectionId connection)
+{
+	if (size < HEADER_SIZE + 1 + sizeof(model::ObjectHandle))
+	{
+		throw std::runtime_error("Command is too short");
+	}
+	const char command = message[HEADER_SIZE];//read without moving forward
+	if (HasHandle(command))
+	{
+		model::ObjectHandle handle;
+		memcpy(&handle, message + HEADER_SIZE + 1, sizeof(handle));
+		model::ObjectHandle translated = model::INVALID_OBJECT_HANDLE;
+		if (m_host)
+		{
+			translated = TranslatePeerHandle(m_peers[connection], handle, message[0] == MESSAGE_OWN_COMMAND);
+		}
 		else
 		{
-			LogWriter::WriteLine("Net error. Invalid data received.");
+			auto it = m_translator.find(handle);
+			if (it != m_translator.end()) translated = it->second;
+		}
+		if (translated == model::INVALID_OBJECT_HANDLE)
+		{
+			LogWriter::WriteLine("Net error. Action references unknown object.");
+			return;
+		}
+		memcpy(message + HEADER_SIZE + 1, &translated, sizeof(translated));
+		//Relayed command uses host handle
+		message[0] = MESSAGE_COMMAND;
+		LogWriter::WriteLine(command == 1 ? "DeleteObject received" : "Action received");
+	}
+	else if (command != 0 && command != 5)//CreateObject and ChangeGlobalProperty have no handles
+	{
+		LogWriter::WriteLine("Net error. Unknown action.");
+	}
+	ReadMemoryStream stream(message + HEADER_SIZE, size - HEADER_SIZE);
+	m_commandHandler.ReadCommandFromStream(stream, m_model);
+	if (command == 0)//CreateObject, remember sender handle
+	{
+		model::ObjectHandle handle;
+		memcpy(&handle, message + HEADER_SIZE + 1, sizeof(handle));
+		auto object = m_model.Get3DObject(m_model.GetObjectCount() - 1);
+		if (m_host)
+		{
+			sPeer& peer = m_peers[connection];
+			peer.objects[handle] = object->GetHandle();
+			peer.ownHandles[object->GetHandle()] = handle;
+		}
+		else
+		{
+			AddRemoteObject(object, handle);
 		}
-		m_netData.clear();
-		m_netTotalSize = 0;
-		m_netRecievedSize = 0;
+		LogWriter::WriteLine("CreateObject received");
+	}
+	else if (m_host)
+	{
+		//Other peers get created objects with deltas
+		Relay(message, size, connection);
 	}
 }
 
+model::ObjectHandle Network::TranslatePeerHandle(sPeer const& peer, model::ObjectHandle handle, bool ownHandle) const
+{
+	if (ownHandle)
+	{
+		auto it = peer.objects.find(handle);
+		return it != peer.objects.end() ? it->second : model::INVALID_OBJECT_HANDLE;
+	}
+	//Peer knows all other objects by host handles
+	return m_model.GetObjectByHandle(handle) ? handle : model::INVALID_OBJECT_HANDLE;
+}
+
 bool Network::IsHost() const
 {
 	return m_host;
 }
 
+uint32_t Network::WriteState(WriteMemoryStream& stream)
+{
+	stream.WriteByte(MESSAGE_STATE);
+	stream.WriteSizeT(0);
+	m_stateManager.SerializeState(stream);
+	return m_replicator.WriteSnapshot(stream);
+}
+
 void Network::SendState()
 {
 	if (!m_socket)
@@ -171,12 +418,126 @@ void Network::SendState()
 		return;
 	}
 	WriteMemoryStream stream;
-	stream.WriteByte(1);//1 For full dump
-	stream.WriteSizeT(0);
-	m_stateManager.SerializeState(stream, true);
+	const uint32_t baseline = WriteState(stream);
+	for (auto& peer : m_peers)
+	{
+		peer.second.baseline = baseline;
+		peer.second.synchronized = true;
+	}
+	Broadcast(stream);
+}
+
+void Network::SendState(ConnectionId connection)
+{
+	WriteMemoryStream stream;
+	sPeer& peer = m_peers[connection];
+	peer.baseline = WriteState(stream);
+	peer.synchronized = true;
+	Send(stream, connection);
+}
+
+void Network::SendDeltas()
+{
+	if (!m_replicator.HasChanges())
+		return;
+	m_replicator.CommitChanges();
+	//Peers that have not created any objects get the same delta if they have acknowledged the same state
+	std::map<uint32_t, std::vector<ConnectionId>> sharedDeltas;
+	std::vector<ConnectionId> ownDeltas;
+	for (auto& peer : m_peers)
+	{
+		if (!peer.second.synchronized)
+			continue;
+		if (peer.second.ownHandles.empty())
+			sharedDeltas[peer.second.baseline].push_back(peer.first);
+		else
+			ownDeltas.push_back(peer.first);
+	}
+	for (auto& group : sharedDeltas)
+	{
+		WriteMemoryStream stream(m_sendBuffer);
+		stream.WriteByte(MESSAGE_DELTA);
+		stream.WriteSizeT(0);
+		m_replicator.WriteDelta(stream, group.first);
+		Send(stream, group.second.data(), group.second.size());
+	}
+	for (ConnectionId connection : ownDeltas)
+	{
+		auto it = m_peers.find(connection);
+		if (it == m_peers.end())
+			continue;
+		auto& ownHandles = it->second.ownHandles;
+		WriteMemoryStream stream(m_sendBuffer);
+		stream.WriteByte(MESSAGE_DELTA);
+		stream.WriteSizeT(0);
+		m_replicator.WriteDelta(stream, it->second.baseline, [&ownHandles](model::IObject* object) {
+			auto handle = ownHandles.find(object->GetHandle());
+			return handle != ownHandles.end() ? handle->second : model::INVALID_OBJECT_HANDLE;
+		});
+		Send(stream, connection);
+	}
+}
+
+void Network::Send(WriteMemoryStream& stream, const ConnectionId* connections, size_t count)
+{
+	if (!m_socket) return;
 	uint32_t size = static_cast<uint32_t>(stream.GetSize());
 	memcpy(&stream.GetData()[1], &size, sizeof(uint32_t));
-	m_socket->SendData(stream.GetData(), stream.GetSize());
+	INetSocket::Buffer buffers[2] = { { stream.GetData(), size } };
+	size_t buffersCount = 1;
+	char wrapper[HEADER_SIZE + sizeof(uint32_t)];
+	std::vector<char> compressed;
+	if (m_compression && size >= COMPRESSION_THRESHOLD)
+	{
+		compressed = CompressLZ4(stream.GetData(), size);
+		const uint32_t compressedSize = static_cast<uint32_t>(compressed.size() + sizeof(wrapper));
+		if (compressedSize < size)
+		{
+			wrapper[0] = MESSAGE_COMPRESSED;
+			memcpy(wrapper + 1, &compressedSize, sizeof(uint32_t));
+			memcpy(wrapper + HEADER_SIZE, &size, sizeof(uint32_t));
+			buffers[0] = { wrapper, sizeof(wrapper) };
+			buffers[1] = { compressed.data(), compressed.size() };
+			buffersCount = 2;
+		}
+	}
+	for (size_t i = 0; i < count; ++i)
+	{
+		m_socket->SendData(connections[i], buffers, buffersCount);
+	}
+}
+
+void Network::Send(WriteMemoryStream& stream, ConnectionId connection)
+{
+	Send(stream, &connection, 1);
+}
+
+void Network::Broadcast(WriteMemoryStream& stream)
+{
+	//Failed send closes connection and removes peer, so peers are collected first
+	std::vector<ConnectionId> connections;
+	connections.reserve(m_peers.size());
+	for (auto& peer : m_peers)
+	{
+		connections.push_back(peer.first);
+	}
+	Send(stream, connections.data(), connections.size());
+}
+
+void Network::Relay(const char* message, size_t size, ConnectionId sender)
+{
+	std::vector<ConnectionId> connections;
+	connections.reserve(m_peers.size());
+	for (auto& peer : m_peers)
+	{
+		if (peer.first != sender)
+			connections.push_back(peer.first);
+	}
+	INetSocket::Buffer buffer = { message, size };
+	for (ConnectionId connection : connections)
+	{
+		m_socket->SendData(connection, &buffer, 1);
+	}
 }
 
 void Network::SendMessage(std::wstring const& message)
@@ -187,9 +548,10 @@ void Network::SendMessage(std::wstring const& message)
 		return;
 	}
 	WriteMemoryStream data;
-	data.WriteByte(0);//0 for text message
+	data.WriteByte(MESSAGE_STRING);
+	data.WriteSizeT(0);
 	data.WriteWString(message);
-	m_socket->SendData(data.GetData(), data.GetSize());
+	Broadcast(data);
 }
 
 void Network::SendAction(ICommand const& command)
@@ -200,47 +562,53 @@ void Network::SendAction(ICommand const& command)
 		return;
 	}
 	WriteMemoryStream result;
-	result.WriteByte(2);//2 for action;
+	result.WriteByte(MESSAGE_COMMAND);
 	result.WriteSizeT(0);//message size
 	command.Serialize(result);
-	if (result.GetData()[5] != 5 && result.GetData()[5] != 0)//it is delete, move, rotate or change object property action, so it contains an object addresses that needs to be translated
+	//Host handles are used by everyone, so only clients translate them
+	if (!m_host && HasHandle(result.GetData()[HEADER_SIZE]))
 	{
-		uint64_t addr;
-		memcpy(&addr, &result.GetData()[6], sizeof(uint64_t));
-		auto newAddr = GetAddress(reinterpret_cast<void*>(addr));
-		memcpy(&result.GetData()[6], &newAddr, sizeof(uint64_t));
+		model::ObjectHandle handle;
+		memcpy(&handle, &result.GetData()[HEADER_SIZE + 1], sizeof(handle));
+		model::ObjectHandle remoteHandle = GetRemoteHandle(handle);
+		if (remoteHandle != model::INVALID_OBJECT_HANDLE)
+		{
+			memcpy(&result.GetData()[HEADER_SIZE + 1], &remoteHandle, sizeof(remoteHandle));
+		}
+		else
+		{
+			result.GetData()[0] = MESSAGE_OWN_COMMAND;
+		}
 	}
-	uint32_t size = static_cast<uint32_t>(result.GetSize());
-	memcpy(&result.GetData()[1], &size, sizeof(uint32_t));
-	m_socket->SendData(result.GetData(), result.GetSize());
+	Broadcast(result);
 	LogWriter::WriteLine("Action sent.");
 }
 
 bool Network::IsConnected()
 {
-	return m_socket.get() != NULL;
+	return m_socket && !m_peers.empty();
 }
 
-void* Network::GetAddress(void* object)
+model::ObjectHandle Network::GetRemoteHandle(model::ObjectHandle localHandle) const
 {
-	for (auto i = m_translator.begin(); i != m_translator.end(); ++i)
-	{
-		if (i->second == object)
-		{
-			return i->first;
-		}
-	}
-	return 0;
+	auto it = m_remoteHandles.find(localHandle);
+	return it != m_remoteHandles.end() ? it->second : model::INVALID_OBJECT_HANDLE;
 }
 
-void Network::AddAddressLocal(std::shared_ptr<model::IObject> const& obj)
+void Network::AddRemoteObject(std::shared_ptr<model::IObject> const& obj, model::ObjectHandle remoteHandle)
 {
-	m_translator[obj.get()] = obj.get();
+	m_translator[remoteHandle] = obj->GetHandle();
+	m_remoteHandles[obj->GetHandle()] = remoteHandle;
 }
 
-void Network::AddAddress(std::shared_ptr<model::IObject> const& obj, void* address)
+void Network::RemoveRemoteObject(model::ObjectHandle localHandle)
 {
-	m_translator[address] = obj.get();
+	auto it = m_remoteHandles.find(localHandle);
+	if (it != m_remoteHandles.end())
+	{
+		m_translator.erase(it->second);
+		m_remoteHandles.erase(it);
+	}
 }
 
 void Network::SetStateRecievedCallback(OnStateRecievedHandler const& onStateRecieved)
@@ -257,5 +625,10 @@ void Network::CallStateRecievedCallback()
 {
 	if (m_stateRecievedCallback) m_stateRecievedCallback();
 }
+
+void Network::SetCompression(bool enable)
+{
+	m_compression = enable;
+}
 }
 }
\ No newline at end of file
@@ -4,14 +4,18 @@
 #include <string>
 #include <functional>
 #include "../INetSocket.h"
+#include "StateReplicator.h"
+#include <map>
 #include <unordered_map>
 
 namespace wargameEngine
 {
+class WriteMemoryStream;
+
 namespace model
 {
 class IObject;
-class IModel;
+class Model;
 }
 namespace controller
 {
@@ -25,35 +29,78 @@ class Network
 	typedef std::function<void()> OnStateRecievedHandler;
 	typedef std::function<void(std::wstring const&)> OnStringReceivedHandler;
 public:
-	Network(IStateManager & stateManager, CommandHandler & commandHandler, model::IModel & model, SocketFactory const& socketFactory);
+	Network(IStateManager & stateManager, CommandHandler & commandHandler, model::Model & model, SocketFactory const& socketFactory);
 	void Host(unsigned short port = 0);
-	void Client(const char * ip, unsigned short port = 0);
+	//Spectators receive game state and messages, but their commands are ignored by host
+	void Client(const char * ip, unsigned short port = 0, bool spectator = false);
 	void Update();
 	bool IsHost() const;
 	void Stop();
+	//Sends full state to every peer. After that host sends only deltas against the state acknowledged by each peer
 	void SendState();
 	void SendMessage(std::wstring const& message);
 	void SendAction(ICommand const& command);
 	bool IsConnected();
-	void AddAddressLocal(std::shared_ptr<model::IObject> const& obj);
-	void AddAddress(std::shared_ptr<model::IObject> const& obj, void* address);
+	//Client side. Object is known by host as remoteHandle
+	void AddRemoteObject(std::shared_ptr<model::IObject> const& obj, model::ObjectHandle remoteHandle);
 	void SetStateRecievedCallback(OnStateRecievedHandler const& onStateRecieved);
 	void SetStringRecievedCallback(OnStringReceivedHandler const& onStringRecieved);
 	void CallStateRecievedCallback();
+	//Compresses large messages. Enabled by default
+	void SetCompression(bool enable);
 private:
-	void* GetAddress(void* obj);
+	typedef INetSocket::ConnectionId ConnectionId;
+	struct sPeer
+	{
+		bool spectator = false;
+		bool synchronized = false;
+		uint32_t baseline = 0;
+		//Objects created by peer commands, peer handle to host handle and back
+		std::unordered_map<model::ObjectHandle, model::ObjectHandle> objects;
+		std::unordered_map<model::ObjectHandle, model::ObjectHandle> ownHandles;
+	};
+	//Returns invalid handle if host does not know the object yet
+	model::ObjectHandle GetRemoteHandle(model::ObjectHandle localHandle) const;
+	void RemoveRemoteObject(model::ObjectHandle localHandle);
+	void OnConnect(ConnectionId connection);
+	void OnData(ConnectionId connection, RingBuffer& received);
+	void OnDisconnect(ConnectionId connection);
+	void OnObjectRemoved(model::IObject* object);
+	//Message is processed in place, so handle translation can change it
+	void ProcessMessage(char* message, size_t size, ConnectionId connection);
+	void ProcessCommand(char* message, size_t size, ConnectionId connection);
+	//Returns host handle of object that peer means or invalid handle. Own handles are the ones peer has created objects with
+	model::ObjectHandle TranslatePeerHandle(sPeer const& peer, model::ObjectHandle handle, bool ownHandle) const;
+	//Returns baseline of peers that receive the state
+	uint32_t WriteState(WriteMemoryStream& stream);
+	void SendState(ConnectionId connection);
+	void SendDeltas();
+	//Writes size to message header and compresses large messages. Same buffers are sent to every connection
+	void Send(WriteMemoryStream& stream, const ConnectionId* connections, size_t count);
+	void Send(WriteMemoryStream& stream, ConnectionId connection);
+	void Broadcast(WriteMemoryStream& stream);
+	//Sends received message to all peers except its sender
+	void Relay(const char* message, size_t size, ConnectionId sender);
 	SocketFactory m_socketFactory;
 	std::unique_ptr<INetSocket> m_socket;
-	std::unordered_map<void*, void*> m_translator;
+	//Client side translation, host handle to local one and back
+	std::unordered_map<model::ObjectHandle, model::ObjectHandle> m_translator;
+	std::unordered_map<model::ObjectHandle, model::ObjectHandle> m_remoteHandles;
 	bool m_host;
-	size_t m_netRecievedSize;
-	size_t m_netTotalSize;
-	std::vector<char> m_netData;
+	bool m_spectator = false;
+	bool m_updating = false;
+	bool m_stopRequested = false;
+	std::map<ConnectionId, sPeer> m_peers;
+	//Deltas are written every update, so their memory is reused
+	std::vector<char> m_sendBuffer;
+	bool m_compression = true;
 	OnStateRecievedHandler m_stateRecievedCallback;
 	OnStringReceivedHandler m_stringRecievedCallback;
 	IStateManager & m_stateManager;
 	CommandHandler & m_commandHandler;
-	model::IModel & m_model;
+	model::Model & m_model;
+	StateReplicator m_replicator;
+	signals::ScopedConnection m_removeConnection;
 };
 }
 }
\ No newline at end of file
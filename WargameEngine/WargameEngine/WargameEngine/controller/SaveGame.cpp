@@ -0,0 +1,249 @@
+#include "SaveGame.h"
+#include "../LogWriter.h"
+#include "../MemoryStream.h"
+#include "../OSSpecific.h"
+#include "../Utils.h"
+#include "../model/Model.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string.h>
+
+namespace wargameEngine
+{
+namespace controller
+{
+namespace
+{
+const char SAVE_MAGIC[4] = { 'W', 'S', 'A', 'V' };
+const uint32_t SAVE_VERSION = 1;
+//Small enough to keep only a fraction of a big save in memory, large enough to keep table of contents short
+const size_t OBJECTS_PER_CHUNK = 1024;
+//Coordinates, rotation, model path size, handle and properties count
+const size_t MIN_OBJECT_SIZE = 4 * sizeof(float) + sizeof(uint32_t) + 2;
+//Sizes of key and value
+const size_t MIN_PROPERTY_SIZE = 2 * sizeof(uint32_t);
+
+enum eChunkType : uint32_t
+{
+	CHUNK_OBJECTS = 1,
+	CHUNK_PROPERTIES = 2,
+};
+
+struct sSaveHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t chunksCount;
+	uint64_t tocOffset;
+};
+
+void WritePropertyMap(IWriteMemoryStream& stream, std::unordered_map<std::wstring, std::wstring> const& properties)
+{
+	stream.WriteVarint(static_cast<uint32_t>(properties.size()));
+	for (auto& property : properties)
+	{
+		stream.WriteWString(property.first);
+		stream.WriteWString(property.second);
+	}
+}
+
+void ReadPropertyList(IReadMemoryStream& stream, std::vector<std::pair<std::wstring, std::wstring>>& properties)
+{
+	const uint32_t count = stream.ReadVarint();
+	if (count > stream.GetRemaining() / MIN_PROPERTY_SIZE)
+	{
+		throw std::runtime_error("Save file is corrupted");
+	}
+	properties.resize(count);
+	for (auto& property : properties)
+	{
+		property.first = stream.ReadWString();
+		property.second = stream.ReadWString();
+	}
+}
+
+bool WriteChunks(const Path& path, sSaveSnapshot const& snapshot)
+{
+	std::ofstream oFile(path, std::ios::binary | std::ios::out);
+	if (!oFile)
+	{
+		return false;
+	}
+	sSaveHeader header;
+	memcpy(header.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC));
+	header.version = SAVE_VERSION;
+	header.chunksCount = snapshot.chunks.size();
+	header.tocOffset = 0;
+	oFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	uint64_t offset = sizeof(header);
+	std::vector<SaveGameReader::sChunk> toc;
+	toc.reserve(snapshot.chunks.size());
+	for (auto& chunk : snapshot.chunks)
+	{
+		oFile.write(chunk.data.data(), chunk.data.size());
+		toc.push_back({ chunk.type, chunk.count, offset, chunk.data.size() });
+		offset += chunk.data.size();
+	}
+	header.tocOffset = offset;
+	oFile.write(reinterpret_cast<const char*>(toc.data()), toc.size() * sizeof(SaveGameReader::sChunk));
+	oFile.seekp(0);
+	oFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	oFile.close();
+	return !!oFile;
+}
+}
+
+sSaveSnapshot MakeSnapshot(model::Model& model)
+{
+	sSaveSnapshot snapshot;
+	std::vector<char> buffer;
+	auto addChunk = [&](uint32_t type, size_t count) {
+		snapshot.chunks.push_back({ type, static_cast<uint32_t>(count), buffer });
+	};
+	const size_t count = model.GetObjectCount();
+	for (size_t begin = 0; begin < count; begin += OBJECTS_PER_CHUNK)
+	{
+		const size_t end = std::min(begin + OBJECTS_PER_CHUNK, count);
+		{
+			WriteMemoryStream stream(buffer);
+			for (size_t i = begin; i < end; ++i)
+			{
+				auto object = model.Get3DObject(i);
+				stream.WriteFloat(object->GetX());
+				stream.WriteFloat(object->GetY());
+				stream.WriteFloat(object->GetZ());
+				stream.WriteFloat(object->GetRotation());
+				stream.WriteString(to_string(object->GetPathToModel()));
+				stream.WriteVarint(object->GetHandle());
+				WritePropertyMap(stream, object->GetAllProperties());
+			}
+		}
+		addChunk(CHUNK_OBJECTS, end - begin);
+	}
+	{
+		WriteMemoryStream stream(buffer);
+		WritePropertyMap(stream, model.GetAllProperties());
+	}
+	addChunk(CHUNK_PROPERTIES, model.GetAllProperties().size());
+	return snapshot;
+}
+
+bool WriteSaveGame(const Path& path, sSaveSnapshot const& snapshot)
+{
+	//Written under temporary name, so failed or interrupted save never destroys the previous one
+	const Path tempPath = path + make_path(L".tmp");
+	if (!WriteChunks(tempPath, snapshot) || !AtomicReplaceFile(tempPath, path))
+	{
+		LogWriter::WriteLine("Cannot write save file " + to_string(path));
+		RemoveFile(tempPath);
+		return false;
+	}
+	return true;
+}
+
+SaveGameReader::SaveGameReader(const Path& path)
+	: m_file(path)
+{
+	sSaveHeader header;
+	FileView headerView = m_file.Map(0, sizeof(header));
+	if (headerView.size() != sizeof(header))
+		return;
+	memcpy(&header, headerView.data(), sizeof(header));
+	if (memcmp(header.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC)) != 0 || header.version != SAVE_VERSION || header.chunksCount == 0
+		|| header.chunksCount > m_file.GetSize() / sizeof(sChunk))
+		return;
+	const size_t tocSize = static_cast<size_t>(header.chunksCount) * sizeof(sChunk);
+	FileView toc = m_file.Map(static_cast<size_t>(header.tocOffset), tocSize);
+	if (toc.size() != tocSize)
+		return;
+	m_chunks.resize(static_cast<size_t>(header.chunksCount));
+	memcpy(m_chunks.data(), toc.data(), tocSize);
+	for (auto& chunk : m_chunks)
+	{
+		if (chunk.type == CHUNK_OBJECTS)
+		{
+			m_objectsCount += chunk.count;
+		}
+	}
+}
+
+bool SaveGameReader::IsValid() const
+{
+	return !m_chunks.empty();
+}
+
+size_t SaveGameReader::GetObjectsCount() const
+{
+	return m_objectsCount;
+}
+
+FileView SaveGameReader::MapChunk(sChunk const& chunk) const
+{
+	FileView view = m_file.Map(static_cast<size_t>(chunk.offset), static_cast<size_t>(chunk.size));
+	if (view.size() != chunk.size)
+	{
+		throw std::runtime_error("Save file is corrupted");
+	}
+	return view;
+}
+
+bool SaveGameReader::ReadObjects(std::vector<sSavedObject>& objects)
+{
+	for (; m_nextChunk < m_chunks.size(); ++m_nextChunk)
+	{
+		sChunk const& chunk = m_chunks[m_nextChunk];
+		if (chunk.type != CHUNK_OBJECTS || chunk.count == 0)
+			continue;
+		if (chunk.count > chunk.size / MIN_OBJECT_SIZE)
+		{
+			throw std::runtime_error("Save file is corrupted");
+		}
+		FileView view = MapChunk(chunk);
+		ReadMemoryStream stream(view.data(), view.size());
+		//Objects of previous chunk are overwritten, so their memory is reused
+		objects.resize(chunk.count);
+		for (auto& object : objects)
+		{
+			object.coords.x = stream.ReadFloat();
+			object.coords.y = stream.ReadFloat();
+			object.coords.z = stream.ReadFloat();
+			object.rotation = stream.ReadFloat();
+			object.model = stream.ReadString();
+			object.handle = stream.ReadVarint();
+			ReadPropertyList(stream, object.properties);
+		}
+		++m_nextChunk;
+		return true;
+	}
+	objects.clear();
+	return false;
+}
+
+void SaveGameReader::Validate()
+{
+	m_nextChunk = 0;
+	std::vector<sSavedObject> objects;
+	while (ReadObjects(objects))
+	{
+	}
+	ReadProperties();
+	m_nextChunk = 0;
+}
+
+std::vector<std::pair<std::wstring, std::wstring>> SaveGameReader::ReadProperties()
+{
+	std::vector<std::pair<std::wstring, std::wstring>> result;
+	for (auto& chunk : m_chunks)
+	{
+		if (chunk.type == CHUNK_PROPERTIES && chunk.size > 0)
+		{
+			FileView view = MapChunk(chunk);
+			ReadMemoryStream stream(view.data(), view.size());
+			ReadPropertyList(stream, result);
+		}
+	}
+	return result;
+}
+}
+}
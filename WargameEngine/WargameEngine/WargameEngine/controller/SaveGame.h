@@ -0,0 +1,77 @@
+#pragma once
+#include "../Typedefs.h"
+#include "../VirtualFileSystem.h"
+#include "../model/ObjectHandle.h"
+#include "../view/Vector3.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace wargameEngine
+{
+namespace model
+{
+class Model;
+}
+
+namespace controller
+{
+struct sSavedObject
+{
+	CVector3f coords;
+	float rotation;
+	std::string model;
+	model::ObjectHandle handle;
+	std::vector<std::pair<std::wstring, std::wstring>> properties;
+};
+
+//Model state serialized into chunks. Making it is the only part of saving that has to be done on the game thread
+struct sSaveSnapshot
+{
+	struct sChunkData
+	{
+		uint32_t type;
+		uint32_t count;
+		std::vector<char> data;
+	};
+	std::vector<sChunkData> chunks;
+};
+
+sSaveSnapshot MakeSnapshot(model::Model& model);
+//Writes chunks one by one and table of contents after them. Can be called from any thread, errors are logged
+bool WriteSaveGame(const Path& path, sSaveSnapshot const& snapshot);
+
+//Reads save game from memory mapping. Chunk is mapped only when it is read and is unmapped right after that
+class SaveGameReader
+{
+public:
+	//Table of contents entry
+	struct sChunk
+	{
+		uint32_t type;
+		uint32_t count;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	SaveGameReader(const Path& path);
+
+	//Returns false if file does not exist or is not a chunked save game
+	bool IsValid() const;
+	size_t GetObjectsCount() const;
+	//Replaces objects with the next chunk. Returns false if all objects are read. Throws std::runtime_error if chunk is corrupted
+	bool ReadObjects(std::vector<sSavedObject>& objects);
+	std::vector<std::pair<std::wstring, std::wstring>> ReadProperties();
+	//Parses every chunk keeping one chunk of objects at a time, then starts reading objects from the first chunk again. Throws std::runtime_error if save is corrupted
+	void Validate();
+
+private:
+	FileView MapChunk(sChunk const& chunk) const;
+
+	MappedFile m_file;
+	std::vector<sChunk> m_chunks;
+	size_t m_nextChunk = 0;
+	size_t m_objectsCount = 0;
+};
+}
+}
@@ -64,6 +64,8 @@
 
 #define GET_MAX_ANISOTROPY L"GetMaxAnisotropy"
 
+#define SET_TEXTURE_MEMORY_BUDGET L"SetTextureMemoryBudget"
+
 #define ENABLE_GPU_SKINNING L"EnableGPUSkinning"
 
 #define DISABLE_GPU_SKINNING L"DisableGPUSkinning"
@@ -82,6 +84,8 @@
 
 #define SET_SKYBOX_SHADERS L"SetSkyboxShaders"
 
+#define SET_INSTANCING_SHADERS L"SetInstancingShaders"
+
 #define UNIFORM_1I L"Uniform1i"
 
 #define UNIFORM_1F L"Uniform1f"
@@ -114,6 +118,12 @@
 
 #define STOP_BENCHMARK L"StopBenchmark"
 
+#define ENABLE_PROFILER L"EnableProfiler"
+
+#define SHOW_PROFILER_OVERLAY L"ShowProfilerOverlay"
+
+#define SAVE_PROFILER_TRACE L"SaveProfilerTrace"
+
 /*CONTROLLER*/
 
 #define LOAD_MODULE L"LoadModule"
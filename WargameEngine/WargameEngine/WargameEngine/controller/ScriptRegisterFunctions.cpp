@@ -2,6 +2,7 @@
 #include "../AsyncFileProvider.h"
 #include "../LogWriter.h"
 #include "../OSSpecific.h"
+#include "../Profiler.h"
 #include "../ThreadPool.h"
 #include "../Utils.h"
 #include "../view/ISoundPlayer.h"
@@ -15,6 +16,29 @@ namespace wargameEngine
 {
 namespace controller
 {
+namespace
+{
+//Uniforms set by scripts go to every program that draws the scene
+template<class T>
+void SetSceneUniform(view::View& view, std::string const& name, int elementSize, size_t count, const T* value)
+{
+	auto& shaderManager = view.GetRenderer().GetShaderManager();
+	auto setUniform = [&](view::IShaderProgram const* shaderProgram) {
+		if (shaderProgram)
+		{
+			shaderManager.PushProgram(*shaderProgram);
+			shaderManager.SetUniformValue(name, elementSize, count, value);
+			shaderManager.PopProgram();
+		}
+	};
+	const size_t viewportsCount = view.GetViewportCount();
+	for (size_t i = 0; i < viewportsCount; ++i)
+	{
+		setUniform(view.GetViewport(i).GetShaderProgram());
+	}
+	setUniform(view.GetInstancingProgram());
+}
+}
 
 void RegisterModelFunctions(IScriptHandler& handler, model::Model& model)
 {
@@ -191,6 +215,16 @@ void RegisterViewFunctions(IScriptHandler& handler, view::View& view, AsyncFileP
 		return view.GetMaxAnisotropy();
 	});
 
+	handler.RegisterFunction(SET_TEXTURE_MEMORY_BUDGET, [&](IArguments const& args) {
+		if (args.GetCount() != 1)
+			throw std::runtime_error("1 argument expected (megabytes)");
+		int megabytes = args.GetInt(1);
+		if (megabytes < 0)
+			throw std::runtime_error("budget cannot be negative");
+		view.SetTextureMemoryBudget(static_cast<size_t>(megabytes) << 20);
+		return nullptr;
+	});
+
 	handler.RegisterFunction(ENABLE_GPU_SKINNING, [&](IArguments const& args) {
 		if (args.GetCount() != 0)
 			throw std::runtime_error("no arguments expected");
@@ -249,6 +283,19 @@ void RegisterViewFunctions(IScriptHandler& handler, view::View& view, AsyncFileP
 		return nullptr;
 	});
 
+	handler.RegisterFunction(SET_INSTANCING_SHADERS, [&](IArguments const& args) {
+		int n = args.GetCount();
+		Path vertex, fragment;
+		if (n > 0)
+			vertex = fileProvider.GetShaderAbsolutePath(args.GetPath(1));
+		if (n > 1)
+			fragment = fileProvider.GetShaderAbsolutePath(args.GetPath(2));
+		if (n > 2)
+			throw std::runtime_error("up to 2 argument expected (vertex shader, fragment shader)");
+		view.SetInstancingShaders(vertex, fragment);
+		return nullptr;
+	});
+
 	handler.RegisterFunction(SET_SHADERS, [&](IArguments const& args) {
 		int n = args.GetCount();
 		Path vertex, fragment, geometry;
@@ -282,18 +329,7 @@ void RegisterViewFunctions(IScriptHandler& handler, view::View& view, AsyncFileP
 			throw std::runtime_error("2 arguments expected (uniform name, value)");
 		std::string name = args.GetStr(1);
 		int value = args.GetInt(2);
-		auto& shaderManager = view.GetRenderer().GetShaderManager();
-		const size_t viewportsCount = view.GetViewportCount();
-		for (size_t i = 0; i < viewportsCount; ++i)
-		{
-			auto shaderProgram = view.GetViewport(i).GetShaderProgram();
-			if (shaderProgram)
-			{
-				shaderManager.PushProgram(*shaderProgram);
-				shaderManager.SetUniformValue(name, 1, 1, &value);
-				shaderManager.PopProgram();
-			}
-		}
+		SetSceneUniform(view, name, 1, 1, &value);
 		return nullptr;
 	});
 
@@ -302,18 +338,7 @@ void RegisterViewFunctions(IScriptHandler& handler, view::View& view, AsyncFileP
 			throw std::runtime_error("2 arguments expected (uniform name, value)");
 		std::string name = args.GetStr(1);
 		float value = args.GetFloat(2);
-		auto& shaderManager = view.GetRenderer().GetShaderManager();
-		const size_t viewportsCount = view.GetViewportCount();
-		for (size_t i = 0; i < viewportsCount; ++i)
-		{
-			auto shaderProgram = view.GetViewport(i).GetShaderProgram();
-			if (shaderProgram)
-			{
-				shaderManager.PushProgram(*shaderProgram);
-				shaderManager.SetUniformValue(name, 1, 1, &value);
-				shaderManager.PopProgram();
-			}
-		}
+		SetSceneUniform(view, name, 1, 1, &value);
 		return nullptr;
 	});
 
@@ -325,18 +350,7 @@ void RegisterViewFunctions(IScriptHandler& handler, view::View& view, AsyncFileP
 		std::vector<float> value = args.GetFloatArray(3);
 		if (value.size() < count)
 			throw std::runtime_error("Not enough elements in the array");
-		auto& shaderManager = view.GetRenderer().GetShaderManager();
-		const size_t viewportsCount = view.GetViewportCount();
-		for (size_t i = 0; i < viewportsCount; ++i)
-		{
-			auto shaderProgram = view.GetViewport(i).GetShaderProgram();
-			if (shaderProgram)
-			{
-				shaderManager.PushProgram(*shaderProgram);
-				shaderManager.SetUniformValue(name, 1, count, &value[0]);
-				shaderManager.PopProgram();
-			}
-		}
+		SetSceneUniform(view, name, 1, count, &value[0]);
 		return nullptr;
 	});
 
@@ -348,18 +362,7 @@ void RegisterViewFunctions(IScriptHandler& handler, view::View& view, AsyncFileP
 		std::vector<float> value = args.GetFloatArray(3);
 		if (value.size() < count * 2)
 			throw std::runtime_error("Not enough elements in the array");
-		auto& shaderManager = view.GetRenderer().GetShaderManager();
-		const size_t viewportsCount = view.GetViewportCount();
-		for (size_t i = 0; i < viewportsCount; ++i)
-		{
-			auto shaderProgram = view.GetViewport(i).GetShaderProgram();
-			if (shaderProgram)
-			{
-				shaderManager.PushProgram(*shaderProgram);
-				shaderManager.SetUniformValue(name, 2, count, &value[0]);
-				shaderManager.PopProgram();
-			}
-		}
+		SetSceneUniform(view, name, 2, count, &value[0]);
 		return nullptr;
 	});
 
@@ -371,18 +374,7 @@ void RegisterViewFunctions(IScriptHandler& handler, view::View& view, AsyncFileP
 		std::vector<float> value = args.GetFloatArray(3);
 		if (value.size() < count * 3)
 			throw std::runtime_error("Not enough elements in the array");
-		auto& shaderManager = view.GetRenderer().GetShaderManager();
-		const size_t viewportsCount = view.GetViewportCount();
-		for (size_t i = 0; i < viewportsCount; ++i)
-		{
-			auto shaderProgram = view.GetViewport(i).GetShaderProgram();
-			if (shaderProgram)
-			{
-				shaderManager.PushProgram(*shaderProgram);
-				shaderManager.SetUniformValue(name, 3, count, &value[0]);
-				shaderManager.PopProgram();
-			}
-		}
+		SetSceneUniform(view, name, 3, count, &value[0]);
 		return nullptr;
 	});
 
@@ -394,18 +386,7 @@ void RegisterViewFunctions(IScriptHandler& handler, view::View& view, AsyncFileP
 		std::vector<float> value = args.GetFloatArray(3);
 		if (value.size() < count * 4)
 			throw std::runtime_error("Not enough elements in the array");
-		auto& shaderManager = view.GetRenderer().GetShaderManager();
-		const size_t viewportsCount = view.GetViewportCount();
-		for (size_t i = 0; i < viewportsCount; ++i)
-		{
-			auto shaderProgram = view.GetViewport(i).GetShaderProgram();
-			if (shaderProgram)
-			{
-				shaderManager.PushProgram(*shaderProgram);
-				shaderManager.SetUniformValue(name, 4, count, &value[0]);
-				shaderManager.PopProgram();
-			}
-		}
+		SetSceneUniform(view, name, 4, count, &value[0]);
 		return nullptr;
 	});
 
@@ -417,18 +398,7 @@ void RegisterViewFunctions(IScriptHandler& handler, view::View& view, AsyncFileP
 		std::vector<float> value = args.GetFloatArray(3);
 		if (value.size() < count * 16)
 			throw std::runtime_error("Not enough elements in the array");
-		auto& shaderManager = view.GetRenderer().GetShaderManager();
-		const size_t viewportsCount = view.GetViewportCount();
-		for (size_t i = 0; i < viewportsCount; ++i)
-		{
-			auto shaderProgram = view.GetViewport(i).GetShaderProgram();
-			if (shaderProgram)
-			{
-				shaderManager.PushProgram(*shaderProgram);
-				shaderManager.SetUniformValue(name, 16, count, &value[0]);
-				shaderManager.PopProgram();
-			}
-		}
+		SetSceneUniform(view, name, 16, count, &value[0]);
 		return nullptr;
 	});
 
@@ -531,9 +501,29 @@ void RegisterViewFunctions(IScriptHandler& handler, view::View& view, AsyncFileP
 		view::PerfomanceMeter::EndBenchmark(fileProvider.GetAbsolutePath(path));
 		return 0;
 	});
+
+	handler.RegisterFunction(ENABLE_PROFILER, [](IArguments const& args) {
+		if (args.GetCount() != 1)
+			throw std::runtime_error("1 argument expected (enable)");
+		Profiler::Enable(args.GetBool(1));
+		return nullptr;
+	});
+
+	handler.RegisterFunction(SHOW_PROFILER_OVERLAY, [](IArguments const& args) {
+		if (args.GetCount() != 1)
+			throw std::runtime_error("1 argument expected (show)");
+		view::PerfomanceMeter::ShowProfilerOverlay(args.GetBool(1));
+		return nullptr;
+	});
+
+	handler.RegisterFunction(SAVE_PROFILER_TRACE, [&](IArguments const& args) {
+		if (args.GetCount() != 1)
+			throw std::runtime_error("1 argument expected - filepath");
+		return Profiler::SaveTrace(fileProvider.GetAbsolutePath(args.GetPath(1)));
+	});
 }
 
-void RegisterControllerFunctions(IScriptHandler& handler, Controller& controller, AsyncFileProvider& fileProvider, ThreadPool& threadPool)
+void RegisterControllerFunctions(IScriptHandler& handler, Controller& controller, model::Model& model, AsyncFileProvider& fileProvider, ThreadPool& threadPool)
 {
 	handler.RegisterFunction(DELETE_TIMED_CALLBACK, [&](IArguments const& args) {
 		if (args.GetCount() != 1)
@@ -617,7 +607,7 @@ void RegisterControllerFunctions(IScriptHandler& handler, Controller& controller
 		auto func = args.GetFunction(1);
 		bool disable = args.GetBool(2);
 		auto callback = [=](std::shared_ptr<model::IObject> obj, std::wstring const& type, double x, double y, double z) {
-			FunctionArgument instance(obj.get(), L"Object");
+			FunctionArgument instance(ObjectToInstance(obj.get()), L"Object");
 			func({ instance, type, x, y, z });
 			return disable;
 		};
@@ -666,11 +656,12 @@ void RegisterControllerFunctions(IScriptHandler& handler, Controller& controller
 	});
 
 	handler.RegisterFunction(LINE_OF_SIGHT, [&](IArguments const& args) {
-		if (args.GetCount() != 2)
-			throw std::runtime_error("2 argument expected (source, target)");
-		model::IObject* shootingModel = (model::IObject*)args.GetClassInstance(1);
-		model::IObject* target = (model::IObject*)args.GetClassInstance(2);
-		return FunctionArgument(static_cast<int>(controller.GetLineOfSight(shootingModel, target)));
+		if (args.GetCount() < 2 || args.GetCount() > 3)
+			throw std::runtime_error("2 or 3 argument expected (source, target, [threshold])");
+		model::IObject* shootingModel = InstanceToObject(model, args.GetClassInstance(1)).get();
+		model::IObject* target = InstanceToObject(model, args.GetClassInstance(2)).get();
+		const size_t threshold = args.GetCount() == 3 ? static_cast<size_t>(std::max(args.GetInt(3), 0)) : 100;
+		return FunctionArgument(static_cast<int>(controller.GetLineOfSight(shootingModel, target, threshold)));
 	});
 
 	handler.RegisterFunction(BEGIN_ACTION_COMPOUND, [&](IArguments const& args) {
@@ -696,11 +687,12 @@ void RegisterControllerFunctions(IScriptHandler& handler, Controller& controller
 	});
 
 	handler.RegisterFunction(NET_CLIENT, [&](IArguments const& args) {
-		if (args.GetCount() != 2)
-			throw std::runtime_error("2 argument expected (ip, port)");
+		if (args.GetCount() < 2 || args.GetCount() > 3)
+			throw std::runtime_error("2 or 3 argument expected (ip, port, spectator)");
 		std::string ip = args.GetStr(1);
 		unsigned short port = static_cast<unsigned short>(args.GetLong(2));
-		controller.GetNetwork().Client(ip.c_str(), port);
+		bool spectator = args.GetCount() > 2 ? args.GetBool(3) : false;
+		controller.GetNetwork().Client(ip.c_str(), port, spectator);
 		return nullptr;
 	});
 
@@ -1,3 +1,5 @@
+#include <memory>
+
 namespace wargameEngine
 {
 class IScriptHandler;
@@ -7,6 +9,7 @@ class ThreadPool;
 namespace model
 {
 class Model;
+class IObject;
 }
 namespace view
 {
@@ -25,9 +28,14 @@ class Controller;
 
 void RegisterModelFunctions(IScriptHandler & handler, model::Model & model);
 void RegisterViewFunctions(IScriptHandler & handler, view::View & view, AsyncFileProvider& fileProvider);
-void RegisterControllerFunctions(IScriptHandler & handler, Controller & controller, AsyncFileProvider & fileProvider, ThreadPool & threadPool);
+void RegisterControllerFunctions(IScriptHandler & handler, Controller & controller, model::Model & model, AsyncFileProvider & fileProvider, ThreadPool & threadPool);
 void RegisterObject(IScriptHandler & handler, Controller & controller, model::Model & model, view::ModelManager & modelManager);
 void RegisterUI(IScriptHandler & handler, ui::IUIElement * uiRoot, view::TranslationManager & transMan);
-void RegisterViewport(IScriptHandler & handler, view::View & view);
+void RegisterViewport(IScriptHandler & handler, view::View & view, model::Model & model);
+
+//Scripts refer to objects by handles, so an instance of removed object does not point to freed memory
+void* ObjectToInstance(const model::IObject* object);
+//Returns nullptr if object is removed
+std::shared_ptr<model::IObject> InstanceToObject(model::Model& model, void* instance);
 }
 }
\ No newline at end of file
@@ -8,12 +8,23 @@
 #include "ScriptObjectProtocol.h"
 #include "ScriptRegisterFunctions.h"
 #include <algorithm>
+#include <cstdint>
 
 namespace wargameEngine
 {
 namespace controller
 {
 
+void* ObjectToInstance(const model::IObject* object)
+{
+	return object ? reinterpret_cast<void*>(static_cast<uintptr_t>(object->GetHandle())) : nullptr;
+}
+
+std::shared_ptr<model::IObject> InstanceToObject(model::Model& model, void* instance)
+{
+	return model.GetObjectByHandle(static_cast<model::ObjectHandle>(reinterpret_cast<uintptr_t>(instance)));
+}
+
 void RegisterObject(IScriptHandler& handler, Controller& controller, model::Model& model, view::ModelManager& modelManager)
 {
 	handler.RegisterMethod(CLASS_OBJECT, NEW_OBJECT, [&](void* /*instance*/, IArguments const& args) {
@@ -24,14 +35,14 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 		float y = args.GetFloat(3);
 		float rotation = args.GetFloat(4);
 		std::shared_ptr<model::IObject> object = controller.CreateObject(model, x, y, rotation);
-		return FunctionArgument(object.get(), L"Object");
+		return FunctionArgument(ObjectToInstance(object.get()), L"Object");
 	});
 
 	handler.RegisterMethod(CLASS_OBJECT, GET_SELECTED_OBJECT, [&](void* /*instance*/, IArguments const& args) {
 		if (args.GetCount() != 0)
 			throw std::runtime_error("no argument expected");
 		model::IObject* object = model.GetSelectedObject().get();
-		return FunctionArgument(object, L"Object");
+		return FunctionArgument(ObjectToInstance(object), L"Object");
 	});
 
 	handler.RegisterMethod(CLASS_OBJECT, GET_COUNT, [&](void* /*instance*/, IArguments const& args) {
@@ -46,7 +57,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 		size_t index = args.GetSizeT(1);
 		if (index > model.GetObjectCount())
 			return FunctionArgument();
-		return FunctionArgument(model.Get3DObject(index - 1).get(), L"Object");
+		return FunctionArgument(ObjectToInstance(model.Get3DObject(index - 1).get()), L"Object");
 	});
 
 	handler.RegisterMethod(CLASS_OBJECT, DELETE_OBJECT, [&](void* instance, IArguments const& args) {
@@ -54,7 +65,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 			throw std::runtime_error("no argument expected");
 		if (!instance)
 			throw std::runtime_error("should be called with a valid instance");
-		std::shared_ptr<model::IObject> shared_object = model.Get3DObject((model::IObject*)instance);
+		std::shared_ptr<model::IObject> shared_object = InstanceToObject(model, instance);
 		controller.DeleteObject(shared_object);
 		return nullptr;
 	});
@@ -62,7 +73,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, GET_OBJECT_MODEL, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 0)
 			throw std::runtime_error("no argument expected");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		return object->GetPathToModel();
@@ -71,7 +82,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, GET_OBJECT_X, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 0)
 			throw std::runtime_error("no argument expected");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		return object->GetX();
@@ -80,7 +91,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, GET_OBJECT_Y, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 0)
 			throw std::runtime_error("no argument expected");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		return object->GetY();
@@ -89,7 +100,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, GET_OBJECT_Z, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 0)
 			throw std::runtime_error("no argument expected");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		return object->GetZ();
@@ -98,7 +109,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, GET_OBJECT_ROTATION, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 0)
 			throw std::runtime_error("no argument expected");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		return object->GetRotation();
@@ -107,7 +118,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, MOVE_OBJECT, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 3)
 			throw std::runtime_error("3 arguments expected(x, y, z)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		object->Move(args.GetFloat(1), args.GetFloat(2), args.GetFloat(3));
@@ -117,7 +128,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, ROTATE_OBJECT, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 1)
 			throw std::runtime_error("1 argument expected(rotation)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		object->Rotate(args.GetFloat(1));
@@ -127,7 +138,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, SHOW_MESH, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 1)
 			throw std::runtime_error("1 argument expected(meshname)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		object->ShowMesh(args.GetStr(1));
@@ -137,7 +148,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, HIDE_MESH, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 1)
 			throw std::runtime_error("1 argument expected(meshname)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		object->HideMesh(args.GetStr(1));
@@ -147,7 +158,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, GET_PROPERTY, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 1)
 			throw std::runtime_error("1 argument expected (key)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		std::wstring key = args.GetWStr(1);
@@ -157,7 +168,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, SET_PROPERTY, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 2)
 			throw std::runtime_error("2 arguments expected (key, value)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		std::wstring key = args.GetWStr(1);
@@ -170,7 +181,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, SET_SELECTABLE, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 1)
 			throw std::runtime_error("1 argument expected(isSelectable)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		object->SetSelectable(args.GetBool(1));
@@ -180,7 +191,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, SET_MOVE_LIMIT, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() < 1)
 			throw std::runtime_error("at least 1 argument expected(moveLimiterType)");
-		auto object = model.Get3DObject(reinterpret_cast<model::IObject*>(instance));
+		auto object = InstanceToObject(model, instance);
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		std::string limiterType = args.GetStr(1);
@@ -242,7 +253,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, SELECT_OBJECT, [&](void* /*instance*/, IArguments const& args) {
 		if (args.GetCount() != 1)
 			throw std::runtime_error("1 argument expected (object to select)");
-		std::shared_ptr<model::IObject> object = model.Get3DObject((model::IObject*)args.GetClassInstance(1));
+		std::shared_ptr<model::IObject> object = InstanceToObject(model, args.GetClassInstance(1));
 		model.SelectObject(object);
 		return nullptr;
 	});
@@ -250,15 +261,14 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, OBJECT_EQUALS, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 1)
 			throw std::runtime_error("1 argument expected (secondObject)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
-		model::IObject* obj2 = (model::IObject*)args.GetClassInstance(1);
-		return object == obj2;
+		//Handle of an object is never reused by another one
+		return instance == args.GetClassInstance(1);
 	});
 
 	handler.RegisterMethod(CLASS_OBJECT, OBJECT_IS_GROUP, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 0)
 			throw std::runtime_error("no argument expected");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		return object->IsGroup();
@@ -267,7 +277,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, GET_GROUP_CHILDREN_COUNT, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 0)
 			throw std::runtime_error("no argument expected");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		if (object)
@@ -283,7 +293,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, GET_GROUP_CHILDREN_AT, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 1)
 			throw std::runtime_error("1 argument expected(index)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		size_t index = args.GetSizeT(1);
@@ -292,7 +302,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 			model::ObjectGroup* group = (model::ObjectGroup*)object;
 			if (index > group->GetCount())
 				FunctionArgument(NULL, L"Object");
-			FunctionArgument(group->GetChild(index - 1).get(), L"Object");
+			FunctionArgument(ObjectToInstance(group->GetChild(index - 1).get()), L"Object");
 		}
 		return nullptr;
 	});
@@ -301,7 +311,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 		int n = args.GetCount();
 		if (n < 1 || n > 3)
 			throw std::runtime_error("1 to 3 argument expected (animation, loop mode, speed)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		std::string anim = args.GetStr(1);
@@ -329,7 +339,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, GET_ANIMATIONS, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 0)
 			throw std::runtime_error("no arguments expected");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		std::vector<std::string> anims = modelManager.GetAnimations(object->GetPathToModel());
@@ -339,7 +349,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, ADDITIONAL_MODEL, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 1)
 			throw std::runtime_error("1 argument expected(model)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		object->AddSecondaryModel(args.GetPath(1));
@@ -349,7 +359,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, REMOVE_ADDITIONAL_MODEL, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 1)
 			throw std::runtime_error("1 argument expected(model)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		object->RemoveSecondaryModel(args.GetPath(1));
@@ -359,7 +369,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, GO_TO, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 5)
 			throw std::runtime_error("5 argument expected(x, y, speed, animation, animationSpeed)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		float x = args.GetFloat(1);
@@ -375,7 +385,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, APPLY_TEAMCOLOR, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 4)
 			throw std::runtime_error("4 argument expected(mask suffix, r, g, b)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		std::wstring suffix = args.GetWStr(1);
@@ -389,7 +399,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, REPLACE_TEXTURE, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 2)
 			throw std::runtime_error("2 argument expected(old texture, new texture)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		Path oldt = args.GetPath(1);
@@ -401,7 +411,7 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 	handler.RegisterMethod(CLASS_OBJECT, MOVE_PATH, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 4)
 			throw std::runtime_error("4 argument expected(positionList, rotationList, timePointList, interpolation)");
-		model::IObject* object = reinterpret_cast<model::IObject*>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object)
 			throw std::runtime_error("should be called with a valid instance");
 		const auto positions = args.GetFloatArray(1);
@@ -421,50 +431,50 @@ void RegisterObject(IScriptHandler& handler, Controller& controller, model::Mode
 
 	handler.RegisterProperty(CLASS_OBJECT, PROPERTY_X, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 1) throw std::runtime_error("1 value expected(x)");
-		model::IObject* object = reinterpret_cast<model::IObject *>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object) throw std::runtime_error("should be called with a valid instance");
 		float x = args.GetFloat(1);
-		object->SetCoords(x, object->GetY(), object->GetZ()); }, [](void* instance) {
-		model::IObject* object = reinterpret_cast<model::IObject *>(instance);
+		object->SetCoords(x, object->GetY(), object->GetZ()); }, [&](void* instance) {
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object) throw std::runtime_error("should be called with a valid instance");
 		return object->GetX(); });
 
 	handler.RegisterProperty(CLASS_OBJECT, PROPERTY_Y, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 1) throw std::runtime_error("1 value expected(y)");
-		model::IObject* object = reinterpret_cast<model::IObject *>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object) throw std::runtime_error("should be called with a valid instance");
 		float y = args.GetFloat(1);
-		object->SetCoords(object->GetX(), y, object->GetZ()); }, [](void* instance) {
-		model::IObject* object = reinterpret_cast<model::IObject *>(instance);
+		object->SetCoords(object->GetX(), y, object->GetZ()); }, [&](void* instance) {
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object) throw std::runtime_error("should be called with a valid instance");
 		return object->GetY(); });
 
 	handler.RegisterProperty(CLASS_OBJECT, PROPERTY_Z, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 1) throw std::runtime_error("1 value expected(z)");
-		model::IObject* object = reinterpret_cast<model::IObject *>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object) throw std::runtime_error("should be called with a valid instance");
 		float z = args.GetFloat(1);
-		object->SetCoords(object->GetX(), object->GetY(), z); }, [](void* instance) {
-		model::IObject* object = reinterpret_cast<model::IObject *>(instance);
+		object->SetCoords(object->GetX(), object->GetY(), z); }, [&](void* instance) {
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object) throw std::runtime_error("should be called with a valid instance");
 		return object->GetZ(); });
 
 	handler.RegisterProperty(CLASS_OBJECT, PROPERTY_ROTATION, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 1) throw std::runtime_error("1 value expected(rotation)");
-		model::IObject* object = reinterpret_cast<model::IObject *>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object) throw std::runtime_error("should be called with a valid instance");
 		float rotation = args.GetFloat(1);
-		object->Rotate(object->GetRotation() - rotation); }, [](void* instance) {
-		model::IObject* object = reinterpret_cast<model::IObject *>(instance);
+		object->Rotate(object->GetRotation() - rotation); }, [&](void* instance) {
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object) throw std::runtime_error("should be called with a valid instance");
 		return object->GetRotation(); });
 
 	handler.RegisterProperty(CLASS_OBJECT, PROPERTY_SELECTABLE, [&](void* instance, IArguments const& args) {
 		if (args.GetCount() != 1) throw std::runtime_error("1 value expected(selectable)");
-		model::IObject* object = reinterpret_cast<model::IObject *>(instance);
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object) throw std::runtime_error("should be called with a valid instance");
-		object->SetSelectable(args.GetBool(1)); }, [](void* instance) {
-		model::IObject* object = reinterpret_cast<model::IObject *>(instance);
+		object->SetSelectable(args.GetBool(1)); }, [&](void* instance) {
+		model::IObject* object = InstanceToObject(model, instance).get();
 		if (!object) throw std::runtime_error("should be called with a valid instance");
 		return object->IsSelectable(); });
 
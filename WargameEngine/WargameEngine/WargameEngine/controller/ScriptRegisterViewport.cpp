@@ -1,4 +1,5 @@
 #include "../IScriptHandler.h"
+#include "../model/Model.h"
 #include "../view/View.h"
 #include "ScriptRegisterFunctions.h"
 #include "ScriptViewportProtocol.h"
@@ -7,7 +8,7 @@ namespace wargameEngine
 {
 namespace controller
 {
-void RegisterViewport(IScriptHandler& handler, view::View& view)
+void RegisterViewport(IScriptHandler& handler, view::View& view, model::Model& model)
 {
 	handler.RegisterMethod(CLASS_VIEWPORT, NEW_VIEWPORT, [&](void*, IArguments const& args) {
 		if (args.GetCount() != 5 && args.GetCount() != 6)
@@ -145,7 +146,7 @@ void RegisterViewport(IScriptHandler& handler, view::View& view)
 			throw std::runtime_error("4 argument expected (object, offsetX, offsetY, offsetZ)");
 		auto viewport = instance ? static_cast<view::Viewport*>(instance) : &view.GetViewport(0);
 		auto& camera = viewport->GetCamera();
-		auto object = reinterpret_cast<model::IObject*>(args.GetClassInstance(1));
+		auto object = InstanceToObject(model, args.GetClassInstance(1)).get();
 		CVector3f offset(args.GetFloat(2), args.GetFloat(3), args.GetFloat(4));
 		camera.AttachToObject(object, offset);
 		return nullptr;
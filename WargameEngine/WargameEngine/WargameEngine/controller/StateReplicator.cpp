@@ -0,0 +1,352 @@
+#include "StateReplicator.h"
+#include "../IMemoryStream.h"
+#include "../Utils.h"
+#include "../model/Model.h"
+#include "../model/Object.h"
+#include <algorithm>
+#include <math.h>
+
+namespace wargameEngine
+{
+namespace controller
+{
+namespace
+{
+enum eEntryFlags : unsigned char
+{
+	CREATED = 1,
+	COORDS = 2,
+	ROTATION = 4,
+	PROPERTIES = 8,
+	OWNED = 16,
+};
+//Positions are sent with 1/1024 unit precision, rotations with 1/65536 of full circle
+const float POSITION_SCALE = 1024.0f;
+const float ROTATION_SCALE = 65536.0f / 360.0f;
+
+void WriteVector(IWriteMemoryStream& stream, CVector3f const& vector, float scale)
+{
+	for (int i = 0; i < 3; ++i)
+	{
+		stream.WriteQuantizedFloat(vector[i], scale);
+	}
+}
+
+CVector3f ReadVector(IReadMemoryStream& stream, float scale)
+{
+	CVector3f result;
+	result.x = stream.ReadQuantizedFloat(scale);
+	result.y = stream.ReadQuantizedFloat(scale);
+	result.z = stream.ReadQuantizedFloat(scale);
+	return result;
+}
+
+CVector3f WrapRotations(CVector3f const& rotations)
+{
+	return CVector3f(remainderf(rotations.x, 360.0f), remainderf(rotations.y, 360.0f), remainderf(rotations.z, 360.0f));
+}
+
+void WriteProperties(IWriteMemoryStream& stream, std::unordered_map<std::wstring, std::wstring> const& properties)
+{
+	stream.WriteVarint(static_cast<uint32_t>(properties.size()));
+	for (auto& property : properties)
+	{
+		stream.WriteWString(property.first);
+		stream.WriteWString(property.second);
+	}
+}
+
+template<class Setter>
+void ReadProperties(IReadMemoryStream& stream, Setter const& setter)
+{
+	uint32_t count = stream.ReadVarint();
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		std::wstring key = stream.ReadWString();
+		std::wstring value = stream.ReadWString();
+		setter(key, value);
+	}
+}
+}
+
+StateReplicator::StateReplicator(model::Model& model)
+	: m_model(model)
+{
+	for (size_t i = 0; i < m_model.GetObjectCount(); ++i)
+	{
+		OnObjectCreated(m_model.Get3DObject(i).get());
+	}
+	m_creationConnection = m_model.DoOnObjectCreation(std::bind(&StateReplicator::OnObjectCreated, this, std::placeholders::_1));
+	m_removeConnection = m_model.DoOnObjectRemove(std::bind(&StateReplicator::OnObjectRemoved, this, std::placeholders::_1));
+}
+
+uint32_t StateReplicator::MarkChanged()
+{
+	m_lastChange = m_sequence + 1;
+	return m_lastChange;
+}
+
+void StateReplicator::OnObjectCreated(model::IObject* object)
+{
+	const uint32_t sequence = MarkChanged();
+	sObjectRecord& record = m_objects[object];
+	record.id = object->GetHandle();
+	record.createdSequence = record.coordsSequence = record.rotationSequence = record.propertiesSequence = sequence;
+	record.coordsConnection = object->DoOnCoordsChange([this, &record](CVector3f const&, CVector3f const&) {
+		record.coordsSequence = MarkChanged();
+	});
+	record.rotationConnection = object->DoOnRotationChange([this, &record](CVector3f const&, CVector3f const&) {
+		record.rotationSequence = MarkChanged();
+	});
+	record.propertyConnection = object->DoOnPropertyChange([this, &record](std::wstring const&, std::wstring const&) {
+		record.propertiesSequence = MarkChanged();
+	});
+}
+
+void StateReplicator::OnObjectRemoved(model::IObject* object)
+{
+	auto it = m_objects.find(object);
+	if (it != m_objects.end())
+	{
+		m_removedObjects.push_back({ it->second.id, MarkChanged() });
+		m_objects.erase(it);
+	}
+	auto remote = m_remoteIds.find(object);
+	if (remote != m_remoteIds.end())
+	{
+		m_remoteObjects.erase(remote->second);
+		m_remoteIds.erase(remote);
+	}
+}
+
+bool StateReplicator::HasChanges()
+{
+	//Model does not signal global property changes and there are few of them, so they are compared
+	if (m_model.GetAllProperties() != m_globalProperties)
+	{
+		m_globalProperties = m_model.GetAllProperties();
+		m_globalPropertiesSequence = MarkChanged();
+	}
+	return m_lastChange > m_sequence;
+}
+
+uint32_t StateReplicator::WriteSnapshot(IWriteMemoryStream& stream) const
+{
+	const size_t count = m_model.GetObjectCount();
+	stream.WriteVarint(m_sequence);
+	stream.WriteVarint(static_cast<uint32_t>(count));
+	for (size_t i = 0; i < count; ++i)
+	{
+		stream.WriteVarint(m_objects.at(m_model.Get3DObject(i).get()).id);
+	}
+	return m_sequence;
+}
+
+uint32_t StateReplicator::CommitChanges()
+{
+	HasChanges();
+	return ++m_sequence;
+}
+
+void StateReplicator::WriteDelta(IWriteMemoryStream& stream, uint32_t baseline, OwnHandleGetter const& getOwnHandle) const
+{
+	stream.WriteVarint(m_sequence);
+	const bool globalPropertiesChanged = m_globalPropertiesSequence > baseline;
+	stream.WriteBool(globalPropertiesChanged);
+	if (globalPropertiesChanged)
+	{
+		WriteProperties(stream, m_globalProperties);
+	}
+	const auto removedBegin = std::find_if(m_removedObjects.begin(), m_removedObjects.end(), [baseline](sRemovedObject const& removed) {
+		return removed.sequence > baseline;
+	});
+	stream.WriteVarint(static_cast<uint32_t>(m_removedObjects.end() - removedBegin));
+	for (auto it = removedBegin; it != m_removedObjects.end(); ++it)
+	{
+		stream.WriteVarint(it->id);
+	}
+	struct sChangedObject
+	{
+		model::IObject* object;
+		uint32_t id;
+		unsigned char flags;
+		model::ObjectHandle ownHandle;
+	};
+	std::vector<sChangedObject> changedObjects;
+	for (auto& pair : m_objects)
+	{
+		sObjectRecord const& record = pair.second;
+		unsigned char flags = 0;
+		if (record.createdSequence > baseline)
+			flags = CREATED | COORDS | ROTATION | PROPERTIES;
+		if (record.coordsSequence > baseline)
+			flags |= COORDS;
+		if (record.rotationSequence > baseline)
+			flags |= ROTATION;
+		if (record.propertiesSequence > baseline)
+			flags |= PROPERTIES;
+		model::ObjectHandle ownHandle = model::INVALID_OBJECT_HANDLE;
+		if ((flags & CREATED) && getOwnHandle)
+		{
+			ownHandle = getOwnHandle(pair.first);
+			if (ownHandle != model::INVALID_OBJECT_HANDLE)
+				flags |= OWNED;
+		}
+		if (flags)
+		{
+			changedObjects.push_back({ pair.first, record.id, flags, ownHandle });
+		}
+	}
+	stream.WriteVarint(static_cast<uint32_t>(changedObjects.size()));
+	for (auto& changed : changedObjects)
+	{
+		model::IObject* object = changed.object;
+		const unsigned char flags = changed.flags;
+		stream.WriteVarint(changed.id);
+		stream.WriteByte(flags);
+		if (flags & CREATED)
+		{
+			stream.WriteString(to_string(object->GetPathToModel()));
+			if (flags & OWNED)
+			{
+				stream.WriteVarint(changed.ownHandle);
+			}
+		}
+		if (flags & COORDS)
+		{
+			WriteVector(stream, object->GetCoords(), POSITION_SCALE);
+		}
+		if (flags & ROTATION)
+		{
+			WriteVector(stream, WrapRotations(object->GetRotations()), ROTATION_SCALE);
+		}
+		if (flags & PROPERTIES)
+		{
+			WriteProperties(stream, object->GetAllProperties());
+		}
+	}
+}
+
+void StateReplicator::ForgetRemovedObjects(uint32_t baseline)
+{
+	auto it = std::find_if(m_removedObjects.begin(), m_removedObjects.end(), [baseline](sRemovedObject const& removed) {
+		return removed.sequence > baseline;
+	});
+	m_removedObjects.erase(m_removedObjects.begin(), it);
+}
+
+uint32_t StateReplicator::ReadSnapshot(IReadMemoryStream& stream)
+{
+	const uint32_t sequence = stream.ReadVarint();
+	const uint32_t count = stream.ReadVarint();
+	if (count != m_model.GetObjectCount())
+		throw std::runtime_error("Snapshot does not match loaded state");
+	//Loaded state replaces the whole model, so removals made before are not needed by anyone
+	m_removedObjects.clear();
+	m_remoteObjects.clear();
+	m_remoteIds.clear();
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const uint32_t id = stream.ReadVarint();
+		model::IObject* object = m_model.Get3DObject(i).get();
+		m_remoteObjects[id] = object;
+		m_remoteIds[object] = id;
+	}
+	return sequence;
+}
+
+uint32_t StateReplicator::ReadDelta(IReadMemoryStream& stream, ObjectFindHandler const& findObject, ObjectCreatedHandler const& onCreated, ObjectRemovedHandler const& onRemoved)
+{
+	const uint32_t sequence = stream.ReadVarint();
+	//Only clients read deltas and they never write them, so own removals are not kept
+	m_removedObjects.clear();
+	if (stream.ReadBool())
+	{
+		//Host sends the whole set, so properties missing from it were removed there
+		std::unordered_map<std::wstring, std::wstring> properties;
+		ReadProperties(stream, [&properties](std::wstring const& key, std::wstring const& value) {
+			properties[key] = value;
+		});
+		std::vector<std::wstring> removed;
+		for (auto& property : m_model.GetAllProperties())
+		{
+			if (properties.find(property.first) == properties.end())
+			{
+				removed.push_back(property.first);
+			}
+		}
+		for (auto& key : removed)
+		{
+			m_model.RemoveProperty(key);
+		}
+		for (auto& property : properties)
+		{
+			m_model.SetProperty(property.first, property.second);
+		}
+	}
+	const uint32_t removedCount = stream.ReadVarint();
+	for (uint32_t i = 0; i < removedCount; ++i)
+	{
+		//Delta may repeat removals that are already applied
+		auto it = m_remoteObjects.find(stream.ReadVarint());
+		if (it != m_remoteObjects.end())
+		{
+			model::IObject* object = it->second;
+			onRemoved(object);
+			m_model.DeleteObjectByPtr(m_model.Get3DObject(object));
+		}
+	}
+	const uint32_t changedCount = stream.ReadVarint();
+	for (uint32_t i = 0; i < changedCount; ++i)
+	{
+		const uint32_t id = stream.ReadVarint();
+		const unsigned char flags = stream.ReadByte();
+		auto it = m_remoteObjects.find(id);
+		std::shared_ptr<model::IObject> created;
+		if (flags & CREATED)
+		{
+			Path path = make_path(stream.ReadString());
+			const model::ObjectHandle ownHandle = (flags & OWNED) ? stream.ReadVarint() : model::INVALID_OBJECT_HANDLE;
+			if (it == m_remoteObjects.end())
+			{
+				if (model::IObject* existing = findObject(id, ownHandle))
+				{
+					it = m_remoteObjects.emplace(id, existing).first;
+					m_remoteIds[existing] = id;
+				}
+				else
+				{
+					created = std::make_shared<model::Object>(path, CVector3f(), 0.0f);
+					it = m_remoteObjects.emplace(id, created.get()).first;
+					m_remoteIds[created.get()] = id;
+					onCreated(created, id);
+				}
+			}
+		}
+		if (it == m_remoteObjects.end())
+			throw std::runtime_error("Delta references unknown object");
+		model::IObject* object = it->second;
+		if (flags & COORDS)
+		{
+			object->SetCoords(ReadVector(stream, POSITION_SCALE));
+		}
+		if (flags & ROTATION)
+		{
+			object->SetRotations(ReadVector(stream, ROTATION_SCALE));
+		}
+		//Object properties can only be set, so they are not replaced like global ones
+		if (flags & PROPERTIES)
+		{
+			ReadProperties(stream, [object](std::wstring const& key, std::wstring const& value) {
+				object->SetProperty(key, value);
+			});
+		}
+		if (created)
+		{
+			m_model.AddObject(created);
+		}
+	}
+	return sequence;
+}
+}
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "../Signal.h"
+#include "../model/ObjectHandle.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wargameEngine
+{
+class IReadMemoryStream;
+class IWriteMemoryStream;
+
+namespace model
+{
+class IObject;
+class Model;
+}
+
+namespace controller
+{
+//Replicates model with snapshots and deltas. Host stamps every object change with the sequence number of the next delta,
+//so delta against baseline contains all changes made after it. Deltas carry absolute quantized values instead of differences,
+//so client can apply delta to any state that is not older than its baseline. Every peer gets a delta against its own baseline.
+//Objects are identified by host handles
+class StateReplicator
+{
+public:
+	typedef std::function<void(std::shared_ptr<model::IObject> const& object, model::ObjectHandle handle)> ObjectCreatedHandler;
+	typedef std::function<void(model::IObject* object)> ObjectRemovedHandler;
+	//Returns local object that already represents host object (created by command or by this peer itself) or nullptr
+	typedef std::function<model::IObject*(model::ObjectHandle handle, model::ObjectHandle ownHandle)> ObjectFindHandler;
+	//Returns handle of object in the peer that has created it or INVALID_OBJECT_HANDLE
+	typedef std::function<model::ObjectHandle(model::IObject* object)> OwnHandleGetter;
+
+	StateReplicator(model::Model& model);
+
+	//Host side
+	//Returns true if model has changed since last delta
+	bool HasChanges();
+	//Appends object ids to full state dump. Returns sequence number that becomes baseline of clients that receive the dump
+	uint32_t WriteSnapshot(IWriteMemoryStream& stream) const;
+	//Closes current delta, so changes made after it go to the next one. Returns sequence number of the delta
+	uint32_t CommitChanges();
+	//Writes all changes made after baseline up to last committed delta
+	void WriteDelta(IWriteMemoryStream& stream, uint32_t baseline, OwnHandleGetter const& getOwnHandle = OwnHandleGetter()) const;
+	//Forgets removed objects once all peers have acknowledged baseline
+	void ForgetRemovedObjects(uint32_t baseline);
+
+	//Client side
+	//Reads data appended by WriteSnapshot. Must be called right after state is loaded. Returns snapshot sequence number
+	uint32_t ReadSnapshot(IReadMemoryStream& stream);
+	//Applies delta and returns its sequence number
+	uint32_t ReadDelta(IReadMemoryStream& stream, ObjectFindHandler const& findObject, ObjectCreatedHandler const& onCreated, ObjectRemovedHandler const& onRemoved);
+
+private:
+	struct sObjectRecord
+	{
+		uint32_t id;
+		uint32_t createdSequence;
+		uint32_t coordsSequence;
+		uint32_t rotationSequence;
+		uint32_t propertiesSequence;
+		signals::ScopedConnection coordsConnection;
+		signals::ScopedConnection rotationConnection;
+		signals::ScopedConnection propertyConnection;
+	};
+	struct sRemovedObject
+	{
+		uint32_t id;
+		uint32_t sequence;
+	};
+
+	void OnObjectCreated(model::IObject* object);
+	void OnObjectRemoved(model::IObject* object);
+	uint32_t MarkChanged();
+
+	model::Model& m_model;
+	std::unordered_map<model::IObject*, sObjectRecord> m_objects;
+	std::vector<sRemovedObject> m_removedObjects;
+	std::unordered_map<std::wstring, std::wstring> m_globalProperties;
+	uint32_t m_globalPropertiesSequence = 0;
+	uint32_t m_sequence = 0;
+	uint32_t m_lastChange = 0;
+	std::unordered_map<uint32_t, model::IObject*> m_remoteObjects;
+	std::unordered_map<model::IObject*, uint32_t> m_remoteIds;
+	signals::ScopedConnection m_creationConnection;
+	signals::ScopedConnection m_removeConnection;
+};
+}
+}
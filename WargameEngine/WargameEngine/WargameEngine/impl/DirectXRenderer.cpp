@@ -473,6 +473,11 @@ void CDirectXRenderer::AddVertexAttribute(IVertexBuffer& buffer, const std::stri
 	reinterpret_cast<CDirectXVertexBuffer&>(buffer).AddVertexAttribute(attribute, elementSize, count, type, values, perInstance);
 }
 
+void CDirectXRenderer::AddVertexAttribute(IVertexBuffer& /*buffer*/, const std::string& attribute, int elementSize, IVertexAttribCache const& cache, IShaderManager::Format type, bool perInstance, size_t offset)
+{
+	m_shaderManager.SetVertexAttribute(attribute, cache, elementSize, 0, type, perInstance, offset);
+}
+
 void CDirectXRenderer::SetColor(const float * color)
 {
 	m_shaderManager.SetColor(color);
@@ -7,6 +7,7 @@
 #include "ShaderManagerDirectX.h"
 
 using wargameEngine::view::IVertexBuffer;
+using wargameEngine::view::IVertexAttribCache;
 using wargameEngine::Path;
 using wargameEngine::view::ICachedTexture;
 using wargameEngine::view::IOcclusionQuery;
@@ -38,6 +39,7 @@ public:
 	void DrawIndirect(IVertexBuffer& buffer, const array_view<IndirectDraw>& indirectList, bool indexed) override;
 	void SetIndexBuffer(IVertexBuffer& buffer, const unsigned int* indexPtr, size_t indexesSize) override;
 	void AddVertexAttribute(IVertexBuffer& buffer, const std::string& attribute, int elementSize, size_t count, IShaderManager::Format type, const void* values, bool perInstance = false) override;
+	void AddVertexAttribute(IVertexBuffer& buffer, const std::string& attribute, int elementSize, IVertexAttribCache const& cache, IShaderManager::Format type, bool perInstance = false, size_t offset = 0) override;
 
 	void PushMatrix() override;
 	void PopMatrix() override;
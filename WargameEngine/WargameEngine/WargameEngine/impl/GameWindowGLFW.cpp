@@ -105,6 +105,7 @@ void CGameWindowGLFW::LaunchMainLoop()
 			if (m_onDraw)
 			{
 				m_onDraw();
+				m_renderer->EndFrame();
 			}
 			if (compositor)
 			{
@@ -30,6 +30,7 @@ void CGameWindowGLUT::OnDrawScene()
 	{
 		g_instance->m_onDraw();
 	}
+	g_instance->m_renderer->EndFrame();
 	glutSwapBuffers();
 }
 
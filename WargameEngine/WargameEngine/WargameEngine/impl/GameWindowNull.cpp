@@ -0,0 +1,120 @@
+#include "GameWindowNull.h"
+#include "../view/InputBase.h"
+#include "NullRenderer.h"
+
+using namespace wargameEngine;
+using namespace view;
+
+namespace
+{
+class CInputNull : public InputBase
+{
+public:
+	void EnableCursor(bool /*enable*/) override {}
+	int GetMouseX() const override { return 0; }
+	int GetMouseY() const override { return 0; }
+	int GetModifiers() const override { return 0; }
+	bool IsKeyPressed(VirtualKey /*key*/) const override { return false; }
+};
+}
+
+CGameWindowNull::CGameWindowNull(int width, int height)
+	: m_width(width)
+	, m_height(height)
+	, m_input(std::make_unique<CInputNull>())
+	, m_renderer(std::make_unique<CNullRenderer>())
+{
+}
+
+CGameWindowNull::~CGameWindowNull()
+{
+}
+
+void CGameWindowNull::LaunchMainLoop()
+{
+	for (size_t frame = 0; !m_onFrame || m_onFrame(frame); ++frame)
+	{
+		if (m_onDraw)
+		{
+			m_onDraw();
+		}
+	}
+	if (m_onShutdown)
+	{
+		m_onShutdown();
+	}
+}
+
+void CGameWindowNull::DoOnFrame(std::function<bool(size_t frame)> const& handler)
+{
+	m_onFrame = handler;
+}
+
+void CGameWindowNull::DoOnDrawScene(std::function<void()> const& handler)
+{
+	m_onDraw = handler;
+}
+
+void CGameWindowNull::DoOnResize(std::function<void(int, int)> const& handler)
+{
+	m_onResize = handler;
+	m_onResize(m_width, m_height);
+}
+
+void CGameWindowNull::DoOnShutdown(std::function<void()> const& handler)
+{
+	m_onShutdown = handler;
+}
+
+void CGameWindowNull::ResizeWindow(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+	if (m_onResize)
+	{
+		m_onResize(width, height);
+	}
+}
+
+void CGameWindowNull::SetTitle(std::wstring const& /*title*/)
+{
+}
+
+void CGameWindowNull::ToggleFullscreen()
+{
+}
+
+void CGameWindowNull::EnableMultisampling(bool /*enable*/, int /*level*/)
+{
+}
+
+bool CGameWindowNull::EnableVRMode(bool show, VRViewportFactory const& /*viewportFactory*/)
+{
+	return !show;
+}
+
+IInput& CGameWindowNull::GetInput()
+{
+	return *m_input;
+}
+
+IRenderer& CGameWindowNull::GetRenderer()
+{
+	return *m_renderer;
+}
+
+IViewHelper& CGameWindowNull::GetViewHelper()
+{
+	return *m_renderer;
+}
+
+void CGameWindowNull::GetWindowSize(int& width, int& height)
+{
+	width = m_width;
+	height = m_height;
+}
+
+CNullRenderer& CGameWindowNull::GetNullRenderer()
+{
+	return *m_renderer;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "../view/IWindow.h"
+#include <functional>
+#include <memory>
+
+class CNullRenderer;
+
+//Window without screen and input for headless runs. Everything is drawn by null renderer
+class CGameWindowNull : public wargameEngine::view::IWindow
+{
+public:
+	CGameWindowNull(int width = 1280, int height = 720);
+	~CGameWindowNull();
+	//Main loop draws frames until frame handler returns false. Handler is called before every frame with its index
+	void LaunchMainLoop() override;
+	void DoOnFrame(std::function<bool(size_t frame)> const& handler);
+	void DoOnDrawScene(std::function<void()> const& handler) override;
+	void DoOnResize(std::function<void(int, int)> const& handler) override;
+	void DoOnShutdown(std::function<void()> const& handler) override;
+	void ResizeWindow(int width, int height) override;
+	void SetTitle(std::wstring const& title) override;
+	void ToggleFullscreen() override;
+	void EnableMultisampling(bool enable, int level = 1.0f) override;
+	bool EnableVRMode(bool show, VRViewportFactory const& viewportFactory = VRViewportFactory()) override;
+	wargameEngine::view::IInput& GetInput() override;
+	wargameEngine::view::IRenderer& GetRenderer() override;
+	wargameEngine::view::IViewHelper& GetViewHelper() override;
+	void GetWindowSize(int& width, int& height) override;
+
+	CNullRenderer& GetNullRenderer();
+
+private:
+	int m_width;
+	int m_height;
+	std::unique_ptr<wargameEngine::view::IInput> m_input;
+	std::unique_ptr<CNullRenderer> m_renderer;
+
+	std::function<bool(size_t)> m_onFrame;
+	std::function<void()> m_onDraw;
+	std::function<void(int, int)> m_onResize;
+	std::function<void()> m_onShutdown;
+};
@@ -7,4 +7,6 @@ public:
 	virtual ~IOpenGLRenderer() = default;
 
 	virtual void EnableMultisampling(bool enable) = 0;
+	//Called by window after frame is drawn, before buffers are swapped
+	virtual void EndFrame() = 0;
 };
\ No newline at end of file
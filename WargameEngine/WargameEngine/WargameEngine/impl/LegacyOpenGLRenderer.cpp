@@ -567,6 +567,11 @@ void CLegacyGLRenderer::AddVertexAttribute(IVertexBuffer& buffer, const std::str
 
 }
 
+void CLegacyGLRenderer::AddVertexAttribute(IVertexBuffer& /*buffer*/, const std::string& attribute, int elementSize, IVertexAttribCache const& cache, IShaderManager::Format type, bool perInstance /*= false*/, size_t offset /*= 0*/)
+{
+	m_shaderManager.SetVertexAttribute(attribute, cache, elementSize, 0, type, perInstance, offset);
+}
+
 std::vector<double> Matrix2DoubleArray(Matrix4F const& matrix)
 {
 	std::vector<double> result(16);
@@ -843,6 +848,10 @@ void CLegacyGLRenderer::EnableMultisampling(bool enable)
 	}
 }
 
+void CLegacyGLRenderer::EndFrame()
+{
+}
+
 std::unique_ptr<IOcclusionQuery> CLegacyGLRenderer::CreateOcclusionQuery()
 {
 	return std::make_unique<CLegacyGLOcclusionQuery>();
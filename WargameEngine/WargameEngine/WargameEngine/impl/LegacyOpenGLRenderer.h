@@ -3,6 +3,7 @@
 #include "ShaderManagerLegacyGL.h"
 
 using wargameEngine::view::IVertexBuffer;
+using wargameEngine::view::IVertexAttribCache;
 using wargameEngine::view::ICachedTexture;
 using wargameEngine::view::IShaderManager;
 
@@ -20,6 +21,7 @@ public:
 	virtual void DrawIndirect(IVertexBuffer& buffer, const array_view<IndirectDraw>& indirectList, bool indexed) override;
 	virtual void SetIndexBuffer(IVertexBuffer& buffer, const unsigned int* indexPtr, size_t indexesSize) override;
 	virtual void AddVertexAttribute(IVertexBuffer& buffer, const std::string& attribute, int elementSize, size_t count, IShaderManager::Format type, const void* values, bool perInstance = false) override;
+	virtual void AddVertexAttribute(IVertexBuffer& buffer, const std::string& attribute, int elementSize, IVertexAttribCache const& cache, IShaderManager::Format type, bool perInstance = false, size_t offset = 0) override;
 
 	virtual void PushMatrix() override;
 	virtual void PopMatrix() override;
@@ -80,6 +82,7 @@ public:
 	virtual std::string GetName() const override;
 	virtual bool SupportsFeature(Feature feature) const override;
 	virtual void EnableMultisampling(bool enable) override;
+	virtual void EndFrame() override;
 private:
 	void ResetViewMatrix();
 	wargameEngine::view::TextureManager* m_textureManager;
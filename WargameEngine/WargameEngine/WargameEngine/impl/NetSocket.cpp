@@ -3,12 +3,18 @@
 #include <ws2tcpip.h>
 #pragma comment(lib, "Ws2_32.lib")
 #define GET_ERROR WSAGetLastError();
+#define poll WSAPoll
+typedef WSAPOLLFD pollfd;
+typedef int socklen_t;
 #else
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
+#include <poll.h>
 #include <unistd.h>
 #include <errno.h>
 #define INVALID_SOCKET -1
@@ -16,10 +22,16 @@
 #define SOCKET int
 #define WSAEWOULDBLOCK EWOULDBLOCK
 #define WSAECONNRESET ECONNRESET
+#define WSAEINPROGRESS EINPROGRESS
 #define GET_ERROR errno
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
 #endif
 #include "../LogWriter.h"
+#include <algorithm>
 #include <cstring>
+#include <vector>
 
 using namespace wargameEngine;
 
@@ -94,123 +106,476 @@ void LogError()
 
 }
 
-void CNetSocket::InitHost(unsigned short port)
+namespace
+{
+//More buffers than any message needs, so vectored writes never have to be split
+const size_t MAX_BUFFERS = 16;
+
+int GetError()
+{
+	return GET_ERROR;
+}
+
+bool IsWouldBlock(int error)
 {
-	if(!InitSocket()) return;
-	m_socket = socket(AF_INET, SOCK_STREAM, 0/*IPPROTO_TCP*/);
-	if (m_socket == INVALID_SOCKET)   // winsock2.h: #define INVALID_SOCKET (SOCKET)(~0)
-	{
-		LogError();
-		return;
-	}
-	m_sockAddr = new struct sockaddr_in;
-	memset(m_sockAddr, 0, sizeof (struct sockaddr_in));
-	if (!ChangeAddress(port)) LogWriter::WriteLine("Net error. Cannot bind to port");
-	listen(m_socket, 10);
-	LogWriter::WriteLine("Net OK. Host is up and running.");
-	sockaddr_in addr;
-	socklen_t size = sizeof(struct sockaddr_in);
-	SOCKET socket = accept(m_socket, (struct sockaddr *)&addr, &size);
-	if (socket == INVALID_SOCKET)
-	{
-		LogError();
-		return;
-	}
 #ifdef _WINDOWS
-	closesocket(m_socket);
+	return error == WSAEWOULDBLOCK;
 #else
-	close(m_socket);
+	return error == EWOULDBLOCK || error == EAGAIN || error == EINTR;
 #endif
-	m_socket = socket;
+}
+
+void CloseSocket(SOCKET socket)
+{
+#ifdef _WINDOWS
+	closesocket(socket);
+#else
+	close(socket);
+#endif
+}
+
+bool SetNonBlocking(SOCKET socket)
+{
 	unsigned long iMode = 1UL;
 #ifdef _WINDOWS
-        int error = ioctlsocket(m_socket, FIONBIO, &iMode);
+	int error = ioctlsocket(socket, FIONBIO, &iMode);
 #else
-        int error = ioctl(m_socket, FIONBIO, &iMode);
+	int error = ioctl(socket, FIONBIO, &iMode);
 #endif
-	
 	if (error == SOCKET_ERROR)
 	{
 		LogError();
-		return;
+		return false;
 	}
-	char textAddr[INET_ADDRSTRLEN];
-	inet_ntop(AF_INET, &addr.sin_addr, textAddr, INET_ADDRSTRLEN);
-	LogWriter::WriteLine(std::string("Net OK. Client ") + textAddr + " is accepted by the host.");
+	//Messages are small and latency matters more than packet count
+	int noDelay = 1;
+	setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+	return true;
 }
 
-void CNetSocket::InitClient(const char * ip, unsigned short port)
+//Returns number of bytes sent, 0 if socket would block or -1 on error
+int SendBuffers(SOCKET socket, const RingBuffer::Span* buffers, size_t count)
 {
-	if (!InitSocket()) return;
-	m_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-	if (m_socket == INVALID_SOCKET)   // winsock2.h: #define INVALID_SOCKET (SOCKET)(~0)
+#ifdef _WINDOWS
+	WSABUF wsaBuffers[MAX_BUFFERS];
+	for (size_t i = 0; i < count; ++i)
 	{
-		LogError();
-		return;
+		wsaBuffers[i].buf = buffers[i].data;
+		wsaBuffers[i].len = static_cast<ULONG>(buffers[i].size);
 	}
-	
-	m_sockAddr = new struct sockaddr_in;
-	memset(m_sockAddr, 0, sizeof (struct sockaddr_in));
-	ChangeAddress(ip, port);
-	LogWriter::WriteLine("Net OK. Trying to connect host.");
-	int error = connect(m_socket, (struct sockaddr *)m_sockAddr, sizeof(struct sockaddr_in));
-	if (error == SOCKET_ERROR)
+	DWORD sent = 0;
+	if (WSASend(socket, wsaBuffers, static_cast<DWORD>(count), &sent, 0, NULL, NULL) == SOCKET_ERROR)
 	{
-		LogError();
-		return;
+		return IsWouldBlock(GetError()) ? 0 : -1;
 	}
-	unsigned long iMode = 1UL;
-#ifdef _WINDOWS
-        error = ioctlsocket(m_socket, FIONBIO, &iMode);
+	return static_cast<int>(sent);
 #else
-        error = ioctl(m_socket, FIONBIO, &iMode);
+	iovec vectors[MAX_BUFFERS];
+	for (size_t i = 0; i < count; ++i)
+	{
+		vectors[i].iov_base = buffers[i].data;
+		vectors[i].iov_len = buffers[i].size;
+	}
+	msghdr message = {};
+	message.msg_iov = vectors;
+	message.msg_iovlen = count;
+	ssize_t sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+	if (sent == SOCKET_ERROR)
+	{
+		return IsWouldBlock(GetError()) ? 0 : -1;
+	}
+	return static_cast<int>(sent);
 #endif
-	if (error == SOCKET_ERROR)
+}
+
+//Returns number of bytes received, -1 if socket would block or -2 on error. 0 means that connection is closed
+int ReceiveBuffers(SOCKET socket, const RingBuffer::Span* buffers, size_t count)
+{
+#ifdef _WINDOWS
+	WSABUF wsaBuffers[2];
+	for (size_t i = 0; i < count; ++i)
 	{
-		LogError();
-		return;
+		wsaBuffers[i].buf = buffers[i].data;
+		wsaBuffers[i].len = static_cast<ULONG>(buffers[i].size);
+	}
+	DWORD received = 0;
+	DWORD flags = 0;
+	if (WSARecv(socket, wsaBuffers, static_cast<DWORD>(count), &received, &flags, NULL, NULL) == SOCKET_ERROR)
+	{
+		return IsWouldBlock(GetError()) ? -1 : -2;
+	}
+	return static_cast<int>(received);
+#else
+	iovec vectors[2];
+	for (size_t i = 0; i < count; ++i)
+	{
+		vectors[i].iov_base = buffers[i].data;
+		vectors[i].iov_len = buffers[i].size;
+	}
+	ssize_t received = readv(socket, vectors, static_cast<int>(count));
+	if (received == SOCKET_ERROR)
+	{
+		return IsWouldBlock(GetError()) ? -1 : -2;
 	}
-	LogWriter::WriteLine("Net OK. Client is connected to the host.");
+	return static_cast<int>(received);
+#endif
 }
+}
+
+struct CNetSocket::sPollSet
+{
+	std::vector<pollfd> descriptors;
+	std::vector<ConnectionId> connections;//0 for listening socket
+};
 
-void CNetSocket::InitFromAnotherSocket(unsigned int socket, void* sockAddr)
+CNetSocket::CNetSocket()
+	: m_listenSocket(INVALID_SOCKET)
+	, m_pollSet(std::make_unique<sPollSet>())
 {
-	m_socket = socket;
-	m_sockAddr = sockAddr;
 }
 
-bool CNetSocket::ChangeAddress(const char* ip, unsigned short port)
+CNetSocket::~CNetSocket()
 {
-	struct sockaddr_in * addr = (struct sockaddr_in *)m_sockAddr;
-	addr->sin_family = AF_INET;
-	addr->sin_port = htons(port);
-	if (inet_pton(AF_INET, ip, (void*)&addr->sin_addr) == -1)
+	while (!m_connections.empty())
+	{
+		CloseConnection(m_connections.begin()->first, false);
+	}
+	if (m_listenSocket != static_cast<SocketHandle>(INVALID_SOCKET))
+	{
+		CloseSocket(m_listenSocket);
+	}
+#ifdef _WINDOWS
+	if (m_initialized && WSACleanup()) LogError();
+#endif
+	LogWriter::WriteLine("Net OK. Socket is closed.");
+}
+
+bool CNetSocket::InitHost(unsigned short port)
+{
+	if (!InitSocket()) return false;
+	SOCKET listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (listenSocket == INVALID_SOCKET)
 	{
 		LogError();
 		return false;
 	}
+	int reuse = 1;
+	setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = INADDR_ANY;
+	if (bind(listenSocket, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR || listen(listenSocket, SOMAXCONN) == SOCKET_ERROR)
+	{
+		LogError();
+		LogWriter::WriteLine("Net error. Cannot bind to port");
+		CloseSocket(listenSocket);
+		return false;
+	}
+	if (!SetNonBlocking(listenSocket))
+	{
+		CloseSocket(listenSocket);
+		return false;
+	}
+	m_listenSocket = listenSocket;
+	LogWriter::WriteLine("Net OK. Host is up and running.");
 	return true;
 }
 
-bool CNetSocket::ChangeAddress(unsigned short port)
+bool CNetSocket::InitClient(const char * ip, unsigned short port)
 {
-	struct sockaddr_in * addr = (struct sockaddr_in *)m_sockAddr;
-	addr->sin_family = AF_INET;
-	addr->sin_port = htons(port);
-	addr->sin_addr.s_addr = INADDR_ANY;
-	int serror = bind(m_socket, (const struct sockaddr *)addr, sizeof (*addr));
-	if (serror == SOCKET_ERROR)
+	if (!InitSocket()) return false;
+	SOCKET clientSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (clientSocket == INVALID_SOCKET)
 	{
 		LogError();
 		return false;
 	}
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	if (inet_pton(AF_INET, ip, &addr.sin_addr) != 1)
+	{
+		LogWriter::WriteLine(std::string("Net error. Invalid address ") + ip);
+		CloseSocket(clientSocket);
+		return false;
+	}
+	if (!SetNonBlocking(clientSocket))
+	{
+		CloseSocket(clientSocket);
+		return false;
+	}
+	LogWriter::WriteLine("Net OK. Trying to connect host.");
+	if (connect(clientSocket, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR)
+	{
+		int error = GetError();
+		if (error != WSAEWOULDBLOCK && error != WSAEINPROGRESS)
+		{
+			LogError();
+			CloseSocket(clientSocket);
+			return false;
+		}
+	}
+	//Connection is reported by Poll even if it is established at once
+	AddConnection(clientSocket, true);
+	return true;
+}
+
+void CNetSocket::SetHandlers(ConnectionHandler const& onConnect, DataHandler const& onData, ConnectionHandler const& onDisconnect)
+{
+	m_onConnect = onConnect;
+	m_onData = onData;
+	m_onDisconnect = onDisconnect;
+}
+
+bool CNetSocket::SendData(ConnectionId id, const Buffer* buffers, size_t count)
+{
+	auto it = m_connections.find(id);
+	if (it == m_connections.end() || count > MAX_BUFFERS)
+		return false;
+	sConnection& connection = *it->second;
+	size_t sent = 0;
+	if (!connection.connecting && connection.sending.GetSize() == 0)
+	{
+		RingBuffer::Span spans[MAX_BUFFERS];
+		for (size_t i = 0; i < count; ++i)
+		{
+			spans[i] = { const_cast<char*>(buffers[i].data), buffers[i].size };
+		}
+		int result = SendBuffers(connection.socket, spans, count);
+		if (result < 0)
+		{
+			LogError();
+			CloseConnection(id, true);
+			return false;
+		}
+		sent = static_cast<size_t>(result);
+	}
+	for (size_t i = 0; i < count; ++i)
+	{
+		const size_t skip = std::min(sent, buffers[i].size);
+		sent -= skip;
+		connection.sending.Write(buffers[i].data + skip, buffers[i].size - skip);
+	}
+	return true;
+}
+
+void CNetSocket::Poll(std::chrono::milliseconds timeout)
+{
+	auto& descriptors = m_pollSet->descriptors;
+	auto& connections = m_pollSet->connections;
+	descriptors.clear();
+	connections.clear();
+	if (m_listenSocket != static_cast<SocketHandle>(INVALID_SOCKET))
+	{
+		pollfd descriptor = {};
+		descriptor.fd = m_listenSocket;
+		descriptor.events = POLLIN;
+		descriptors.push_back(descriptor);
+		connections.push_back(0);
+	}
+	for (auto& pair : m_connections)
+	{
+		pollfd descriptor = {};
+		descriptor.fd = pair.second->socket;
+		descriptor.events = POLLIN;
+		if (pair.second->connecting || pair.second->sending.GetSize() > 0)
+		{
+			descriptor.events |= POLLOUT;
+		}
+		descriptors.push_back(descriptor);
+		connections.push_back(pair.first);
+	}
+	if (descriptors.empty())
+		return;
+	int result = poll(descriptors.data(), static_cast<unsigned>(descriptors.size()), static_cast<int>(timeout.count()));
+	if (result == SOCKET_ERROR)
+	{
+		if (!IsWouldBlock(GetError())) LogError();
+		return;
+	}
+	for (size_t i = 0; i < descriptors.size() && result > 0; ++i)
+	{
+		const short events = descriptors[i].revents;
+		if (events == 0)
+			continue;
+		--result;
+		const ConnectionId id = connections[i];
+		if (id == 0)
+		{
+			Accept();
+			continue;
+		}
+		//Handlers may close connections, so they are looked up again every time
+		auto it = m_connections.find(id);
+		if (it == m_connections.end())
+			continue;
+		sConnection* connection = it->second.get();
+		if (connection->connecting)
+		{
+			if (!(events & (POLLOUT | POLLERR | POLLHUP)))
+				continue;
+			int error = 0;
+			socklen_t size = sizeof(error);
+			getsockopt(connection->socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &size);
+			if (error != 0 || (events & (POLLERR | POLLHUP)))
+			{
+				LogWriter::WriteLine("Net error. Cannot connect to the host.");
+				CloseConnection(id, true);
+				continue;
+			}
+			connection->connecting = false;
+			LogWriter::WriteLine("Net OK. Client is connected to the host.");
+			if (m_onConnect) m_onConnect(id);
+			it = m_connections.find(id);
+			if (it == m_connections.end())
+				continue;
+			connection = it->second.get();
+		}
+		bool alive = true;
+		if (events & (POLLIN | POLLHUP | POLLERR))
+		{
+			alive = Receive(*connection);
+			if (connection->received.GetSize() > 0 && m_onData)
+			{
+				m_onData(id, connection->received);
+				it = m_connections.find(id);
+				if (it == m_connections.end())
+					continue;
+				connection = it->second.get();
+				if (connection->received.GetSize() == connection->received.GetCapacity())
+				{
+					LogWriter::WriteLine("Net error. Received message does not fit receive buffer.");
+					alive = false;
+				}
+			}
+		}
+		if (alive && connection->sending.GetSize() > 0)
+		{
+			alive = Flush(*connection);
+		}
+		if (!alive)
+		{
+			CloseConnection(id, true);
+		}
+	}
+}
+
+void CNetSocket::Disconnect(ConnectionId connection)
+{
+	CloseConnection(connection, false);
+}
+
+size_t CNetSocket::GetConnectionsCount() const
+{
+	return m_connections.size();
+}
+
+CNetSocket::ConnectionId CNetSocket::AddConnection(SocketHandle socket, bool connecting)
+{
+	const ConnectionId id = m_nextConnection++;
+	auto connection = std::make_unique<sConnection>();
+	connection->socket = socket;
+	connection->connecting = connecting;
+	m_connections.emplace(id, std::move(connection));
+	return id;
+}
+
+void CNetSocket::Accept()
+{
+	for (;;)
+	{
+		sockaddr_in addr;
+		socklen_t size = sizeof(addr);
+		SOCKET clientSocket = accept(m_listenSocket, reinterpret_cast<sockaddr*>(&addr), &size);
+		if (clientSocket == INVALID_SOCKET)
+		{
+			if (!IsWouldBlock(GetError())) LogError();
+			return;
+		}
+		if (!SetNonBlocking(clientSocket))
+		{
+			CloseSocket(clientSocket);
+			continue;
+		}
+		const ConnectionId id = AddConnection(clientSocket, false);
+		char textAddr[INET_ADDRSTRLEN];
+		inet_ntop(AF_INET, &addr.sin_addr, textAddr, INET_ADDRSTRLEN);
+		LogWriter::WriteLine(std::string("Net OK. Client ") + textAddr + " is accepted by the host.");
+		if (m_onConnect) m_onConnect(id);
+	}
+}
+
+bool CNetSocket::Receive(sConnection& connection)
+{
+	for (;;)
+	{
+		RingBuffer::Span spans[2];
+		//Buffer is grown only by data handler for messages it has validated, so peer cannot make it grow without bound.
+		//Full buffer is passed to handler, the rest is read by the next Poll
+		const size_t count = connection.received.GetFreeSpans(spans);
+		if (count == 0)
+			return true;
+		const size_t freeSize = spans[0].size + (count > 1 ? spans[1].size : 0);
+		int result = ReceiveBuffers(connection.socket, spans, count);
+		if (result == 0)
+		{
+			LogWriter::WriteLine("Net OK. Connection is closed by the other side.");
+			return false;
+		}
+		if (result == -1)
+			return true;
+		if (result < 0)
+		{
+			LogError();
+			return false;
+		}
+		connection.received.Commit(static_cast<size_t>(result));
+		if (static_cast<size_t>(result) < freeSize)
+			return true;
+	}
+}
+
+bool CNetSocket::Flush(sConnection& connection)
+{
+	while (connection.sending.GetSize() > 0)
+	{
+		RingBuffer::Span spans[2];
+		const size_t count = connection.sending.GetDataSpans(spans);
+		int result = SendBuffers(connection.socket, spans, count);
+		if (result < 0)
+		{
+			LogError();
+			return false;
+		}
+		if (result == 0)
+			return true;
+		connection.sending.Consume(static_cast<size_t>(result));
+	}
 	return true;
 }
 
+void CNetSocket::CloseConnection(ConnectionId id, bool notify)
+{
+	auto it = m_connections.find(id);
+	if (it == m_connections.end())
+		return;
+	CloseSocket(it->second->socket);
+	m_connections.erase(it);
+	if (notify && m_onDisconnect)
+	{
+		m_onDisconnect(id);
+	}
+}
+
 bool CNetSocket::InitSocket()
 {
+	if (m_initialized)
+		return true;
 #ifdef _WINDOWS
-    WORD wVersion;
+	WORD wVersion;
 	WSADATA wsaData;
 	wVersion = MAKEWORD(2, 2);
 	int wsaInitError = WSAStartup(wVersion, &wsaData);
@@ -219,21 +584,25 @@ bool CNetSocket::InitSocket()
 		LogWriter::WriteLine("Net Error. Error initalizing WSA.");
 		return false;
 	}
-	else
-		return true;
-#else
-        return true;
 #endif
+	m_initialized = true;
+	return true;
 }
 
 std::string CNetSocket::GetIP() const
 {
+	SocketHandle socket = m_listenSocket;
+	if (socket == static_cast<SocketHandle>(INVALID_SOCKET) && !m_connections.empty())
+	{
+		socket = m_connections.begin()->second->socket;
+	}
 	struct sockaddr_in name;
 	socklen_t namelen = sizeof (struct sockaddr_in);
-	int error = getsockname(m_socket, (struct sockaddr *) &name, &namelen);
+	int error = getsockname(socket, (struct sockaddr *) &name, &namelen);
 	if (error == SOCKET_ERROR)
 	{
 		LogError();
+		return std::string();
 	}
 	char textAddr[INET_ADDRSTRLEN];
 	inet_ntop(AF_INET, &name.sin_addr, textAddr, INET_ADDRSTRLEN);
@@ -242,59 +611,18 @@ std::string CNetSocket::GetIP() const
 
 unsigned short CNetSocket::GetPort() const
 {
+	SocketHandle socket = m_listenSocket;
+	if (socket == static_cast<SocketHandle>(INVALID_SOCKET) && !m_connections.empty())
+	{
+		socket = m_connections.begin()->second->socket;
+	}
 	struct sockaddr_in name;
 	socklen_t namelen = sizeof (struct sockaddr_in);
-	int error = getsockname(m_socket, (struct sockaddr *) &name, &namelen);
+	int error = getsockname(socket, (struct sockaddr *) &name, &namelen);
 	if (error == SOCKET_ERROR)
 	{
 		LogError();
+		return 0;
 	}
 	return ntohs(name.sin_port);
 }
-
-bool CNetSocket::SendData(const char * data, size_t len) const
-{
-	int count = send(m_socket, data, static_cast<int>(len), 0);
-	if (count == SOCKET_ERROR)
-	{
-		LogError();
-		return false;
-	}
-	return count == static_cast<int>(len);
-}
-
-int CNetSocket::RecieveData(char* data, size_t maxLength)
-{
-	int count = recv(m_socket, data, static_cast<int>(maxLength), 0);
-	if (count == 0)
-	{
-		LogWriter::WriteLine("Net OK. Connection is closed by the other side.");
-	}
-	if (count == SOCKET_ERROR)
-	{	
-        int wsError = GET_ERROR;
-		if (wsError != WSAEWOULDBLOCK)
-		{
-			LogError();
-		}
-		if (wsError == WSAECONNRESET)
-		{
-			return 0;
-		}
-	}
-	return count;
-}
-
-CNetSocket::~CNetSocket()
-{
-#ifdef _WINDOWS
-	int wsError = closesocket(m_socket);
-	if (wsError) LogError();
-	wsError = WSACleanup();
-	if (wsError) LogError();
-#else
-    close (m_socket);
-#endif
-	delete (struct sockaddr_in*) m_sockAddr;
-	LogWriter::WriteLine("Net OK. Socket is closed.");
-}
\ No newline at end of file
@@ -1,23 +1,56 @@
 #pragma once
 #include "../INetSocket.h"
+#include "../RingBuffer.h"
+#include <cstdint>
+#include <map>
+#include <memory>
 #include <string>
 
 class CNetSocket : public wargameEngine::INetSocket
 {
 public:
-	void InitHost(unsigned short port = 0) override;
-	void InitClient(const char* ip, unsigned short port = 0) override;
-	void InitFromAnotherSocket(unsigned int socket, void* sockAddr) override;
-	bool SendData(const char* data, size_t len) const override;
-	int RecieveData(char* data, size_t maxLength) override;
-	std::string GetIP() const;
-	unsigned short GetPort() const;
+	CNetSocket();
 	~CNetSocket();
 
+	bool InitHost(unsigned short port = 0) override;
+	bool InitClient(const char* ip, unsigned short port = 0) override;
+	void SetHandlers(ConnectionHandler const& onConnect, DataHandler const& onData, ConnectionHandler const& onDisconnect) override;
+	bool SendData(ConnectionId connection, const Buffer* buffers, size_t count) override;
+	void Poll(std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) override;
+	void Disconnect(ConnectionId connection) override;
+	size_t GetConnectionsCount() const override;
+	unsigned short GetPort() const override;
+	std::string GetIP() const;
+
 private:
+#ifdef _WINDOWS
+	typedef uintptr_t SocketHandle;
+#else
+	typedef int SocketHandle;
+#endif
+	struct sConnection
+	{
+		SocketHandle socket;
+		wargameEngine::RingBuffer received;
+		wargameEngine::RingBuffer sending;
+		bool connecting = false;
+	};
+	struct sPollSet;
+
 	bool InitSocket();
-	bool ChangeAddress(const char* ip, unsigned short port = 0);
-	bool ChangeAddress(unsigned short port = 0);
-	int m_socket;
-	void* m_sockAddr;
+	ConnectionId AddConnection(SocketHandle socket, bool connecting);
+	void Accept();
+	//Return false if connection is broken
+	bool Receive(sConnection& connection);
+	bool Flush(sConnection& connection);
+	void CloseConnection(ConnectionId connection, bool notify);
+
+	SocketHandle m_listenSocket;
+	std::map<ConnectionId, std::unique_ptr<sConnection>> m_connections;
+	ConnectionId m_nextConnection = 1;
+	std::unique_ptr<sPollSet> m_pollSet;
+	ConnectionHandler m_onConnect;
+	DataHandler m_onData;
+	ConnectionHandler m_onDisconnect;
+	bool m_initialized = false;
 };
\ No newline at end of file
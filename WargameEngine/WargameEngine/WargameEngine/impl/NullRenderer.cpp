@@ -0,0 +1,556 @@
+#include "NullRenderer.h"
+#include "../view/IViewport.h"
+#include "../view/PerfomanceMeter.h"
+#include "../view/TextureManager.h"
+#include <cstring>
+
+using namespace std;
+using namespace wargameEngine;
+using namespace view;
+
+namespace
+{
+class CNullShaderProgram : public IShaderProgram
+{
+};
+
+class CNullVertexAttribCache : public IVertexAttribCache
+{
+};
+
+class CNullCachedTexture : public ICachedTexture
+{
+};
+
+class CNullVertexBuffer : public IVertexBuffer
+{
+};
+
+class CNullFrameBuffer : public IFrameBuffer
+{
+public:
+	CNullFrameBuffer(sNullRendererStats& stats)
+		: m_stats(stats)
+	{
+	}
+	void Bind() const override
+	{
+		++m_stats.stateChanges;
+	}
+	void UnBind() const override
+	{
+		++m_stats.stateChanges;
+	}
+	void AssignTexture(ICachedTexture& /*texture*/, IRenderer::CachedTextureType /*type*/) override
+	{
+	}
+
+private:
+	sNullRendererStats& m_stats;
+};
+
+class CNullOcclusionQuery : public IOcclusionQuery
+{
+public:
+	void Query(std::function<void()> const& handler) override
+	{
+		handler();
+	}
+	bool IsVisible() const override
+	{
+		return true;
+	}
+};
+
+size_t GetMipMapsSize(TextureMipMaps const& mipmaps, unsigned short bpp)
+{
+	size_t size = 0;
+	for (auto& mipmap : mipmaps)
+	{
+		size += mipmap.size ? mipmap.size : mipmap.width * mipmap.height * bpp / 8;
+	}
+	return size;
+}
+}
+
+CNullShaderManager::CNullShaderManager(sNullRendererStats& stats)
+	: m_stats(stats)
+{
+}
+
+void CNullShaderManager::ReportUpload(size_t bytes) const
+{
+	++m_stats.bufferUploads;
+	m_stats.uploadedBytes += bytes;
+}
+
+unique_ptr<IShaderProgram> CNullShaderManager::NewProgram(const Path& /*vertex*/, const Path& /*fragment*/, const Path& /*geometry*/)
+{
+	return make_unique<CNullShaderProgram>();
+}
+
+unique_ptr<IShaderProgram> CNullShaderManager::NewProgramSource(string const& /*vertex*/, string const& /*fragment*/, string const& /*geometry*/)
+{
+	return make_unique<CNullShaderProgram>();
+}
+
+void CNullShaderManager::PushProgram(IShaderProgram const& /*program*/) const
+{
+	++m_stats.stateChanges;
+}
+
+void CNullShaderManager::PopProgram() const
+{
+	++m_stats.stateChanges;
+}
+
+void CNullShaderManager::SetUniformValue(string const& /*uniform*/, int /*elementSize*/, size_t /*count*/, const float* /*value*/) const
+{
+	++m_stats.stateChanges;
+}
+
+void CNullShaderManager::SetUniformValue(string const& /*uniform*/, int /*elementSize*/, size_t /*count*/, const int* /*value*/) const
+{
+	++m_stats.stateChanges;
+}
+
+void CNullShaderManager::SetUniformValue(string const& /*uniform*/, int /*elementSize*/, size_t /*count*/, const unsigned int* /*value*/) const
+{
+	++m_stats.stateChanges;
+}
+
+UniformHandle CNullShaderManager::GetUniformHandle(string const& uniform) const
+{
+	return m_uniforms.Get(uniform);
+}
+
+void CNullShaderManager::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const float* value) const
+{
+	SetUniformValue(m_uniforms.GetName(uniform), elementSize, count, value);
+}
+
+void CNullShaderManager::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const int* value) const
+{
+	SetUniformValue(m_uniforms.GetName(uniform), elementSize, count, value);
+}
+
+void CNullShaderManager::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const unsigned int* value) const
+{
+	SetUniformValue(m_uniforms.GetName(uniform), elementSize, count, value);
+}
+
+void CNullShaderManager::SetVertexAttribute(string const& /*attribute*/, int elementSize, size_t count, const float* /*values*/, bool /*perInstance*/) const
+{
+	ReportUpload(elementSize * count * sizeof(float));
+}
+
+void CNullShaderManager::SetVertexAttribute(string const& /*attribute*/, int elementSize, size_t count, const int* /*values*/, bool /*perInstance*/) const
+{
+	ReportUpload(elementSize * count * sizeof(int));
+}
+
+void CNullShaderManager::SetVertexAttribute(string const& /*attribute*/, int elementSize, size_t count, const unsigned int* /*values*/, bool /*perInstance*/) const
+{
+	ReportUpload(elementSize * count * sizeof(unsigned int));
+}
+
+void CNullShaderManager::SetVertexAttribute(string const& /*attribute*/, IVertexAttribCache const& /*cache*/, int /*elementSize*/, size_t /*count*/, Format /*type*/, bool /*perInstance*/, size_t /*offset*/) const
+{
+	++m_stats.stateChanges;
+}
+
+void CNullShaderManager::DisableVertexAttribute(string const& /*attribute*/, int /*size*/, const float* /*defaultValue*/) const
+{
+	++m_stats.stateChanges;
+}
+
+void CNullShaderManager::DisableVertexAttribute(string const& /*attribute*/, int /*size*/, const int* /*defaultValue*/) const
+{
+	++m_stats.stateChanges;
+}
+
+void CNullShaderManager::DisableVertexAttribute(string const& /*attribute*/, int /*size*/, const unsigned int* /*defaultValue*/) const
+{
+	++m_stats.stateChanges;
+}
+
+unique_ptr<IVertexAttribCache> CNullShaderManager::CreateVertexAttribCache(size_t size, const void* /*value*/, bool /*dynamic*/) const
+{
+	ReportUpload(size);
+	return make_unique<CNullVertexAttribCache>();
+}
+
+void CNullShaderManager::UpdateVertexAttribCache(IVertexAttribCache& /*cache*/, const void* /*value*/, size_t /*offset*/, size_t size) const
+{
+	ReportUpload(size);
+}
+
+bool CNullShaderManager::NeedsMVPMatrix() const
+{
+	return true;
+}
+
+void CNullShaderManager::SetMatrices(const float* model, const float* view, const float* projection, const float* mvp, size_t /*multiviewCount*/)
+{
+	m_stats.stateChanges += (model ? 1 : 0) + (view ? 1 : 0) + (projection ? 1 : 0) + (mvp ? 1 : 0);
+}
+
+CNullRenderer::CNullRenderer()
+	: m_shaderManager(m_stats)
+{
+	m_colorUniform = m_shaderManager.GetUniformHandle("color");
+	m_lightsCountUniform = m_shaderManager.GetUniformHandle("lightsCount");
+}
+
+void CNullRenderer::ReportDraw(size_t count, size_t instances, RenderMode mode)
+{
+	m_matrixManager.UpdateMatrices(m_shaderManager);
+	++m_stats.draws;
+	PerfomanceMeter::ReportDraw(instances > 1 ? instances * count : count, mode);
+}
+
+void CNullRenderer::ReportUpload(size_t bytes)
+{
+	++m_stats.bufferUploads;
+	m_stats.uploadedBytes += bytes;
+}
+
+void CNullRenderer::RenderArrays(RenderMode mode, array_view<CVector3f> const& vertices, array_view<CVector3f> const& normals, array_view<CVector2f> const& texCoords)
+{
+	ReportUpload(vertices.size() * sizeof(CVector3f) + normals.size() * sizeof(CVector3f) + texCoords.size() * sizeof(CVector2f));
+	ReportDraw(vertices.size(), 0, mode);
+}
+
+void CNullRenderer::RenderArrays(RenderMode mode, array_view<CVector2i> const& vertices, array_view<CVector2f> const& texCoords)
+{
+	ReportUpload(vertices.size() * sizeof(CVector2i) + texCoords.size() * sizeof(CVector2f));
+	ReportDraw(vertices.size(), 0, mode);
+}
+
+void CNullRenderer::Draw(IVertexBuffer& /*buffer*/, size_t count, size_t /*begin*/, size_t instances)
+{
+	ReportDraw(count, instances, RenderMode::Triangles);
+}
+
+void CNullRenderer::DrawIndexed(IVertexBuffer& /*buffer*/, size_t count, size_t /*begin*/, size_t instances)
+{
+	ReportDraw(count, instances, RenderMode::Triangles);
+}
+
+void CNullRenderer::DrawIndirect(IVertexBuffer& /*buffer*/, const array_view<IndirectDraw>& indirectList, bool /*indexed*/)
+{
+	//Whole list is a single multi draw call
+	size_t count = 0;
+	for (auto& command : indirectList)
+	{
+		count += command.instances > 1 ? command.instances * command.count : command.count;
+	}
+	ReportDraw(count, 0, RenderMode::Triangles);
+}
+
+void CNullRenderer::SetIndexBuffer(IVertexBuffer& /*buffer*/, const unsigned int* indexPtr, size_t indexesSize)
+{
+	if (indexPtr)
+	{
+		ReportUpload(indexesSize * sizeof(unsigned int));
+	}
+}
+
+void CNullRenderer::AddVertexAttribute(IVertexBuffer& /*buffer*/, const string& /*attribute*/, int elementSize, size_t count, IShaderManager::Format /*type*/, const void* /*values*/, bool /*perInstance*/)
+{
+	ReportUpload(elementSize * count * sizeof(float));
+}
+
+void CNullRenderer::AddVertexAttribute(IVertexBuffer& /*buffer*/, const string& /*attribute*/, int /*elementSize*/, IVertexAttribCache const& /*cache*/, IShaderManager::Format /*type*/, bool /*perInstance*/, size_t /*offset*/)
+{
+	++m_stats.stateChanges;
+}
+
+void CNullRenderer::PushMatrix()
+{
+	m_matrixManager.PushMatrix();
+}
+
+void CNullRenderer::PopMatrix()
+{
+	m_matrixManager.PopMatrix();
+}
+
+void CNullRenderer::Translate(const CVector3f& delta)
+{
+	m_matrixManager.Translate(delta.x, delta.y, delta.z);
+}
+
+void CNullRenderer::Translate(int dx, int dy, int dz)
+{
+	m_matrixManager.Translate(static_cast<float>(dx), static_cast<float>(dy), static_cast<float>(dz));
+}
+
+void CNullRenderer::Rotate(float angle, const CVector3f& axis)
+{
+	m_matrixManager.Rotate(angle, axis);
+}
+
+void CNullRenderer::Rotate(const CVector3f& rotations)
+{
+	m_matrixManager.Rotate(rotations);
+}
+
+void CNullRenderer::Scale(float scale)
+{
+	m_matrixManager.Scale(scale);
+}
+
+const float* CNullRenderer::GetViewMatrix() const
+{
+	return m_matrixManager.GetViewMatrix();
+}
+
+const float* CNullRenderer::GetModelMatrix() const
+{
+	return m_matrixManager.GetModelMatrix();
+}
+
+void CNullRenderer::SetModelMatrix(const float* matrix)
+{
+	m_matrixManager.SetModelMatrix(matrix);
+}
+
+void CNullRenderer::LookAt(const CVector3f& position, const CVector3f& direction, const CVector3f& up)
+{
+	m_matrixManager.LookAt(position, direction, up);
+}
+
+void CNullRenderer::SetTexture(const Path& texture, bool forceLoadNow, int flags)
+{
+	if (texture.empty())
+	{
+		return UnbindTexture();
+	}
+	if (forceLoadNow)
+	{
+		m_textureManager->LoadTextureNow(texture, flags);
+	}
+	SetTexture(*m_textureManager->GetTexturePtr(texture, nullptr, flags));
+}
+
+void CNullRenderer::SetTexture(const ICachedTexture& /*texture*/, TextureSlot /*slot*/)
+{
+	++m_stats.stateChanges;
+}
+
+void CNullRenderer::UnbindTexture(TextureSlot /*slot*/)
+{
+	++m_stats.stateChanges;
+}
+
+void CNullRenderer::RenderToTexture(const function<void()>& func, ICachedTexture& /*texture*/, unsigned int width, unsigned int height)
+{
+	++m_stats.stateChanges;
+	int oldViewport[4];
+	memcpy(oldViewport, m_viewport, sizeof(int) * 4);
+	m_viewport[0] = 0;
+	m_viewport[1] = 0;
+	m_viewport[2] = static_cast<int>(width);
+	m_viewport[3] = static_cast<int>(height);
+	m_matrixManager.SaveMatrices();
+	m_matrixManager.SetOrthographicProjection(0.0f, static_cast<float>(width), 0.0f, static_cast<float>(height));
+	m_matrixManager.ResetModelView();
+
+	func();
+
+	m_matrixManager.RestoreMatrices();
+	memcpy(m_viewport, oldViewport, sizeof(int) * 4);
+	++m_stats.stateChanges;
+}
+
+unique_ptr<ICachedTexture> CNullRenderer::CreateTexture(const void* data, unsigned int width, unsigned int height, CachedTextureType type)
+{
+	if (data)
+	{
+		ReportUpload(width * height * (type == CachedTextureType::Alpha ? 1 : 4));
+	}
+	return make_unique<CNullCachedTexture>();
+}
+
+void CNullRenderer::SetColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a)
+{
+	auto charToFloat = [](const int value) { return static_cast<float>(value) / 0xff; };
+	const float color[] = { charToFloat(r), charToFloat(g), charToFloat(b), charToFloat(a) };
+	SetColor(color);
+}
+
+void CNullRenderer::SetColor(const float* color)
+{
+	m_shaderManager.SetUniformValue(m_colorUniform, 4, 1, color);
+}
+
+void CNullRenderer::SetMaterial(const float* /*ambient*/, const float* /*diffuse*/, const float* /*specular*/, float /*shininess*/)
+{
+	++m_stats.stateChanges;
+}
+
+unique_ptr<IVertexBuffer> CNullRenderer::CreateVertexBuffer(const float* vertex, const float* normals, const float* texcoords, size_t size, bool /*temp*/)
+{
+	const size_t components = (vertex ? 3 : 0) + (normals ? 3 : 0) + (texcoords ? 2 : 0);
+	if (components > 0)
+	{
+		ReportUpload(size * components * sizeof(float));
+	}
+	return make_unique<CNullVertexBuffer>();
+}
+
+string CNullRenderer::GetName() const
+{
+	return "Null";
+}
+
+bool CNullRenderer::SupportsFeature(Feature /*feature*/) const
+{
+	return true;
+}
+
+IShaderManager& CNullRenderer::GetShaderManager()
+{
+	return m_shaderManager;
+}
+
+unique_ptr<ICachedTexture> CNullRenderer::CreateEmptyTexture(bool /*cubemap*/)
+{
+	return make_unique<CNullCachedTexture>();
+}
+
+void CNullRenderer::SetTextureAnisotropy(float /*value*/)
+{
+}
+
+void CNullRenderer::UploadTexture(ICachedTexture& /*texture*/, unsigned char* /*data*/, size_t width, size_t height, unsigned short bpp, int /*flags*/, TextureMipMaps const& mipmaps)
+{
+	ReportUpload(width * height * bpp / 8 + GetMipMapsSize(mipmaps, bpp));
+}
+
+void CNullRenderer::UploadCompressedTexture(ICachedTexture& /*texture*/, unsigned char* /*data*/, size_t /*width*/, size_t /*height*/, size_t size, int /*flags*/, TextureMipMaps const& mipmaps)
+{
+	ReportUpload(size + GetMipMapsSize(mipmaps, 0));
+}
+
+void CNullRenderer::UploadCubemap(ICachedTexture& /*texture*/, TextureMipMaps const& sides, unsigned short bpp, int /*flags*/)
+{
+	ReportUpload(GetMipMapsSize(sides, bpp));
+}
+
+bool CNullRenderer::Force32Bits() const
+{
+	return false;
+}
+
+bool CNullRenderer::ForceFlipBMP() const
+{
+	return false;
+}
+
+bool CNullRenderer::ConvertBgra() const
+{
+	return false;
+}
+
+void CNullRenderer::WindowCoordsToWorldVector(IViewport& viewport, int x, int y, CVector3f& start, CVector3f& end) const
+{
+	m_matrixManager.WindowCoordsToWorldVector(x, y, (float)viewport.GetX(), (float)viewport.GetY(), (float)viewport.GetWidth(), (float)viewport.GetHeight(), viewport.GetViewMatrix(), viewport.GetProjectionMatrix(), start, end);
+}
+
+void CNullRenderer::WorldCoordsToWindowCoords(IViewport& viewport, CVector3f const& worldCoords, int& x, int& y) const
+{
+	m_matrixManager.WorldCoordsToWindowCoords(worldCoords, (float)viewport.GetX(), (float)viewport.GetY(), (float)viewport.GetWidth(), (float)viewport.GetHeight(), viewport.GetViewMatrix(), viewport.GetProjectionMatrix(), x, y);
+}
+
+unique_ptr<IFrameBuffer> CNullRenderer::CreateFramebuffer() const
+{
+	return make_unique<CNullFrameBuffer>(m_stats);
+}
+
+unique_ptr<IOcclusionQuery> CNullRenderer::CreateOcclusionQuery()
+{
+	return make_unique<CNullOcclusionQuery>();
+}
+
+void CNullRenderer::SetNumberOfLights(size_t count)
+{
+	int number = static_cast<int>(count);
+	m_shaderManager.SetUniformValue(m_lightsCountUniform, 1, 1, &number);
+}
+
+void CNullRenderer::SetUpLight(size_t /*index*/, CVector3f const& /*position*/, const float* /*ambient*/, const float* /*diffuse*/, const float* /*specular*/)
+{
+	++m_stats.stateChanges;
+}
+
+float CNullRenderer::GetMaximumAnisotropyLevel() const
+{
+	return 1.0f;
+}
+
+const float* CNullRenderer::GetProjectionMatrix() const
+{
+	return m_matrixManager.GetProjectionMatrix();
+}
+
+void CNullRenderer::EnableDepthTest(bool /*enableRead*/, bool /*enableWrite*/)
+{
+	++m_stats.stateChanges;
+}
+
+void CNullRenderer::EnableColorWrite(bool /*rgb*/, bool /*alpha*/)
+{
+	++m_stats.stateChanges;
+}
+
+void CNullRenderer::EnableBlending(bool /*enable*/)
+{
+	++m_stats.stateChanges;
+}
+
+void CNullRenderer::SetUpViewport(unsigned int viewportX, unsigned int viewportY, unsigned int viewportWidth, unsigned int viewportHeight, float viewingAngle, float nearPane, float farPane)
+{
+	m_matrixManager.SetUpViewport(viewportWidth, viewportHeight, viewingAngle, nearPane, farPane);
+	m_viewport[0] = viewportX;
+	m_viewport[1] = viewportY;
+	m_viewport[2] = viewportWidth;
+	m_viewport[3] = viewportHeight;
+	++m_stats.stateChanges;
+}
+
+void CNullRenderer::DrawIn2D(function<void()> const& drawHandler)
+{
+	m_matrixManager.SaveMatrices();
+	m_matrixManager.SetOrthographicProjection(static_cast<float>(m_viewport[0]), static_cast<float>(m_viewport[2]), static_cast<float>(m_viewport[3]), static_cast<float>(m_viewport[1]));
+	m_matrixManager.ResetModelView();
+
+	drawHandler();
+
+	m_matrixManager.RestoreMatrices();
+}
+
+void CNullRenderer::EnablePolygonOffset(bool /*enable*/, float /*factor*/, float /*units*/)
+{
+	++m_stats.stateChanges;
+}
+
+void CNullRenderer::ClearBuffers(bool /*color*/, bool /*depth*/)
+{
+}
+
+void CNullRenderer::SetTextureManager(TextureManager& textureManager)
+{
+	m_textureManager = &textureManager;
+}
+
+sNullRendererStats const& CNullRenderer::GetStats() const
+{
+	return m_stats;
+}
+
+void CNullRenderer::ResetStats()
+{
+	m_stats = sNullRendererStats();
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include "../view/IViewHelper.h"
+#include "MatrixManagerGLM.h"
+
+//Counts work that renderer would send to GPU. Bytes are the sizes of data passed to renderer
+struct sNullRendererStats
+{
+	size_t draws = 0;
+	size_t stateChanges = 0;
+	size_t bufferUploads = 0;
+	size_t uploadedBytes = 0;
+};
+
+class CNullShaderManager : public wargameEngine::view::IShaderManager
+{
+public:
+	CNullShaderManager(sNullRendererStats& stats);
+	std::unique_ptr<wargameEngine::view::IShaderProgram> NewProgram(const wargameEngine::Path& vertex = wargameEngine::Path(), const wargameEngine::Path& fragment = wargameEngine::Path(), const wargameEngine::Path& geometry = wargameEngine::Path()) override;
+	std::unique_ptr<wargameEngine::view::IShaderProgram> NewProgramSource(std::string const& vertex = "", std::string const& fragment = "", std::string const& geometry = "") override;
+	void PushProgram(wargameEngine::view::IShaderProgram const& program) const override;
+	void PopProgram() const override;
+
+	void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const float* value) const override;
+	void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const int* value) const override;
+	void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const unsigned int* value) const override;
+	wargameEngine::view::UniformHandle GetUniformHandle(std::string const& uniform) const override;
+	void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const float* value) const override;
+	void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const int* value) const override;
+	void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const unsigned int* value) const override;
+
+	void SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const float* values, bool perInstance = false) const override;
+	void SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const int* values, bool perInstance = false) const override;
+	void SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const unsigned int* values, bool perInstance = false) const override;
+
+	void DisableVertexAttribute(std::string const& attribute, int size, const float* defaultValue) const override;
+	void DisableVertexAttribute(std::string const& attribute, int size, const int* defaultValue) const override;
+	void DisableVertexAttribute(std::string const& attribute, int size, const unsigned int* defaultValue) const override;
+
+	std::unique_ptr<wargameEngine::view::IVertexAttribCache> CreateVertexAttribCache(size_t size, const void* value, bool dynamic = false) const override;
+	void UpdateVertexAttribCache(wargameEngine::view::IVertexAttribCache& cache, const void* value, size_t offset, size_t size) const override;
+	void SetVertexAttribute(std::string const& attribute, wargameEngine::view::IVertexAttribCache const& cache, int elementSize, size_t count, Format type, bool perInstance = false, size_t offset = 0) const override;
+
+	bool NeedsMVPMatrix() const override;
+	void SetMatrices(const float* model = nullptr, const float* view = nullptr, const float* projection = nullptr, const float* mvp = nullptr, size_t multiviewCount = 1) override;
+
+private:
+	void ReportUpload(size_t bytes) const;
+	sNullRendererStats& m_stats;
+	mutable wargameEngine::view::UniformRegistry m_uniforms;
+};
+
+//Renderer that draws nothing. Matrices are computed as usual, so CPU side of the frame costs the same as with real backend
+class CNullRenderer : public wargameEngine::view::IViewHelper
+{
+public:
+	CNullRenderer();
+
+	//IRenderer
+	void RenderArrays(RenderMode mode, array_view<CVector3f> const& vertices, array_view<CVector3f> const& normals, array_view<CVector2f> const& texCoords) override;
+	void RenderArrays(RenderMode mode, array_view<CVector2i> const& vertices, array_view<CVector2f> const& texCoords) override;
+	void Draw(wargameEngine::view::IVertexBuffer& buffer, size_t count, size_t begin = 0, size_t instances = 0) override;
+	void DrawIndexed(wargameEngine::view::IVertexBuffer& buffer, size_t count, size_t begin = 0, size_t instances = 0) override;
+	void DrawIndirect(wargameEngine::view::IVertexBuffer& buffer, const array_view<IndirectDraw>& indirectList, bool indexed) override;
+	void SetIndexBuffer(wargameEngine::view::IVertexBuffer& buffer, const unsigned int* indexPtr, size_t indexesSize) override;
+	void AddVertexAttribute(wargameEngine::view::IVertexBuffer& buffer, const std::string& attribute, int elementSize, size_t count, wargameEngine::view::IShaderManager::Format type, const void* values, bool perInstance = false) override;
+	void AddVertexAttribute(wargameEngine::view::IVertexBuffer& buffer, const std::string& attribute, int elementSize, wargameEngine::view::IVertexAttribCache const& cache, wargameEngine::view::IShaderManager::Format type, bool perInstance = false, size_t offset = 0) override;
+
+	void PushMatrix() override;
+	void PopMatrix() override;
+	void Translate(const CVector3f& delta) override;
+	void Translate(int dx, int dy, int dz = 0) override;
+	void Rotate(float angle, const CVector3f& axis) override;
+	void Rotate(const CVector3f& rotations) override;
+	void Scale(float scale) override;
+	const float* GetViewMatrix() const override;
+	const float* GetModelMatrix() const override;
+	void SetModelMatrix(const float* matrix) override;
+	void LookAt(const CVector3f& position, const CVector3f& direction, const CVector3f& up) override;
+
+	void SetTexture(const wargameEngine::Path& texture, bool forceLoadNow = false, int flags = 0) override;
+	void SetTexture(const wargameEngine::view::ICachedTexture& texture, TextureSlot slot = TextureSlot::Diffuse) override;
+	void UnbindTexture(TextureSlot slot = TextureSlot::Diffuse) override;
+	void RenderToTexture(const std::function<void()>& func, wargameEngine::view::ICachedTexture& texture, unsigned int width, unsigned int height) override;
+	std::unique_ptr<wargameEngine::view::ICachedTexture> CreateTexture(const void* data, unsigned int width, unsigned int height, CachedTextureType type = CachedTextureType::RGBA) override;
+
+	void SetColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a = 0xff) override;
+	void SetColor(const float* color) override;
+	void SetMaterial(const float* ambient, const float* diffuse, const float* specular, float shininess) override;
+
+	std::unique_ptr<wargameEngine::view::IVertexBuffer> CreateVertexBuffer(const float* vertex = nullptr, const float* normals = nullptr, const float* texcoords = nullptr, size_t size = 0, bool temp = false) override;
+
+	std::string GetName() const override;
+	bool SupportsFeature(Feature feature) const override;
+	wargameEngine::view::IShaderManager& GetShaderManager() override;
+
+	//ITextureHelper
+	std::unique_ptr<wargameEngine::view::ICachedTexture> CreateEmptyTexture(bool cubemap = false) override;
+	void SetTextureAnisotropy(float value = 1.0f) override;
+	void UploadTexture(wargameEngine::view::ICachedTexture& texture, unsigned char* data, size_t width, size_t height, unsigned short bpp, int flags, wargameEngine::view::TextureMipMaps const& mipmaps = wargameEngine::view::TextureMipMaps()) override;
+	void UploadCompressedTexture(wargameEngine::view::ICachedTexture& texture, unsigned char* data, size_t width, size_t height, size_t size, int flags, wargameEngine::view::TextureMipMaps const& mipmaps = wargameEngine::view::TextureMipMaps()) override;
+	void UploadCubemap(wargameEngine::view::ICachedTexture& texture, wargameEngine::view::TextureMipMaps const& sides, unsigned short bpp, int flags) override;
+	bool Force32Bits() const override;
+	bool ForceFlipBMP() const override;
+	bool ConvertBgra() const override;
+
+	//IViewHelper
+	void WindowCoordsToWorldVector(wargameEngine::view::IViewport& viewport, int x, int y, CVector3f& start, CVector3f& end) const override;
+	void WorldCoordsToWindowCoords(wargameEngine::view::IViewport& viewport, CVector3f const& worldCoords, int& x, int& y) const override;
+	std::unique_ptr<wargameEngine::view::IFrameBuffer> CreateFramebuffer() const override;
+	std::unique_ptr<wargameEngine::view::IOcclusionQuery> CreateOcclusionQuery() override;
+	void SetNumberOfLights(size_t count) override;
+	void SetUpLight(size_t index, CVector3f const& position, const float* ambient, const float* diffuse, const float* specular) override;
+	float GetMaximumAnisotropyLevel() const override;
+	const float* GetProjectionMatrix() const override;
+	void EnableDepthTest(bool enableRead, bool enableWrite) override;
+	void EnableColorWrite(bool rgb, bool alpha) override;
+	void EnableBlending(bool enable) override;
+	void SetUpViewport(unsigned int viewportX, unsigned int viewportY, unsigned int viewportWidth, unsigned int viewportHeight, float viewingAngle, float nearPane = 1.0f, float farPane = 1000.0f) override;
+	void DrawIn2D(std::function<void()> const& drawHandler) override;
+	void EnablePolygonOffset(bool enable, float factor = 0.0f, float units = 0.0f) override;
+	void ClearBuffers(bool color = true, bool depth = true) override;
+	void SetTextureManager(wargameEngine::view::TextureManager& textureManager) override;
+
+	//Stats are accumulated until reset
+	sNullRendererStats const& GetStats() const;
+	void ResetStats();
+
+private:
+	void ReportDraw(size_t count, size_t instances, RenderMode mode);
+	void ReportUpload(size_t bytes);
+
+	//Framebuffers are created by const method, so stats are mutable
+	mutable sNullRendererStats m_stats;
+	CNullShaderManager m_shaderManager;
+	CMatrixManagerGLM m_matrixManager;
+	wargameEngine::view::TextureManager* m_textureManager = nullptr;
+	int m_viewport[4] = { 0, 0, 0, 0 };
+	wargameEngine::view::UniformHandle m_colorUniform;
+	wargameEngine::view::UniformHandle m_lightsCountUniform;
+};
@@ -110,6 +110,15 @@ public:
 		}
 	}
 
+	void AddVertexAttribute(COpenGLESRenderer& renderer, CShaderManagerOpenGLES& shaderManager, const std::string& attribute, int elementSize, IVertexAttribCache const& cache, IShaderManager::Format type, bool perInstance, size_t offset)
+	{
+		if (m_buffer)
+		{
+			Bind(renderer, shaderManager);
+		}
+		shaderManager.SetVertexAttribute(attribute, cache, elementSize, 0, type, perInstance, offset);
+	}
+
 private:
 	mutable std::unordered_map<const IShaderProgram*, GLuint> m_vaos;
 	GLuint m_indexesBuffer = 0;
@@ -398,6 +407,11 @@ void COpenGLESRenderer::AddVertexAttribute(IVertexBuffer& buffer, const std::str
 	reinterpret_cast<COpenGLESVertexBuffer&>(buffer).AddVertexAttribute(*this, m_shaderManager, attribute, elementSize, count, type, values, perInstance);
 }
 
+void COpenGLESRenderer::AddVertexAttribute(IVertexBuffer& buffer, const std::string& attribute, int elementSize, IVertexAttribCache const& cache, IShaderManager::Format type, bool perInstance, size_t offset)
+{
+	reinterpret_cast<COpenGLESVertexBuffer&>(buffer).AddVertexAttribute(*this, m_shaderManager, attribute, elementSize, cache, type, perInstance, offset);
+}
+
 void COpenGLESRenderer::PushMatrix()
 {
 	m_matrixManager.PushMatrix();
@@ -0,0 +1,190 @@
+#include "OpenGLIndirectCache.h"
+#include <GL/glew.h>
+#include "gl.h"
+#include <algorithm>
+#include <string.h>
+
+using namespace wargameEngine;
+using namespace view;
+
+namespace
+{
+constexpr size_t MIN_BUFFER_SIZE = 4096;
+//Cache is cleared when it grows larger, so lists that never repeat do not take memory forever
+constexpr size_t MAX_CACHE_SIZE = 1024 * 1024;
+
+//Commands are hashed by words, it is several times faster than hashing bytes
+uint64_t HashCommands(std::vector<unsigned int> const& commands)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (unsigned int word : commands)
+	{
+		hash = (hash ^ word) * 0x100000001b3ull;
+	}
+	return hash;
+}
+}
+
+COpenGLIndirectCache::~COpenGLIndirectCache()
+{
+	if (m_buffer)
+	{
+		glDeleteBuffers(1, &m_buffer);
+	}
+}
+
+size_t COpenGLIndirectCache::Get(array_view<IRenderer::IndirectDraw> const& list, bool indexed, bool drawIds)
+{
+	const size_t stride = (indexed ? sizeof(DrawElementsIndirectCommand) : sizeof(DrawArraysIndirectCommand)) / sizeof(unsigned int);
+	m_commands.resize(list.size() * stride);
+	unsigned int* command = m_commands.data();
+	for (size_t i = 0; i < list.size(); ++i, command += stride)
+	{
+		auto& draw = list[i];
+		command[0] = static_cast<unsigned int>(draw.count);
+		command[1] = static_cast<unsigned int>(draw.instances);
+		command[2] = static_cast<unsigned int>(draw.start);
+		command[3] = 0;
+		command[stride - 1] = drawIds ? static_cast<unsigned int>(i) : 0;
+	}
+	const size_t size = m_commands.size() * sizeof(unsigned int);
+	const uint64_t hash = HashCommands(m_commands);
+	size_t offset = m_data.size();
+	bool found = false;
+	auto range = m_blocksByHash.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		auto& block = m_blocks[it->second];
+		if (block.size == size && memcmp(m_data.data() + block.offset, m_commands.data(), size) == 0)
+		{
+			block.lastUsedFrame = m_frame;
+			offset = block.offset;
+			found = true;
+			break;
+		}
+	}
+	if (!found)
+	{
+		//Least recently used block of the same size is rewritten, so blocks of lists that were drawn lately stay available
+		size_t reusable = m_blocks.size();
+		auto sizeIt = m_blocksBySize.find(size);
+		if (sizeIt != m_blocksBySize.end())
+		{
+			for (size_t index : sizeIt->second)
+			{
+				auto& block = m_blocks[index];
+				if (block.lastUsedFrame != m_frame && (reusable == m_blocks.size() || block.lastUsedFrame < m_blocks[reusable].lastUsedFrame))
+				{
+					reusable = index;
+				}
+			}
+		}
+		offset = reusable != m_blocks.size() ? Rewrite(reusable, hash) : Append(hash);
+	}
+	Flush();
+	return offset;
+}
+
+size_t COpenGLIndirectCache::Rewrite(size_t blockIndex, uint64_t hash)
+{
+	auto& block = m_blocks[blockIndex];
+	auto range = m_blocksByHash.equal_range(block.hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (it->second == blockIndex)
+		{
+			m_blocksByHash.erase(it);
+			break;
+		}
+	}
+	block.hash = hash;
+	block.lastUsedFrame = m_frame;
+	m_blocksByHash.emplace(hash, blockIndex);
+	//Commands are compared by 4 byte words, changed words next to each other make one range
+	const char* source = reinterpret_cast<const char*>(m_commands.data());
+	char* destination = m_data.data() + block.offset;
+	const size_t words = block.size / sizeof(unsigned int);
+	for (size_t i = 0; i < words;)
+	{
+		if (memcmp(destination + i * sizeof(unsigned int), source + i * sizeof(unsigned int), sizeof(unsigned int)) == 0)
+		{
+			++i;
+			continue;
+		}
+		size_t end = i + 1;
+		while (end < words && memcmp(destination + end * sizeof(unsigned int), source + end * sizeof(unsigned int), sizeof(unsigned int)) != 0)
+		{
+			++end;
+		}
+		memcpy(destination + i * sizeof(unsigned int), source + i * sizeof(unsigned int), (end - i) * sizeof(unsigned int));
+		m_dirtyRanges.push_back({ block.offset + i * sizeof(unsigned int), block.offset + end * sizeof(unsigned int) });
+		i = end;
+	}
+	return block.offset;
+}
+
+size_t COpenGLIndirectCache::Append(uint64_t hash)
+{
+	const size_t size = m_commands.size() * sizeof(unsigned int);
+	if (m_data.size() + size > MAX_CACHE_SIZE)
+	{
+		Clear();
+	}
+	const size_t offset = m_data.size();
+	m_data.resize(offset + size);
+	memcpy(m_data.data() + offset, m_commands.data(), size);
+	m_blocksByHash.emplace(hash, m_blocks.size());
+	m_blocksBySize[size].push_back(m_blocks.size());
+	m_blocks.push_back({ offset, size, hash, m_frame });
+	m_dirtyRanges.push_back({ offset, offset + size });
+	return offset;
+}
+
+void COpenGLIndirectCache::Flush()
+{
+	if (!m_buffer)
+	{
+		glGenBuffers(1, &m_buffer);
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_buffer);
+	if (m_dirtyRanges.empty())
+	{
+		return;
+	}
+	if (m_data.size() > m_bufferSize)
+	{
+		m_bufferSize = std::max({ m_data.size(), m_bufferSize * 2, MIN_BUFFER_SIZE });
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, m_bufferSize, nullptr, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, m_data.size(), m_data.data());
+		m_dirtyRanges.clear();
+		return;
+	}
+	std::sort(m_dirtyRanges.begin(), m_dirtyRanges.end());
+	size_t begin = m_dirtyRanges.front().first;
+	size_t end = m_dirtyRanges.front().second;
+	for (auto& range : m_dirtyRanges)
+	{
+		if (range.first > end)
+		{
+			glBufferSubData(GL_DRAW_INDIRECT_BUFFER, begin, end - begin, m_data.data() + begin);
+			begin = range.first;
+		}
+		end = std::max(end, range.second);
+	}
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, begin, end - begin, m_data.data() + begin);
+	m_dirtyRanges.clear();
+}
+
+void COpenGLIndirectCache::Clear()
+{
+	m_data.clear();
+	m_blocks.clear();
+	m_blocksByHash.clear();
+	m_blocksBySize.clear();
+	m_dirtyRanges.clear();
+}
+
+void COpenGLIndirectCache::EndFrame()
+{
+	++m_frame;
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+#include "../view/IRenderer.h"
+#include <unordered_map>
+#include <vector>
+
+struct DrawElementsIndirectCommand
+{
+	unsigned int count;
+	unsigned int primCount;
+	unsigned int firstIndex;
+	unsigned int baseVertex;
+	unsigned int baseInstance;
+};
+
+struct DrawArraysIndirectCommand
+{
+	unsigned int count;
+	unsigned int primCount;
+	unsigned int first;
+	unsigned int baseInstance;
+};
+
+//Indirect commands of recent draws kept in one GL_DRAW_INDIRECT_BUFFER. Blocks are found by hash of their commands,
+//so draw lists that do not change between frames are uploaded once. If list is not found, least recently used block of the same size
+//that was not used in current frame is rewritten, and only commands that differ are uploaded again
+class COpenGLIndirectCache
+{
+public:
+	COpenGLIndirectCache() = default;
+	~COpenGLIndirectCache();
+	COpenGLIndirectCache(COpenGLIndirectCache const&) = delete;
+	COpenGLIndirectCache& operator=(COpenGLIndirectCache const&) = delete;
+
+	//Binds buffer to GL_DRAW_INDIRECT_BUFFER and returns byte offset of commands.
+	//If drawIds is true, base instance of every command is its index in the list
+	size_t Get(array_view<wargameEngine::view::IRenderer::IndirectDraw> const& list, bool indexed, bool drawIds);
+	void EndFrame();
+
+private:
+	struct sBlock
+	{
+		size_t offset;
+		size_t size;
+		uint64_t hash;
+		unsigned int lastUsedFrame;
+	};
+
+	size_t Rewrite(size_t blockIndex, uint64_t hash);
+	size_t Append(uint64_t hash);
+	void Flush();
+	void Clear();
+
+	std::vector<unsigned int> m_commands;
+	//Copy of buffer contents, so changed commands can be found without reading GPU memory
+	std::vector<char> m_data;
+	std::vector<sBlock> m_blocks;
+	std::unordered_multimap<uint64_t, size_t> m_blocksByHash;
+	std::unordered_map<size_t, std::vector<size_t>> m_blocksBySize;
+	std::vector<std::pair<size_t, size_t>> m_dirtyRanges;
+	size_t m_bufferSize = 0;
+	unsigned int m_buffer = 0;
+	unsigned int m_frame = 0;
+};
\ No newline at end of file
@@ -14,6 +14,9 @@ using namespace view;
 
 namespace
 {
+//Optional uint attribute that tells indexed mesh drawn by multi draw indirect its index in draw list
+constexpr char DRAW_ID_ATTRIBUTE[] = "drawId";
+
 class COpenGLVertexBuffer : public IVertexBuffer
 {
 public:
@@ -98,6 +101,15 @@ public:
 		}
 	}
 
+	void AddVertexAttribute(COpenGLRenderer& renderer, CShaderManagerOpenGL& shaderManager, const std::string& attribute, int elementSize, IVertexAttribCache const& cache, IShaderManager::Format type, bool perInstance, size_t offset)
+	{
+		if (m_cache)
+		{
+			Bind(renderer, shaderManager);
+		}
+		shaderManager.SetVertexAttribute(attribute, cache, elementSize, 0, type, perInstance, offset);
+	}
+
 private:
 	mutable std::unordered_map<const IShaderProgram*, GLuint> m_vaos;
 	GLuint m_indexesBuffer = 0;
@@ -280,9 +292,11 @@ COpenGLRenderer::COpenGLRenderer()
 	glBindVertexArray(m_vao);
 
 	m_color[3] = 1.0f;
+	m_colorUniform = m_shaderManager.GetUniformHandle("color");
+	m_lightsCountUniform = m_shaderManager.GetUniformHandle("lightsCount");
 	m_shaderManager.DoOnProgramChange([this]() {
 		m_matrixManager.InvalidateMatrices();
-		m_shaderManager.SetUniformValue("color", 4, 1, m_color);
+		m_shaderManager.SetUniformValue(m_colorUniform, 4, 1, m_color);
 	});
 
 	m_defaultProgram = m_shaderManager.NewProgram(Path(), Path(), Path());
@@ -340,67 +354,50 @@ void COpenGLRenderer::DrawIndexed(IVertexBuffer& vertexBuffer, size_t count, siz
 	PerfomanceMeter::ReportDraw(instances > 1 ? instances * count : count, RenderMode::Triangles);
 }
 
-typedef struct {
-	GLuint count;
-	GLuint primCount;
-	GLuint firstIndex;
-	GLuint baseVertex;
-	GLuint baseInstance;
-} DrawElementsIndirectCommand;
-
-typedef  struct {
-	GLuint  count;
-	GLuint  primCount;
-	GLuint  first;
-	GLuint  baseInstance;
-} DrawArraysIndirectCommand;
-
 void COpenGLRenderer::DrawIndirect(IVertexBuffer& buffer, const array_view<IndirectDraw>& indirectList, bool indexed)
 {
-	if (GL_ARB_draw_indirect && indirectList.size() > 5)
+	if (GLEW_ARB_draw_indirect && indirectList.size() > 5)
 	{
 		reinterpret_cast<COpenGLVertexBuffer&>(buffer).Bind(*this, m_shaderManager);
 		m_matrixManager.UpdateMatrices(m_shaderManager);
-		if (!m_drawIndirectBuffer)
+		const bool multiDraw = GLEW_ARB_multi_draw_indirect != GL_FALSE;
+		//Draw ID is read from instanced attribute, so every command must draw one instance
+		bool drawIds = indexed && multiDraw && GLEW_ARB_base_instance && m_shaderManager.HasVertexAttribute(DRAW_ID_ATTRIBUTE);
+		for (size_t i = 0; drawIds && i < indirectList.size(); ++i)
 		{
-			glGenBuffers(1, &m_drawIndirectBuffer);
+			drawIds = indirectList[i].instances <= 1;
 		}
-		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_drawIndirectBuffer);
+		if (drawIds)
+		{
+			SetDrawIds(indirectList.size());
+		}
+		const size_t offset = m_indirectCache.Get(indirectList, indexed, drawIds);
+		const GLsizei drawCount = static_cast<GLsizei>(indirectList.size());
 		if (indexed)
 		{
-			std::vector<DrawElementsIndirectCommand> commands;
-			std::transform(indirectList.begin(), indirectList.end(), std::back_inserter(commands), [](const IndirectDraw& indirect) {
-				return DrawElementsIndirectCommand{ static_cast<GLuint>(indirect.count), static_cast<GLuint>(indirect.instances), static_cast<GLuint>(indirect.start), 0, 0 };
-			});
-			glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STREAM_DRAW);
-			if (GL_ARB_multi_draw_indirect)
+			if (multiDraw)
 			{
-				glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, NULL, indirectList.size(), sizeof(DrawElementsIndirectCommand));
+				glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<void*>(offset), drawCount, sizeof(DrawElementsIndirectCommand));
 			}
 			else
 			{
 				for (size_t i = 0; i < indirectList.size(); ++i)
 				{
-					glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(i * sizeof(DrawElementsIndirectCommand)));
+					glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<void*>(offset + i * sizeof(DrawElementsIndirectCommand)));
 				}
 			}
 		}
 		else
 		{
-			std::vector<DrawArraysIndirectCommand> commands;
-			std::transform(indirectList.begin(), indirectList.end(), std::back_inserter(commands), [](const IndirectDraw& indirect) {
-				return DrawArraysIndirectCommand{ static_cast<GLuint>(indirect.count), static_cast<GLuint>(indirect.instances), static_cast<GLuint>(indirect.start), 0 };
-			});
-			glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawArraysIndirectCommand), commands.data(), GL_STREAM_DRAW);
-			if (GL_ARB_multi_draw_indirect)
+			if (multiDraw)
 			{
-				glMultiDrawArraysIndirect(GL_TRIANGLES, NULL, indirectList.size(), sizeof(DrawArraysIndirectCommand));
+				glMultiDrawArraysIndirect(GL_TRIANGLES, reinterpret_cast<void*>(offset), drawCount, sizeof(DrawArraysIndirectCommand));
 			}
 			else
 			{
 				for (size_t i = 0; i < indirectList.size(); ++i)
 				{
-					glDrawArraysIndirect(GL_TRIANGLES, (void*)(i * sizeof(DrawArraysIndirectCommand)));
+					glDrawArraysIndirect(GL_TRIANGLES, reinterpret_cast<void*>(offset + i * sizeof(DrawArraysIndirectCommand)));
 				}
 			}
 		}
@@ -440,6 +437,18 @@ void COpenGLRenderer::Draw(IVertexBuffer& vertexBuffer, size_t count, size_t beg
 	PerfomanceMeter::ReportDraw(instances > 1 ? instances * count : count, RenderMode::Triangles);
 }
 
+void COpenGLRenderer::SetDrawIds(size_t count)
+{
+	if (count > m_drawIdsCount)
+	{
+		m_drawIdsCount = std::max(count, m_drawIdsCount * 2);
+		std::vector<unsigned int> drawIds(m_drawIdsCount);
+		std::iota(drawIds.begin(), drawIds.end(), 0);
+		m_drawIds = m_shaderManager.CreateVertexAttribCache(drawIds.size() * sizeof(unsigned int), drawIds.data());
+	}
+	m_shaderManager.SetVertexAttribute(DRAW_ID_ATTRIBUTE, *m_drawIds, 1, count, IShaderManager::Format::UInt32, true);
+}
+
 void COpenGLRenderer::SetIndexBuffer(IVertexBuffer& buffer, const unsigned int* indexPtr, size_t indexesSize)
 {
 	GLuint indexBuffer;
@@ -455,6 +464,11 @@ void COpenGLRenderer::AddVertexAttribute(IVertexBuffer& buffer, const std::strin
 	reinterpret_cast<COpenGLVertexBuffer&>(buffer).AddVertexAttribute(*this, m_shaderManager, attribute, elementSize, count, type, values, perInstance);
 }
 
+void COpenGLRenderer::AddVertexAttribute(IVertexBuffer& buffer, const std::string& attribute, int elementSize, IVertexAttribCache const& cache, IShaderManager::Format type, bool perInstance, size_t offset)
+{
+	reinterpret_cast<COpenGLVertexBuffer&>(buffer).AddVertexAttribute(*this, m_shaderManager, attribute, elementSize, cache, type, perInstance, offset);
+}
+
 void COpenGLRenderer::PushMatrix()
 {
 	m_matrixManager.PushMatrix();
@@ -683,7 +697,7 @@ void COpenGLRenderer::SetColor(unsigned char r, unsigned char g, unsigned char b
 void COpenGLRenderer::SetColor(const float* color)
 {
 	memcpy(m_color, color, sizeof(float) * 4);
-	m_shaderManager.SetUniformValue("color", 4, 1, m_color);
+	m_shaderManager.SetUniformValue(m_colorUniform, 4, 1, m_color);
 }
 
 void COpenGLRenderer::SetMaterial(const float* ambient, const float* diffuse, const float* specular, const float shininess)
@@ -891,18 +905,23 @@ void COpenGLRenderer::WorldCoordsToWindowCoords(IViewport& viewport, CVector3f c
 
 void COpenGLRenderer::SetNumberOfLights(size_t count)
 {
-	static const string numberOfLightsKey = "lightsCount";
 	int number = static_cast<int>(count);
-	m_shaderManager.SetUniformValue(numberOfLightsKey, 1, 1, &number);
+	m_shaderManager.SetUniformValue(m_lightsCountUniform, 1, 1, &number);
 }
 
 void COpenGLRenderer::SetUpLight(size_t index, CVector3f const& position, const float* ambient, const float* diffuse, const float* specular)
 {
-	const string key = "lights[" + to_string(index) + "].";
-	m_shaderManager.SetUniformValue(key + "pos", 3, 1, position.ptr());
-	m_shaderManager.SetUniformValue(key + "ambient", 4, 1, ambient);
-	m_shaderManager.SetUniformValue(key + "diffuse", 4, 1, diffuse);
-	m_shaderManager.SetUniformValue(key + "specular", 4, 1, specular);
+	while (m_lightUniforms.size() <= index)
+	{
+		const string key = "lights[" + to_string(m_lightUniforms.size()) + "].";
+		m_lightUniforms.push_back({ m_shaderManager.GetUniformHandle(key + "pos"), m_shaderManager.GetUniformHandle(key + "ambient"),
+			m_shaderManager.GetUniformHandle(key + "diffuse"), m_shaderManager.GetUniformHandle(key + "specular") });
+	}
+	auto& uniforms = m_lightUniforms[index];
+	m_shaderManager.SetUniformValue(uniforms.position, 3, 1, position.ptr());
+	m_shaderManager.SetUniformValue(uniforms.ambient, 4, 1, ambient);
+	m_shaderManager.SetUniformValue(uniforms.diffuse, 4, 1, diffuse);
+	m_shaderManager.SetUniformValue(uniforms.specular, 4, 1, specular);
 }
 
 float COpenGLRenderer::GetMaximumAnisotropyLevel() const
@@ -1005,6 +1024,12 @@ void COpenGLRenderer::EnableMultisampling(bool enable)
 	}
 }
 
+void COpenGLRenderer::EndFrame()
+{
+	m_shaderManager.EndFrame();
+	m_indirectCache.EndFrame();
+}
+
 void COpenGLRenderer::BindVAO(unsigned vao, unsigned indexBuffer)
 {
 	if (vao == 0)
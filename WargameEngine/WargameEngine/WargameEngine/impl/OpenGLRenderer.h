@@ -1,9 +1,11 @@
 #pragma once
 #include "IOpenGLRenderer.h"
 #include "MatrixManagerGLM.h"
+#include "OpenGLIndirectCache.h"
 #include "ShaderManagerOpenGL.h"
 
 using wargameEngine::view::IVertexBuffer;
+using wargameEngine::view::IVertexAttribCache;
 using wargameEngine::view::IShaderManager;
 using wargameEngine::view::ICachedTexture;
 using wargameEngine::view::TextureMipMaps;
@@ -22,6 +24,7 @@ public:
 	void DrawIndirect(IVertexBuffer& buffer, const array_view<IndirectDraw>& indirectList, bool indexed) override;
 	void SetIndexBuffer(IVertexBuffer& buffer, const unsigned int* indexPtr, size_t indexesSize) override;
 	void AddVertexAttribute(IVertexBuffer& buffer, const std::string& attribute, int elementSize, size_t count, IShaderManager::Format type, const void* values, bool perInstance = false) override;
+	void AddVertexAttribute(IVertexBuffer& buffer, const std::string& attribute, int elementSize, IVertexAttribCache const& cache, IShaderManager::Format type, bool perInstance = false, size_t offset = 0) override;
 
 	void PushMatrix() override;
 	void PopMatrix() override;
@@ -83,19 +86,36 @@ public:
 	void DrawIn2D(std::function<void()> const& drawHandler) override;
 
 	void EnableMultisampling(bool enable) override;
+	void EndFrame() override;
 
 	void BindVAO(unsigned vao, unsigned indexBuffer);
 
 private:
+	//Binds sequence 0, 1, 2... to draw ID attribute. Base instance of indirect command selects its element
+	void SetDrawIds(size_t count);
+
+	struct sLightUniforms
+	{
+		wargameEngine::view::UniformHandle position;
+		wargameEngine::view::UniformHandle ambient;
+		wargameEngine::view::UniformHandle diffuse;
+		wargameEngine::view::UniformHandle specular;
+	};
+
 	wargameEngine::view::TextureManager* m_textureManager = nullptr;
 	CShaderManagerOpenGL m_shaderManager;
 	float m_color[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	wargameEngine::view::UniformHandle m_colorUniform;
+	wargameEngine::view::UniformHandle m_lightsCountUniform;
+	std::vector<sLightUniforms> m_lightUniforms;
 	int m_viewport[4];
 	std::unique_ptr<wargameEngine::view::IShaderProgram> m_defaultProgram;
 	unsigned int m_vao = 0;
 	unsigned int m_activeVao = 0;
 	unsigned int m_indexBuffer = 0;
-	unsigned int m_drawIndirectBuffer = 0;
+	COpenGLIndirectCache m_indirectCache;
+	std::unique_ptr<IVertexAttribCache> m_drawIds;
+	size_t m_drawIdsCount = 0;
 	CMatrixManagerGLM m_matrixManager;
 	std::vector<unsigned> m_currentTextures;
 	bool m_supportsMultibind = false;
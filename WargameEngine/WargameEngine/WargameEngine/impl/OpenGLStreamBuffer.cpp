@@ -0,0 +1,188 @@
+#include "OpenGLStreamBuffer.h"
+#include "../view/PerfomanceMeter.h"
+#include <GL/glew.h>
+#include "gl.h"
+#include <algorithm>
+#include <string.h>
+
+using namespace wargameEngine;
+using namespace view;
+
+namespace
+{
+//Offsets are aligned, so attributes of any type can start there
+constexpr size_t ALIGNMENT = 16;
+//Wait is limited, so a lost context does not hang the game
+constexpr GLuint64 MAX_WAIT_NS = 1000000000;
+
+size_t Align(size_t value, size_t alignment = ALIGNMENT)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+}
+
+COpenGLStreamBuffer::COpenGLStreamBuffer(size_t regionSize)
+	: m_regionSize(Align(regionSize))
+{
+	CreateStorage();
+}
+
+COpenGLStreamBuffer::~COpenGLStreamBuffer()
+{
+	DeleteStorage();
+	if (!m_overflowBuffers.empty())
+	{
+		glDeleteBuffers(static_cast<GLsizei>(m_overflowBuffers.size()), m_overflowBuffers.data());
+	}
+}
+
+void COpenGLStreamBuffer::CreateStorage()
+{
+	const size_t size = m_regionSize * FRAMES;
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+	if (GLEW_ARB_buffer_storage)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+		m_persistentData = static_cast<char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+	}
+	m_region = 0;
+	m_offset = 0;
+	m_regionReady = true;
+}
+
+void COpenGLStreamBuffer::DeleteStorage()
+{
+	for (auto& fence : m_fences)
+	{
+		if (fence)
+		{
+			glDeleteSync(static_cast<GLsync>(fence));
+			fence = nullptr;
+		}
+	}
+	if (m_persistentData)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		m_persistentData = nullptr;
+	}
+	glDeleteBuffers(1, &m_buffer);
+	m_buffer = 0;
+}
+
+void COpenGLStreamBuffer::WaitForRegion()
+{
+	m_regionReady = true;
+	auto& fence = m_fences[m_region];
+	if (!fence)
+	{
+		return;
+	}
+	GLsync sync = static_cast<GLsync>(fence);
+	GLenum result = glClientWaitSync(sync, 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		//GPU is still reading data written FRAMES frames ago
+		PerfomanceMeter::ReportStreamStall();
+		glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, MAX_WAIT_NS);
+	}
+	glDeleteSync(sync);
+	fence = nullptr;
+}
+
+void COpenGLStreamBuffer::Orphan(unsigned int buffer, std::initializer_list<Part> parts, size_t size)
+{
+	m_lastBuffer = buffer;
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	//New storage is allocated, draws issued before keep reading the old one
+	glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+	size_t offset = 0;
+	for (auto& part : parts)
+	{
+		if (part.second)
+		{
+			glBufferSubData(GL_ARRAY_BUFFER, offset, part.second, part.first);
+			offset += part.second;
+		}
+	}
+}
+
+size_t COpenGLStreamBuffer::Upload(std::initializer_list<Part> parts, size_t alignment)
+{
+	size_t size = 0;
+	for (auto& part : parts)
+	{
+		size += part.second;
+	}
+	PerfomanceMeter::ReportStreamUpload(size);
+	if (!m_persistentData)
+	{
+		Orphan(m_buffer, parts, size);
+		return 0;
+	}
+	m_frameRequested += Align(size, std::max(alignment, ALIGNMENT));
+	if (alignment > ALIGNMENT)
+	{
+		const size_t regionStart = m_region * m_regionSize;
+		m_offset = Align(regionStart + m_offset, alignment) - regionStart;
+	}
+	if (m_offset + size > m_regionSize)
+	{
+		m_overflow = true;
+		GLuint buffer;
+		glGenBuffers(1, &buffer);
+		m_overflowBuffers.push_back(buffer);
+		Orphan(buffer, parts, size);
+		return 0;
+	}
+	if (!m_regionReady)
+	{
+		WaitForRegion();
+	}
+	const size_t offset = m_region * m_regionSize + m_offset;
+	m_lastBuffer = m_buffer;
+	glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+	char* data = m_persistentData + offset;
+	for (auto& part : parts)
+	{
+		if (part.second)
+		{
+			memcpy(data, part.first, part.second);
+			data += part.second;
+		}
+	}
+	m_offset = Align(m_offset + size);
+	return offset;
+}
+
+unsigned int COpenGLStreamBuffer::GetBuffer() const
+{
+	return m_lastBuffer;
+}
+
+void COpenGLStreamBuffer::EndFrame()
+{
+	if (m_overflow)
+	{
+		//Storage may be used by GPU yet, but driver keeps deleted buffers until they are not needed
+		glDeleteBuffers(static_cast<GLsizei>(m_overflowBuffers.size()), m_overflowBuffers.data());
+		m_overflowBuffers.clear();
+		DeleteStorage();
+		while (m_regionSize < m_frameRequested)
+		{
+			m_regionSize *= 2;
+		}
+		CreateStorage();
+		m_overflow = false;
+	}
+	else if (m_offset > 0)
+	{
+		m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_region = (m_region + 1) % FRAMES;
+		m_offset = 0;
+		m_regionReady = false;
+	}
+	m_frameRequested = 0;
+}
\ No newline at end of file
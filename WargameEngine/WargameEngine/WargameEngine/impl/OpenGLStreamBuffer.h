@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+//Ring buffer for vertex data that is generated every frame. Storage is split into regions for consecutive frames,
+//and region is written again only after fence of the frame that used it is signaled.
+//Without ARB_buffer_storage every upload orphans the buffer instead, mapping it each time is several times slower
+class COpenGLStreamBuffer
+{
+public:
+	typedef std::pair<const void*, size_t> Part;
+
+	explicit COpenGLStreamBuffer(size_t regionSize = 4 * 1024 * 1024);
+	~COpenGLStreamBuffer();
+	COpenGLStreamBuffer(COpenGLStreamBuffer const&) = delete;
+	COpenGLStreamBuffer& operator=(COpenGLStreamBuffer const&) = delete;
+
+	//Copies parts one after another and returns byte offset of the first one. Buffer stays bound to GL_ARRAY_BUFFER.
+	//Data that does not fit current region is uploaded to its own buffer and region grows next frame.
+	//Alignment must be a power of two, uniform buffer ranges need GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+	size_t Upload(std::initializer_list<Part> parts, size_t alignment = 16);
+	//Buffer that holds data of the last upload
+	unsigned int GetBuffer() const;
+	//Fences the region of current frame. Next frame uses next region
+	void EndFrame();
+
+private:
+	static constexpr size_t FRAMES = 3;
+
+	void CreateStorage();
+	void DeleteStorage();
+	void WaitForRegion();
+	void Orphan(unsigned int buffer, std::initializer_list<Part> parts, size_t size);
+
+	unsigned int m_buffer = 0;
+	//Kept until the end of frame, so every overflowed draw reads its own data
+	std::vector<unsigned int> m_overflowBuffers;
+	unsigned int m_lastBuffer = 0;
+	char* m_persistentData = nullptr;
+	void* m_fences[FRAMES] = {};
+	size_t m_regionSize;
+	size_t m_region = 0;
+	size_t m_offset = 0;
+	size_t m_frameRequested = 0;
+	bool m_regionReady = true;
+	bool m_overflow = false;
+};
\ No newline at end of file
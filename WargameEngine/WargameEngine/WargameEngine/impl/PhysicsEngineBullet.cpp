@@ -10,6 +10,8 @@
 #include "../model/Landscape.h"
 #include "../model/IBoundingBoxManager.h"
 #include "../view/IRenderer.h"
+#include "../ThreadPool.h"
+#include <atomic>
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include "../LogWriter.h"
@@ -218,6 +220,31 @@ public:
 		return result;
 	}
 
+	size_t CastRays(array_view<IPhysicsEngine::Ray> const& rays, IPhysicsEngine::RayFilter const& excludeObjects, ThreadPool& threadPool, size_t stopAfterFreeRays) const
+	{
+		//btCollisionWorld::rayTest shares the broadphase traversal stack, so workers walk the broadphase trees with static btDbvt::rayTest
+		//and test shapes with static rayTestSingle. Both only read the world, which stays unchanged while caller is blocked
+		auto broadphase = static_cast<const btDbvtBroadphase*>(m_overlappingPairCache.get());
+		std::atomic<size_t> freeRays(0);
+		threadPool.ParallelFor(0, rays.size(), [&](size_t begin, size_t end) {
+			size_t localFreeRays = 0;
+			for (size_t i = begin; i < end && freeRays.load(std::memory_order_relaxed) + localFreeRays < stopAfterFreeRays; ++i)
+			{
+				RayBlockerFinder finder(ToBtVector3(rays[i].origin), ToBtVector3(rays[i].dest), excludeObjects);
+				for (int set = 0; set < 2 && !finder.blocked; ++set)
+				{
+					btDbvt::rayTest(broadphase->m_sets[set].m_root, finder.from, finder.to, finder);
+				}
+				if (!finder.blocked)
+				{
+					++localFreeRays;
+				}
+			}
+			freeRays += localFreeRays;
+		}, RAYS_GRAIN_SIZE);
+		return freeRays;
+	}
+
 	void AddBounding(const Path& modelName, Bounding const& bounding)
 	{
 		std::function<std::unique_ptr<btCollisionShape>(Bounding const&)> processShape = [&processShape, this](Bounding const& bounding)->std::unique_ptr<btCollisionShape> {
@@ -379,6 +406,52 @@ private:
 		std::function<void()> m_onUpdate;
 	};
 
+	struct AnyHitRayCallback : public btCollisionWorld::RayResultCallback
+	{
+		btScalar addSingleResult(btCollisionWorld::LocalRayResult& rayResult, bool) override
+		{
+			m_collisionObject = rayResult.m_collisionObject;
+			//No hit can be closer, so shapes stop testing
+			m_closestHitFraction = 0;
+			return 0;
+		}
+	};
+
+	struct RayBlockerFinder : public btDbvt::ICollide
+	{
+		RayBlockerFinder(btVector3 const& rayFrom, btVector3 const& rayTo, IPhysicsEngine::RayFilter const& excludeObjects)
+			: from(rayFrom), to(rayTo), exclude(excludeObjects)
+		{
+			fromTransform.setIdentity();
+			fromTransform.setOrigin(from);
+			toTransform.setIdentity();
+			toTransform.setOrigin(to);
+		}
+
+		void Process(const btDbvtNode* leaf)
+		{
+			if (blocked)
+				return;
+			auto collisionObject = static_cast<const btCollisionObject*>(static_cast<btBroadphaseProxy*>(leaf->data)->m_clientObject);
+			//Static objects and ground have no owner and never block line of sight
+			auto owner = static_cast<const IBaseObject*>(collisionObject->getUserPointer());
+			if (!owner || !btRigidBody::upcast(collisionObject) || exclude.find(owner) != exclude.end())
+				return;
+			AnyHitRayCallback callback;
+			btCollisionWorld::rayTestSingle(fromTransform, toTransform, const_cast<btCollisionObject*>(collisionObject), collisionObject->getCollisionShape(),
+				collisionObject->getWorldTransform(), callback);
+			blocked = callback.hasHit();
+		}
+
+		btVector3 from;
+		btVector3 to;
+		btTransform fromTransform;
+		btTransform toTransform;
+		IPhysicsEngine::RayFilter const& exclude;
+		bool blocked = false;
+	};
+	static const size_t RAYS_GRAIN_SIZE = 32;
+
 	struct Object
 	{
 		std::unique_ptr<btRigidBody> rigidBody;
@@ -445,6 +518,11 @@ IPhysicsEngine::CastRayResult CPhysicsEngineBullet::CastRay(CVector3f const& ori
 	return m_pImpl->CastRay(origin, dest, excludeObjects);
 }
 
+size_t CPhysicsEngineBullet::CastRays(array_view<Ray> const& rays, RayFilter const& excludeObjects, ThreadPool& threadPool, size_t stopAfterFreeRays) const
+{
+	return m_pImpl->CastRays(rays, excludeObjects, threadPool, stopAfterFreeRays);
+}
+
 bool CPhysicsEngineBullet::TestObject(IBaseObject * object) const
 {
 	return m_pImpl->TestObject(object);
@@ -18,6 +18,7 @@ public:
 	void RemoveObject(IBaseObject* object) override;
 	void SetGround(wargameEngine::model::Landscape* landscape) override;
 	CastRayResult CastRay(CVector3f const& origin, CVector3f const& dest, std::vector<IBaseObject*> const& excludeObjects = std::vector<IBaseObject*>()) const override;
+	size_t CastRays(array_view<Ray> const& rays, RayFilter const& excludeObjects, wargameEngine::ThreadPool& threadPool, size_t stopAfterFreeRays = SIZE_MAX) const override;
 	bool TestObject(IBaseObject* object) const override;
 	void Draw(wargameEngine::view::IRenderer& renderer) const override;
 
@@ -1,6 +1,7 @@
 #include "ScriptHandlerLua.h"
 #include "../LogWriter.h"
 #include "../Utils.h"
+#include "../Profiler.h"
 #include <lua.hpp>
 
 using namespace wargameEngine;
@@ -322,6 +323,7 @@ void CScriptHandlerLua::RunScript(const Path& path)
 
 void CScriptHandlerLua::CallFunctionImpl(FunctionArguments const& arguments, lua_State* lua_state)
 {
+	Profiler::Zone zone("Lua");
 	for (auto& arg : arguments)
 	{
 		PushReturnValue(lua_state, arg);
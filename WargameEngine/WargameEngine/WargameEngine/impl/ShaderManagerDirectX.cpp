@@ -83,8 +83,17 @@ public:
 	{
 		return &m_pBuffer;
 	}
+	size_t GetSize() const
+	{
+		return m_size;
+	}
+	void SetSize(size_t size)
+	{
+		m_size = size;
+	}
 private:
 	CComPtr<ID3D11Buffer> m_pBuffer;
+	size_t m_size = 0;
 };
 
 CShaderManagerDirectX::CShaderManagerDirectX(CDirectXRenderer * render)
@@ -306,6 +315,26 @@ void CShaderManagerDirectX::SetUniformValue(std::string const& uniform, int elem
 	SetUniformValueImpl(uniform, elementSize, count, value);
 }
 
+UniformHandle CShaderManagerDirectX::GetUniformHandle(std::string const& uniform) const
+{
+	return m_uniforms.Get(uniform);
+}
+
+void CShaderManagerDirectX::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const float* value) const
+{
+	SetUniformValue(m_uniforms.GetName(uniform), elementSize, count, value);
+}
+
+void CShaderManagerDirectX::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const int* value) const
+{
+	SetUniformValue(m_uniforms.GetName(uniform), elementSize, count, value);
+}
+
+void CShaderManagerDirectX::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const unsigned int* value) const
+{
+	SetUniformValue(m_uniforms.GetName(uniform), elementSize, count, value);
+}
+
 void CShaderManagerDirectX::SetUniformValueImpl(std::string const& uniform, int elementSize, size_t count, const void* value) const
 {
 	auto buffer = FindBuffer(uniform);
@@ -340,14 +369,22 @@ void CShaderManagerDirectX::SetVertexAttributeImpl(std::string const& attribute,
 	}
 }
 
-std::unique_ptr<IVertexAttribCache> CShaderManagerDirectX::CreateVertexAttribCache(size_t size, const void* value) const
+std::unique_ptr<IVertexAttribCache> CShaderManagerDirectX::CreateVertexAttribCache(size_t size, const void* value, bool /*dynamic*/) const
 {
 	auto result = std::make_unique<CVertexAttribCacheDirectX>();
 	CreateBuffer(result->GetBufferPtr(), size);
 	CopyBufferData(result->GetBuffer(), value, size);
+	result->SetSize(size);
 	return std::move(result);
 }
 
+void CShaderManagerDirectX::UpdateVertexAttribCache(IVertexAttribCache& cache, const void* value, size_t /*offset*/, size_t /*size*/) const
+{
+	//Buffers are dynamic and mapped with discard, which throws away the whole contents
+	auto& dxCache = reinterpret_cast<CVertexAttribCacheDirectX&>(cache);
+	CopyBufferData(dxCache.GetBuffer(), value, dxCache.GetSize());
+}
+
 void CShaderManagerDirectX::SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const float* values, bool perInstance) const
 {
 	static const DXGI_FORMAT format[] = { DXGI_FORMAT_R32_FLOAT, DXGI_FORMAT_R32G32_FLOAT, DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R32G32B32A32_FLOAT };
@@ -27,6 +27,10 @@ public:
 	void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const float* value) const override;
 	void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const int* value) const override;
 	void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const unsigned int* value) const override;
+	wargameEngine::view::UniformHandle GetUniformHandle(std::string const& uniform) const override;
+	void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const float* value) const override;
+	void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const int* value) const override;
+	void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const unsigned int* value) const override;
 
 	void SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const float* values, bool perInstance = false) const override;
 	void SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const int* values, bool perInstance = false) const override;
@@ -35,7 +39,8 @@ public:
 	void DisableVertexAttribute(std::string const& attribute, int size, const int* defaultValue) const override;
 	void DisableVertexAttribute(std::string const& attribute, int size, const unsigned int* defaultValue) const override;
 
-	std::unique_ptr<IVertexAttribCache> CreateVertexAttribCache(size_t size, const void* value) const override;
+	std::unique_ptr<IVertexAttribCache> CreateVertexAttribCache(size_t size, const void* value, bool dynamic = false) const override;
+	void UpdateVertexAttribCache(IVertexAttribCache& cache, const void* value, size_t offset, size_t size) const override;
 
 	void SetVertexAttribute(std::string const& attribute, IVertexAttribCache const& cache, int elementSize, size_t count, Format type, bool perInstance = false, size_t offset = 0) const override;
 
@@ -98,4 +103,5 @@ private:
 	typedef std::vector<std::pair<LPCSTR, DXGI_FORMAT>> InputLayoutDesc;
 	mutable std::map<InputLayoutDesc, CComPtr<ID3D11InputLayout>> m_inputLayouts;
 	mutable std::tuple<DXGI_FORMAT, DXGI_FORMAT, DXGI_FORMAT> m_lastInputLayout;
+	mutable wargameEngine::view::UniformRegistry m_uniforms;
 };
\ No newline at end of file
@@ -21,11 +21,16 @@ public:
 class CLegacyGLVertexAttribCache : public IVertexAttribCache
 {
 public:
-	CLegacyGLVertexAttribCache(size_t size, const void* data)
+	CLegacyGLVertexAttribCache(size_t size, const void* data, bool dynamic)
 	{
 		glGenBuffers(1, &m_cache);
 		glBindBuffer(GL_ARRAY_BUFFER, m_cache);
-		glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, size, data, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+	}
+	void Update(const void* data, size_t offset, size_t size)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, m_cache);
+		glBufferSubData(GL_ARRAY_BUFFER, offset, size, reinterpret_cast<const char*>(data) + offset);
 	}
 	~CLegacyGLVertexAttribCache()
 	{
@@ -291,9 +296,34 @@ void CShaderManagerLegacyGL::SetUniformValue(std::string const& uniform, int ele
 	}
 }
 
-std::unique_ptr<IVertexAttribCache> CShaderManagerLegacyGL::CreateVertexAttribCache(size_t size, const void* value) const
+UniformHandle CShaderManagerLegacyGL::GetUniformHandle(std::string const& uniform) const
+{
+	return m_uniforms.Get(uniform);
+}
+
+void CShaderManagerLegacyGL::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const float* value) const
+{
+	SetUniformValue(m_uniforms.GetName(uniform), elementSize, count, value);
+}
+
+void CShaderManagerLegacyGL::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const int* value) const
+{
+	SetUniformValue(m_uniforms.GetName(uniform), elementSize, count, value);
+}
+
+void CShaderManagerLegacyGL::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const unsigned int* value) const
+{
+	SetUniformValue(m_uniforms.GetName(uniform), elementSize, count, value);
+}
+
+std::unique_ptr<IVertexAttribCache> CShaderManagerLegacyGL::CreateVertexAttribCache(size_t size, const void* value, bool dynamic) const
+{
+	return std::make_unique<CLegacyGLVertexAttribCache>(size, value, dynamic);
+}
+
+void CShaderManagerLegacyGL::UpdateVertexAttribCache(IVertexAttribCache& cache, const void* value, size_t offset, size_t size) const
 {
-	return std::make_unique<CLegacyGLVertexAttribCache>(size, value);
+	reinterpret_cast<CLegacyGLVertexAttribCache&>(cache).Update(value, offset, size);
 }
 
 void CShaderManagerLegacyGL::SetVertexAttributeImpl(std::string const& attribute, int elementSize, size_t /*count*/, const void* values, bool perInstance, unsigned int format) const
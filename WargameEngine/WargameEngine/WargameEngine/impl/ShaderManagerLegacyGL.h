@@ -15,6 +15,10 @@ public:
 	virtual void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const float* value) const override;
 	virtual void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const int* value) const override;
 	virtual void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const unsigned int* value) const override;
+	virtual wargameEngine::view::UniformHandle GetUniformHandle(std::string const& uniform) const override;
+	virtual void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const float* value) const override;
+	virtual void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const int* value) const override;
+	virtual void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const unsigned int* value) const override;
 
 	virtual void SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const float* values, bool perInstance = false) const override;
 	virtual void SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const int* values, bool perInstance = false) const override;
@@ -24,7 +28,8 @@ public:
 	virtual void DisableVertexAttribute(std::string const& attribute, int size, const int* defaultValue) const override;
 	virtual void DisableVertexAttribute(std::string const& attribute, int size, const unsigned int* defaultValue) const override;
 
-	virtual std::unique_ptr<wargameEngine::view::IVertexAttribCache> CreateVertexAttribCache(size_t size, const void* value) const override;
+	virtual std::unique_ptr<wargameEngine::view::IVertexAttribCache> CreateVertexAttribCache(size_t size, const void* value, bool dynamic = false) const override;
+	virtual void UpdateVertexAttribCache(wargameEngine::view::IVertexAttribCache& cache, const void* value, size_t offset, size_t size) const override;
 
 	virtual void SetVertexAttribute(std::string const& attribute, wargameEngine::view::IVertexAttribCache const& cache, int elementSize, size_t count, Format type, bool perInstance = false, size_t offset = 0) const override;
 
@@ -34,4 +39,5 @@ private:
 	void SetVertexAttributeImpl(std::string const& attribute, int elementSize, size_t count, const void* values, bool perInstance, unsigned int format) const;
 	void NewProgramImpl(unsigned program, unsigned vertexShader, unsigned framgentShader);
 	mutable std::vector<unsigned int> m_programs;
+	mutable wargameEngine::view::UniformRegistry m_uniforms;
 };
\ No newline at end of file
@@ -4,8 +4,10 @@
 #include "../Utils.h"
 #include <GL/glew.h>
 #include "gl.h"
+#include <algorithm>
 #include <fstream>
 #include <map>
+#include <string.h>
 
 using namespace wargameEngine;
 using namespace view;
@@ -25,6 +27,10 @@ public:
 	int viewMatrixLocation = -1;
 	int projectionMatrixLocation = -1;
 	int mvpMatrixLocation = -1;
+	bool frameBlock = false;
+	bool materialBlock = false;
+	//Locations of uniform handles, resolved on first use
+	mutable std::vector<int> uniformLocations;
 };
 
 namespace
@@ -67,15 +73,25 @@ constexpr char MVP_MATRIX_KEY[] = "mvp_matrix";
 constexpr char VIEW_MATRIX_KEY[] = "view_matrix";
 constexpr char MODEL_MATRIX_KEY[] = "model_matrix";
 constexpr char PROJ_MATRIX_KEY[] = "proj_matrix";
+constexpr char FRAME_BLOCK_NAME[] = "PerFrame";
+constexpr char MATERIAL_BLOCK_NAME[] = "Material";
+//std140 sizes in bytes: two matrices, three vec4 and float padded to vec4
+constexpr size_t BLOCK_SIZES[] = { 32 * sizeof(float), 16 * sizeof(float) };
+constexpr int UNRESOLVED_LOCATION = -2;
 
 class COpenGLVertexAttribCache : public IVertexAttribCache
 {
 public:
-	COpenGLVertexAttribCache(size_t size, const void* data)
+	COpenGLVertexAttribCache(size_t size, const void* data, bool dynamic)
 	{
 		glGenBuffers(1, &m_cache);
 		glBindBuffer(GL_ARRAY_BUFFER, m_cache);
-		glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, size, data, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+	}
+	void Update(const void* data, size_t offset, size_t size)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, m_cache);
+		glBufferSubData(GL_ARRAY_BUFFER, offset, size, reinterpret_cast<const char*>(data) + offset);
 	}
 	~COpenGLVertexAttribCache()
 	{
@@ -98,6 +114,87 @@ private:
 	GLuint m_cache;
 };
 
+void SetUniform(GLint location, int elementSize, size_t count, const float* value)
+{
+	if (location == -1)
+		return;
+	switch (elementSize)
+	{
+	case 1:
+		glUniform1fv(location, static_cast<GLsizei>(count), value);
+		break;
+	case 2:
+		glUniform2fv(location, static_cast<GLsizei>(count), value);
+		break;
+	case 3:
+		glUniform3fv(location, static_cast<GLsizei>(count), value);
+		break;
+	case 4:
+		glUniform4fv(location, static_cast<GLsizei>(count), value);
+		break;
+	case 16:
+		glUniformMatrix4fv(location, static_cast<GLsizei>(count), false, value);
+		break;
+	default:
+		throw std::runtime_error("Unknown elementSize. 1, 2, 3, 4 or 16 expected");
+	}
+}
+
+void SetUniform(GLint location, int elementSize, size_t count, const int* value)
+{
+	if (location == -1)
+		return;
+	switch (elementSize)
+	{
+	case 1:
+		glUniform1iv(location, static_cast<GLsizei>(count), value);
+		break;
+	case 2:
+		glUniform2iv(location, static_cast<GLsizei>(count), value);
+		break;
+	case 3:
+		glUniform3iv(location, static_cast<GLsizei>(count), value);
+		break;
+	case 4:
+		glUniform4iv(location, static_cast<GLsizei>(count), value);
+		break;
+	default:
+		throw std::runtime_error("Unknown elementSize. 1, 2, 3 or 4 expected");
+	}
+}
+
+void SetUniform(GLint location, int elementSize, size_t count, const unsigned int* value)
+{
+	if (location == -1)
+		return;
+	switch (elementSize)
+	{
+	case 1:
+		glUniform1uiv(location, static_cast<GLsizei>(count), value);
+		break;
+	case 2:
+		glUniform2uiv(location, static_cast<GLsizei>(count), value);
+		break;
+	case 3:
+		glUniform3uiv(location, static_cast<GLsizei>(count), value);
+		break;
+	case 4:
+		glUniform4uiv(location, static_cast<GLsizei>(count), value);
+		break;
+	default:
+		throw std::runtime_error("Unknown elementSize. 1, 2, 3 or 4 expected");
+	}
+}
+
+bool SetUniformBlockBinding(GLuint program, const char* name, GLuint binding)
+{
+	const GLuint index = glGetUniformBlockIndex(program, name);
+	if (index == GL_INVALID_INDEX)
+		return false;
+	glUniformBlockBinding(program, index, binding);
+	return true;
+}
+
 GLuint CompileShader(std::string const& shaderText, GLuint program, GLenum type)
 {
 	GLuint shader = glCreateShader(type);
@@ -137,11 +234,6 @@ CShaderManagerOpenGL::CShaderManagerOpenGL()
 
 CShaderManagerOpenGL::~CShaderManagerOpenGL()
 {
-	for (auto& buf : m_vertexAttribBuffers)
-	{
-		glDeleteBuffers(1, &buf.second);
-	}
-	glDeleteBuffers(1, &m_vertexInputBuffer);
 }
 
 void CShaderManagerOpenGL::PushProgram(IShaderProgram const& program) const
@@ -246,6 +338,11 @@ void CShaderManagerOpenGL::NewProgramImpl(COpenGLShaderProgram* programPtr, unsi
 	programPtr->viewMatrixLocation = glGetUniformLocation(program, VIEW_MATRIX_KEY);
 	programPtr->projectionMatrixLocation = glGetUniformLocation(program, PROJ_MATRIX_KEY);
 	programPtr->mvpMatrixLocation = glGetUniformLocation(program, MVP_MATRIX_KEY);
+	if (GLEW_ARB_uniform_buffer_object)
+	{
+		programPtr->frameBlock = SetUniformBlockBinding(program, FRAME_BLOCK_NAME, FRAME_BLOCK);
+		programPtr->materialBlock = SetUniformBlockBinding(program, MATERIAL_BLOCK_NAME, MATERIAL_BLOCK);
+	}
 }
 
 std::unique_ptr<IShaderProgram> CShaderManagerOpenGL::NewProgramSource(std::string const& vertex /* = "" */, std::string const& fragment /* = "" */, std::string const& geometry /* = "" */)
@@ -273,82 +370,47 @@ std::unique_ptr<IShaderProgram> CShaderManagerOpenGL::NewProgramSource(std::stri
 
 void CShaderManagerOpenGL::SetUniformValue(std::string const& uniform, int elementSize, size_t count, const float* value) const
 {
-	int unfrm = GetUniformLocation(uniform);
-	if (unfrm == -1)
-		return;
-	switch (elementSize)
-	{
-	case 1:
-		glUniform1fv(unfrm, static_cast<GLsizei>(count), value);
-		break;
-	case 2:
-		glUniform2fv(unfrm, static_cast<GLsizei>(count), value);
-		break;
-	case 3:
-		glUniform3fv(unfrm, static_cast<GLsizei>(count), value);
-		break;
-	case 4:
-		glUniform4fv(unfrm, static_cast<GLsizei>(count), value);
-		break;
-	case 16:
-		glUniformMatrix4fv(unfrm, static_cast<GLsizei>(count), false, value);
-		break;
-	default:
-		throw std::runtime_error("Unknown elementSize. 1, 2, 3, 4 or 16 expected");
-	}
+	SetUniform(GetUniformLocation(uniform), elementSize, count, value);
 }
 
 void CShaderManagerOpenGL::SetUniformValue(std::string const& uniform, int elementSize, size_t count, const int* value) const
 {
-	GLint unfrm = GetUniformLocation(uniform);
-	if (unfrm == -1)
-		return;
-	switch (elementSize)
-	{
-	case 1:
-		glUniform1iv(unfrm, static_cast<GLsizei>(count), value);
-		break;
-	case 2:
-		glUniform2iv(unfrm, static_cast<GLsizei>(count), value);
-		break;
-	case 3:
-		glUniform3iv(unfrm, static_cast<GLsizei>(count), value);
-		break;
-	case 4:
-		glUniform4iv(unfrm, static_cast<GLsizei>(count), value);
-		break;
-	default:
-		throw std::runtime_error("Unknown elementSize. 1, 2, 3 or 4 expected");
-	}
+	SetUniform(GetUniformLocation(uniform), elementSize, count, value);
 }
 
 void CShaderManagerOpenGL::SetUniformValue(std::string const& uniform, int elementSize, size_t count, const unsigned int* value) const
 {
-	GLint unfrm = GetUniformLocation(uniform);
-	if (unfrm == -1)
-		return;
-	switch (elementSize)
-	{
-	case 1:
-		glUniform1uiv(unfrm, static_cast<GLsizei>(count), value);
-		break;
-	case 2:
-		glUniform2uiv(unfrm, static_cast<GLsizei>(count), value);
-		break;
-	case 3:
-		glUniform3uiv(unfrm, static_cast<GLsizei>(count), value);
-		break;
-	case 4:
-		glUniform4uiv(unfrm, static_cast<GLsizei>(count), value);
-		break;
-	default:
-		throw std::runtime_error("Unknown elementSize. 1, 2, 3 or 4 expected");
-	}
+	SetUniform(GetUniformLocation(uniform), elementSize, count, value);
 }
 
-std::unique_ptr<IVertexAttribCache> CShaderManagerOpenGL::CreateVertexAttribCache(size_t size, const void* value) const
+UniformHandle CShaderManagerOpenGL::GetUniformHandle(std::string const& uniform) const
 {
-	return std::make_unique<COpenGLVertexAttribCache>(size, value);
+	return m_uniforms.Get(uniform);
+}
+
+void CShaderManagerOpenGL::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const float* value) const
+{
+	SetUniform(GetUniformLocation(uniform), elementSize, count, value);
+}
+
+void CShaderManagerOpenGL::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const int* value) const
+{
+	SetUniform(GetUniformLocation(uniform), elementSize, count, value);
+}
+
+void CShaderManagerOpenGL::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const unsigned int* value) const
+{
+	SetUniform(GetUniformLocation(uniform), elementSize, count, value);
+}
+
+std::unique_ptr<IVertexAttribCache> CShaderManagerOpenGL::CreateVertexAttribCache(size_t size, const void* value, bool dynamic) const
+{
+	return std::make_unique<COpenGLVertexAttribCache>(size, value, dynamic);
+}
+
+void CShaderManagerOpenGL::UpdateVertexAttribCache(IVertexAttribCache& cache, const void* value, size_t offset, size_t size) const
+{
+	reinterpret_cast<COpenGLVertexAttribCache&>(cache).Update(value, offset, size);
 }
 
 void CShaderManagerOpenGL::DoOnProgramChange(std::function<void()> const& handler)
@@ -360,34 +422,22 @@ void CShaderManagerOpenGL::SetInputAttributes(const void* vertices, const void*
 {
 	constexpr size_t normalComponents = 3;
 	constexpr size_t texcoordComponents = 2;
-	if (!m_vertexInputBuffer)
-	{
-		glGenBuffers(1, &m_vertexInputBuffer);
-	}
 	auto& glProgram = reinterpret_cast<const COpenGLShaderProgram&>(*m_programs.back());
-	std::vector<float> data((vertexComponents + (normals ? 3 : 0) + (texCoords ? 2 : 0)) * count);
-	memcpy(data.data(), vertices, count * vertexComponents * sizeof(float));
-	if (normals)
-	{
-		memcpy(data.data() + count * vertexComponents, normals, count * normalComponents * sizeof(float));
-	}
-	if (texCoords)
-	{
-		memcpy(data.data() + count * vertexComponents + (normals ? count * normalComponents : 0), texCoords, count * texcoordComponents * sizeof(float));
-	}
-	glBindBuffer(GL_ARRAY_BUFFER, m_vertexInputBuffer);
-	glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STREAM_DRAW);
+	const size_t verticesSize = count * vertexComponents * sizeof(float);
+	const size_t normalsSize = normals ? count * normalComponents * sizeof(float) : 0;
+	const size_t texCoordsSize = texCoords ? count * texcoordComponents * sizeof(float) : 0;
+	const size_t offset = GetStreamBuffer().Upload({ { vertices, verticesSize }, { normals, normalsSize }, { texCoords, texCoordsSize } });
 	if (glProgram.vertexAttribLocation != -1)
 	{
 		glEnableVertexAttribArray(glProgram.vertexAttribLocation);
-		glVertexAttribPointer(glProgram.vertexAttribLocation, vertexComponents, GL_FLOAT, false, 0, 0);
+		glVertexAttribPointer(glProgram.vertexAttribLocation, vertexComponents, GL_FLOAT, false, 0, (void*)offset);
 	}
 	if (glProgram.normalAttribLocation != -1)
 	{
 		if (normals)
 		{
 			glEnableVertexAttribArray(glProgram.normalAttribLocation);
-			glVertexAttribPointer(glProgram.normalAttribLocation, normalComponents, GL_FLOAT, GL_FALSE, 0, (void*)(count * vertexComponents * sizeof(float)));
+			glVertexAttribPointer(glProgram.normalAttribLocation, normalComponents, GL_FLOAT, GL_FALSE, 0, (void*)(offset + verticesSize));
 		}
 		else
 		{
@@ -399,7 +449,7 @@ void CShaderManagerOpenGL::SetInputAttributes(const void* vertices, const void*
 		if (texCoords)
 		{
 			glEnableVertexAttribArray(glProgram.texCoordAttribLocation);
-			glVertexAttribPointer(glProgram.texCoordAttribLocation, texcoordComponents, GL_FLOAT, GL_FALSE, 0, (void*)((count * vertexComponents + (normals ? count * normalComponents : 0)) * sizeof(float)));
+			glVertexAttribPointer(glProgram.texCoordAttribLocation, texcoordComponents, GL_FLOAT, GL_FALSE, 0, (void*)(offset + verticesSize + normalsSize));
 		}
 		else
 		{
@@ -451,6 +501,15 @@ void CShaderManagerOpenGL::SetInputAttributes(const IVertexAttribCache& cache, s
 void CShaderManagerOpenGL::SetMaterial(const float* ambient, const float* diffuse, const float* specular, const float shininess)
 {
 	auto& glProgram = reinterpret_cast<const COpenGLShaderProgram&>(*m_programs.back());
+	if (glProgram.materialBlock)
+	{
+		WriteUniformBlock(MATERIAL_BLOCK, 0, ambient, 4);
+		WriteUniformBlock(MATERIAL_BLOCK, 4, diffuse, 4);
+		WriteUniformBlock(MATERIAL_BLOCK, 8, specular, 4);
+		WriteUniformBlock(MATERIAL_BLOCK, 12, &shininess, 1);
+		BindUniformBlock(MATERIAL_BLOCK);
+		return;
+	}
 	glUniform4fv(glProgram.materialAmbientLocation, 1, ambient);
 	glUniform4fv(glProgram.materialDiffuseLocation, 1, diffuse);
 	glUniform4fv(glProgram.materialSpecularLocation, 1, specular);
@@ -476,12 +535,42 @@ void CShaderManagerOpenGL::SetMatrices(const float* model, const float* view, co
 	}
 	if (projection && glProgram.projectionMatrixLocation != -1)
 	{
-		glUniformMatrix4fv(glProgram.projectionMatrixLocation, 1, false, view);
+		glUniformMatrix4fv(glProgram.projectionMatrixLocation, 1, false, projection);
 	}
 	if (mvp && glProgram.mvpMatrixLocation != -1)
 	{
 		glUniformMatrix4fv(glProgram.mvpMatrixLocation, static_cast<GLsizei>(multiviewCount), false, mvp);
 	}
+	if (glProgram.frameBlock)
+	{
+		if (view)
+			WriteUniformBlock(FRAME_BLOCK, 0, view, 16);
+		if (projection)
+			WriteUniformBlock(FRAME_BLOCK, 16, projection, 16);
+		BindUniformBlock(FRAME_BLOCK);
+	}
+}
+
+void CShaderManagerOpenGL::WriteUniformBlock(UniformBlock block, size_t offset, const float* data, size_t size)
+{
+	auto& uniformBlock = m_uniformBlocks[block];
+	float* blockData = uniformBlock.data + offset;
+	if (memcmp(blockData, data, size * sizeof(float)) != 0)
+	{
+		memcpy(blockData, data, size * sizeof(float));
+		uniformBlock.bound = false;
+	}
+}
+
+void CShaderManagerOpenGL::BindUniformBlock(UniformBlock block) const
+{
+	auto& uniformBlock = m_uniformBlocks[block];
+	if (uniformBlock.bound)
+		return;
+	auto& streamBuffer = GetStreamBuffer();
+	const size_t offset = streamBuffer.Upload({ { uniformBlock.data, BLOCK_SIZES[block] } }, m_uniformBufferAlignment);
+	glBindBufferRange(GL_UNIFORM_BUFFER, block, streamBuffer.GetBuffer(), offset, BLOCK_SIZES[block]);
+	uniformBlock.bound = true;
 }
 
 void CShaderManagerOpenGL::SetVertexAttributeImpl(std::string const& attribute, int elementSize, size_t count, const void* values, bool perInstance, unsigned int format) const
@@ -501,24 +590,53 @@ void CShaderManagerOpenGL::SetVertexAttributeImpl(std::string const& attribute,
 		glDisableVertexAttribArray(index);
 		return;
 	}
-	if (m_vertexAttribBuffers.find(attribute) == m_vertexAttribBuffers.end())
-	{
-		unsigned int buffer;
-		glGenBuffers(1, &buffer);
-		m_vertexAttribBuffers.emplace(std::make_pair(attribute, buffer));
-	}
-	glBindBuffer(GL_ARRAY_BUFFER, m_vertexAttribBuffers.at(attribute));
-	glBufferData(GL_ARRAY_BUFFER, elementSize * count * sizeof(float), values, GL_STREAM_DRAW);
+	const size_t offset = GetStreamBuffer().Upload({ { values, elementSize * count * sizeof(float) } });
 
 	if (format == GL_FLOAT)
-		glVertexAttribPointer(index, elementSize, format, GL_FALSE, 0, NULL);
+		glVertexAttribPointer(index, elementSize, format, GL_FALSE, 0, (void*)offset);
 	else
-		glVertexAttribIPointer(index, elementSize, format, 0, NULL);
+		glVertexAttribIPointer(index, elementSize, format, 0, (void*)offset);
 	glEnableVertexAttribArray(index);
 	if (perInstance)
 		glVertexAttribDivisorARB(index, 1);
 }
 
+bool CShaderManagerOpenGL::HasVertexAttribute(std::string const& attribute) const
+{
+	auto& programCache = GetProgramCache();
+	auto it = programCache.attribLocations.find(attribute);
+	if (it == programCache.attribLocations.end())
+	{
+		it = programCache.attribLocations.emplace(std::make_pair(attribute, glGetAttribLocation(m_activeProgram, attribute.c_str()))).first;
+		programCache.attribState.emplace(std::make_pair(attribute, false));
+	}
+	return it->second != -1;
+}
+
+COpenGLStreamBuffer& CShaderManagerOpenGL::GetStreamBuffer() const
+{
+	if (!m_streamBuffer)
+	{
+		m_streamBuffer = std::make_unique<COpenGLStreamBuffer>();
+		GLint alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		m_uniformBufferAlignment = std::max<size_t>(m_uniformBufferAlignment, alignment);
+	}
+	return *m_streamBuffer;
+}
+
+void CShaderManagerOpenGL::EndFrame()
+{
+	if (m_streamBuffer)
+	{
+		m_streamBuffer->EndFrame();
+	}
+	for (auto& block : m_uniformBlocks)
+	{
+		block.bound = false;
+	}
+}
+
 CShaderManagerOpenGL::ShaderProgramCache& CShaderManagerOpenGL::GetProgramCache() const
 {
 	auto it = m_shaderProgramCache.find(m_activeProgram);
@@ -540,6 +658,24 @@ int CShaderManagerOpenGL::GetUniformLocation(std::string const& uniform) const
 	return it->second;
 }
 
+int CShaderManagerOpenGL::GetUniformLocation(UniformHandle uniform) const
+{
+	if (!uniform.IsValid())
+		return -1;
+	auto& glProgram = reinterpret_cast<const COpenGLShaderProgram&>(*m_programs.back());
+	auto& locations = glProgram.uniformLocations;
+	if (uniform.GetId() >= locations.size())
+	{
+		locations.resize(uniform.GetId() + 1, UNRESOLVED_LOCATION);
+	}
+	int& location = locations[uniform.GetId()];
+	if (location == UNRESOLVED_LOCATION)
+	{
+		location = glGetUniformLocation(glProgram.program, m_uniforms.GetName(uniform).c_str());
+	}
+	return location;
+}
+
 void CShaderManagerOpenGL::SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const float* values, bool perInstance) const
 {
 	SetVertexAttributeImpl(attribute, elementSize, count, values, perInstance, GL_FLOAT);
@@ -1,5 +1,6 @@
 #pragma once
 #include "../view/IShaderManager.h"
+#include "OpenGLStreamBuffer.h"
 #include <functional>
 #include <map>
 #include <vector>
@@ -20,6 +21,10 @@ public:
 	virtual void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const float* value) const override;
 	virtual void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const int* value) const override;
 	virtual void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const unsigned int* value) const override;
+	wargameEngine::view::UniformHandle GetUniformHandle(std::string const& uniform) const override;
+	void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const float* value) const override;
+	void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const int* value) const override;
+	void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const unsigned int* value) const override;
 
 	virtual void SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const float* values, bool perInstance = false) const override;
 	virtual void SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const int* values, bool perInstance = false) const override;
@@ -30,16 +35,23 @@ public:
 	virtual void DisableVertexAttribute(std::string const& attribute, int size, const int* defaultValue) const override;
 	virtual void DisableVertexAttribute(std::string const& attribute, int size, const unsigned int* defaultValue) const override;
 
-	virtual std::unique_ptr<wargameEngine::view::IVertexAttribCache> CreateVertexAttribCache(size_t size, const void* value) const override;
+	virtual std::unique_ptr<wargameEngine::view::IVertexAttribCache> CreateVertexAttribCache(size_t size, const void* value, bool dynamic = false) const override;
+	virtual void UpdateVertexAttribCache(wargameEngine::view::IVertexAttribCache& cache, const void* value, size_t offset, size_t size) const override;
 
 	void DoOnProgramChange(std::function<void()> const& handler);
+	bool HasVertexAttribute(std::string const& attribute) const;
 
+	//Vertices are streamed through the ring buffer
 	void SetInputAttributes(const void* vertices, const void* normals, const void* texCoords, size_t count, size_t vertexComponents);
 	void SetInputAttributes(const wargameEngine::view::IVertexAttribCache& cache, size_t vertexOffset, size_t normalOffset, size_t texCoordOffset, size_t stride);
+	//Material is written to std140 block "Material" if program declares it, otherwise to material.* uniforms
 	void SetMaterial(const float* ambient, const float* diffuse, const float* specular, const float shininess);
 
 	bool NeedsMVPMatrix() const override;
+	//Programs can declare std140 block "PerFrame" { view_matrix; proj_matrix; } instead of plain uniforms. Block holds only the first view of multiview.
+	//Model and MVP matrices change every draw and stay plain uniforms, rebinding a block range per draw is several times slower
 	void SetMatrices(const float* model = nullptr, const float* view = nullptr, const float* projection = nullptr, const float* mvp = nullptr, size_t multiviewCount = 1) override;
+	void EndFrame();
 
 private:
 	struct ShaderProgramCache
@@ -49,16 +61,38 @@ private:
 		std::map<std::string, bool> attribState;
 	};
 
+	enum UniformBlock
+	{
+		FRAME_BLOCK,
+		MATERIAL_BLOCK,
+		UNIFORM_BLOCKS_COUNT
+	};
+	//Copy of std140 block data. Block is uploaded to the stream buffer only when its data changes
+	struct sUniformBlock
+	{
+		float data[32] = {};
+		//Bound range holds current data. Ranges are valid until the end of frame
+		bool bound = false;
+	};
+
 	void SetVertexAttributeImpl(std::string const& attribute, int elementSize, size_t count, const void* values, bool perInstance, unsigned int format) const;
 	ShaderProgramCache& GetProgramCache() const;
 	int GetUniformLocation(std::string const& uniform) const;
+	int GetUniformLocation(wargameEngine::view::UniformHandle uniform) const;
+	//Offset and size are in floats
+	void WriteUniformBlock(UniformBlock block, size_t offset, const float* data, size_t size);
+	void BindUniformBlock(UniformBlock block) const;
 	void NewProgramImpl(COpenGLShaderProgram* programPtr, unsigned vertexShader, unsigned framgentShader, unsigned geometryShader);
+	//Created on first use, when GL is initialized
+	COpenGLStreamBuffer& GetStreamBuffer() const;
 
 	mutable std::vector<const wargameEngine::view::IShaderProgram*> m_programs;
 	mutable unsigned int m_activeProgram = 0;
 	std::function<void()> m_onProgramChange;
-	mutable std::map<std::string, unsigned> m_vertexAttribBuffers;
-	mutable unsigned m_vertexInputBuffer = 0;
+	mutable std::unique_ptr<COpenGLStreamBuffer> m_streamBuffer;
 
 	mutable std::map<unsigned, ShaderProgramCache> m_shaderProgramCache;
+	mutable wargameEngine::view::UniformRegistry m_uniforms;
+	mutable sUniformBlock m_uniformBlocks[UNIFORM_BLOCKS_COUNT];
+	mutable size_t m_uniformBufferAlignment = 16;
 };
\ No newline at end of file
@@ -66,11 +66,16 @@ constexpr char PROJ_MATRIX_KEY[] = "proj_matrix";
 class COpenGLESVertexAttribCache : public IVertexAttribCache
 {
 public:
-	COpenGLESVertexAttribCache(size_t size, const void* data)
+	COpenGLESVertexAttribCache(size_t size, const void* data, bool dynamic)
 	{
 		glGenBuffers(1, &m_cache);
 		glBindBuffer(GL_ARRAY_BUFFER, m_cache);
-		glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, size, data, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+	}
+	void Update(const void* data, size_t offset, size_t size)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, m_cache);
+		glBufferSubData(GL_ARRAY_BUFFER, offset, size, reinterpret_cast<const char*>(data) + offset);
 	}
 	~COpenGLESVertexAttribCache()
 	{
@@ -260,9 +265,34 @@ void CShaderManagerOpenGLES::SetUniformValue(std::string const& uniform, int ele
 	}
 }
 
-std::unique_ptr<IVertexAttribCache> CShaderManagerOpenGLES::CreateVertexAttribCache(size_t size, const void* value) const
+UniformHandle CShaderManagerOpenGLES::GetUniformHandle(std::string const& uniform) const
+{
+	return m_uniforms.Get(uniform);
+}
+
+void CShaderManagerOpenGLES::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const float* value) const
+{
+	SetUniformValue(m_uniforms.GetName(uniform), elementSize, count, value);
+}
+
+void CShaderManagerOpenGLES::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const int* value) const
+{
+	SetUniformValue(m_uniforms.GetName(uniform), elementSize, count, value);
+}
+
+void CShaderManagerOpenGLES::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const unsigned int* value) const
+{
+	SetUniformValue(m_uniforms.GetName(uniform), elementSize, count, value);
+}
+
+std::unique_ptr<IVertexAttribCache> CShaderManagerOpenGLES::CreateVertexAttribCache(size_t size, const void* value, bool dynamic) const
+{
+	return std::make_unique<COpenGLESVertexAttribCache>(size, value, dynamic);
+}
+
+void CShaderManagerOpenGLES::UpdateVertexAttribCache(IVertexAttribCache& cache, const void* value, size_t offset, size_t size) const
 {
-	return std::make_unique<COpenGLESVertexAttribCache>(size, value);
+	reinterpret_cast<COpenGLESVertexAttribCache&>(cache).Update(value, offset, size);
 }
 
 void CShaderManagerOpenGLES::DoOnProgramChange(std::function<void()> const& handler)
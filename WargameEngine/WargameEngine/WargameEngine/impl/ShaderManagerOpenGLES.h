@@ -22,6 +22,10 @@ public:
 	void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const float* value) const override;
 	void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const int* value) const override;
 	void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const unsigned int* value) const override;
+	wargameEngine::view::UniformHandle GetUniformHandle(std::string const& uniform) const override;
+	void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const float* value) const override;
+	void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const int* value) const override;
+	void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const unsigned int* value) const override;
 
 	void SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const float* values, bool perInstance = false) const override;
 	void SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const int* values, bool perInstance = false) const override;
@@ -32,7 +36,8 @@ public:
 	void DisableVertexAttribute(std::string const& attribute, int size, const int* defaultValue) const override;
 	void DisableVertexAttribute(std::string const& attribute, int size, const unsigned int* defaultValue) const override;
 
-	std::unique_ptr<IVertexAttribCache> CreateVertexAttribCache(size_t size, const void* value) const override;
+	std::unique_ptr<IVertexAttribCache> CreateVertexAttribCache(size_t size, const void* value, bool dynamic = false) const override;
+	void UpdateVertexAttribCache(IVertexAttribCache& cache, const void* value, size_t offset, size_t size) const override;
 
 	bool NeedsMVPMatrix() const override;
 	void SetMatrices(const float* model = nullptr, const float* view = nullptr, const float* projection = nullptr, const float* mvp = nullptr, size_t multiviewCount = 1) override;
@@ -64,4 +69,5 @@ private:
 	mutable unsigned m_vertexInputBuffer = 0;
 
 	mutable std::map<unsigned, ShaderProgramCache> m_shaderProgramCache;
+	mutable wargameEngine::view::UniformRegistry m_uniforms;
 };
\ No newline at end of file
@@ -1,9 +1,40 @@
 #include "TextWriter.h"
+#include "../Utils.h"
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 
 using namespace wargameEngine;
 using namespace view;
 
+namespace
+{
+const int PAGE_SIZE = 512;
+//Empty pixels between glyphs, so filtering does not mix neighbours
+const int GLYPH_PADDING = 1;
+//Layouts of strings that change every frame (FPS counter) would pile up otherwise
+const size_t MAX_CACHED_LAYOUTS = 512;
+
+wchar_t ToUnicode(char symbol)
+{
+	if (static_cast<unsigned char>(symbol) < 0x80)
+	{
+		return static_cast<wchar_t>(symbol);
+	}
+	wchar_t result = 0;
+	mbtowc(&result, &symbol, 1);
+	return result;
+}
+
+std::wstring ToUnicode(std::string const& text)
+{
+	std::wstring result(text.size(), L'\0');
+	std::transform(text.begin(), text.end(), result.begin(), [](char symbol) { return ToUnicode(symbol); });
+	return result;
+}
+}
+
 CTextWriter::CTextWriter()
 {
 	if (FT_Init_FreeType(&m_ft))
@@ -21,6 +52,8 @@ void CTextWriter::Reset()
 {
 	m_faces.clear();
 	m_symbols.clear();
+	m_pages.clear();
+	m_layouts.clear();
 }
 
 FT_Face CTextWriter::GetFace(std::string const& name)
@@ -61,151 +94,177 @@ sGlyph CTextWriter::CreateSymbol(sSymbol const& s)
 	symbol.width = face->glyph->bitmap.width;
 	symbol.rows = face->glyph->bitmap.rows;
 	symbol.advancex = face->glyph->advance.x >> 6;
-	symbol.bitmapData.resize(symbol.width * symbol.rows);
-	memcpy(symbol.bitmapData.data(), face->glyph->bitmap.buffer, symbol.bitmapData.size());
+	symbol.page = 0;
+	if (symbol.width > 0 && symbol.rows > 0)
+	{
+		PlaceGlyph(symbol, face->glyph->bitmap.buffer, face->glyph->bitmap.pitch);
+	}
 	return symbol;
 }
 
-void CTextWriter::CreateTexture(sGlyph& glyph, IRenderer& renderer)
+void CTextWriter::PlaceGlyph(sGlyph& glyph, const unsigned char* bitmap, int pitch)
 {
-	if (!glyph.texture)
+	const int width = glyph.width + GLYPH_PADDING;
+	const int height = glyph.rows + GLYPH_PADDING;
+	sAtlasPage* page = m_pages.empty() ? nullptr : &m_pages.back();
+	sAtlasPage::sShelf* shelf = nullptr;
+	if (page)
+	{
+		for (auto& current : page->shelves)
+		{
+			if (height <= current.height && current.x + width <= page->width)
+			{
+				shelf = &current;
+				break;
+			}
+		}
+		const int bottom = page->shelves.empty() ? 0 : page->shelves.back().y + page->shelves.back().height;
+		if (!shelf && bottom + height <= page->height && width <= page->width)
+		{
+			page->shelves.push_back({ bottom, height, 0 });
+			shelf = &page->shelves.back();
+		}
+	}
+	if (!shelf)
 	{
-		glyph.texture = renderer.CreateTexture(glyph.bitmapData.data(), glyph.width, glyph.rows, IRenderer::CachedTextureType::Alpha);
+		//Glyphs bigger than a page get their own one
+		m_pages.emplace_back();
+		page = &m_pages.back();
+		page->width = std::max(PAGE_SIZE, width);
+		page->height = std::max(PAGE_SIZE, height);
+		page->pixels.resize(static_cast<size_t>(page->width) * page->height);
+		page->shelves.push_back({ 0, height, 0 });
+		shelf = &page->shelves.back();
 	}
+	for (int row = 0; row < glyph.rows; ++row)
+	{
+		//Negative pitch means that bitmap goes from bottom to top
+		const unsigned char* source = pitch >= 0 ? bitmap + row * pitch : bitmap + (glyph.rows - 1 - row) * -pitch;
+		memcpy(&page->pixels[static_cast<size_t>(shelf->y + row) * page->width + shelf->x], source, glyph.width);
+	}
+	glyph.page = m_pages.size() - 1;
+	glyph.texMin = CVector2f(static_cast<float>(shelf->x) / page->width, static_cast<float>(shelf->y) / page->height);
+	glyph.texMax = CVector2f(static_cast<float>(shelf->x + glyph.width) / page->width, static_cast<float>(shelf->y + glyph.rows) / page->height);
+	shelf->x += width;
+	page->dirty = true;
 }
 
 sGlyph& CTextWriter::GetSymbol(FT_Face font, unsigned int size, char symbol)
 {
-	auto it = std::find_if(m_symbols.begin(), m_symbols.end(), [&](auto const& pair) {
-		auto& s = pair.first;
-		return s.face == font && s.size == size && s.symbol == symbol;
-	});
-	if (it == m_symbols.end())
-	{
-		sSymbol s;
-		s.face = font;
-		s.size = size;
-		s.symbol = symbol;
-		mbstowcs(&s.unicodeSymbol, &symbol, 1);
-		m_symbols.emplace(s, CreateSymbol(s));
-		return m_symbols.at(s);
-	}
-	return it->second;
+	return GetSymbol(font, size, ToUnicode(symbol));
 }
 
 sGlyph& CTextWriter::GetSymbol(FT_Face font, unsigned int size, wchar_t symbol)
 {
-	auto it = std::find_if(m_symbols.begin(), m_symbols.end(), [&](auto const& pair) {
-		auto& s = pair.first;
-		return s.face == font && s.size == size && s.unicodeSymbol == symbol;
-	});
+	sSymbol s;
+	s.face = font;
+	s.size = size;
+	s.unicodeSymbol = symbol;
+	auto it = m_symbols.find(s);
 	if (it == m_symbols.end())
 	{
-		sSymbol s;
-		s.face = font;
-		s.size = size;
-		s.unicodeSymbol = symbol;
-		wcstombs(&s.symbol, &symbol, 1);
-		m_symbols.emplace(s, CreateSymbol(s));
-		return m_symbols[s];
+		it = m_symbols.emplace(s, CreateSymbol(s)).first;
 	}
 	return it->second;
 }
 
-void CTextWriter::DrawBitmap(IRenderer& renderer, int x, int y, sGlyph const& symbol)
+sTextLayout const& CTextWriter::GetLayout(FT_Face face, unsigned int size, std::wstring const& text, int width)
 {
-	int x2 = x + symbol.bitmap_left;
-	int y2 = y - symbol.bitmap_top;
-	int w = symbol.width;
-	int h = symbol.rows;
-	static const std::array<CVector2f, 4> tex = { CVector2f(0.0f, 0.0f), { 1.0f, 0.0f }, { 0.0f, 1.0f }, { 1.0f, 1.0f } };
-	renderer.RenderArrays(IRenderer::RenderMode::TriangleStrip, { CVector2i(x2, y2), { x2 + w, y2 }, { x2, y2 + h }, { x2 + w, y2 + h } }, tex);
-}
-
-void CTextWriter::PrintText(IRenderer& renderer, int x, int y, std::string const& font, unsigned int size, std::string const& text, int width, int /*height*/)
-{
-	int newx = x;
-	FT_Face face = GetFace(font);
-
-	for (size_t i = 0; i < text.size(); ++i)
+	sLayoutKey key = { face, size, width, text };
+	auto it = m_layouts.find(key);
+	if (it != m_layouts.end())
+	{
+		return it->second;
+	}
+	if (m_layouts.size() >= MAX_CACHED_LAYOUTS)
+	{
+		m_layouts.clear();
+	}
+	sTextLayout layout;
+	int x = 0;
+	int y = 0;
+	for (wchar_t symbol : text)
 	{
-		if (text[i] == '\n')
+		if (symbol == '\n')
 		{
 			y += size;
-			newx = x;
+			x = 0;
+			continue;
 		}
-		else
+		sGlyph const& glyph = GetSymbol(face, size, symbol);
+		if ((width <= 0 || x + glyph.advancex <= width) && glyph.width > 0 && glyph.rows > 0)
 		{
-			sGlyph& glyph = GetSymbol(face, size, text[i]);
-			if (width > 0 && newx + glyph.advancex > x + width)
+			auto batch = std::find_if(layout.batches.begin(), layout.batches.end(), [&](sTextLayout::sBatch const& b) { return b.page == glyph.page; });
+			if (batch == layout.batches.end())
 			{
-				newx += glyph.advancex;
-				continue;
+				layout.batches.emplace_back();
+				batch = layout.batches.end() - 1;
+				batch->page = glyph.page;
 			}
-			CreateTexture(glyph, renderer);
-			renderer.SetTexture(*glyph.texture);
-			DrawBitmap(renderer, newx, y, glyph);
-			newx += glyph.advancex;
+			const int x1 = x + glyph.bitmap_left;
+			const int y1 = y - glyph.bitmap_top;
+			const int x2 = x1 + glyph.width;
+			const int y2 = y1 + glyph.rows;
+			batch->vertices.insert(batch->vertices.end(), { CVector2i(x1, y1), { x2, y1 }, { x1, y2 }, { x2, y1 }, { x2, y2 }, { x1, y2 } });
+			batch->texCoords.insert(batch->texCoords.end(), { glyph.texMin, { glyph.texMax.x, glyph.texMin.y }, { glyph.texMin.x, glyph.texMax.y },
+				{ glyph.texMax.x, glyph.texMin.y }, glyph.texMax, { glyph.texMin.x, glyph.texMax.y } });
 		}
+		x += glyph.advancex;
 	}
+	return m_layouts.emplace(std::move(key), std::move(layout)).first->second;
 }
 
-void CTextWriter::PrintText(IRenderer& renderer, int x, int y, std::string const& font, unsigned int size, std::wstring const& text, int width, int /*height*/)
+void CTextWriter::DrawLayout(IRenderer& renderer, int x, int y, sTextLayout const& layout)
 {
-	int newx = x;
-	FT_Face face = GetFace(font);
-
-	for (size_t i = 0; i < text.size(); ++i)
+	for (auto& batch : layout.batches)
 	{
-		if (text[i] == '\n')
+		sAtlasPage& page = m_pages[batch.page];
+		if (page.dirty || !page.texture)
 		{
-			y += size;
-			newx = x;
+			page.texture = renderer.CreateTexture(page.pixels.data(), page.width, page.height, IRenderer::CachedTextureType::Alpha);
+			page.dirty = false;
 		}
-		else
+		m_vertices.resize(batch.vertices.size());
+		for (size_t i = 0; i < batch.vertices.size(); ++i)
 		{
-			sGlyph& glyph = GetSymbol(face, size, text[i]);
-			if (width > 0 && newx + glyph.advancex > x + width)
-			{
-				newx += glyph.advancex;
-				continue;
-			}
-			CreateTexture(glyph, renderer);
-			renderer.SetTexture(*glyph.texture);
-			DrawBitmap(renderer, newx, y, glyph);
-			newx += glyph.advancex;
+			m_vertices[i] = CVector2i(batch.vertices[i].x + x, batch.vertices[i].y + y);
 		}
+		renderer.SetTexture(*page.texture);
+		renderer.RenderArrays(IRenderer::RenderMode::Triangles, m_vertices, batch.texCoords);
 	}
 }
 
-bool sSymbol::operator<(const sSymbol& other) const
+void CTextWriter::PrintText(IRenderer& renderer, int x, int y, std::string const& font, unsigned int size, std::string const& text, int width, int /*height*/)
 {
-	if (symbol < other.symbol)
-	{
-		return true;
-	}
-	if (symbol > other.symbol)
-	{
-		return false;
-	}
-	if (size < other.size)
-	{
-		return true;
-	}
-	if (size > other.size)
-	{
-		return false;
-	}
-	if (face < other.face)
-	{
-		return true;
-	}
-	if (face > other.face)
-	{
-		return false;
-	}
-	return false;
+	DrawLayout(renderer, x, y, GetLayout(GetFace(font), size, ToUnicode(text), width));
+}
+
+void CTextWriter::PrintText(IRenderer& renderer, int x, int y, std::string const& font, unsigned int size, std::wstring const& text, int width, int /*height*/)
+{
+	DrawLayout(renderer, x, y, GetLayout(GetFace(font), size, text, width));
+}
+
+bool sSymbol::operator==(const sSymbol& other) const
+{
+	return unicodeSymbol == other.unicodeSymbol && size == other.size && face == other.face;
+}
+
+size_t sSymbolHash::operator()(const sSymbol& symbol) const
+{
+	return std::hash<void*>()(symbol.face) ^ (static_cast<size_t>(symbol.unicodeSymbol) << 8) ^ symbol.size;
+}
+
+bool sLayoutKey::operator==(const sLayoutKey& other) const
+{
+	return face == other.face && size == other.size && width == other.width && text == other.text;
 }
+
+size_t sLayoutKeyHash::operator()(const sLayoutKey& key) const
+{
+	const uint64_t seed = reinterpret_cast<uintptr_t>(key.face) ^ (static_cast<uint64_t>(key.size) << 32) ^ static_cast<uint32_t>(key.width);
+	return static_cast<size_t>(HashData(key.text.data(), key.text.size() * sizeof(wchar_t), seed));
+}
+
 int CTextWriter::GetStringHeight(std::string const& font, unsigned int size, std::string const& text)
 {
 	int height = 0;
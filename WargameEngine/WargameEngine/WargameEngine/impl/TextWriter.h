@@ -4,27 +4,72 @@
 #include FT_FREETYPE_H
 #include "../view/IRenderer.h"
 #include <map>
-#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 struct sSymbol
 {
-	char symbol;
 	wchar_t unicodeSymbol;
 	unsigned int size;
 	FT_Face face;
-	bool operator<(const sSymbol& other) const;
+	bool operator==(const sSymbol& other) const;
+};
+struct sSymbolHash
+{
+	size_t operator()(const sSymbol& symbol) const;
 };
 struct sGlyph
 {
-	std::unique_ptr<wargameEngine::view::ICachedTexture> texture;
+	//Glyphs without pixels (spaces) are not placed to atlas
+	size_t page;
+	CVector2f texMin;
+	CVector2f texMax;
 	int bitmap_left;
 	int bitmap_top;
 	int width;
 	int rows;
 	int advancex;
-	std::vector<unsigned char> bitmapData;
+};
+//Atlas page is filled with shelves of glyphs. Glyph is placed to the first shelf that is high enough and has free space
+struct sAtlasPage
+{
+	struct sShelf
+	{
+		int y;
+		int height;
+		int x;
+	};
+	int width;
+	int height;
+	std::vector<unsigned char> pixels;
+	std::vector<sShelf> shelves;
+	std::unique_ptr<wargameEngine::view::ICachedTexture> texture;
+	//Texture is recreated before drawing if glyphs were added after it was created
+	bool dirty = true;
+};
+struct sLayoutKey
+{
+	FT_Face face;
+	unsigned int size;
+	int width;
+	std::wstring text;
+	bool operator==(const sLayoutKey& other) const;
+};
+struct sLayoutKeyHash
+{
+	size_t operator()(const sLayoutKey& key) const;
+};
+//Glyph quads of a string relative to its origin. One batch per atlas page
+struct sTextLayout
+{
+	struct sBatch
+	{
+		size_t page;
+		std::vector<CVector2i> vertices;
+		std::vector<CVector2f> texCoords;
+	};
+	std::vector<sBatch> batches;
 };
 
 class CTextWriter : public wargameEngine::view::ITextWriter
@@ -47,12 +92,18 @@ private:
 	FT_Face GetFace(std::string const& name);
 	sGlyph& GetSymbol(FT_Face font, unsigned int size, char symbol);
 	sGlyph& GetSymbol(FT_Face font, unsigned int size, wchar_t symbol);
-	void DrawBitmap(wargameEngine::view::IRenderer& renderer, int x, int y, sGlyph const& symbol);
 	sGlyph CreateSymbol(const sSymbol& s);
-	void CreateTexture(sGlyph& glyph, wargameEngine::view::IRenderer& renderer);
+	//Copies glyph bitmap to atlas and sets its page and texture coordinates
+	void PlaceGlyph(sGlyph& glyph, const unsigned char* bitmap, int pitch);
+	sTextLayout const& GetLayout(FT_Face face, unsigned int size, std::wstring const& text, int width);
+	void DrawLayout(wargameEngine::view::IRenderer& renderer, int x, int y, sTextLayout const& layout);
 
 	FT_Library m_ft;
 	std::map<std::string, FT_Face> m_faces;
-	std::map<sSymbol, sGlyph> m_symbols;
+	std::unordered_map<sSymbol, sGlyph, sSymbolHash> m_symbols;
+	std::vector<sAtlasPage> m_pages;
+	std::unordered_map<sLayoutKey, sTextLayout, sLayoutKeyHash> m_layouts;
+	//Vertices of the batch moved to text position. Kept between calls to avoid allocations
+	std::vector<CVector2i> m_vertices;
 	std::string m_customFontLocation;
-};
\ No newline at end of file
+};
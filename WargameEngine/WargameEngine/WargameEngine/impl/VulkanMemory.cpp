@@ -33,14 +33,14 @@ CVulkanVertexAttribCache::~CVulkanVertexAttribCache()
 	m_renderer->DestroyBuffer(m_buffer);
 }
 
-void CVulkanVertexAttribCache::Upload(const void* data, VkDeviceSize size)
+void CVulkanVertexAttribCache::Upload(const void* data, VkDeviceSize size, VkDeviceSize offset)
 {
 	VkDevice device = m_renderer->GetDevice();
 	void *vertex_buffer_memory_pointer;
-	VkResult result = vkMapMemory(device, *m_memory, m_memory->GetOffset(), size, 0, &vertex_buffer_memory_pointer);
+	VkResult result = vkMapMemory(device, *m_memory, m_memory->GetOffset() + offset, size, 0, &vertex_buffer_memory_pointer);
 	LOG_VK_RESULT(result, "Cannot map memory");
 	memcpy(vertex_buffer_memory_pointer, data, static_cast<size_t>(size));
-	VkMappedMemoryRange flush_range = { VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, nullptr, *m_memory, m_memory->GetOffset(), size };
+	VkMappedMemoryRange flush_range = { VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, nullptr, *m_memory, m_memory->GetOffset() + offset, size };
 	result = vkFlushMappedMemoryRanges(device, 1, &flush_range);
 	LOG_VK_RESULT(result, "Cannot flush memory");
 	vkUnmapMemory(device, *m_memory);
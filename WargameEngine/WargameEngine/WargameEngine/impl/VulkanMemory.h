@@ -64,7 +64,7 @@ public:
 	CVulkanVertexAttribCache(CVulkanVertexAttribCache && other) = default;
 	CVulkanVertexAttribCache& operator=(CVulkanVertexAttribCache const& other) = delete;
 	~CVulkanVertexAttribCache();
-	void Upload(const void* data, VkDeviceSize size);
+	void Upload(const void* data, VkDeviceSize size, VkDeviceSize offset = 0);
 	void UploadStaged(const void* data, VkDeviceSize size, VkCommandBuffer commandBuffer);
 	operator VkBuffer() const { return m_buffer; }
 private:
@@ -534,6 +534,10 @@ void CVulkanRenderer::EnableMultisampling(bool enable)
 {
 }
 
+void CVulkanRenderer::EndFrame()
+{
+}
+
 void CVulkanRenderer::WindowCoordsToWorldVector(IViewport& viewport, int x, int y, CVector3f& start, CVector3f& end) const
 {
 	glm::vec4 viewportData(viewport.GetX(), viewport.GetY(), viewport.GetWidth(), viewport.GetHeight());
@@ -766,6 +770,11 @@ void CVulkanRenderer::AddVertexAttribute(IVertexBuffer& buffer, const std::strin
 	//TODO:
 }
 
+void CVulkanRenderer::AddVertexAttribute(IVertexBuffer& /*buffer*/, const std::string& attribute, int elementSize, IVertexAttribCache const& cache, IShaderManager::Format type, bool perInstance /*= false*/, size_t offset /*= 0*/)
+{
+	m_shaderManager.SetVertexAttribute(attribute, cache, elementSize, 0, type, perInstance, offset);
+}
+
 void CVulkanRenderer::SetColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a /*= UCHAR_MAX*/)
 {
 	auto charToFloat = [](const int value) { return static_cast<float>(value) / 0xff; };
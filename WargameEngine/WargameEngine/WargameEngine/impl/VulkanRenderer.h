@@ -9,6 +9,7 @@
 
 class CVulkanRenderer;
 using wargameEngine::view::IVertexBuffer;
+using wargameEngine::view::IVertexAttribCache;
 using wargameEngine::view::IShaderManager;
 using wargameEngine::view::ICachedTexture;
 
@@ -133,6 +134,7 @@ public:
 	void DrawIndirect(IVertexBuffer& buffer, const array_view<IndirectDraw>& indirectList, bool indexed) override;
 	void SetIndexBuffer(IVertexBuffer& buffer, const unsigned int* indexPtr, size_t indexesSize) override;
 	void AddVertexAttribute(IVertexBuffer& buffer, const std::string& attribute, int elementSize, size_t count, IShaderManager::Format type, const void* values, bool perInstance = false) override;
+	void AddVertexAttribute(IVertexBuffer& buffer, const std::string& attribute, int elementSize, IVertexAttribCache const& cache, IShaderManager::Format type, bool perInstance = false, size_t offset = 0) override;
 
 	void PushMatrix() override;
 	void PopMatrix() override;
@@ -192,6 +194,7 @@ public:
 	void DrawIn2D(std::function<void()> const& drawHandler) override;
 
 	void EnableMultisampling(bool enable) override;
+	void EndFrame() override;
 
 private:
 	void CreateDeviceAndQueues();
@@ -130,6 +130,26 @@ void CVulkanShaderManager::SetUniformValue(std::string const& uniform, int eleme
 	m_programsStack.back()->SetUniformValue(uniform, value, elementSize * count * sizeof(unsigned));
 }
 
+UniformHandle CVulkanShaderManager::GetUniformHandle(std::string const& uniform) const
+{
+	return m_uniforms.Get(uniform);
+}
+
+void CVulkanShaderManager::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const float* value) const
+{
+	SetUniformValue(m_uniforms.GetName(uniform), elementSize, count, value);
+}
+
+void CVulkanShaderManager::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const int* value) const
+{
+	SetUniformValue(m_uniforms.GetName(uniform), elementSize, count, value);
+}
+
+void CVulkanShaderManager::SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const unsigned int* value) const
+{
+	SetUniformValue(m_uniforms.GetName(uniform), elementSize, count, value);
+}
+
 void CVulkanShaderManager::SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const float* values, bool perInstance /*= false*/) const
 {
 	uint32_t location = m_programsStack.back()->GetVertexAttributeLocation(attribute);
@@ -194,13 +214,18 @@ void CVulkanShaderManager::DisableVertexAttribute(std::string const& attribute,
 	m_renderer.GetPipelineHelper().RemoveVertexAttribute(location);
 }
 
-std::unique_ptr<IVertexAttribCache> CVulkanShaderManager::CreateVertexAttribCache(size_t size, const void* value) const
+std::unique_ptr<IVertexAttribCache> CVulkanShaderManager::CreateVertexAttribCache(size_t size, const void* value, bool /*dynamic*/) const
 {
 	auto result = std::make_unique<CVulkanVertexAttribCache>(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, m_renderer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
 	result->Upload(value, size);
 	return std::move(result);
 }
 
+void CVulkanShaderManager::UpdateVertexAttribCache(IVertexAttribCache& cache, const void* value, size_t offset, size_t size) const
+{
+	reinterpret_cast<CVulkanVertexAttribCache&>(cache).Upload(reinterpret_cast<const char*>(value) + offset, size, offset);
+}
+
 bool CVulkanShaderManager::NeedsMVPMatrix() const
 {
 	return true;
@@ -74,6 +74,10 @@ public:
 	virtual void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const float* value) const override;
 	virtual void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const int* value) const override;
 	virtual void SetUniformValue(std::string const& uniform, int elementSize, size_t count, const unsigned int* value) const override;
+	virtual wargameEngine::view::UniformHandle GetUniformHandle(std::string const& uniform) const override;
+	virtual void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const float* value) const override;
+	virtual void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const int* value) const override;
+	virtual void SetUniformValue(wargameEngine::view::UniformHandle uniform, int elementSize, size_t count, const unsigned int* value) const override;
 
 	virtual void SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const float* values, bool perInstance = false) const override;
 	virtual void SetVertexAttribute(std::string const& attribute, int elementSize, size_t count, const int* values, bool perInstance = false) const override;
@@ -84,7 +88,8 @@ public:
 	virtual void DisableVertexAttribute(std::string const& attribute, int size, const int* defaultValue) const override;
 	virtual void DisableVertexAttribute(std::string const& attribute, int size, const unsigned int* defaultValue) const override;
 
-	virtual std::unique_ptr<IVertexAttribCache> CreateVertexAttribCache(size_t size, const void* value) const override;
+	virtual std::unique_ptr<IVertexAttribCache> CreateVertexAttribCache(size_t size, const void* value, bool dynamic = false) const override;
+	virtual void UpdateVertexAttribCache(IVertexAttribCache& cache, const void* value, size_t offset, size_t size) const override;
 
 	bool NeedsMVPMatrix() const override;
 	void SetMatrices(const float* model = nullptr, const float* view = nullptr, const float* projection = nullptr, const float* mvp = nullptr, size_t multiviewCount = 1);
@@ -97,5 +102,5 @@ private:
 	std::unique_ptr<CVulkanShaderProgram> m_defaultProgram;
 	std::function<void(const CVulkanShaderProgram&)> m_onProgramChange;
 	mutable std::vector<const CVulkanShaderProgram*> m_programsStack;
-	
+	mutable wargameEngine::view::UniformRegistry m_uniforms;
 };
\ No newline at end of file
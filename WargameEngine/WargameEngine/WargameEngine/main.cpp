@@ -1,4 +1,5 @@
 #include "Application.h"
+#include "BenchmarkRunner.h"
 #include "LogWriter.h"
 #include "Module.h"
 #include "view/BuiltInImageReaders.h"
@@ -18,6 +19,7 @@
 #include "impl/GameWindowGLUT.h"
 #define WINDOW_CLASS CGameWindowGLUT
 #endif
+#include "impl/GameWindowNull.h"
 #include "impl/SoundPlayerFMod.h"
 #include "impl/TextWriter.h"
 #include "impl/ScriptHandlerLua.h"
@@ -26,6 +28,7 @@
 #include "impl/AssimpModelLoader.h"
 #include "impl/PathfindingMicroPather.h"
 #include "Utils.h"
+#include "VirtualFileSystem.h"
 #include "view/PluginModelLoader.h"
 
 using namespace wargameEngine;
@@ -54,9 +57,12 @@ int WINAPI WinMain(_In_ HINSTANCE /*hInstance*/, _In_opt_ HINSTANCE /*hPrevInsta
 int main(int argc, char* argv[])
 {
 #endif
-	srand(static_cast<unsigned int>(time(NULL)));
 	Context context;
 	Module module;
+	//Benchmark options are read in any order, but used only if benchmark script is set
+	bool benchmark = false;
+	BenchmarkRunner::Settings benchmarkSettings;
+	benchmarkSettings.output = make_path(std::string("benchmark.json"));
 	for (int i = 1; i < argc; ++i)
 	{
 		if (!strcmp(argv[i], "-module"))
@@ -69,14 +75,89 @@ int main(int argc, char* argv[])
 			}
 			module = Module(Utf8ToWstring(argv[i]));
 		}
+		else if (!strcmp(argv[i], "-pack"))
+		{
+			if (i + 2 >= argc)
+			{
+				LogWriter::WriteLine("Module folder and pack filename expected");
+				return 1;
+			}
+			try
+			{
+				size_t count = VirtualFileSystem::CreatePack(make_path(std::string(argv[i + 1])), make_path(std::string(argv[i + 2])));
+				LogWriter::WriteLine(std::to_string(count) + " files packed into " + argv[i + 2]);
+			}
+			catch (std::exception const& e)
+			{
+				LogWriter::WriteLine(e.what());
+				return 1;
+			}
+			return 0;
+		}
+		else if (!strcmp(argv[i], "-benchmark"))
+		{
+			if (i + 1 == argc)
+			{
+				LogWriter::WriteLine("Benchmark script filename expected");
+				return 1;
+			}
+			benchmark = true;
+			benchmarkSettings.script = make_path(std::string(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "-frames") || !strcmp(argv[i], "-warmup") || !strcmp(argv[i], "-timestep"))
+		{
+			if (i + 1 == argc)
+			{
+				LogWriter::WriteLine(std::string(argv[i]) + " expects a number");
+				return 1;
+			}
+			const double value = atof(argv[i + 1]);
+			if (!strcmp(argv[i], "-frames"))
+				benchmarkSettings.frames = static_cast<size_t>(value);
+			else if (!strcmp(argv[i], "-warmup"))
+				benchmarkSettings.warmupFrames = static_cast<size_t>(value);
+			else
+				benchmarkSettings.timeStep = std::chrono::microseconds(static_cast<long long>(value * 1000.0));
+			++i;
+		}
+		else if (!strcmp(argv[i], "-output"))
+		{
+			if (i + 1 == argc)
+			{
+				LogWriter::WriteLine("Benchmark output filename expected");
+				return 1;
+			}
+			benchmarkSettings.output = make_path(std::string(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "-trace"))
+		{
+			if (i + 1 == argc)
+			{
+				LogWriter::WriteLine("Trace filename expected");
+				return 1;
+			}
+			benchmarkSettings.trace = make_path(std::string(argv[++i]));
+		}
 	}
+	//Benchmark runs are reproducible, so random numbers are the same every time
+	srand(benchmark ? 0 : static_cast<unsigned int>(time(NULL)));
 	if (module.name.empty())
 	{
 		module.script = L"main.lua";
 		module.textures = L"texture\\";
 		module.models = L"models\\";
 	}
-	context.window = std::make_unique<WINDOW_CLASS>();
+	CGameWindowNull* nullWindow = nullptr;
+	if (benchmark)
+	{
+		auto window = std::make_unique<CGameWindowNull>();
+		nullWindow = window.get();
+		context.window = std::move(window);
+	}
+	else
+	{
+		context.window = std::make_unique<WINDOW_CLASS>();
+	}
 	context.soundPlayer = std::make_unique<CSoundPlayerFMod>();
 	context.textWriter = std::make_unique<CTextWriter>();
 	context.physicsEngine = std::make_unique<CPhysicsEngineBullet>();
@@ -90,7 +171,7 @@ int main(int argc, char* argv[])
 	context.imageReaders.push_back(std::make_unique<CDdsImageReader>());
 	context.imageReaders.push_back(std::make_unique<CStbImageReader>());
 	context.modelReaders.push_back(std::make_unique<CObjModelFactory>());
-	context.modelReaders.push_back(std::make_unique<CColladaModelFactory>());
+	context.modelReaders.push_back(std::make_unique<CColladaModelFactory>(true));
 	context.modelReaders.push_back(std::make_unique<CWBMModelFactory>());
 	auto assimpPlugin = TryLoadPlugin(make_path("AssimpPlugin.dll"));
 	if (assimpPlugin)
@@ -98,7 +179,13 @@ int main(int argc, char* argv[])
 		context.modelReaders.push_back(std::make_unique<PluginModelLoader>(std::move(assimpPlugin)));
 	}
 
+	IScriptHandler& scriptHandler = *context.scriptHandler;
 	Application app(std::move(context));
+	std::unique_ptr<BenchmarkRunner> benchmarkRunner;
+	if (benchmark)
+	{
+		benchmarkRunner = std::make_unique<BenchmarkRunner>(benchmarkSettings, app, *nullWindow, scriptHandler);
+	}
 	app.Run(std::move(module));
 	return 0;
 }
@@ -0,0 +1,65 @@
+#pragma once
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define WARGAME_SIMD_SSE
+#include <xmmintrin.h>
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WARGAME_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define WARGAME_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace wargameEngine
+{
+namespace math
+{
+//result = a * b for row-major 4x4 matrices (b * a for column-major ones). result may point to a or b
+inline void MultiplyMatrices(const float* a, const float* b, float* result)
+{
+#if defined(WARGAME_SIMD_SSE)
+	const __m128 b0 = _mm_loadu_ps(b);
+	const __m128 b1 = _mm_loadu_ps(b + 4);
+	const __m128 b2 = _mm_loadu_ps(b + 8);
+	const __m128 b3 = _mm_loadu_ps(b + 12);
+	for (int row = 0; row < 4; ++row)
+	{
+		const float* aRow = a + row * 4;
+		__m128 c = _mm_mul_ps(_mm_set1_ps(aRow[0]), b0);
+		c = _mm_add_ps(c, _mm_mul_ps(_mm_set1_ps(aRow[1]), b1));
+		c = _mm_add_ps(c, _mm_mul_ps(_mm_set1_ps(aRow[2]), b2));
+		c = _mm_add_ps(c, _mm_mul_ps(_mm_set1_ps(aRow[3]), b3));
+		_mm_storeu_ps(result + row * 4, c);
+	}
+#elif defined(WARGAME_SIMD_NEON)
+	const float32x4_t b0 = vld1q_f32(b);
+	const float32x4_t b1 = vld1q_f32(b + 4);
+	const float32x4_t b2 = vld1q_f32(b + 8);
+	const float32x4_t b3 = vld1q_f32(b + 12);
+	for (int row = 0; row < 4; ++row)
+	{
+		const float* aRow = a + row * 4;
+		float32x4_t c = vmulq_n_f32(b0, aRow[0]);
+		c = vmlaq_n_f32(c, b1, aRow[1]);
+		c = vmlaq_n_f32(c, b2, aRow[2]);
+		c = vmlaq_n_f32(c, b3, aRow[3]);
+		vst1q_f32(result + row * 4, c);
+	}
+#else
+	float c[16];
+	for (int row = 0; row < 4; ++row)
+	{
+		for (int column = 0; column < 4; ++column)
+		{
+			c[row * 4 + column] = a[row * 4] * b[column] + a[row * 4 + 1] * b[4 + column] + a[row * 4 + 2] * b[8 + column] + a[row * 4 + 3] * b[12 + column];
+		}
+	}
+	for (int i = 0; i < 16; ++i)
+	{
+		result[i] = c[i];
+	}
+#endif
+}
+}
+}
@@ -19,7 +19,7 @@ public:
 	{
 	}
 
-	Path GetPathToModel() const final
+	Path const& GetPathToModel() const final
 	{
 		return m_model;
 	}
@@ -19,7 +19,7 @@ public:
 
 	virtual ~IBaseObject() {}
 
-	virtual Path GetPathToModel() const = 0;
+	virtual Path const& GetPathToModel() const = 0;
 	virtual void SetCoords(float x, float y, float z) = 0;
 	virtual void SetCoords(CVector3f const& coords) = 0;
 	virtual void Move(float dx, float dy, float dz) = 0;
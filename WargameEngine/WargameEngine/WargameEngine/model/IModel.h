@@ -1,4 +1,5 @@
 #pragma once
+#include "ObjectHandle.h"
 #include <memory>
 
 namespace wargameEngine
@@ -20,6 +21,8 @@ public:
 	virtual ObjectPtr Get3DObject(const IBaseObject* obj) = 0;
 	virtual size_t GetObjectCount() const = 0;
 	virtual ObjectPtr Get3DObject(size_t index) = 0;
+	//Returns nullptr if object is removed
+	virtual ObjectPtr GetObjectByHandle(ObjectHandle handle) = 0;
 
 	virtual ~IModel() {}
 };
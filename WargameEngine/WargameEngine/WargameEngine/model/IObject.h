@@ -1,6 +1,7 @@
 #pragma once
 #include "IBaseObject.h"
 #include "Animation.h"
+#include "ObjectHandle.h"
 #include "TeamColor.h"
 #include <chrono>
 #include <unordered_map>
@@ -15,6 +16,9 @@ namespace model
 class IObject : public IBaseObject
 {
 public:
+	//std::wstring key, std::wstring newValue
+	typedef signals::Signal<void, std::wstring const&, std::wstring const&> PropertySignal;
+
 	virtual std::set<std::string> const& GetHiddenMeshes() const = 0;
 	virtual void HideMesh(std::string const& meshName) = 0;
 	virtual void ShowMesh(std::string const& meshName) = 0;
@@ -24,12 +28,12 @@ public:
 	virtual void SetSelectable(bool selectable) = 0;
 	virtual std::unordered_map<std::wstring, std::wstring> const& GetAllProperties() const = 0;
 	virtual void PlayAnimation(std::string const& animation, AnimationLoop loop = AnimationLoop::NonLooping, float speed = 1.0f) = 0;
-	virtual std::string GetAnimation() const = 0;
+	virtual std::string const& GetAnimation() const = 0;
 	virtual float GetAnimationTime() const = 0;
 	virtual void AddSecondaryModel(const Path& model) = 0;
 	virtual void RemoveSecondaryModel(const Path& model) = 0;
 	virtual size_t GetSecondaryModelsCount() const = 0;
-	virtual Path GetSecondaryModel(size_t index) const = 0;
+	virtual Path const& GetSecondaryModel(size_t index) const = 0;
 	virtual AnimationLoop GetAnimationLoop() const = 0;
 	virtual float GetAnimationSpeed() const = 0;
 	virtual void Update(std::chrono::microseconds timeSinceLastUpdate) = 0;
@@ -38,6 +42,10 @@ public:
 	virtual void ReplaceTexture(const Path& oldTexture, const Path& newTexture) = 0;
 	virtual std::unordered_map<Path, Path> const& GetReplaceTextures() const = 0;
 	virtual bool IsGroup() const = 0;
+	virtual signals::SignalConnection DoOnPropertyChange(PropertySignal::Slot const& handler) = 0;
+	//Handle is assigned by model when object is added. Removed object keeps it, so it gets the same handle if it is added back
+	virtual ObjectHandle GetHandle() const = 0;
+	virtual void SetHandle(ObjectHandle handle) = 0;
 };
 }
 }
\ No newline at end of file
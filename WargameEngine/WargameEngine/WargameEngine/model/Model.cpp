@@ -3,11 +3,19 @@
 #include "../model/ObjectGroup.h"
 #include "Object.h"
 #include <cstring>
+#include <stdexcept>
 
 namespace wargameEngine
 {
 namespace model
 {
+namespace
+{
+const unsigned HANDLE_INDEX_BITS = 20;
+const uint32_t HANDLE_INDEX_MASK = (1u << HANDLE_INDEX_BITS) - 1;
+const uint32_t MAX_HANDLE_GENERATION = (1u << (32 - HANDLE_INDEX_BITS)) - 1;
+}
+
 size_t Model::GetObjectCount() const
 {
 	return m_objects.size();
@@ -25,12 +33,16 @@ std::shared_ptr<IObject> Model::Get3DObject(size_t number)
 
 std::shared_ptr<IObject> Model::Get3DObject(const IBaseObject * object)
 {
-	for (auto i = m_objects.begin(); i != m_objects.end(); ++i)
+	if (!object)
 	{
-		if (i->get() == object)
-		{
-			return *i;
-		}
+		return nullptr;
+	}
+	//Static objects and projectiles have no full object and handle
+	IObject* fullObject = const_cast<IBaseObject*>(object)->GetFullObject();
+	if (fullObject)
+	{
+		auto result = GetObjectByHandle(fullObject->GetHandle());
+		return result.get() == fullObject ? result : nullptr;
 	}
 	if (object == m_selectedObject.get())
 	{
@@ -39,15 +51,92 @@ std::shared_ptr<IObject> Model::Get3DObject(const IBaseObject * object)
 	return nullptr;
 }
 
+std::shared_ptr<IObject> Model::GetObjectByHandle(ObjectHandle handle)
+{
+	const uint32_t index = handle & HANDLE_INDEX_MASK;
+	if (index >= m_slots.size() || m_slots[index].generation != handle >> HANDLE_INDEX_BITS)
+	{
+		return nullptr;
+	}
+	return m_slots[index].object;
+}
+
 void Model::AddObject(std::shared_ptr<IObject> const& pObject)
 {
+	AddObject(pObject, pObject->GetHandle());
+}
+
+void Model::AddObject(std::shared_ptr<IObject> const& pObject, ObjectHandle handle)
+{
+	pObject->SetHandle(AcquireHandle(pObject, handle));
 	m_objects.push_back(pObject);
 	m_onObjectCreation(pObject.get());
 }
 
+ObjectHandle Model::AcquireHandle(std::shared_ptr<IObject> const& object, ObjectHandle handle)
+{
+	uint32_t index = handle & HANDLE_INDEX_MASK;
+	const uint32_t generation = handle >> HANDLE_INDEX_BITS;
+	if (generation != 0)
+	{
+		for (size_t i = m_slots.size(); i <= index; ++i)
+		{
+			m_freeSlots.push_back(static_cast<uint32_t>(i));
+		}
+		if (index >= m_slots.size())
+		{
+			m_slots.resize(index + 1);
+		}
+		if (!m_slots[index].object)
+		{
+			m_slots[index] = { object, generation };
+			return handle;
+		}
+	}
+	while (!m_freeSlots.empty() && m_slots[m_freeSlots.back()].object)
+	{
+		m_freeSlots.pop_back();
+	}
+	if (m_freeSlots.empty())
+	{
+		if (m_slots.size() > HANDLE_INDEX_MASK)
+			throw std::runtime_error("Too many objects");
+		m_freeSlots.push_back(static_cast<uint32_t>(m_slots.size()));
+		m_slots.emplace_back();
+	}
+	index = m_freeSlots.back();
+	m_freeSlots.pop_back();
+	sSlot& slot = m_slots[index];
+	//Generation is changed only when slot is reused, so removed object can get its handle back until then
+	slot.generation = slot.generation % MAX_HANDLE_GENERATION + 1;
+	slot.object = object;
+	return (slot.generation << HANDLE_INDEX_BITS) | index;
+}
+
+void Model::ReleaseHandle(ObjectHandle handle)
+{
+	const uint32_t index = handle & HANDLE_INDEX_MASK;
+	if (GetObjectByHandle(handle))
+	{
+		m_slots[index].object.reset();
+		m_freeSlots.push_back(index);
+	}
+}
+
 void Model::SelectObject(std::shared_ptr<IObject> const& pObject)
 {
+	if (m_selectionHasSlot)
+	{
+		ReleaseHandle(m_selectedObject->GetHandle());
+		m_selectionHasSlot = false;
+	}
 	m_selectedObject = pObject;
+	//Selection group is not a part of model, but scripts and commands refer to it by handle too
+	if (pObject && !GetObjectByHandle(pObject->GetHandle()))
+	{
+		pObject->SetHandle(AcquireHandle(pObject, pObject->GetHandle()));
+		m_selectionHasSlot = true;
+	}
 }
 
 std::shared_ptr<const IObject> Model::GetSelectedObject() const
@@ -82,12 +171,13 @@ void Model::DeleteObjectByPtr(std::shared_ptr<IObject> const& pObject)
 		ObjectGroup* group = (ObjectGroup*)pObject.get();
 		group->DeleteAll();
 	}
-	if (pObject == m_selectedObject) m_selectedObject = nullptr;
+	if (pObject == m_selectedObject) SelectObject(nullptr);
 	for (auto i = m_objects.begin(); i != m_objects.end(); ++i)
 	{
 		if (i->get() == pObject.get())
 		{
 			m_objects.erase(i);
+			ReleaseHandle(pObject->GetHandle());
 			break;
 		}
 	}
@@ -96,7 +186,13 @@ void Model::DeleteObjectByPtr(std::shared_ptr<IObject> const& pObject)
 
 void Model::Clear()
 {
+	auto objects = std::move(m_objects);
 	m_objects.clear();
+	for (auto& object : objects)
+	{
+		ReleaseHandle(object->GetHandle());
+		m_onObjectRemove(object.get());
+	}
 	m_properties.clear();
 }
 
@@ -112,6 +208,11 @@ void Model::SetProperty(std::wstring const& key, std::wstring const& value)
 	m_properties[key] = value;
 }
 
+void Model::RemoveProperty(std::wstring const& key)
+{
+	m_properties.erase(key);
+}
+
 std::unordered_map<std::wstring, std::wstring> const&  Model::GetAllProperties() const
 {
 	return m_properties;
@@ -22,11 +22,15 @@ public:
 	Model() = default;
 
 	virtual size_t GetObjectCount() const override;
+	//Removal is signalled for every object, so view, physics and network forget them like deleted ones
 	void Clear();
 	std::shared_ptr<const IObject> Get3DObject(size_t number) const;
 	virtual std::shared_ptr<IObject> Get3DObject(size_t number) override;
 	virtual std::shared_ptr<IObject> Get3DObject(const IBaseObject * obj) override;
+	virtual std::shared_ptr<IObject> GetObjectByHandle(ObjectHandle handle) override;
 	virtual void AddObject(std::shared_ptr<IObject> const&) override;
+	//Restores handle of saved object if it is not used by another object. Otherwise object gets a new handle
+	void AddObject(std::shared_ptr<IObject> const& pObject, ObjectHandle handle);
 	virtual void DeleteObjectByPtr(std::shared_ptr<IObject> const& pObject) override;
 	void SelectObject(std::shared_ptr<IObject> const& pObject);
 	std::shared_ptr<const IObject> GetSelectedObject() const;
@@ -36,6 +40,7 @@ public:
 	StaticObject& GetStaticObject(size_t index);
 	virtual void SetProperty(std::wstring const& key, std::wstring const& value) override;
 	virtual std::wstring GetProperty(std::wstring const& key) const override;
+	void RemoveProperty(std::wstring const& key);
 	std::unordered_map<std::wstring, std::wstring> const& GetAllProperties() const;
 	void AddProjectile(Projectile const& projectile);
 	size_t GetProjectileCount() const;
@@ -63,7 +68,19 @@ private:
 	Model& operator=(const Model&) = delete;
 	Model& operator=(Model&&) = delete;
 
+	struct sSlot
+	{
+		std::shared_ptr<IObject> object;
+		uint32_t generation = 0;
+	};
+	ObjectHandle AcquireHandle(std::shared_ptr<IObject> const& object, ObjectHandle handle);
+	void ReleaseHandle(ObjectHandle handle);
+
 	std::vector<std::shared_ptr<IObject>> m_objects;
+	std::vector<sSlot> m_slots;
+	//Free slots are not removed from this list when handles are restored, so taken slots are skipped
+	std::vector<uint32_t> m_freeSlots;
+	bool m_selectionHasSlot = false;
 	std::vector<StaticObject> m_staticObjects;
 	std::vector<Projectile> m_projectiles;
 	std::vector<ParticleEffect> m_particleEffects;
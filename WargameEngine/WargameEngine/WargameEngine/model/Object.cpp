@@ -36,7 +36,12 @@ void Object::HideMesh(std::string const& meshName)
 
 void Object::SetProperty(std::wstring const& key, std::wstring const& value)
 {
-	m_properties[key] = value;
+	auto& property = m_properties[key];
+	if (property != value)
+	{
+		property = value;
+		m_onPropertyChange(key, value);
+	}
 }
 
 std::wstring const Object::GetProperty(std::wstring const& key) const
@@ -74,7 +79,7 @@ void Object::PlayAnimation(std::string const& animation, AnimationLoop loop, flo
 	m_animationTime = std::chrono::microseconds(0ll);
 }
 
-std::string Object::GetAnimation() const
+std::string const& Object::GetAnimation() const
 {
 	return m_animation;
 }
@@ -105,7 +110,7 @@ size_t Object::GetSecondaryModelsCount() const
 	return m_secondaryModels.size();
 }
 
-Path Object::GetSecondaryModel(size_t index) const
+Path const& Object::GetSecondaryModel(size_t index) const
 {
 	return m_secondaryModels[index];
 }
@@ -172,5 +177,20 @@ IObject* Object::GetFullObject()
 	return this;
 }
 
+signals::SignalConnection Object::DoOnPropertyChange(PropertySignal::Slot const& handler)
+{
+	return m_onPropertyChange.Connect(handler);
+}
+
+ObjectHandle Object::GetHandle() const
+{
+	return m_handle;
+}
+
+void Object::SetHandle(ObjectHandle handle)
+{
+	m_handle = handle;
+}
+
 }
 }
\ No newline at end of file
@@ -22,12 +22,12 @@ public:
 	void SetSelectable(bool selectable) override;
 	std::unordered_map<std::wstring, std::wstring> const& GetAllProperties() const override;
 	void PlayAnimation(std::string const& animation, AnimationLoop loop, float speed) override;
-	std::string GetAnimation() const override;
+	std::string const& GetAnimation() const override;
 	float GetAnimationTime() const override;
 	void AddSecondaryModel(const Path& model) override;
 	void RemoveSecondaryModel(const Path& model) override;
 	size_t GetSecondaryModelsCount() const override;
-	Path GetSecondaryModel(size_t index) const override;
+	Path const& GetSecondaryModel(size_t index) const override;
 	AnimationLoop GetAnimationLoop() const override;
 	float GetAnimationSpeed() const override;
 	void Update(std::chrono::microseconds timeSinceLastUpdate) override;
@@ -37,6 +37,9 @@ public:
 	std::unordered_map<Path, Path> const& GetReplaceTextures() const override;
 	bool IsGroup() const override;
 	IObject* GetFullObject() override;
+	signals::SignalConnection DoOnPropertyChange(PropertySignal::Slot const& handler) override;
+	ObjectHandle GetHandle() const override;
+	void SetHandle(ObjectHandle handle) override;
 
 private:
 	std::vector<Path> m_secondaryModels;
@@ -49,6 +52,8 @@ private:
 	float m_animationSpeed = 1.0f;
 	std::vector<TeamColor> m_teamColor;
 	std::unordered_map<Path, Path> m_replaceTextures;
+	PropertySignal m_onPropertyChange;
+	ObjectHandle m_handle = INVALID_OBJECT_HANDLE;
 };
 }
 }
\ No newline at end of file
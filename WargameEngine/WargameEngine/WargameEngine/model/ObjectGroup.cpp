@@ -13,9 +13,10 @@ ObjectGroup::ObjectGroup(IModel & model) :m_current(0), m_model(model)
 
 }
 
-Path ObjectGroup::GetPathToModel() const
+Path const& ObjectGroup::GetPathToModel() const
 {
-	if (m_children.empty()) return make_path(L"");
+	static const Path emptyPath;
+	if (m_children.empty()) return emptyPath;
 	return m_children[m_current]->GetPathToModel();
 }
 
@@ -246,9 +247,10 @@ void ObjectGroup::PlayAnimation(std::string const& animation, AnimationLoop loop
 	}
 }
 
-std::string ObjectGroup::GetAnimation() const
+std::string const& ObjectGroup::GetAnimation() const
 {
-	if (m_children.empty()) return "";
+	static const std::string emptyAnimation;
+	if (m_children.empty()) return emptyAnimation;
 	return m_children[m_current]->GetAnimation();
 }
 
@@ -280,9 +282,10 @@ size_t ObjectGroup::GetSecondaryModelsCount() const
 	return m_children[m_current]->GetSecondaryModelsCount();
 }
 
-Path ObjectGroup::GetSecondaryModel(size_t index) const
+Path const& ObjectGroup::GetSecondaryModel(size_t index) const
 {
-	if (m_children.empty()) return Path();
+	static const Path emptyPath;
+	if (m_children.empty()) return emptyPath;
 	return m_children[m_current]->GetSecondaryModel(index);
 }
 
@@ -362,5 +365,20 @@ signals::SignalConnection ObjectGroup::DoOnRotationChange(RotationSignal::Slot c
 	return m_children[m_current]->DoOnRotationChange(handler);
 }
 
+signals::SignalConnection ObjectGroup::DoOnPropertyChange(PropertySignal::Slot const& handler)
+{
+	return m_children[m_current]->DoOnPropertyChange(handler);
+}
+
+ObjectHandle ObjectGroup::GetHandle() const
+{
+	return m_handle;
+}
+
+void ObjectGroup::SetHandle(ObjectHandle handle)
+{
+	m_handle = handle;
+}
+
 }
 }
\ No newline at end of file
@@ -12,7 +12,7 @@ class ObjectGroup : public IObject
 {
 public:
 	ObjectGroup(IModel & model);
-	Path GetPathToModel() const override;
+	Path const& GetPathToModel() const override;
 	void Move(float dx, float dy, float dz) override;
 	void SetCoords(float x, float y, float z) override;
 	void SetCoords(CVector3f const& coords) override;
@@ -43,12 +43,12 @@ public:
 	std::unordered_map<std::wstring, std::wstring> const& GetAllProperties() const override;
 	bool CastsShadow() const override;
 	void PlayAnimation(std::string const& animation, AnimationLoop loop, float speed) override;
-	std::string GetAnimation() const override;
+	std::string const& GetAnimation() const override;
 	float GetAnimationTime() const override;
 	void AddSecondaryModel(const Path& model) override;
 	void RemoveSecondaryModel(const Path& model) override;
 	size_t GetSecondaryModelsCount() const override;
-	Path GetSecondaryModel(size_t index) const override;
+	Path const& GetSecondaryModel(size_t index) const override;
 	AnimationLoop GetAnimationLoop() const override;
 	float GetAnimationSpeed() const override;
 	void Update(std::chrono::microseconds timeSinceLastUpdate) override;
@@ -60,11 +60,15 @@ public:
 	virtual IObject* GetFullObject() override;
 	virtual signals::SignalConnection DoOnCoordsChange(CoordsSignal::Slot const& handler) override;
 	virtual signals::SignalConnection DoOnRotationChange(RotationSignal::Slot const& handler) override;
+	virtual signals::SignalConnection DoOnPropertyChange(PropertySignal::Slot const& handler) override;
+	ObjectHandle GetHandle() const override;
+	void SetHandle(ObjectHandle handle) override;
 private:
 	std::vector<std::shared_ptr<IObject>> m_children;
 	size_t m_current;
 	const std::set<std::string> empty;
 	IModel & m_model;
+	ObjectHandle m_handle = INVALID_OBJECT_HANDLE;
 };
 }
 }
\ No newline at end of file
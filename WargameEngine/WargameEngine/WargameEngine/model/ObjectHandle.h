@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+
+namespace wargameEngine
+{
+namespace model
+{
+//Stable object id. Low bits are index of model slot, high bits are slot generation, so handle of removed object never refers to a new one
+typedef uint32_t ObjectHandle;
+const ObjectHandle INVALID_OBJECT_HANDLE = 0;
+}
+}
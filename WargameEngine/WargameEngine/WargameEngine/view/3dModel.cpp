@@ -1,6 +1,7 @@
 #include "3dModel.h"
 #include "../model/Object.h"
 #include "IRenderer.h"
+#include <algorithm>
 #include <float.h>
 #include "Matrix4.h"
 #include "IShaderManager.h"
@@ -18,7 +19,7 @@ C3DModel::~C3DModel()
 }
 
 void C3DModel::SetModel(std::vector<CVector3f> & vertices, std::vector<CVector2f> & textureCoords, std::vector<CVector3f> & normals, std::vector<unsigned int> & indexes,
-	MaterialManager & materials, std::vector<sMesh> & meshes)
+	MaterialManager & materials, std::vector<sMesh> & meshes, const CVector3f* bounds)
 {
 	m_vertices.swap(vertices);
 	m_textureCoords.swap(textureCoords);
@@ -34,6 +35,30 @@ void C3DModel::SetModel(std::vector<CVector3f> & vertices, std::vector<CVector2f
 		mesh.material = m_materials.GetMaterial(mesh.materialName);
 		mesh.end = (i == m_meshes.size() - 1) ? m_indexes.size() + 1 : m_meshes[i + 1].begin;
 	}
+	if (bounds)
+	{
+		m_boundsMin = bounds[0];
+		m_boundsMax = bounds[1];
+		return;
+	}
+	m_boundsMin = m_boundsMax = m_vertices.empty() ? CVector3f() : m_vertices.front();
+	for (auto& vertex : m_vertices)
+	{
+		m_boundsMin = CVector3f(std::min(m_boundsMin.x, vertex.x), std::min(m_boundsMin.y, vertex.y), std::min(m_boundsMin.z, vertex.z));
+		m_boundsMax = CVector3f(std::max(m_boundsMax.x, vertex.x), std::max(m_boundsMax.y, vertex.y), std::max(m_boundsMax.z, vertex.z));
+	}
+}
+
+void C3DModel::SetGPUWeights(std::vector<float>& weights, std::vector<int>& weightIndexes)
+{
+	m_gpuWeights.swap(weights);
+	m_gpuWeightIndexes.swap(weightIndexes);
+}
+
+void C3DModel::GetBounds(CVector3f& min, CVector3f& max) const
+{
+	min = m_boundsMin;
+	max = m_boundsMax;
 }
 
 void C3DModel::SetAnimation(std::vector<unsigned int> & weightCount, std::vector<unsigned int> & weightIndexes, std::vector<float> & weights, std::vector<sJoint> & skeleton, std::vector<sAnimation> & animations)
@@ -43,6 +68,42 @@ void C3DModel::SetAnimation(std::vector<unsigned int> & weightCount, std::vector
 	m_weights.swap(weights);
 	m_skeleton.swap(skeleton);
 	m_animations.swap(animations);
+	m_poseEvaluator.Init(m_skeleton, m_animations);
+	m_weightsOffsets.clear();
+	if (!m_weightsCount.empty())
+	{
+		m_weightsOffsets.resize(m_vertices.size() + 1);
+		m_weightsOffsets[0] = 0;
+		for (size_t i = 0; i < m_vertices.size(); ++i)
+		{
+			m_weightsOffsets[i + 1] = m_weightsOffsets[i] + (i < m_weightsCount.size() ? m_weightsCount[i] : 0);
+		}
+	}
+}
+
+bool C3DModel::IsSkinned() const
+{
+	return !m_weightsCount.empty();
+}
+
+bool C3DModel::PrepareSkinnedVertices(SkinnedVertices& output) const
+{
+	const size_t capacity = output.vertices.capacity() + output.normals.capacity();
+	output.vertices.resize(m_vertices.size());
+	output.normals.resize(m_normals.empty() ? 0 : m_vertices.size());
+	output.buffer = { output.vertices.data(), output.normals.empty() ? nullptr : output.normals.data(), output.vertices.size(), m_textureCoords.data(), m_indexes.data(), m_indexes.size() };
+	return output.vertices.capacity() + output.normals.capacity() != capacity;
+}
+
+size_t C3DModel::GetSkinnedVerticesCount() const
+{
+	return m_weightsOffsets.empty() ? 0 : m_vertices.size();
+}
+
+void C3DModel::SkinVertices(const float* skinMatrices, size_t begin, size_t end, SkinnedVertices& output) const
+{
+	view::SkinVertices(skinMatrices, m_vertices.data(), output.normals.empty() ? nullptr : m_normals.data(), m_weightsOffsets.data(), m_weightsIndexes.data(), m_weights.data(),
+		begin, end, output.vertices.data(), output.normals.empty() ? nullptr : output.normals.data());
 }
 
 void C3DModel::SetVertexColors(std::vector<math::vec4>&& colors)
@@ -50,16 +111,13 @@ void C3DModel::SetVertexColors(std::vector<math::vec4>&& colors)
 	m_vertexColors = std::move(colors);
 }
 
-void C3DModel::GetModelMeshes(IRenderer& renderer, TextureManager& textureManager, MeshList& meshesVec, const std::set<std::string>* hideMeshes,
+void C3DModel::GetModelMeshes(Matrix4F const& objectMatrix, TextureManager const& textureManager, MeshCollection& result, const std::set<std::string>* hideMeshes,
 	IVertexBuffer* vertexBuffer, const std::vector<model::TeamColor>* teamcolor, const std::unordered_map<Path, Path>* replaceTextures, 
-	const std::shared_ptr<std::vector<float>>& skeleton, const std::shared_ptr<TempMeshBuffer>& tempBuffer) const
+	const float* skeleton, size_t skeletonSize, const TempMeshBuffer* tempBuffer) const
 {
-	renderer.PushMatrix();
-	renderer.Rotate(m_rotation);
-	renderer.Scale(m_scale);
-	const Matrix4F modelMatrix = renderer.GetModelMatrix();
-	renderer.PopMatrix();
+	const Matrix4F modelMatrix = objectMatrix * m_localMatrix;
 	const bool indexed = !m_indexes.empty();
+	auto& meshesVec = result.meshes;
 	for (const sMesh& mesh : m_meshes)
 	{
 		if (hideMeshes && hideMeshes->find(mesh.name) != hideMeshes->end())
@@ -67,24 +125,42 @@ void C3DModel::GetModelMeshes(IRenderer& renderer, TextureManager& textureManage
 			continue;
 		}
 		Material* material = mesh.material;
-		ICachedTexture* texture = GetTexturePtr(material, replaceTextures, textureManager, teamcolor);
-		auto& prev = meshesVec.back();
-		if (prev.buffer == vertexBuffer && material == prev.material && texture == prev.texturePtr && prev.start + prev.count == mesh.begin)
+		const Path* texturePath = GetTexturePath(material, replaceTextures);
+		ICachedTexture* texture = nullptr;
+		if (texturePath)
 		{
-			prev.count += mesh.end - mesh.begin;
+			texture = (!teamcolor && texturePath == &material->texture && material->texturePtrGeneration == textureManager.GetGeneration()) ? material->texturePtr : nullptr;
+			if (!texture)
+			{
+				texture = textureManager.FindTexturePtr(*texturePath, teamcolor);
+			}
+		}
+		const bool prevUnresolved = !result.unresolvedTextures.empty() && result.unresolvedTextures.back().meshIndex + 1 == meshesVec.size();
+		if (texture || !texturePath)
+		{
+			if (!meshesVec.empty() && !prevUnresolved)
+			{
+				auto& prev = meshesVec.back();
+				if (prev.buffer == vertexBuffer && prev.tempBuffer == tempBuffer && material == prev.material && texture == prev.texturePtr && prev.start + prev.count == mesh.begin)
+				{
+					prev.count += mesh.end - mesh.begin;
+					continue;
+				}
+			}
 		}
 		else
 		{
-			meshesVec.emplace_back(DrawableMesh{ nullptr, texture, material, vertexBuffer, modelMatrix * mesh.meshTransform, tempBuffer, skeleton, mesh.begin, mesh.end - mesh.begin, indexed });
+			result.unresolvedTextures.push_back({ meshesVec.size(), texturePath, teamcolor, material });
 		}
+		meshesVec.emplace_back(DrawableMesh{ nullptr, texture, material, vertexBuffer, modelMatrix * mesh.meshTransform, tempBuffer, skeleton, skeletonSize, mesh.begin, mesh.end - mesh.begin, indexed });
 	}
 }
 
 //GPU skinning is limited to 4 weights per vertex (no more, no less). So we will add some empty weights if there is less or delete exceeding if there is more
-void C3DModel::CalculateGPUWeights(IRenderer & renderer)
+void C3DModel::CalculateGPUWeights(std::vector<float>& gpuWeight, std::vector<int>& gpuWeightIndexes) const
 {
-	std::vector<int> gpuWeightIndexes;
-	std::vector<float> gpuWeight;
+	gpuWeightIndexes.clear();
+	gpuWeight.clear();
 	gpuWeightIndexes.reserve(m_weightsCount.size() * 4);
 	gpuWeight.reserve(m_weightsCount.size() * 4);
 	size_t k = 0;
@@ -111,11 +187,9 @@ void C3DModel::CalculateGPUWeights(IRenderer & renderer)
 			gpuWeight[i * 4 + j] /= sum;
 		}
 	}
-	renderer.AddVertexAttribute(*m_vertexBuffer, "weights", 4, gpuWeight.size() / 4, IShaderManager::Format::Float32, gpuWeight.data());
-	renderer.AddVertexAttribute(*m_vertexBuffer, "weightIndices", 4, gpuWeightIndexes.size() / 4, IShaderManager::Format::SInt32, gpuWeightIndexes.data());
 }
 
-void MultiplyVectorToMatrix(CVector3f & vect, float * matrix)
+void MultiplyVectorToMatrix(CVector3f & vect, const float * matrix)
 {
 	if (!matrix) return;
 	float result[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
@@ -137,164 +211,65 @@ void MultiplyVectorToMatrix(CVector3f & vect, float * matrix)
 }
 
 
-void MultiplyMatrices(float * a, float * b)
-{
-	float c[16];
-	for (int i = 0; i < 4; i++)
-	{
-		for (int j = 0; j < 4; j++)
-		{
-			c[i * 4 + j] = 0;
-			for (int k = 0; k < 4; k++)
-			{
-				c[i * 4 + j] = c[i * 4 + j] + a[i * 4 + k] * b[k * 4 + j];
-			}
-		}
-	}
-	memcpy(a, c, sizeof(float) * 16);
-}
-
-void AddAllChildren(std::vector<sAnimation> const& anims, size_t current, std::vector<size_t> & set)
-{
-	set.push_back(current);
-	auto& children = anims[current].children;
-	for (size_t i = 0; i < children.size(); ++i)
-	{
-		AddAllChildren(anims, children[i], set);
-	}
-}
-
-void InterpolateMatrices(float * m1, const float * m2, float t)//works bad if matrices are strongly differ
-{
-	for (size_t i = 0; i < 16; ++i)
-	{
-		m1[i] = m1[i] * t + m2[i] * (1.0f - t);
-	}
-}
-
-std::vector<float> CalculateJointMatrices(std::vector<sJoint> const& skeleton, std::vector<sAnimation> const& animations, std::string const& animationToPlay, model::AnimationLoop loop, float time)
+//returns if animations is ended
+void C3DModel::GetMeshesSkinned(Matrix4F const& objectMatrix, TextureManager const& textureManager, MeshCollection& result, const std::set<std::string> * hideMeshes,
+	std::string const& animationToPlay, model::AnimationLoop loop, float time, bool gpuSkinning, const std::vector<model::TeamColor> * teamcolor, 
+	const std::unordered_map<Path, Path> * replaceTextures, PoseCache* poseCache, SkinnedVertices* skinned) const
 {
-	//copy all matrices
-	std::vector<float> jointMatrices;
-	jointMatrices.resize(skeleton.size() * 16);
-	for (size_t i = 0; i < skeleton.size(); ++i)
+	const size_t skeletonSize = m_poseEvaluator.GetPaletteSize();
+	int animation = m_poseEvaluator.FindAnimation(animationToPlay);
+	if (!m_poseEvaluator.WrapTime(animation, loop, time))
 	{
-		memcpy(&jointMatrices[i * 16], skeleton[i].matrix, sizeof(float) * 16);
+		animation = PoseEvaluator::NO_ANIMATION;
 	}
-	//apply animations
-	if (!animationToPlay.empty())
+	const float* jointMatrices;
+	if (poseCache)
 	{
-		//get animations that are need to be played
-		std::vector<size_t> animsToPlay;
-		for (size_t i = 0; i < animations.size(); ++i)
-		{
-			if (animations[i].id == animationToPlay)
-			{
-				AddAllChildren(animations, i, animsToPlay);
-				if (time > animations[i].duration)
-				{
-					if (loop == model::AnimationLoop::Looping)
-					{
-						time = fmod(time, animations[i].duration);
-					}
-					else if (loop == model::AnimationLoop::HoldEnd)
-					{
-						time = animations[i].duration;
-					}
-				}
-				break;
-			}
-		}
-		//replace affected joints with animation matrices
-		for (size_t i = 0; i < animsToPlay.size(); ++i)
-		{
-			const sAnimation * anim = &animations[animsToPlay[i]];
-			size_t k;
-			for (k = 0; k < anim->keyframes.size(); ++k)
-			{
-				if (time <= anim->keyframes[k] && (k == 0 || time > anim->keyframes[k - 1]))
-				{
-					break;
-				}
-			}
-			if (k < anim->keyframes.size())
-			{
-				for (size_t j = 0; j < 16; ++j)
-				{
-					jointMatrices[anim->boneIndex * 16 + j] = anim->matrices[k * 16 + j];
-				}
-				if (k > 0)
-				{
-					InterpolateMatrices(&jointMatrices[anim->boneIndex * 16], &anim->matrices[(k - 1) * 16], (time - anim->keyframes[k - 1]) / (anim->keyframes[k] - anim->keyframes[k - 1]));
-				}
-			}
-		}
+		jointMatrices = poseCache->GetPose(m_poseEvaluator, animation, time);
 	}
-	//cycle through all joints and multiply them to their parents
-	for (size_t i = 0; i < skeleton.size(); ++i)
-	{
-		if (skeleton[i].parentIndex != -1)
-		{
-			float parent[16];
-			memcpy(parent, &jointMatrices[skeleton[i].parentIndex * 16], sizeof(float) * 16);
-			MultiplyMatrices(parent, &jointMatrices[i * 16]);
-			memcpy(&jointMatrices[i * 16], parent, sizeof(float) * 16);
-		}
-	}
-	//multiply all matrices by invBindMatrices
-	for (size_t i = 0; i < skeleton.size(); ++i)
+	else
 	{
-		Matrix4F m(skeleton[i].invBindMatrix);
-		m *= &jointMatrices[i * 16];
-		memcpy(&jointMatrices[i * 16], m, sizeof(float) * 16);
+		float* palette = result.arena.Allocate<float>(skeletonSize);
+		m_poseEvaluator.Evaluate(animation, time, palette);
+		jointMatrices = palette;
 	}
-	return jointMatrices;
-}
-
-//returns if animations is ended
-void C3DModel::GetMeshesSkinned(IRenderer & renderer, TextureManager& textureManager, MeshList& meshesVec, const std::set<std::string> * hideMeshes,
-	std::string const& animationToPlay, model::AnimationLoop loop, float time, bool gpuSkinning, const std::vector<model::TeamColor> * teamcolor, 
-	const std::unordered_map<Path, Path> * replaceTextures)
-{
-	const auto jointMatrices = std::make_shared<std::vector<float>>(CalculateJointMatrices(m_skeleton, m_animations, animationToPlay, loop, time));
 	if (gpuSkinning)
 	{
-		return GetModelMeshes(renderer, textureManager, meshesVec, hideMeshes, m_vertexBuffer.get(), teamcolor, replaceTextures, jointMatrices, nullptr);
+		return GetModelMeshes(objectMatrix, textureManager, result, hideMeshes, m_vertexBuffer.get(), teamcolor, replaceTextures, jointMatrices, skeletonSize, nullptr);
 	}
 	else
 	{
-		std::vector<CVector3f> vertices;
-		std::vector<CVector3f> normals;
-		vertices.resize(m_vertices.size());
-		normals.reserve(m_normals.size() * 3);
-		size_t k = 0;
-		for (size_t i = 0; i < m_vertices.size(); ++i)
+		float* skinMatrices = result.arena.Allocate<float>(skeletonSize);
+		m_poseEvaluator.GetSkinMatrices(jointMatrices, skinMatrices);
+		const TempMeshBuffer* tempVertices;
+		if (skinned)
 		{
-			//recalculate vertex using bones
-			for (size_t j = 0; j < m_weightsCount[i]; ++j, ++k)
-			{
-				CVector3f vertex = m_vertices[i];
-				sJoint * joint = &m_skeleton[m_weightsIndexes[k]];
-				MultiplyVectorToMatrix(vertex, joint->invBindMatrix);
-				MultiplyVectorToMatrix(vertex, &(*jointMatrices)[m_weightsIndexes[k] * 16]);
-				vertex *= m_weights[k];
-				vertices[i] += vertex;
-				CVector3f normal = m_normals[i];
-				MultiplyVectorToMatrix(normal, joint->invBindMatrix);
-				MultiplyVectorToMatrix(normal, &(*jointMatrices)[m_weightsIndexes[k] * 16]);
-				normal *= m_weights[k];
-				normals[i] = normal;
-			}
+			//vertices are skinned later together with other objects
+			result.skinningJobs.push_back({ this, skinMatrices, skinned });
+			tempVertices = &skinned->buffer;
 		}
-		auto tempVertices = std::make_shared<TempMeshBuffer>(TempMeshBuffer{vertices, normals, m_textureCoords.data(), m_indexes.data(), m_indexes.size()});
-		return GetModelMeshes(renderer, textureManager, meshesVec, hideMeshes, m_vertexBuffer.get(), teamcolor, replaceTextures, nullptr, tempVertices);
+		else
+		{
+			CVector3f* vertices = result.arena.Allocate<CVector3f>(m_vertices.size());
+			CVector3f* normals = m_normals.empty() ? nullptr : result.arena.Allocate<CVector3f>(m_vertices.size());
+			view::SkinVertices(skinMatrices, m_vertices.data(), normals ? m_normals.data() : nullptr, m_weightsOffsets.data(), m_weightsIndexes.data(), m_weights.data(),
+				0, m_vertices.size(), vertices, normals);
+			tempVertices = result.arena.New<TempMeshBuffer>(TempMeshBuffer{ vertices, normals, m_vertices.size(), m_textureCoords.data(), m_indexes.data(), m_indexes.size() });
+		}
+		return GetModelMeshes(objectMatrix, textureManager, result, hideMeshes, nullptr, teamcolor, replaceTextures, nullptr, 0, tempVertices);
 	}
 }
 
-void C3DModel::GetMeshes(IRenderer & renderer, TextureManager& textureManager, model::IObject* object, bool gpuSkinning, MeshList& meshesVec)
+void C3DModel::PrepareBuffers(IRenderer& renderer)
 {
 	if (!m_vertexBuffer && !m_vertices.empty())
 	{
+		renderer.PushMatrix();
+		renderer.SetModelMatrix(Matrix4F());
+		renderer.Rotate(m_rotation);
+		renderer.Scale(m_scale);
+		m_localMatrix = renderer.GetModelMatrix();
+		renderer.PopMatrix();
 		m_vertexBuffer = renderer.CreateVertexBuffer(&m_vertices.data()->x, &m_normals.data()->x, &m_textureCoords.data()->x, m_vertices.size(), false);
 		if (!m_indexes.empty())
 		{
@@ -306,21 +281,32 @@ void C3DModel::GetMeshes(IRenderer & renderer, TextureManager& textureManager, m
 		}
 		if (!m_weightsCount.empty())
 		{
-			CalculateGPUWeights(renderer);
+			if (m_gpuWeights.empty())
+			{
+				CalculateGPUWeights(m_gpuWeights, m_gpuWeightIndexes);
+			}
+			renderer.AddVertexAttribute(*m_vertexBuffer, "weights", 4, m_gpuWeights.size() / 4, IShaderManager::Format::Float32, m_gpuWeights.data());
+			renderer.AddVertexAttribute(*m_vertexBuffer, "weightIndices", 4, m_gpuWeightIndexes.size() / 4, IShaderManager::Format::SInt32, m_gpuWeightIndexes.data());
+			//Buffer keeps them now
+			std::vector<float>().swap(m_gpuWeights);
+			std::vector<int>().swap(m_gpuWeightIndexes);
 		}
 	}
+}
 
+void C3DModel::GetMeshes(Matrix4F const& objectMatrix, TextureManager const& textureManager, model::IObject* object, bool gpuSkinning, MeshCollection& result, PoseCache* poseCache, SkinnedVertices* skinned) const
+{
 	auto* hiddenMeshes = (object && !object->GetHiddenMeshes().empty()) ? &object->GetHiddenMeshes() : nullptr;
 	auto* teamcolor = (object && !object->GetTeamColor().empty()) ? &object->GetTeamColor() : nullptr;
 	auto* replaceTextures = (object && !object->GetReplaceTextures().empty()) ? &object->GetReplaceTextures() : nullptr;
 	if (!m_weightsCount.empty() && object)//object needs to be skinned
 	{
-		return GetMeshesSkinned(renderer, textureManager, meshesVec, hiddenMeshes, object->GetAnimation(), object->GetAnimationLoop(), object->GetAnimationTime() / object->GetAnimationSpeed(),
-			gpuSkinning, teamcolor, replaceTextures);
+		return GetMeshesSkinned(objectMatrix, textureManager, result, hiddenMeshes, object->GetAnimation(), object->GetAnimationLoop(), object->GetAnimationTime() / object->GetAnimationSpeed(),
+			gpuSkinning, teamcolor, replaceTextures, poseCache, skinned);
 	}
 	else//static object
 	{
-		return GetModelMeshes(renderer, textureManager, meshesVec, hiddenMeshes, m_vertexBuffer.get(), teamcolor, replaceTextures, nullptr, nullptr);
+		return GetModelMeshes(objectMatrix, textureManager, result, hiddenMeshes, m_vertexBuffer.get(), teamcolor, replaceTextures, nullptr, 0, nullptr);
 	}
 }
 
@@ -355,23 +341,19 @@ std::vector<std::string> C3DModel::GetAnimations() const
 	return result;
 }
 
-ICachedTexture* C3DModel::GetTexturePtr(Material* material, const std::unordered_map<Path, Path>* replaceTextures, TextureManager &textureManager, const std::vector<model::TeamColor>* teamcolor) const
+const Path* C3DModel::GetTexturePath(Material* material, const std::unordered_map<Path, Path>* replaceTextures) const
 {
 	if (material && !material->texture.empty())
 	{
-		if (replaceTextures && replaceTextures->find(material->texture) != replaceTextures->end())
+		if (replaceTextures)
 		{
-			return textureManager.GetTexturePtr(replaceTextures->at(material->texture), teamcolor);
-		}
-		if (teamcolor)
-		{
-			return textureManager.GetTexturePtr(material->texture, teamcolor);
-		}
-		if (!material->texturePtr)
-		{
-			material->texturePtr = textureManager.GetTexturePtr(material->texture);
+			auto it = replaceTextures->find(material->texture);
+			if (it != replaceTextures->end())
+			{
+				return &it->second;
+			}
 		}
-		return material->texturePtr;
+		return &material->texture;
 	}
 	return nullptr;
 }
@@ -4,6 +4,7 @@
 #include "../model/TeamColor.h"
 #include "DrawableMesh.h"
 #include "MaterialManager.h"
+#include "SkeletalPose.h"
 #include "Vector3.h"
 #include "../math/vec4.h"
 #include <unordered_map>
@@ -67,26 +68,43 @@ public:
 	C3DModel& operator=(C3DModel const& other) = delete;
 	C3DModel& operator=(C3DModel&& other) = default;
 
+	//bounds are min and max corners. They are calculated from vertices if not set
 	void SetModel(std::vector<CVector3f>& vertices, std::vector<CVector2f>& textureCoords, std::vector<CVector3f>& normals, std::vector<unsigned int>& indexes,
-		MaterialManager& materials, std::vector<sMesh>& meshes);
+		MaterialManager& materials, std::vector<sMesh>& meshes, const CVector3f* bounds = nullptr);
 	void SetAnimation(std::vector<unsigned int>& weightCount, std::vector<unsigned int>& weightIndexes, std::vector<float>& weights, std::vector<sJoint>& skeleton, std::vector<sAnimation>& animations);
+	//Precomputed weights for GPU skinning, 4 per vertex. They are only kept until buffers are created
+	void SetGPUWeights(std::vector<float>& weights, std::vector<int>& weightIndexes);
+	void GetBounds(CVector3f& min, CVector3f& max) const;
 	void SetVertexColors(std::vector<math::vec4>&& colors);
 	void PreloadTextures(TextureManager& textureManager) const;
 	std::vector<std::string> GetAnimations() const;
-	void GetMeshes(IRenderer& renderer, TextureManager& textureManager, model::IObject* object, bool gpuSkinning, MeshList& meshesVec);
+	bool IsSkinned() const;
+	//Sizes output for this model. Returns true if memory was reallocated
+	bool PrepareSkinnedVertices(SkinnedVertices& output) const;
+	size_t GetSkinnedVerticesCount() const;
+	//Skins vertices [begin, end) to output prepared by PrepareSkinnedVertices. Used to execute SkinningJob
+	void SkinVertices(const float* skinMatrices, size_t begin, size_t end, SkinnedVertices& output) const;
+	//Creates GPU buffers. Must be called from the main thread before GetMeshes
+	void PrepareBuffers(IRenderer& renderer);
+	//Does not modify model or texture manager, so it can be called from several threads at once. Skinning palettes are taken from poseCache if it is set.
+	//If skinned is set, CPU skinning is deferred to SkinningJob that writes there
+	void GetMeshes(Matrix4F const& objectMatrix, TextureManager const& textureManager, model::IObject* object, bool gpuSkinning, MeshCollection& result, PoseCache* poseCache = nullptr,
+		SkinnedVertices* skinned = nullptr) const;
 
 	float GetScale() const;
 	CVector3f GetRotation() const;
 
 private:
-	void GetModelMeshes(IRenderer& renderer, TextureManager& textureManager, MeshList& meshesVec, const std::set<std::string>* hideMeshes,
+	friend std::vector<char> SerializeWBMModel(C3DModel const& model);
+
+	void GetModelMeshes(Matrix4F const& objectMatrix, TextureManager const& textureManager, MeshCollection& result, const std::set<std::string>* hideMeshes,
 		IVertexBuffer* vertexBuffer, const std::vector<model::TeamColor>* teamcolor, const std::unordered_map<Path, Path>* replaceTextures,
-		const std::shared_ptr<std::vector<float>>& skeleton, const std::shared_ptr<TempMeshBuffer>& tempBuffer) const;
-	ICachedTexture* GetTexturePtr(Material* material, const std::unordered_map<Path, Path>* replaceTextures, TextureManager& textureManager, const std::vector<model::TeamColor>* teamcolor) const;
-	void CalculateGPUWeights(IRenderer& renderer);
-	void GetMeshesSkinned(IRenderer& renderer, TextureManager& textureManager, MeshList& meshesVec, const std::set<std::string>* hideMeshes,
+		const float* skeleton, size_t skeletonSize, const TempMeshBuffer* tempBuffer) const;
+	const Path* GetTexturePath(Material* material, const std::unordered_map<Path, Path>* replaceTextures) const;
+	void CalculateGPUWeights(std::vector<float>& weights, std::vector<int>& weightIndexes) const;
+	void GetMeshesSkinned(Matrix4F const& objectMatrix, TextureManager const& textureManager, MeshCollection& result, const std::set<std::string>* hideMeshes,
 		std::string const& animationToPlay, model::AnimationLoop loop, float time, bool gpuSkinning, const std::vector<model::TeamColor>* teamcolor = nullptr,
-		const std::unordered_map<Path, Path>* replaceTextures = nullptr);
+		const std::unordered_map<Path, Path>* replaceTextures = nullptr, PoseCache* poseCache = nullptr, SkinnedVertices* skinned = nullptr) const;
 
 	std::vector<CVector3f> m_vertices;
 	std::vector<CVector2f> m_textureCoords;
@@ -96,16 +114,23 @@ private:
 	std::vector<unsigned int> m_weightsCount;
 	std::vector<unsigned int> m_weightsIndexes;
 	std::vector<float> m_weights;
+	std::vector<unsigned int> m_weightsOffsets;
+	std::vector<float> m_gpuWeights;
+	std::vector<int> m_gpuWeightIndexes;
 	std::vector<sJoint> m_skeleton;
 	std::vector<sAnimation> m_animations;
+	PoseEvaluator m_poseEvaluator;
 	std::vector<sMesh> m_meshes;
 	MaterialManager m_materials;
 	float m_scale;
 	CVector3f m_rotation;
+	CVector3f m_boundsMin;
+	CVector3f m_boundsMax;
 	size_t m_count;
 	std::unique_ptr<IVertexBuffer> m_vertexBuffer;
+	Matrix4F m_localMatrix;
 };
 
-void MultiplyVectorToMatrix(CVector3f& vect, float* matrix);
+void MultiplyVectorToMatrix(CVector3f& vect, const float* matrix);
 }
 }
\ No newline at end of file
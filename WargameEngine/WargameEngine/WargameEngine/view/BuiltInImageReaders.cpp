@@ -298,9 +298,9 @@ bool CBmpImageReader::ImageIsSupported(unsigned char* data, size_t size, const P
 	return (size > 2) && strncmp((char*)data, "BM", 2) == 0;
 }
 
-Image CBmpImageReader::ReadImage(unsigned char* data, size_t /*size*/, const Path& /*filePath*/, sReaderParameters const& params)
+Image CBmpImageReader::ReadImage(unsigned char* data, size_t size, const Path& /*filePath*/, sReaderParameters const& params)
 {
-	ReadMemoryStream stream(reinterpret_cast<char*>(data));
+	ReadMemoryStream stream(reinterpret_cast<char*>(data), size);
 	stream.Seek(0x0A);
 	int headerSize = stream.ReadInt();
 	stream.ReadInt(); //skip 4 bytes
@@ -1,5 +1,6 @@
 #include "ColladaModelFactory.h"
 #include "3dModel.h"
+#include "WBMModelFactory.h"
 #include <vector>
 #include <unordered_map>
 #include <string>
@@ -7,9 +8,12 @@
 #include <algorithm>
 #include <limits.h>
 #include "../rapidxml/rapidxml.hpp"
-#include <sstream>
-#include <numeric>
-#include <cwctype>
+#include <stdexcept>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "../NumberParser.h"
+#include "../OSSpecific.h"
 #include "../Utils.h"
 
 using namespace std;
@@ -21,22 +25,78 @@ namespace view
 {
 namespace
 {
-template<class T>
-vector<T> GetValues(xml_node<>* data)
+const char CACHE_MAGIC[4] = { 'W', 'C', 'O', 'L' };
+const uint32_t CACHE_VERSION = 1;
+
+struct sCacheHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t hash;
+};
+
+//Arrays have count attribute, so they are parsed without reallocations
+size_t GetCount(xml_node<>* data)
+{
+	xml_attribute<>* count = data->first_attribute("count");
+	return count ? static_cast<size_t>(strtoul(count->value(), nullptr, 10)) : 0;
+}
+
+vector<float> GetFloats(xml_node<>* data)
 {
-	vector<T> res;
-	//replace(value.begin(), value.end(), ',', '.');
-	stringstream sstream(data->value());
-	while (!sstream.eof())
+	vector<float> res;
+	if (!data)
+		return res;
+	res.reserve(GetCount(data));
+	if (!ParseFloatList(data->value(), data->value() + data->value_size(), res))
 	{
-		T val;
-		sstream >> val;
-		res.push_back(val);
+		throw runtime_error("Collada model has invalid number in " + string(data->name()));
 	}
-	res.shrink_to_fit();
 	return res;
 }
 
+vector<unsigned> GetIndexes(xml_node<>* data)
+{
+	vector<unsigned> res;
+	if (!data)
+		return res;
+	res.reserve(GetCount(data));
+	if (!ParseUnsignedList(data->value(), data->value() + data->value_size(), res))
+	{
+		throw runtime_error("Collada model has invalid index in " + string(data->name()));
+	}
+	return res;
+}
+
+vector<string> GetNames(xml_node<>* data)
+{
+	vector<string> res;
+	if (!data)
+		return res;
+	res.reserve(GetCount(data));
+	const char* end = data->value() + data->value_size();
+	for (const char* pos = SkipWhitespace(data->value(), end); pos < end; pos = SkipWhitespace(pos, end))
+	{
+		const char* nameEnd = FindWhitespace(pos, end);
+		res.emplace_back(pos, nameEnd);
+		pos = nameEnd;
+	}
+	return res;
+}
+
+void CopyValues(vector<float> const& values, float* result, size_t count)
+{
+	memcpy(result, values.data(), sizeof(float) * std::min(count, values.size()));
+}
+
+void SetIdentity(float* matrix)
+{
+	for (size_t i = 0; i < 16; ++i)
+	{
+		matrix[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+	}
+}
+
 string GetImagePath(string const& samplerID, xml_node<>* effect)
 {
 	xml_node<>* newparam = effect->first_node("newparam");
@@ -83,22 +143,23 @@ void LoadJoints(xml_node<> * element, vector<sJoint> & arr, int parent)
 	joint.bone = element->first_attribute("sid")->value();
 	joint.id = element->first_attribute("id")->value();
 	joint.parentIndex = parent;
+	SetIdentity(joint.matrix);
+	SetIdentity(joint.invBindMatrix);
 	xml_node<> * matrix = element->first_node("matrix");
 	if (matrix)
 	{
-		vector<float> mat = GetValues<float>(matrix);
-		memcpy(joint.matrix, mat.data(), sizeof(float) * 16);
+		CopyValues(GetFloats(matrix), joint.matrix, 16);
 	}
 	else//todo: matrix from translation and rotation
 	{
 		/*float resultMatrix[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
 		xml_node<> * translate = element->first_node("translate");
-		vector<float> translatef = GetValues<float>(translate);
+		vector<float> translatef = GetFloats(translate);
 		resultMatrix *= translatef
 		xml_node<> * rotate = element->first_node("rotate");
 		while (rotate)
 		{
-			vector<float> rotatef = GetValues<float>(rotate);
+			vector<float> rotatef = GetFloats(rotate);
 			resultMatrix *= rotatef
 			rotate = rotate->next_sibling("rotate");
 		}*/
@@ -116,7 +177,7 @@ void LoadJoints(xml_node<> * element, vector<sJoint> & arr, int parent)
 	}
 }
 
-void LoadAnimations(xml_node<> * element, vector<sJoint> const& joints, vector<sAnimation> & anims, int parent)
+void LoadAnimations(xml_node<> * element, vector<sJoint> const& joints, unordered_map<string, size_t> const& jointsById, vector<sAnimation> & anims, int parent)
 {
 	xml_node<>* animation = element->first_node("animation");
 	while (animation)
@@ -141,11 +202,11 @@ void LoadAnimations(xml_node<> * element, vector<sJoint> const& joints, vector<s
 			{
 				if (input->first_attribute("semantic")->value() == string("INPUT"))
 				{
-					anim.keyframes = GetValues<float>(sources[input->first_attribute("source")->value()]);
+					anim.keyframes = GetFloats(sources[input->first_attribute("source")->value()]);
 				}
 				if (input->first_attribute("semantic")->value() == string("OUTPUT"))
 				{
-					anim.matrices = GetValues<float>(sources[input->first_attribute("source")->value()]);
+					anim.matrices = GetFloats(sources[input->first_attribute("source")->value()]);
 				}
 				input = input->next_sibling("input");
 			}
@@ -156,48 +217,46 @@ void LoadAnimations(xml_node<> * element, vector<sJoint> const& joints, vector<s
 			string bone = channel->first_attribute("target")->value();
 			string mode = bone.substr(bone.find('/') + 1);
 			bone = bone.substr(0, bone.find('/'));
-			for (size_t i = 0; i < joints.size(); ++i)
+			auto joint = jointsById.find(bone);
+			if (joint != jointsById.end())
 			{
-				if (bone == joints[i].id)
+				const size_t i = joint->second;
+				if (mode != "transform")
 				{
-					if (mode != "transform")
+					vector<float> result;
+					if (mode.substr(0, 9) == "transform")
 					{
-						vector<float> result;
-						if (mode.substr(0, 9) == "transform")
+						char x = mode[10] - '0';
+						char y = mode[13] - '0';
+						float matrix[16];
+						memcpy(matrix, joints[i].matrix, sizeof(float) * 16);
+						for (size_t j = 0; j < anim.matrices.size(); ++j)
 						{
-							char x = mode[10] - '0';
-							char y = mode[13] - '0';
-							float matrix[16];
-							memcpy(matrix, joints[i].matrix, sizeof(float) * 16);
-							for (size_t j = 0; j < anim.matrices.size(); ++j)
+							matrix[y * 4 + x] = anim.matrices[j];
+							for (size_t k = 0; k < 16; ++k)
 							{
-								matrix[y * 4 + x] = anim.matrices[j];
-								for (size_t k = 0; k < 16; ++k)
-								{
-									result.push_back(matrix[k]);
-								}
+								result.push_back(matrix[k]);
 							}
 						}
-						anim.matrices = result;
 					}
-					anim.boneIndex = static_cast<unsigned>(i);
-					anim.duration = 0.0f;
-					for (size_t j = 0; j < anim.keyframes.size(); ++j)
+					anim.matrices = result;
+				}
+				anim.boneIndex = static_cast<unsigned>(i);
+				anim.duration = 0.0f;
+				for (size_t j = 0; j < anim.keyframes.size(); ++j)
+				{
+					if (anim.keyframes[j] > anim.duration)
 					{
-						if (anim.keyframes[j] > anim.duration)
-						{
-							anim.duration = anim.keyframes[j];
-						}
+						anim.duration = anim.keyframes[j];
 					}
-					anims.push_back(anim);
-					if (parent > 0)
-						anims[static_cast<size_t>(parent)].children.push_back(anims.size() - 1);
-					break;
 				}
+				anims.push_back(anim);
+				if (parent > 0)
+					anims[static_cast<size_t>(parent)].children.push_back(anims.size() - 1);
 			}
 			channel = channel->next_sibling("channel");
 		}
-		LoadAnimations(animation, joints, anims, static_cast<int>(anims.size()) - 1);
+		LoadAnimations(animation, joints, jointsById, anims, static_cast<int>(anims.size()) - 1);
 		animation = animation->next_sibling("animation");
 	}
 }
@@ -273,8 +332,7 @@ void LoadPhongModel(xml_node<>* phong, Material &material, unordered_map<string,
 		xml_node<>* color = ambient->first_node("color");
 		if (color)
 		{
-			vector<float> c = GetValues<float>(color);
-			memcpy(material.ambient, c.data(), 3 * sizeof(float));
+			CopyValues(GetFloats(color), material.ambient, 3);
 		}
 	}
 	xml_node<>* diffuse = phong->first_node("diffuse");
@@ -283,8 +341,7 @@ void LoadPhongModel(xml_node<>* phong, Material &material, unordered_map<string,
 		xml_node<>* color = diffuse->first_node("color");
 		if (color)
 		{
-			vector<float> c = GetValues<float>(color);
-			memcpy(material.diffuse, c.data(), 3 * sizeof(float));
+			CopyValues(GetFloats(color), material.diffuse, 3);
 		}
 		xml_node<>* texture = diffuse->first_node("texture");
 		if (texture)
@@ -303,8 +360,7 @@ void LoadPhongModel(xml_node<>* phong, Material &material, unordered_map<string,
 		xml_node<>* color = specular->first_node("color");
 		if (color)
 		{
-			vector<float> c = GetValues<float>(color);
-			memcpy(material.specular, c.data(), 3 * sizeof(float));
+			CopyValues(GetFloats(color), material.specular, 3);
 		}
 	}
 	xml_node<>* shininess = phong->first_node("shininess");
@@ -396,7 +452,76 @@ void LoadAnimationClips(xml_node<>* clipsLib, std::vector<sAnimation> & animatio
 }
 }
 
+CColladaModelFactory::CColladaModelFactory(bool binaryCache)
+	: m_binaryCache(binaryCache)
+{
+}
+
 std::unique_ptr<C3DModel> CColladaModelFactory::LoadModel(unsigned char * data, size_t size, C3DModel const& dummyModel, const Path& /*filePath*/)
+{
+	Path directory;
+	if (m_binaryCache)
+	{
+		std::lock_guard<std::mutex> lk(m_cacheMutex);
+		directory = m_cacheDirectory;
+	}
+	if (directory.empty())
+	{
+		return ParseModel(data, size, dummyModel);
+	}
+	const uint64_t hash = HashData(data, size);
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.wcol", static_cast<unsigned long long>(hash));
+	const Path cachePath = directory + make_path(L"/") + make_path(std::string(name));
+	std::vector<char> cache = ReadFile(cachePath);
+	sCacheHeader header;
+	if (cache.size() > sizeof(header))
+	{
+		memcpy(&header, cache.data(), sizeof(header));
+		if (memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 && header.version == CACHE_VERSION && header.hash == hash)
+		{
+			try
+			{
+				return CWBMModelFactory().LoadModel(reinterpret_cast<unsigned char*>(cache.data()) + sizeof(header), cache.size() - sizeof(header), dummyModel, cachePath);
+			}
+			catch (std::exception const& e)
+			{
+				LogWriter::WriteLine("Model cache " + to_string(cachePath) + " is corrupted. " + e.what());
+			}
+		}
+	}
+	auto result = ParseModel(data, size, dummyModel);
+	if (!MakeDir(directory))
+	{
+		return result;
+	}
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	header.hash = hash;
+	std::vector<char> serialized = SerializeWBMModel(*result);
+	//Written under temporary name, so other instance or crash never leaves half written cache
+	const Path tempPath = cachePath + make_path(L".tmp");
+	bool written = false;
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::out);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(serialized.data(), serialized.size());
+		written = !!file;
+	}
+	if (!written || !AtomicReplaceFile(tempPath, cachePath))
+	{
+		RemoveFile(tempPath);
+	}
+	return result;
+}
+
+void CColladaModelFactory::SetCacheDirectory(const Path& directory)
+{
+	std::lock_guard<std::mutex> lk(m_cacheMutex);
+	m_cacheDirectory = directory;
+}
+
+std::unique_ptr<C3DModel> CColladaModelFactory::ParseModel(unsigned char * data, size_t size, C3DModel const& dummyModel)
 {
 	std::vector<char> normalizedData;
 	normalizedData.resize(size);
@@ -473,6 +598,12 @@ std::unique_ptr<C3DModel> CColladaModelFactory::LoadModel(unsigned char * data,
 	unordered_map<string, vector<unsigned int>> weightIndexes;
 	unordered_map<string, vector<float>> tempWeights;
 	unordered_map<string, vector<float>> bindShapeMatrices;
+	//First joint with the name is used
+	unordered_map<string, size_t> jointsByBone;
+	for (size_t i = 0; i < joints.size(); ++i)
+	{
+		jointsByBone.emplace(joints[i].bone, i);
+	}
 	xml_node<>* controllerLib = root->first_node("library_controllers");
 	if (controllerLib)
 	{
@@ -482,7 +613,7 @@ std::unique_ptr<C3DModel> CColladaModelFactory::LoadModel(unsigned char * data,
 			xml_node<> * skin = controller->first_node("skin");
 			if (skin)
 			{
-				bindShapeMatrices[skin->first_attribute("source")->value() + 1] = GetValues<float>(skin->first_node("bind_shape_matrix"));
+				bindShapeMatrices[skin->first_attribute("source")->value() + 1] = GetFloats(skin->first_node("bind_shape_matrix"));
 				string geometryId = skin->first_attribute("source")->value() + 1;
 				unordered_map<string, xml_node<>*> sources;
 				xml_node<> * source = skin->first_node("source");
@@ -514,19 +645,15 @@ std::unique_ptr<C3DModel> CColladaModelFactory::LoadModel(unsigned char * data,
 				}
 				if (jointSource && invMatrices)//assign inv_bind_matricies
 				{
-					vector<float> inv = GetValues<float>(invMatrices);
-					size_t index = 0;
-					stringstream sstream(jointSource->value());
-					while (sstream.good())
+					vector<float> inv = GetFloats(invMatrices);
+					vector<string> names = GetNames(jointSource);
+					for (size_t index = 0; index < names.size() && (index + 1) * 16 <= inv.size(); ++index)
 					{
-						string fl;
-						sstream >> fl;
-						auto it = find_if(joints.begin(), joints.end(), [&](sJoint const& joint) {return joint.bone == fl; });
-						if (it != joints.end())
+						auto it = jointsByBone.find(names[index]);
+						if (it != jointsByBone.end())
 						{
-							memcpy(it->invBindMatrix, &inv[index * 16], sizeof(float) * 16);
+							memcpy(joints[it->second].invBindMatrix, &inv[index * 16], sizeof(float) * 16);
 						}
-						++index;
 					}
 				}
 				xml_node<> * vertex_weights = skin->first_node("vertex_weights");
@@ -546,23 +673,31 @@ std::unique_ptr<C3DModel> CColladaModelFactory::LoadModel(unsigned char * data,
 						}
 						input = input->next_sibling("input");
 					}
-					vector<unsigned int> vcount = GetValues<unsigned>(vertex_weights->first_node("vcount"));
-					vector<size_t> v = GetValues<size_t>(vertex_weights->first_node("v"));
-					vector<string> jointNames;
-					string sname = jointSource->first_node()->value();
-					replace(sname.begin(), sname.end(), '\0', ' ');
-					stringstream sstream(sname);
-					while (!sstream.eof())
+					vector<unsigned int> vcount = GetIndexes(vertex_weights->first_node("vcount"));
+					vector<unsigned int> v = GetIndexes(vertex_weights->first_node("v"));
+					vector<string> jointNames = GetNames(jointSource);
+					//Skin joint index to skeleton joint index
+					vector<unsigned int> jointMap(jointNames.size(), UINT_MAX);
+					for (size_t i = 0; i < jointNames.size(); ++i)
 					{
-						string val;
-						sstream >> val;
-						jointNames.push_back(val);
+						auto it = jointsByBone.find(jointNames[i]);
+						if (it != jointsByBone.end())
+						{
+							jointMap[i] = static_cast<unsigned>(it->second);
+						}
 					}
-					vector<float> weightArray = GetValues<float>(weightsSource);
+					vector<float> weightArray = GetFloats(weightsSource);
+					vector<unsigned int>& geometryWeightIndexes = weightIndexes[geometryId];
+					vector<float>& geometryWeights = tempWeights[geometryId];
+					geometryWeightIndexes.reserve(v.size() / 2);
+					geometryWeights.reserve(v.size() / 2);
 					size_t l = 0;
-					weightCount[geometryId] = vcount;
 					for (size_t i = 0; i < vcount.size(); ++i)
 					{
+						if (l + vcount[i] * 2 > v.size())
+						{
+							throw runtime_error("Collada model has not enough vertex weights");
+						}
 						for (size_t k = 0; k < vcount[i]; k++)
 						{
 							size_t jointIndex = v[l + k * 2];
@@ -572,18 +707,15 @@ std::unique_ptr<C3DModel> CColladaModelFactory::LoadModel(unsigned char * data,
 								continue;
 							}
 							size_t weightIndex = v[l + k * 2 + 1];
-							for (size_t m = 0; m < joints.size(); ++m)
+							if (jointMap[jointIndex] != UINT_MAX && weightIndex < weightArray.size())
 							{
-								if (joints[m].bone == jointNames[jointIndex])
-								{
-									weightIndexes[geometryId].push_back(static_cast<unsigned>(m));
-									tempWeights[geometryId].push_back(weightArray[weightIndex]);
-									break;
-								}
+								geometryWeightIndexes.push_back(jointMap[jointIndex]);
+								geometryWeights.push_back(weightArray[weightIndex]);
 							}
 						}
 						l += vcount[i] * 2;
 					}
+					weightCount[geometryId] = std::move(vcount);
 					vertex_weights = vertex_weights->next_sibling("vertex_weights");
 				}
 			}
@@ -594,7 +726,12 @@ std::unique_ptr<C3DModel> CColladaModelFactory::LoadModel(unsigned char * data,
 	xml_node<>* animationLib = root->first_node("library_animations");
 	if (animationLib && controllerLib)
 	{
-		LoadAnimations(animationLib, joints, animations, -1);
+		unordered_map<string, size_t> jointsById;
+		for (size_t i = 0; i < joints.size(); ++i)
+		{
+			jointsById.emplace(joints[i].id, i);
+		}
+		LoadAnimations(animationLib, joints, jointsById, animations, -1);
 	}
 	xml_node<>* clipsLib = root->first_node("library_animation_clips");
 	if (clipsLib)
@@ -659,15 +796,15 @@ std::unique_ptr<C3DModel> CColladaModelFactory::LoadModel(unsigned char * data,
 								string inputType = vertEntry->first_attribute("semantic")->value();
 								if (inputType == "POSITION")
 								{
-									vert = GetValues<float>(sources[vertEntry->first_attribute("source")->value()]);
+									vert = GetFloats(sources[vertEntry->first_attribute("source")->value()]);
 								}
 								else if (inputType == "NORMAL")
 								{
-									normal = GetValues<float>(sources[vertEntry->first_attribute("source")->value()]);
+									normal = GetFloats(sources[vertEntry->first_attribute("source")->value()]);
 								}
 								else if (inputType == "TEXCOORD")
 								{
-									texcoord = GetValues<float>(sources[vertEntry->first_attribute("source")->value()]);
+									texcoord = GetFloats(sources[vertEntry->first_attribute("source")->value()]);
 
 								}
 								vertEntry = vertEntry->next_sibling("input");
@@ -678,13 +815,13 @@ std::unique_ptr<C3DModel> CColladaModelFactory::LoadModel(unsigned char * data,
 					{
 						simple = false;
 						normalOffset = atoi(input->first_attribute("offset")->value());
-						normal = GetValues<float>(sources[input->first_attribute("source")->value()]);
+						normal = GetFloats(sources[input->first_attribute("source")->value()]);
 					}
 					else if (type == "TEXCOORD")
 					{
 						texcoordOffset = atoi(input->first_attribute("offset")->value());
 						simple = false;
-						texcoord = GetValues<float>(sources[input->first_attribute("source")->value()]);
+						texcoord = GetFloats(sources[input->first_attribute("source")->value()]);
 						texCoordStride = atoi(sources[input->first_attribute("source")->value()]->next_sibling("technique_common")->first_node("accessor")->first_attribute("stride")->value());
 					}
 					size_t offset = static_cast<size_t>(atoi(input->first_attribute("offset")->value()));
@@ -711,46 +848,68 @@ std::unique_ptr<C3DModel> CColladaModelFactory::LoadModel(unsigned char * data,
 					vector<float>& weightPtr = tempWeights[meshId];
 					weights.insert(weights.end(), weightPtr.begin(), weightPtr.end());
 				}
-				vector<size_t> currentIndexes;
+				vector<unsigned int> const& meshWeightCount = weightCount[meshId];
+				vector<unsigned int> const& meshWeightIndexes = weightIndexes[meshId];
+				vector<float> const& meshWeights = tempWeights[meshId];
+				auto bindShapeMatrix = bindShapeMatrices.find(meshId);
+				const float* bindShape = bindShapeMatrix != bindShapeMatrices.end() && bindShapeMatrix->second.size() >= 16 ? bindShapeMatrix->second.data() : nullptr;
+				//Starting index of every vertex weights, so they are not summed up for each corner
+				vector<size_t> weightStarts;
+				if (!simple && controllerLib)
+				{
+					weightStarts.resize(meshWeightCount.size() + 1, 0);
+					for (size_t i = 0; i < meshWeightCount.size(); ++i)
+					{
+						weightStarts[i + 1] = weightStarts[i] + meshWeightCount[i];
+					}
+				}
 				xml_node<>* polygons = triangles->first_node("p");
 				while (polygons)
 				{
-					string value = polygons->value();
-					size_t indexCount = (std::count(value.begin(), value.end(), ' ') + 1) / maxOffset;
+					vector<unsigned int> polygonIndexes = GetIndexes(polygons);
+					if (simple)
+					{
+						indexes.reserve(indexes.size() + polygonIndexes.size());
+						for (unsigned int i : polygonIndexes)
+						{
+							indexes.push_back(static_cast<unsigned>(i + indexOffset));
+						}
+						polygons = polygons->next_sibling("p");
+						continue;
+					}
+					const size_t indexCount = polygonIndexes.size() / maxOffset;
 					indexes.reserve(indexes.size() + indexCount);
 					vertices.reserve(vertices.size() + indexCount);
 					normals.reserve(normals.size() + indexCount);
 					textureCoords.reserve(textureCoords.size() + indexCount);
-					stringstream sstream(value);
-					while (!sstream.eof())
+					for (size_t corner = 0; corner < indexCount; ++corner)
 					{
-						size_t i;
-						sstream >> i;
-						if (simple)
+						const unsigned int* currentIndexes = &polygonIndexes[corner * maxOffset];
+						const size_t vertexIndex = currentIndexes[vertexOffset];
+						if (vertexIndex * 3 + 3 > vert.size())
 						{
-							indexes.push_back(static_cast<unsigned>(i + indexOffset));
+							throw runtime_error("Collada model has vertex index out of range");
 						}
-						else
+						CVector3f vertex(&vert[vertexIndex * 3]);
+						MultiplyVectorToMatrix(vertex, bindShape);
+						vertices.push_back(vertex);
+						const size_t normalIndex = currentIndexes[normalOffset];
+						normals.push_back(normalIndex * 3 + 3 <= normal.size() ? CVector3f(&normal[normalIndex * 3]) : CVector3f());
+						if (currentIndexes[texcoordOffset] * texCoordStride < texcoord.size())
+							textureCoords.push_back(CVector2f(&texcoord[currentIndexes[texcoordOffset] * texCoordStride]));
+						indexes.push_back(static_cast<unsigned>(vertices.size() - 1));
+						if (controllerLib)
 						{
-							currentIndexes.push_back(i);
-							if (currentIndexes.size() == maxOffset)
+							unsigned int count = vertexIndex < meshWeightCount.size() ? meshWeightCount[vertexIndex] : 0;
+							weightsCount.push_back(count);
+							if (count)
 							{
-								CVector3f vertex(&vert[currentIndexes[vertexOffset] * 3]);
-								MultiplyVectorToMatrix(vertex, bindShapeMatrices[meshId].data());
-								vertices.push_back(vertex);
-								normals.push_back(CVector3f(&normal[currentIndexes[normalOffset] * 3]));
-								if(currentIndexes[texcoordOffset] * texCoordStride < texcoord.size())
-								textureCoords.push_back(CVector2f(&texcoord[currentIndexes[texcoordOffset] * texCoordStride]));
-								indexes.push_back(static_cast<unsigned>(vertices.size() - 1));
-								if (controllerLib)
-								{
-									unsigned int count = weightCount[meshId][currentIndexes[vertexOffset]];
-									weightsCount.push_back(count);
-									unsigned int start = accumulate(weightCount[meshId].begin(), weightCount[meshId].begin() + currentIndexes[vertexOffset], 0);//Get the starting index of the current vertex weight
-									weightsIndexes.insert(weightsIndexes.end(), weightIndexes[meshId].begin() + start, weightIndexes[meshId].begin() + start + count);
-									weights.insert(weights.end(), tempWeights[meshId].begin() + start, tempWeights[meshId].begin() + start + count);
-								}
-								currentIndexes.clear();
+								size_t start = weightStarts[vertexIndex];
+								//Weights of unknown joints are skipped, so there may be less of them than vcount says
+								size_t end = std::min(start + count, meshWeights.size());
+								start = std::min(start, end);
+								weightsIndexes.insert(weightsIndexes.end(), meshWeightIndexes.begin() + start, meshWeightIndexes.begin() + end);
+								weights.insert(weights.end(), meshWeights.begin() + start, meshWeights.begin() + end);
 							}
 						}
 					}
@@ -781,10 +940,7 @@ std::unique_ptr<C3DModel> CColladaModelFactory::LoadModel(unsigned char * data,
 
 bool CColladaModelFactory::ModelIsSupported(unsigned char * /*data*/, size_t /*size*/, const Path& filePath) const
 {
-	size_t dotCoord = filePath.find_last_of('.') + 1;
-	Path extension = filePath.substr(dotCoord, filePath.length() - dotCoord);
-	std::transform(extension.begin(), extension.end(), extension.begin(), std::towlower);
-	return extension == make_path(L"dae");
+	return GetExtension(filePath) == make_path(L"dae");
 }
 }
 }
\ No newline at end of file
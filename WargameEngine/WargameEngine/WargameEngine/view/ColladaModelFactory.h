@@ -1,5 +1,6 @@
 #pragma once
 #include "IModelReader.h"
+#include <mutex>
 
 namespace wargameEngine
 {
@@ -8,9 +9,19 @@ namespace view
 class CColladaModelFactory : public IModelReader
 {
 public:
+	//Binary cache stores parsed model as WBM file named after hash of the source file in the cache directory. Nothing is cached until directory is set
+	explicit CColladaModelFactory(bool binaryCache = false);
+
 	bool ModelIsSupported(unsigned char* data, size_t size, const Path& filePath) const override;
 
 	std::unique_ptr<C3DModel> LoadModel(unsigned char* data, size_t size, C3DModel const& dummyModel, const Path& filePath) override;
+	void SetCacheDirectory(const Path& directory) override;
+private:
+	std::unique_ptr<C3DModel> ParseModel(unsigned char* data, size_t size, C3DModel const& dummyModel);
+
+	bool m_binaryCache;
+	Path m_cacheDirectory;
+	std::mutex m_cacheMutex;
 };
 }
 }
\ No newline at end of file
@@ -0,0 +1,368 @@
+#include "CullingTree.h"
+#include <algorithm>
+#include <glm/gtx/euler_angles.hpp>
+
+namespace wargameEngine
+{
+namespace view
+{
+namespace
+{
+//Enlargement of leaf boxes relative to their size, so objects can move a bit without being reinserted
+const float FAT_BOX_RATIO = 0.1f;
+const float FAT_BOX_MIN_MARGIN = 0.05f;
+
+AxisAlignedBox MakeFatBox(AxisAlignedBox const& box)
+{
+	CVector3f size = box.max - box.min;
+	CVector3f margin(size.x * FAT_BOX_RATIO + FAT_BOX_MIN_MARGIN, size.y * FAT_BOX_RATIO + FAT_BOX_MIN_MARGIN, size.z * FAT_BOX_RATIO + FAT_BOX_MIN_MARGIN);
+	return{ box.min - margin, box.max + margin };
+}
+}
+
+bool AxisAlignedBox::Contains(AxisAlignedBox const& other) const
+{
+	return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z
+		&& max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+}
+
+AxisAlignedBox AxisAlignedBox::Union(AxisAlignedBox const& other) const
+{
+	return{ CVector3f(std::min(min.x, other.min.x), std::min(min.y, other.min.y), std::min(min.z, other.min.z)),
+		CVector3f(std::max(max.x, other.max.x), std::max(max.y, other.max.y), std::max(max.z, other.max.z)) };
+}
+
+float AxisAlignedBox::GetSurfaceArea() const
+{
+	CVector3f size = max - min;
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+AxisAlignedBox AxisAlignedBox::Transform(CVector3f const& translation, CVector3f const& rotations, float scale) const
+{
+	const glm::mat4 rotation = glm::yawPitchRoll(glm::radians(rotations.x), glm::radians(rotations.y), glm::radians(rotations.z));
+	const CVector3f center = (min + max) * (0.5f * scale);
+	const CVector3f extent = (max - min) * (0.5f * scale);
+	float resultMin[3], resultMax[3];
+	for (int row = 0; row < 3; ++row)
+	{
+		float worldCenter = translation[row];
+		float worldExtent = 0.0f;
+		for (int column = 0; column < 3; ++column)
+		{
+			worldCenter += rotation[column][row] * center[column];
+			worldExtent += fabs(rotation[column][row]) * extent[column];
+		}
+		resultMin[row] = worldCenter - worldExtent;
+		resultMax[row] = worldCenter + worldExtent;
+	}
+	return{ CVector3f(resultMin), CVector3f(resultMax) };
+}
+
+Frustum::Frustum(const float* projectionMatrix, const float* viewMatrix)
+{
+	float m[16];
+	for (int column = 0; column < 4; ++column)
+	{
+		for (int row = 0; row < 4; ++row)
+		{
+			float value = 0.0f;
+			for (int k = 0; k < 4; ++k)
+			{
+				value += projectionMatrix[k * 4 + row] * viewMatrix[column * 4 + k];
+			}
+			m[column * 4 + row] = value;
+		}
+	}
+	//Plane i is row 3 plus or minus row i / 2 of clip matrix: left, right, bottom, top, near, far
+	for (int i = 0; i < 6; ++i)
+	{
+		const int row = i / 2;
+		const float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+		for (int column = 0; column < 4; ++column)
+		{
+			m_planes[i][column] = m[column * 4 + 3] + sign * m[column * 4 + row];
+		}
+	}
+}
+
+Frustum::eTestResult Frustum::Test(AxisAlignedBox const& box) const
+{
+	eTestResult result = eTestResult::Inside;
+	for (auto& plane : m_planes)
+	{
+		//corner furthest along plane normal
+		const float px = plane[0] >= 0.0f ? box.max.x : box.min.x;
+		const float py = plane[1] >= 0.0f ? box.max.y : box.min.y;
+		const float pz = plane[2] >= 0.0f ? box.max.z : box.min.z;
+		if (plane[0] * px + plane[1] * py + plane[2] * pz + plane[3] < 0.0f)
+		{
+			return eTestResult::Outside;
+		}
+		const float nx = plane[0] >= 0.0f ? box.min.x : box.max.x;
+		const float ny = plane[1] >= 0.0f ? box.min.y : box.max.y;
+		const float nz = plane[2] >= 0.0f ? box.min.z : box.max.z;
+		if (plane[0] * nx + plane[1] * ny + plane[2] * nz + plane[3] < 0.0f)
+		{
+			result = eTestResult::Intersects;
+		}
+	}
+	return result;
+}
+
+CullingTree::ProxyId CullingTree::Insert(AxisAlignedBox const& box, model::IBaseObject* object)
+{
+	int proxy = AllocateNode();
+	m_nodes[proxy].box = MakeFatBox(box);
+	m_nodes[proxy].object = object;
+	m_nodes[proxy].height = 0;
+	InsertLeaf(proxy);
+	++m_proxyCount;
+	return proxy;
+}
+
+void CullingTree::Remove(ProxyId proxy)
+{
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	--m_proxyCount;
+}
+
+bool CullingTree::Update(ProxyId proxy, AxisAlignedBox const& box)
+{
+	if (m_nodes[proxy].box.Contains(box))
+	{
+		return false;
+	}
+	RemoveLeaf(proxy);
+	m_nodes[proxy].box = MakeFatBox(box);
+	InsertLeaf(proxy);
+	return true;
+}
+
+void CullingTree::Clear()
+{
+	m_nodes.clear();
+	m_root = -1;
+	m_freeList = -1;
+	m_proxyCount = 0;
+}
+
+size_t CullingTree::GetProxyCount() const
+{
+	return m_proxyCount;
+}
+
+void CullingTree::Query(Frustum const& frustum, std::vector<model::IBaseObject*>& result) const
+{
+	if (m_root == -1)
+	{
+		return;
+	}
+	m_stack.clear();
+	m_stack.push_back(m_root);
+	while (!m_stack.empty())
+	{
+		const int index = m_stack.back();
+		m_stack.pop_back();
+		const sNode& node = m_nodes[index];
+		auto test = frustum.Test(node.box);
+		if (test == Frustum::eTestResult::Outside)
+		{
+			continue;
+		}
+		if (node.IsLeaf())
+		{
+			result.push_back(node.object);
+		}
+		else if (test == Frustum::eTestResult::Inside)
+		{
+			CollectLeaves(index, result);
+		}
+		else
+		{
+			m_stack.push_back(node.child1);
+			m_stack.push_back(node.child2);
+		}
+	}
+}
+
+void CullingTree::CollectLeaves(int node, std::vector<model::IBaseObject*>& result) const
+{
+	if (m_nodes[node].IsLeaf())
+	{
+		result.push_back(m_nodes[node].object);
+		return;
+	}
+	CollectLeaves(m_nodes[node].child1, result);
+	CollectLeaves(m_nodes[node].child2, result);
+}
+
+int CullingTree::AllocateNode()
+{
+	if (m_freeList == -1)
+	{
+		m_nodes.emplace_back();
+		return static_cast<int>(m_nodes.size() - 1);
+	}
+	int node = m_freeList;
+	m_freeList = m_nodes[node].parent;
+	m_nodes[node] = sNode();
+	return node;
+}
+
+void CullingTree::FreeNode(int node)
+{
+	m_nodes[node].parent = m_freeList;
+	m_nodes[node].object = nullptr;
+	m_nodes[node].height = -1;
+	m_freeList = node;
+}
+
+void CullingTree::InsertLeaf(int leaf)
+{
+	if (m_root == -1)
+	{
+		m_root = leaf;
+		m_nodes[leaf].parent = -1;
+		return;
+	}
+	//Find the best sibling by surface area heuristic
+	const AxisAlignedBox leafBox = m_nodes[leaf].box;
+	int index = m_root;
+	while (!m_nodes[index].IsLeaf())
+	{
+		const sNode& node = m_nodes[index];
+		const float area = node.box.GetSurfaceArea();
+		const float combinedArea = node.box.Union(leafBox).GetSurfaceArea();
+		//Cost of creating a new parent for this node and the new leaf
+		const float cost = 2.0f * combinedArea;
+		//Minimum cost of pushing the leaf further down the tree
+		const float inheritanceCost = 2.0f * (combinedArea - area);
+		auto descendCost = [&](int child) {
+			const sNode& childNode = m_nodes[child];
+			const float newArea = childNode.box.Union(leafBox).GetSurfaceArea();
+			return childNode.IsLeaf() ? newArea + inheritanceCost : newArea - childNode.box.GetSurfaceArea() + inheritanceCost;
+		};
+		const float cost1 = descendCost(node.child1);
+		const float cost2 = descendCost(node.child2);
+		if (cost < cost1 && cost < cost2)
+		{
+			break;
+		}
+		index = cost1 < cost2 ? node.child1 : node.child2;
+	}
+	const int sibling = index;
+	const int oldParent = m_nodes[sibling].parent;
+	const int newParent = AllocateNode();
+	sNode& parentNode = m_nodes[newParent];
+	parentNode.parent = oldParent;
+	parentNode.box = leafBox.Union(m_nodes[sibling].box);
+	parentNode.height = m_nodes[sibling].height + 1;
+	parentNode.child1 = sibling;
+	parentNode.child2 = leaf;
+	if (oldParent != -1)
+	{
+		if (m_nodes[oldParent].child1 == sibling)
+			m_nodes[oldParent].child1 = newParent;
+		else
+			m_nodes[oldParent].child2 = newParent;
+	}
+	else
+	{
+		m_root = newParent;
+	}
+	m_nodes[sibling].parent = newParent;
+	m_nodes[leaf].parent = newParent;
+	Refit(m_nodes[leaf].parent);
+}
+
+void CullingTree::RemoveLeaf(int leaf)
+{
+	if (leaf == m_root)
+	{
+		m_root = -1;
+		return;
+	}
+	const int parent = m_nodes[leaf].parent;
+	const int grandParent = m_nodes[parent].parent;
+	const int sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+	FreeNode(parent);
+	if (grandParent == -1)
+	{
+		m_root = sibling;
+		m_nodes[sibling].parent = -1;
+		return;
+	}
+	if (m_nodes[grandParent].child1 == parent)
+		m_nodes[grandParent].child1 = sibling;
+	else
+		m_nodes[grandParent].child2 = sibling;
+	m_nodes[sibling].parent = grandParent;
+	Refit(grandParent);
+}
+
+void CullingTree::Refit(int index)
+{
+	while (index != -1)
+	{
+		index = Balance(index);
+		sNode& node = m_nodes[index];
+		node.height = 1 + std::max(m_nodes[node.child1].height, m_nodes[node.child2].height);
+		node.box = m_nodes[node.child1].box.Union(m_nodes[node.child2].box);
+		index = node.parent;
+	}
+}
+
+int CullingTree::Balance(int a)
+{
+	sNode& nodeA = m_nodes[a];
+	if (nodeA.IsLeaf() || nodeA.height < 2)
+	{
+		return a;
+	}
+	const int b = nodeA.child1;
+	const int c = nodeA.child2;
+	const int balance = m_nodes[c].height - m_nodes[b].height;
+	if (balance >= -1 && balance <= 1)
+	{
+		return a;
+	}
+	//Rotate the higher child up and make a its child. Grandchild with less height stays under a
+	const bool rotateC = balance > 1;
+	const int up = rotateC ? c : b;
+	const int other = rotateC ? b : c;
+	sNode& nodeUp = m_nodes[up];
+	const int f = nodeUp.child1;
+	const int g = nodeUp.child2;
+	nodeUp.child1 = a;
+	nodeUp.parent = nodeA.parent;
+	nodeA.parent = up;
+	if (nodeUp.parent != -1)
+	{
+		if (m_nodes[nodeUp.parent].child1 == a)
+			m_nodes[nodeUp.parent].child1 = up;
+		else
+			m_nodes[nodeUp.parent].child2 = up;
+	}
+	else
+	{
+		m_root = up;
+	}
+	const bool keepF = m_nodes[f].height > m_nodes[g].height;
+	const int kept = keepF ? f : g;
+	const int moved = keepF ? g : f;
+	nodeUp.child2 = kept;
+	if (rotateC)
+		nodeA.child2 = moved;
+	else
+		nodeA.child1 = moved;
+	m_nodes[moved].parent = a;
+	nodeA.box = m_nodes[other].box.Union(m_nodes[moved].box);
+	nodeA.height = 1 + std::max(m_nodes[other].height, m_nodes[moved].height);
+	nodeUp.box = nodeA.box.Union(m_nodes[kept].box);
+	nodeUp.height = 1 + std::max(nodeA.height, m_nodes[kept].height);
+	return up;
+}
+}
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "Vector3.h"
+#include <vector>
+
+namespace wargameEngine
+{
+namespace model
+{
+class IBaseObject;
+}
+
+namespace view
+{
+struct AxisAlignedBox
+{
+	CVector3f min;
+	CVector3f max;
+
+	bool Contains(AxisAlignedBox const& other) const;
+	AxisAlignedBox Union(AxisAlignedBox const& other) const;
+	float GetSurfaceArea() const;
+	//Returns world space box of local box after scale, rotation (degrees, same order as IRenderer::Rotate) and translation
+	AxisAlignedBox Transform(CVector3f const& translation, CVector3f const& rotations, float scale) const;
+};
+
+//Clip planes of a viewport. Matrices are column-major as returned by IViewport
+class Frustum
+{
+public:
+	enum class eTestResult
+	{
+		Outside,
+		Intersects,
+		Inside,
+	};
+
+	Frustum(const float* projectionMatrix, const float* viewMatrix);
+	eTestResult Test(AxisAlignedBox const& box) const;
+
+private:
+	float m_planes[6][4];
+};
+
+//Dynamic bounding volume hierarchy over world space boxes of objects. Leaves keep enlarged boxes so small movements do not restructure the tree
+class CullingTree
+{
+public:
+	typedef int ProxyId;
+	static const ProxyId INVALID_PROXY = -1;
+
+	ProxyId Insert(AxisAlignedBox const& box, model::IBaseObject* object);
+	void Remove(ProxyId proxy);
+	//Returns true if proxy moved out of its enlarged box and was reinserted
+	bool Update(ProxyId proxy, AxisAlignedBox const& box);
+	void Clear();
+	size_t GetProxyCount() const;
+	//Appends objects whose boxes are not completely outside of frustum
+	void Query(Frustum const& frustum, std::vector<model::IBaseObject*>& result) const;
+
+private:
+	struct sNode
+	{
+		AxisAlignedBox box;
+		model::IBaseObject* object = nullptr;
+		//next free node when node is not used
+		int parent = -1;
+		int child1 = -1;
+		int child2 = -1;
+		//0 for leaves, -1 for free nodes
+		int height = -1;
+
+		bool IsLeaf() const { return child1 == -1; }
+	};
+
+	int AllocateNode();
+	void FreeNode(int node);
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	int Balance(int node);
+	void Refit(int node);
+	void CollectLeaves(int node, std::vector<model::IBaseObject*>& result) const;
+
+	std::vector<sNode> m_nodes;
+	int m_root = -1;
+	int m_freeList = -1;
+	size_t m_proxyCount = 0;
+	mutable std::vector<int> m_stack;
+};
+}
+}
@@ -1,25 +1,51 @@
 #pragma once
 #include <memory>
 #include <vector>
+#include "../Typedefs.h"
+#include "FrameArena.h"
+#include "IRenderer.h"
 #include "Matrix4.h"
 #include "Vector3.h"
 
 namespace wargameEngine
 {
+namespace model
+{
+struct TeamColor;
+}
+
 namespace view
 {
-class IVertexBuffer;
 class IShaderProgram;
 class ICachedTexture;
+class C3DModel;
 struct Material;
 
+//Vertices that are generated on CPU every frame. Memory is owned by frame arena or SkinnedVertices
 struct TempMeshBuffer
 {
-	std::vector<CVector3f> vertices;
-	std::vector<CVector3f> normals;
+	const CVector3f* vertices;
+	const CVector3f* normals;
+	size_t verticesCount;
 	const CVector2f* texCoords;
 	const unsigned* indexes;
-	const size_t indexesCount;
+	size_t indexesCount;
+};
+
+//Vertices of an object skinned on CPU. Kept between frames, so memory is only reallocated when object model changes
+struct SkinnedVertices
+{
+	std::vector<CVector3f> vertices;
+	std::vector<CVector3f> normals;
+	TempMeshBuffer buffer;
+};
+
+//CPU skinning recorded while meshes are collected. All jobs of the frame are executed together on the thread pool
+struct SkinningJob
+{
+	const C3DModel* model;
+	const float* skinMatrices;
+	SkinnedVertices* output;
 };
 
 struct DrawableMesh
@@ -29,8 +55,9 @@ struct DrawableMesh
 	Material* material = nullptr;
 	IVertexBuffer * buffer = nullptr;
 	Matrix4F modelMatrix;
-	std::shared_ptr<TempMeshBuffer> tempBuffer;
-	std::shared_ptr<std::vector<float>> skeleton;
+	const TempMeshBuffer* tempBuffer = nullptr;
+	const float* skeleton = nullptr;
+	size_t skeletonSize = 0;
 	size_t start = 0;
 	size_t count = 0;
 	bool indexed = false;
@@ -42,5 +69,73 @@ struct DrawableMesh
 };
 
 using MeshList = std::vector<DrawableMesh>;
+
+//Meshes of m_meshesToDraw that are drawn instanced. Model matrices of instances are stored as 4 columns one after another, each column has room for capacity instances,
+//so an attribute per column can point to the first instance of a group. Buffer is kept between frames, only the range of changed matrices is uploaded
+struct InstancedMeshes
+{
+	//Objects that have the same meshes, drawn with one call
+	struct Group
+	{
+		size_t firstInstance;
+		size_t instances;
+		size_t drawsBegin;
+		size_t drawsEnd;
+	};
+	//Range of meshes with the same shader, texture, buffer and material
+	struct Block
+	{
+		size_t begin;
+		size_t end;
+		size_t groupsBegin;
+		size_t groupsEnd;
+	};
+
+	std::vector<Block> blocks;
+	std::vector<Group> groups;
+	std::vector<IRenderer::IndirectDraw> draws;
+	std::vector<const Matrix4F*> matrices;
+	//Contents of the buffer
+	std::vector<float> columns;
+	std::unique_ptr<IVertexAttribCache> buffer;
+	size_t capacity = 0;
+	//Scratch storage, begin and end of each object in a block
+	std::vector<std::pair<size_t, size_t>> objects;
+	std::vector<size_t> order;
+
+	void Reset()
+	{
+		blocks.clear();
+		groups.clear();
+		draws.clear();
+		matrices.clear();
+	}
+};
+
+//Texture that was not created yet when mesh was collected on a worker thread. It is created later on the main thread
+struct UnresolvedTexture
+{
+	size_t meshIndex;
+	const Path* texture;
+	const std::vector<model::TeamColor>* teamcolor;
+	Material* material;
+};
+
+//Output of mesh collection for a single worker. Storage is reused between frames
+struct MeshCollection
+{
+	MeshList meshes;
+	std::vector<UnresolvedTexture> unresolvedTextures;
+	std::vector<SkinningJob> skinningJobs;
+	FrameArena arena;
+
+	void Reset()
+	{
+		meshes.clear();
+		unresolvedTextures.clear();
+		skinningJobs.clear();
+		arena.Reset();
+	}
+};
 }
 }
\ No newline at end of file
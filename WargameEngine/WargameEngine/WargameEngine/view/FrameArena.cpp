@@ -0,0 +1,52 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace wargameEngine
+{
+namespace view
+{
+FrameArena::FrameArena(size_t blockSize)
+	: m_blockSize(blockSize)
+{
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	for (; m_currentBlock < m_blocks.size(); ++m_currentBlock, m_offset = 0)
+	{
+		auto& block = m_blocks[m_currentBlock];
+		const uintptr_t address = reinterpret_cast<uintptr_t>(block.data.get()) + m_offset;
+		const size_t padding = (alignment - address % alignment) % alignment;
+		if (m_offset + padding + size <= block.size)
+		{
+			m_offset += padding + size;
+			return block.data.get() + m_offset - size;
+		}
+	}
+	//Blocks are allocated with new[], so they are aligned for any fundamental type
+	const size_t newBlockSize = std::max(m_blockSize, size + alignment);
+	if (m_blocks.size() == m_blocks.capacity())
+	{
+		++m_heapAllocations;
+	}
+	m_blocks.push_back({ std::make_unique<char[]>(newBlockSize), newBlockSize });
+	++m_heapAllocations;
+	m_currentBlock = m_blocks.size() - 1;
+	m_offset = 0;
+	return Allocate(size, alignment);
+}
+
+void FrameArena::Reset()
+{
+	m_currentBlock = 0;
+	m_offset = 0;
+	m_heapAllocations = 0;
+}
+
+size_t FrameArena::GetHeapAllocations() const
+{
+	return m_heapAllocations;
+}
+}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace wargameEngine
+{
+namespace view
+{
+//Linear allocator for data that lives until the end of frame. Memory blocks are kept on Reset, so steady state frames do not touch the heap
+class FrameArena
+{
+public:
+	FrameArena(size_t blockSize = 64 * 1024);
+
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+	//Destructors are never called, so only trivially destructible types are allowed
+	template<class T>
+	T* Allocate(size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "Frame arena does not call destructors");
+		return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+	}
+	template<class T, class... Args>
+	T* New(Args&&... args)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "Frame arena does not call destructors");
+		return new (Allocate(sizeof(T), alignof(T))) T{ std::forward<Args>(args)... };
+	}
+	//Invalidates all allocated memory
+	void Reset();
+	//Returns number of heap allocations made since last Reset
+	size_t GetHeapAllocations() const;
+
+private:
+	struct sBlock
+	{
+		std::unique_ptr<char[]> data;
+		size_t size;
+	};
+
+	std::vector<sBlock> m_blocks;
+	size_t m_blockSize;
+	size_t m_currentBlock = 0;
+	size_t m_offset = 0;
+	size_t m_heapAllocations = 0;
+};
+}
+}
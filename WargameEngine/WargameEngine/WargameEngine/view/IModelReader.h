@@ -4,6 +4,8 @@
 
 namespace wargameEngine
 {
+class ThreadPool;
+
 namespace view
 {
 class C3DModel;
@@ -15,6 +17,10 @@ public:
 
 	virtual bool ModelIsSupported(unsigned char* data, size_t size, const Path& filePath) const = 0;
 	virtual std::unique_ptr<C3DModel> LoadModel(unsigned char* data, size_t size, const C3DModel& dummyModel, const Path& filePath) = 0;
+	//Readers that can split loading of one file into parallel jobs use the pool. Called when reader is registered
+	virtual void SetThreadPool(ThreadPool& /*threadPool*/) {}
+	//Readers that cache parsed files keep them in the directory. Called from the main thread when module changes, loads of the previous module may still run
+	virtual void SetCacheDirectory(const Path& /*directory*/) {}
 };
 }
 }
\ No newline at end of file
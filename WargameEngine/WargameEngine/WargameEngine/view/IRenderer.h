@@ -71,6 +71,8 @@ public:
 	virtual void DrawIndirect(IVertexBuffer& buffer, const array_view<IndirectDraw>& indirectList, bool indexed) = 0;
 	virtual void SetIndexBuffer(IVertexBuffer& buffer, const unsigned int* indexPtr, size_t indexesSize) = 0;
 	virtual void AddVertexAttribute(IVertexBuffer& buffer, const std::string& attribute, int elementSize, size_t count, IShaderManager::Format type, const void* values, bool perInstance = false) = 0;
+	//Attribute is read from cache created by shader manager, so data that does not change is not uploaded again. Offset is in bytes
+	virtual void AddVertexAttribute(IVertexBuffer& buffer, const std::string& attribute, int elementSize, IVertexAttribCache const& cache, IShaderManager::Format type, bool perInstance = false, size_t offset = 0) = 0;
 
 	virtual void PushMatrix() = 0;
 	virtual void PopMatrix() = 0;
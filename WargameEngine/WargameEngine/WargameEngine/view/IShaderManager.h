@@ -2,6 +2,8 @@
 #include "../Typedefs.h"
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace wargameEngine
 {
@@ -20,6 +22,41 @@ public:
 	virtual ~IVertexAttribCache() {}
 };
 
+//Uniform name registered in shader manager. Its location is resolved once per program, so setting it does not search by name
+class UniformHandle
+{
+public:
+	UniformHandle() = default;
+	explicit UniformHandle(size_t id) : m_id(id) {}
+	size_t GetId() const { return m_id; }
+	bool IsValid() const { return m_id != INVALID_ID; }
+
+private:
+	static constexpr size_t INVALID_ID = static_cast<size_t>(-1);
+	size_t m_id = INVALID_ID;
+};
+
+//Gives sequential ids to uniform names. Used by shader managers to implement GetUniformHandle
+class UniformRegistry
+{
+public:
+	UniformHandle Get(const std::string& uniform)
+	{
+		auto it = m_ids.find(uniform);
+		if (it == m_ids.end())
+		{
+			it = m_ids.emplace(uniform, m_names.size()).first;
+			m_names.push_back(uniform);
+		}
+		return UniformHandle(it->second);
+	}
+	const std::string& GetName(UniformHandle handle) const { return m_names.at(handle.GetId()); }
+
+private:
+	std::unordered_map<std::string, size_t> m_ids;
+	std::vector<std::string> m_names;
+};
+
 class IShaderManager
 {
 public:
@@ -34,6 +71,12 @@ public:
 	virtual void SetUniformValue(const std::string& uniform, int elementSize, size_t count, const int* value) const = 0;
 	virtual void SetUniformValue(const std::string& uniform, int elementSize, size_t count, const unsigned int* value) const = 0;
 
+	//Handles do not depend on program, get them once and use with every program
+	virtual UniformHandle GetUniformHandle(const std::string& uniform) const = 0;
+	virtual void SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const float* value) const = 0;
+	virtual void SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const int* value) const = 0;
+	virtual void SetUniformValue(UniformHandle uniform, int elementSize, size_t count, const unsigned int* value) const = 0;
+
 	virtual void SetVertexAttribute(const std::string& attribute, int elementSize, size_t count, const float* values, bool perInstance = false) const = 0;
 	virtual void SetVertexAttribute(const std::string& attribute, int elementSize, size_t count, const int* values, bool perInstance = false) const = 0;
 	virtual void SetVertexAttribute(const std::string& attribute, int elementSize, size_t count, const unsigned int* values, bool perInstance = false) const = 0;
@@ -42,7 +85,10 @@ public:
 	virtual void DisableVertexAttribute(const std::string& attribute, int size, const int* defaultValue) const = 0;
 	virtual void DisableVertexAttribute(const std::string& attribute, int size, const unsigned int* defaultValue) const = 0;
 
-	virtual std::unique_ptr<IVertexAttribCache> CreateVertexAttribCache(size_t size, const void* value) const = 0;
+	//Dynamic caches are expected to be changed by UpdateVertexAttribCache often
+	virtual std::unique_ptr<IVertexAttribCache> CreateVertexAttribCache(size_t size, const void* value, bool dynamic = false) const = 0;
+	//Writes size bytes at offset of the cache. value points to the whole contents of the cache, backends that cannot write a part of buffer used by GPU upload all of it
+	virtual void UpdateVertexAttribCache(IVertexAttribCache& cache, const void* value, size_t offset, size_t size) const = 0;
 
 	enum class Format
 	{
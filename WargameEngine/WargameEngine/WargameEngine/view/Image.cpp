@@ -46,7 +46,7 @@ Image::Image(std::vector<unsigned char>&& uncompressedData, size_t width, size_t
 	, m_bpp(bpp)
 	, m_flags(flags)
 	, m_size(size)
-	, m_uncompressedData(uncompressedData)
+	, m_uncompressedData(std::move(uncompressedData))
 {
 	m_data = m_uncompressedData.data();
 }
@@ -1,3 +1,4 @@
+#pragma once
 #include "../Typedefs.h"
 
 namespace wargameEngine
@@ -16,6 +17,8 @@ struct Material
 	Path specularMap;
 	Path bumpMap;
 	ICachedTexture* texturePtr = nullptr;
+	//Texture manager generation texturePtr was cached at. Pointer is stale after textures are evicted
+	unsigned texturePtrGeneration = 0;
 };
 }
 }
\ No newline at end of file
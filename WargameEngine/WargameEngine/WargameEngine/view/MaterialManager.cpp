@@ -18,6 +18,11 @@ void MaterialManager::AddMaterial(std::string const& name, Material const& mater
 	m_materials[name] = material;
 }
 
+std::unordered_map<std::string, Material> const& MaterialManager::GetMaterials() const
+{
+	return m_materials;
+}
+
 void MaterialManager::InsertMaterials(std::unordered_map<std::string, Material> const& materials)
 {
 	m_materials.insert(materials.begin(), materials.end());
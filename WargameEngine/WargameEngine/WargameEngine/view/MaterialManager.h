@@ -14,6 +14,7 @@ public:
 	void InsertMaterials(std::unordered_map<std::string, Material> const& materials);
 	Material* GetMaterial(std::string const& name);
 	void AddMaterial(std::string const& name, Material const& material);
+	std::unordered_map<std::string, Material> const& GetMaterials() const;
 
 private:
 	std::unordered_map<std::string, Material> m_materials;
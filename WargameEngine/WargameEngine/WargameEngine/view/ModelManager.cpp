@@ -13,7 +13,7 @@ namespace wargameEngine
 namespace view
 {
 ModelManager::ModelManager(model::IBoundingBoxManager & bbmanager, AsyncFileProvider & asyncFileProvider)
-	: m_bbManager(&bbmanager), m_asyncFileProvider(&asyncFileProvider), m_gpuSkinning(false)
+	: m_bbManager(&bbmanager), m_asyncFileProvider(&asyncFileProvider), m_gpuSkinning(false), m_cacheDir(make_path(L"cache"))
 {
 }
 
@@ -25,22 +25,44 @@ void ModelManager::LoadIfNotExist(const Path& path, TextureManager& textureManag
 {
 	if (m_models.find(path) == m_models.end())
 	{
-		auto& model = *m_models.emplace(std::make_pair(path, std::make_unique<C3DModel>(m_bbManager->GetModelScale(path), m_bbManager->GetModelRotation(path)))).first->second;
+		const float scale = m_bbManager->GetModelScale(path);
+		const CVector3f rotation = m_bbManager->GetModelRotation(path);
+		m_models.emplace(std::make_pair(path, std::make_unique<C3DModel>(scale, rotation)));
 		auto fullPath = m_asyncFileProvider->GetModelAbsolutePath(path);
-		m_asyncFileProvider->GetModelAsync(path, [=, &model](void* data, size_t size) {
+		const Path cacheDir = m_cacheDir.empty() ? Path() : m_asyncFileProvider->GetAbsolutePath(m_cacheDir);
+		if (cacheDir != m_readersCacheDir)
+		{
+			for (auto& reader : m_modelReaders)
+			{
+				reader->SetCacheDirectory(cacheDir);
+			}
+			m_readersCacheDir = cacheDir;
+		}
+		//Loaded model replaces the placeholder on the main thread, so models can be read without locks while meshes are collected.
+		//Placeholder may be destroyed by Reset while loading, so worker uses its own copy and stale result is dropped
+		auto loadedModel = std::make_shared<std::unique_ptr<C3DModel>>();
+		const size_t resetCount = m_resetCount;
+		m_asyncFileProvider->GetModelAsync(path, [=](void* data, size_t size) {
 			unsigned char* charData = reinterpret_cast<unsigned char*>(data);
+			const C3DModel dummyModel(scale, rotation);
 			for (auto& loader : m_modelReaders)
 			{
 				if (loader->ModelIsSupported(charData, size, fullPath))
 				{
-					auto mdl = loader->LoadModel(charData, size, model, fullPath);
-					std::unique_lock<std::mutex> lk(m_mutex);
-					m_models[path] = std::move(mdl);
+					*loadedModel = loader->LoadModel(charData, size, dummyModel, fullPath);
 					return;
 				}
 			}
 			throw std::runtime_error("Cannot load model " + to_string(path) + ". None of installed readers cannot load it");
 		}, [=, &textureManager]() {
+			if (resetCount != m_resetCount)
+			{
+				return;
+			}
+			if (*loadedModel)
+			{
+				m_models[path] = std::move(*loadedModel);
+			}
 			m_models[path]->PreloadTextures(textureManager);
 		}, [](std::exception const& e) {
 			LogWriter::WriteLine(e.what());
@@ -48,11 +70,27 @@ void ModelManager::LoadIfNotExist(const Path& path, TextureManager& textureManag
 	}
 }
 
-void ModelManager::GetModelMeshes(const Path& path, IRenderer & renderer, TextureManager& textureManager, model::IObject* object, MeshList& meshesVec)
+C3DModel* ModelManager::PrepareModel(const Path& path, IRenderer & renderer, TextureManager& textureManager)
 {
 	LoadIfNotExist(path, textureManager);
-	std::unique_lock<std::mutex> lk(m_mutex);
-	m_models[path]->GetMeshes(renderer, textureManager, object, m_gpuSkinning, meshesVec);
+	auto& model = *m_models.find(path)->second;
+	model.PrepareBuffers(renderer);
+	return &model;
+}
+
+void ModelManager::GetModelMeshes(C3DModel const& modelToDraw, Matrix4F const& objectMatrix, TextureManager const& textureManager, model::IObject* object, MeshCollection& result, SkinnedVertices* skinned) const
+{
+	modelToDraw.GetMeshes(objectMatrix, textureManager, object, m_gpuSkinning, result, &m_poseCache, skinned);
+}
+
+void ModelManager::BeginFrame()
+{
+	m_poseCache.Reset();
+}
+
+size_t ModelManager::GetFrameHeapAllocations() const
+{
+	return m_poseCache.GetHeapAllocations();
 }
 
 std::vector<std::string> ModelManager::GetAnimations(const Path& path)
@@ -65,14 +103,27 @@ void ModelManager::EnableGPUSkinning(bool enable)
 	m_gpuSkinning = enable;
 }
 
+bool ModelManager::IsGPUSkinningEnabled() const
+{
+	return m_gpuSkinning;
+}
+
 void ModelManager::RegisterModelReader(std::unique_ptr<IModelReader> && reader)
 {
 	m_modelReaders.push_back(std::move(reader));
+	m_modelReaders.back()->SetCacheDirectory(m_readersCacheDir);
+}
+
+void ModelManager::SetCacheDirectory(const Path& directory)
+{
+	m_cacheDir = directory;
 }
 
 void ModelManager::Reset()
 {
 	m_models.clear();
+	m_poseCache.Reset();
+	++m_resetCount;
 }
 }
 }
\ No newline at end of file
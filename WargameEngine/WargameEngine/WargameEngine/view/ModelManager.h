@@ -2,9 +2,9 @@
 #include <set>
 #include <memory>
 #include <vector>
-#include <mutex>
 #include "../Typedefs.h"
 #include "DrawableMesh.h"
+#include "SkeletalPose.h"
 
 namespace wargameEngine
 {
@@ -28,19 +28,36 @@ class ModelManager
 public:
 	ModelManager(model::IBoundingBoxManager & bbmanager, AsyncFileProvider & asyncFileProvider);
 	~ModelManager();
-	void GetModelMeshes(const Path& path, IRenderer & renderer, TextureManager& textureManager, model::IObject* object, MeshList& meshesVec);
+	//Loads model if needed and creates its buffers. Must be called from the main thread. Returned model stays valid until ThreadPool::Update or Reset is called
+	C3DModel* PrepareModel(const Path& path, IRenderer & renderer, TextureManager& textureManager);
+	//Can be called from several threads at once for models returned by PrepareModel. skinned receives CPU skinned vertices of the object
+	void GetModelMeshes(C3DModel const& modelToDraw, Matrix4F const& objectMatrix, TextureManager const& textureManager, model::IObject* object, MeshCollection& result,
+		SkinnedVertices* skinned = nullptr) const;
+	//Drops skeleton poses cached during previous frame. Must be called before meshes are collected
+	void BeginFrame();
+	//Returns number of heap allocations made by pose cache since BeginFrame
+	size_t GetFrameHeapAllocations() const;
 	void LoadIfNotExist(const Path& path, TextureManager& textureManager);
 	std::vector<std::string> GetAnimations(const Path& path);
 	void EnableGPUSkinning(bool enable);
+	bool IsGPUSkinningEnabled() const;
 	void RegisterModelReader(std::unique_ptr<IModelReader> && reader);
+	//Relative to module folder. Readers keep caches of parsed models there
+	void SetCacheDirectory(const Path& directory);
 	void Reset();
 private:
 	std::unordered_map<Path, std::unique_ptr<C3DModel>> m_models;
 	std::vector<std::unique_ptr<IModelReader>> m_modelReaders;
 	model::IBoundingBoxManager * m_bbManager;
 	AsyncFileProvider * m_asyncFileProvider;
-	std::mutex m_mutex;
 	bool m_gpuSkinning;
+	Path m_cacheDir;
+	//Absolute directory that readers have, it changes with module
+	Path m_readersCacheDir;
+	//Loads started before Reset do not put their models back
+	size_t m_resetCount = 0;
+	//Internally synchronized, shared by all threads that collect meshes
+	mutable PoseCache m_poseCache;
 };
 }
 }
\ No newline at end of file
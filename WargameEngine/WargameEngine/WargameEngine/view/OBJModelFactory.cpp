@@ -1,14 +1,15 @@
 #include "OBJModelFactory.h"
 #include "../AsyncFileProvider.h"
 #include "../LogWriter.h"
+#include "../NumberParser.h"
+#include "../ThreadPool.h"
 #include "../Utils.h"
 #include "3dModel.h"
 #include "IRenderer.h"
 #include <algorithm>
-#include <cwctype>
-#include <fstream>
+#include <cstring>
+#include <stdexcept>
 #include <unordered_map>
-#include <sstream>
 #include <string>
 #include <vector>
 
@@ -18,130 +19,347 @@ namespace view
 {
 namespace
 {
-struct FaceIndex
+//Files are split into chunks of lines of about this size. Every chunk is parsed by its own job
+const size_t CHUNK_SIZE = 1024 * 1024;
+const int MAX_INDEX = 1 << 30;
+
+enum class eStatement
 {
-	size_t vertex;
-	size_t normal;
-	size_t textureCoord;
+	MaterialLibrary,
+	UseMaterial,
+	Group,
 };
 
-size_t ParseStringUntilSlash(std::stringstream& indexStream, char ch = 0)
+struct sStatement
 {
-	std::string index;
-	if (ch == 0)
+	eStatement type;
+	//Number of face vertices of the chunk before the statement
+	size_t position;
+	std::string value;
+};
+
+//Indexes are written in file starting from 1, 0 means there is no such attribute. Negative indexes are relative to the last defined element,
+//they are stored counted from the beginning of the chunk and marked by bits of relative
+struct sFaceVertex
+{
+	int index[3];
+	unsigned char relative;
+};
+
+struct sChunk
+{
+	std::vector<CVector3f> vertices;
+	std::vector<CVector2f> textureCoords;
+	std::vector<CVector3f> normals;
+	std::vector<sFaceVertex> faces;
+	std::vector<sStatement> statements;
+};
+
+struct sVertexKey
+{
+	int vertex;
+	int textureCoord;
+	int normal;
+
+	bool operator==(sVertexKey const& other) const
 	{
-		std::getline(indexStream, index);
+		return vertex == other.vertex && textureCoord == other.textureCoord && normal == other.normal;
 	}
-	else
+};
+
+struct VertexKeyHash
+{
+	size_t operator()(sVertexKey const& key) const
+	{
+		uint64_t hash = static_cast<uint32_t>(key.vertex) * 0x9E3779B97F4A7C15ull;
+		hash ^= (hash >> 29) + static_cast<uint32_t>(key.textureCoord) * 0xBF58476D1CE4E5B9ull;
+		hash ^= (hash >> 31) + static_cast<uint32_t>(key.normal) * 0x94D049BB133111EBull;
+		return static_cast<size_t>(hash ^ (hash >> 32));
+	}
+};
+
+bool IsDigit(char ch)
+{
+	return ch >= '0' && ch <= '9';
+}
+
+//Missing values are left unchanged
+const char* ParseFloats(const char* pos, const char* end, float* values, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		pos = SkipWhitespace(pos, end);
+		const char* tokenEnd = FindWhitespace(pos, end);
+		if (tokenEnd == pos)
+			break;
+		ParseFloat(pos, tokenEnd, values[i]);
+		pos = tokenEnd;
+	}
+	return pos;
+}
+
+std::string ParseWord(const char* pos, const char* end)
+{
+	pos = SkipWhitespace(pos, end);
+	return std::string(pos, FindWhitespace(pos, end));
+}
+
+//Face vertex is v, v/vt, v//vn or v/vt/vn
+sFaceVertex ParseFaceVertex(const char* pos, const char* end, sChunk const& chunk)
+{
+	const size_t counts[3] = { chunk.vertices.size(), chunk.textureCoords.size(), chunk.normals.size() };
+	sFaceVertex result = {};
+	for (size_t i = 0; i < 3 && pos < end; ++i)
+	{
+		const bool negative = *pos == '-';
+		if (negative)
+			++pos;
+		int value = 0;
+		for (; pos < end && IsDigit(*pos); ++pos)
+		{
+			//Too big index is out of range anyway, so it is clamped before it can overflow
+			const int digit = *pos - '0';
+			value = value > (MAX_INDEX - digit) / 10 ? MAX_INDEX : value * 10 + digit;
+		}
+		if (negative && value != 0)
+		{
+			result.index[i] = static_cast<int>(counts[i]) - value;
+			result.relative |= 1 << i;
+		}
+		else
+		{
+			result.index[i] = value;
+		}
+		if (pos < end && *pos == '/')
+			++pos;
+		else
+			break;
+	}
+	return result;
+}
+
+//Polygons are split into triangle fans
+void ParseFace(const char* pos, const char* end, sChunk& chunk)
+{
+	size_t count = 0;
+	sFaceVertex first;
+	sFaceVertex last;
+	for (pos = SkipWhitespace(pos, end); pos < end; pos = SkipWhitespace(pos, end))
+	{
+		const char* tokenEnd = FindWhitespace(pos, end);
+		sFaceVertex vertex = ParseFaceVertex(pos, tokenEnd, chunk);
+		pos = tokenEnd;
+		if (count == 0)
+		{
+			first = vertex;
+		}
+		else if (count >= 2)
+		{
+			chunk.faces.push_back(first);
+			chunk.faces.push_back(last);
+			chunk.faces.push_back(vertex);
+		}
+		last = vertex;
+		++count;
+	}
+}
+
+void ParseLine(const char* pos, const char* end, sChunk& chunk)
+{
+	pos = SkipWhitespace(pos, end);
+	const char* keywordEnd = FindWhitespace(pos, end);
+	const size_t length = keywordEnd - pos;
+	if (length == 0 || *pos == '#')
+		return;
+	if (length == 1 && *pos == 'v')
+	{
+		CVector3f vertex;
+		ParseFloats(keywordEnd, end, &vertex.x, 3);
+		chunk.vertices.push_back(vertex);
+	}
+	else if (length == 2 && pos[0] == 'v' && pos[1] == 't')
+	{
+		CVector2f textureCoord;
+		ParseFloats(keywordEnd, end, &textureCoord.x, 2);
+		chunk.textureCoords.push_back(textureCoord);
+	}
+	else if (length == 2 && pos[0] == 'v' && pos[1] == 'n')
+	{
+		CVector3f normal;
+		ParseFloats(keywordEnd, end, &normal.x, 3);
+		chunk.normals.push_back(normal);
+	}
+	else if (length == 1 && *pos == 'f')
+	{
+		ParseFace(keywordEnd, end, chunk);
+	}
+	else if (length == 6 && memcmp(pos, "usemtl", 6) == 0)
+	{
+		chunk.statements.push_back({ eStatement::UseMaterial, chunk.faces.size(), ParseWord(keywordEnd, end) });
+	}
+	else if (length == 6 && memcmp(pos, "mtllib", 6) == 0)
+	{
+		chunk.statements.push_back({ eStatement::MaterialLibrary, chunk.faces.size(), ParseWord(keywordEnd, end) });
+	}
+	else if (length == 1 && *pos == 'g')
 	{
-		std::getline(indexStream, index, ch);
+		//Group name is the rest of line
+		const char* nameBegin = SkipWhitespace(keywordEnd, end);
+		const char* nameEnd = end;
+		while (nameEnd > nameBegin && FindWhitespace(nameEnd - 1, nameEnd) != nameEnd)
+			--nameEnd;
+		if (nameEnd != nameBegin)
+		{
+			chunk.statements.push_back({ eStatement::Group, chunk.faces.size(), std::string(nameBegin, nameEnd) });
+		}
 	}
-	return (!index.empty()) ? static_cast<size_t>(atol(index.c_str())) : 0u;
 }
 
-FaceIndex ParseFaceIndex(std::string const& str)
+void ParseChunk(const char* pos, const char* end, sChunk& chunk)
 {
-	std::stringstream indexStream(str);
-	FaceIndex res;
-	res.vertex = ParseStringUntilSlash(indexStream, '/');
-	res.textureCoord = ParseStringUntilSlash(indexStream, '/');
-	res.normal = ParseStringUntilSlash(indexStream);
-	return res;
+	while (pos < end)
+	{
+		const char* lineEnd = static_cast<const char*>(memchr(pos, '\n', end - pos));
+		if (!lineEnd)
+			lineEnd = end;
+		ParseLine(pos, lineEnd, chunk);
+		pos = lineEnd + 1;
+	}
 }
 
 std::unordered_map<std::string, Material> LoadMTL(const Path& path)
 {
 	std::unordered_map<std::string, Material> materials;
-	std::ifstream iFile(path);
-	if (!iFile.good())
+	std::vector<char> data = ReadFile(path);
+	if (data.empty())
 	{
-		iFile.close();
 		LogWriter::WriteLine("Error loading MTL " + to_string(path));
 		return materials;
 	}
-	std::string line;
-	std::string type;
-	float dvalue;
 	Material* lastMaterial = NULL;
-	while (std::getline(iFile, line))
+	const char* pos = data.data();
+	const char* end = pos + data.size();
+	while (pos < end)
 	{
-		if (line.empty() || line[0] == '#') //Empty line or commentary
+		const char* lineEnd = static_cast<const char*>(memchr(pos, '\n', end - pos));
+		if (!lineEnd)
+			lineEnd = end;
+		const char* typeBegin = SkipWhitespace(pos, lineEnd);
+		const char* typeEnd = FindWhitespace(typeBegin, lineEnd);
+		const std::string type(typeBegin, typeEnd);
+		pos = lineEnd + 1;
+		if (type.empty() || type[0] == '#') //Empty line or commentary
 			continue;
 
-		std::istringstream lineStream(line);
-		lineStream >> type;
-
 		if (type == "newmtl") //name
 		{
-			lineStream >> type;
-			materials[type] = Material();
-			lastMaterial = &materials[type];
+			lastMaterial = &materials[ParseWord(typeEnd, lineEnd)];
+			*lastMaterial = Material();
 		}
-
-		if (type == "Ka" && lastMaterial) //ambient color
+		if (!lastMaterial)
+			continue;
+		if (type == "Ka") //ambient color
 		{
-			for (size_t i = 0; i < 3; ++i)
-			{
-				lineStream >> dvalue;
-				lastMaterial->ambient[i] = dvalue;
-			}
+			ParseFloats(typeEnd, lineEnd, lastMaterial->ambient, 3);
 		}
-		if (type == "Kd" && lastMaterial) //diffuse color
+		if (type == "Kd") //diffuse color
 		{
-			for (size_t i = 0; i < 3; ++i)
-			{
-				lineStream >> dvalue;
-				lastMaterial->diffuse[i] = dvalue;
-			}
+			ParseFloats(typeEnd, lineEnd, lastMaterial->diffuse, 3);
 		}
-		if (type == "Ks" && lastMaterial) //specular color
+		if (type == "Ks") //specular color
 		{
-			for (size_t i = 0; i < 3; ++i)
-			{
-				lineStream >> dvalue;
-				lastMaterial->specular[i] = dvalue;
-			}
+			ParseFloats(typeEnd, lineEnd, lastMaterial->specular, 3);
 		}
-		if (type == "Ns" && lastMaterial) //specular coefficient
+		if (type == "Ns") //specular coefficient
 		{
-			lineStream >> dvalue;
-			lastMaterial->shininess = dvalue;
+			ParseFloats(typeEnd, lineEnd, &lastMaterial->shininess, 1);
 		}
-		if (type == "map_Kd" && lastMaterial) //texture
+		if (type == "map_Kd") //texture
 		{
-			std::string texture;
-			lineStream >> texture;
-			lastMaterial->texture = make_path(texture);
+			lastMaterial->texture = make_path(ParseWord(typeEnd, lineEnd));
 		}
-		if ((type == "map_bump" || type == "bump") && lastMaterial) //bump texture
+		if (type == "map_bump" || type == "bump") //bump texture
 		{
-			std::string texture;
-			lineStream >> texture;
-			lastMaterial->bumpMap = make_path(texture);
+			lastMaterial->bumpMap = make_path(ParseWord(typeEnd, lineEnd));
 		}
-		if (type == "map_specular" && lastMaterial) //custom specular map extension
+		if (type == "map_specular") //custom specular map extension
 		{
-			std::string texture;
-			lineStream >> texture;
-			lastMaterial->texture = make_path(texture);
+			lastMaterial->texture = make_path(ParseWord(typeEnd, lineEnd));
 		}
 	}
-	iFile.close();
 	return materials;
 }
+
+//Converts index from file to index in array of all elements. Returns -1 if there is no such attribute
+int ResolveIndex(sFaceVertex const& face, size_t component, size_t chunkOffset, size_t count)
+{
+	int64_t index = face.index[component];
+	if (face.relative & (1 << component))
+	{
+		index += chunkOffset;
+	}
+	else if (index == 0)
+	{
+		return -1;
+	}
+	else
+	{
+		--index;
+	}
+	if (index < 0 || index >= static_cast<int64_t>(count))
+	{
+		throw std::runtime_error("OBJ face refers to an element that does not exist");
+	}
+	return static_cast<int>(index);
+}
 }
 
-std::unique_ptr<C3DModel> CObjModelFactory::LoadModel(unsigned char* data, size_t /*size*/, const C3DModel& dummyModel, const Path& filePath)
+std::unique_ptr<C3DModel> CObjModelFactory::LoadModel(unsigned char* data, size_t size, const C3DModel& dummyModel, const Path& filePath)
 {
 	auto slashPos = filePath.find_last_of(make_path(L"\\/"));
 	Path parentPath = slashPos == filePath.npos ? filePath : filePath.substr(0, slashPos);
+	const char* text = reinterpret_cast<const char*>(data);
+	//Chunks end at line ends
+	std::vector<const char*> bounds(1, text);
+	while (static_cast<size_t>(text + size - bounds.back()) > CHUNK_SIZE)
+	{
+		const char* lineEnd = static_cast<const char*>(memchr(bounds.back() + CHUNK_SIZE, '\n', text + size - bounds.back() - CHUNK_SIZE));
+		if (!lineEnd)
+			break;
+		bounds.push_back(lineEnd + 1);
+	}
+	bounds.push_back(text + size);
+	std::vector<sChunk> chunks(bounds.size() - 1);
+	auto parseChunks = [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+		{
+			ParseChunk(bounds[i], bounds[i + 1], chunks[i]);
+		}
+	};
+	if (m_threadPool && chunks.size() > 1)
+	{
+		m_threadPool->ParallelFor(0, chunks.size(), parseChunks);
+	}
+	else
+	{
+		parseChunks(0, chunks.size());
+	}
+
 	std::vector<CVector3f> tempVertices;
 	std::vector<CVector2f> tempTextureCoords;
 	std::vector<CVector3f> tempNormals;
+	size_t facesCount = 0;
+	for (auto& chunk : chunks)
+	{
+		tempVertices.insert(tempVertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+		tempTextureCoords.insert(tempTextureCoords.end(), chunk.textureCoords.begin(), chunk.textureCoords.end());
+		tempNormals.insert(tempNormals.end(), chunk.normals.begin(), chunk.normals.end());
+		facesCount += chunk.faces.size();
+	}
 	std::vector<CVector3f> vertices;
 	std::vector<CVector2f> textureCoords;
 	std::vector<CVector3f> normals;
-	std::unordered_map<std::string, unsigned int> faces;
+	std::unordered_map<sVertexKey, unsigned int, VertexKeyHash> faces;
 	std::vector<unsigned int> indexes;
 	MaterialManager materialManager;
 	std::vector<sMesh> meshes;
@@ -150,131 +368,78 @@ std::unique_ptr<C3DModel> CObjModelFactory::LoadModel(unsigned char* data, size_
 	std::vector<float> weights;
 	std::vector<sJoint> joints;
 	std::vector<sAnimation> animations;
-	std::stringstream iFile((char*)data);
-	std::string type;
-	CVector3f p3;
-	CVector2f p2;
+	indexes.reserve(facesCount);
+	faces.reserve(facesCount / 4);
 	sMesh mesh;
-	bool useFaces = false;
-	bool useNormals = false;
-	bool useUVs = false;
-	while (iFile.good())
-	{
-		iFile >> type;
-		if (type.empty() || type[0] == '#') //Empty line or commentary
-			continue;
-
-		if (type == "v") // Vertex
-		{
-			iFile >> p3.x;
-			iFile >> p3.y;
-			iFile >> p3.z;
-			tempVertices.push_back(p3);
-		}
-
-		if (type == "vt") // Texture coords
+	auto addMesh = [&]() {
+		mesh.begin = indexes.size();
+		if (!meshes.empty() && mesh.begin == meshes.back().begin)
 		{
-			useUVs = true;
-			iFile >> p2.x;
-			iFile >> p2.y;
-			tempTextureCoords.push_back(p2);
+			meshes.back() = mesh;
 		}
-		if (type == "vn") // Normals
+		else
 		{
-			useNormals = true;
-			iFile >> p3.x;
-			iFile >> p3.y;
-			iFile >> p3.z;
-			tempNormals.push_back(p3);
-		}
-		if (type == "f") // faces
-		{
-			useFaces = true;
-			for (unsigned int i = 0; i < 3; ++i)
-			{
-				std::string index3;
-				iFile >> index3;
-				if (faces.find(index3) != faces.end()) //This vertex/texture coord/normal already exist
-				{
-					indexes.push_back(faces[index3]);
-				}
-				else //std::make_unique<vertex/texcoord/normal
-				{
-					FaceIndex faceIndex = ParseFaceIndex(index3);
-					vertices.push_back(tempVertices[faceIndex.vertex - 1]);
-					if (faceIndex.textureCoord != 0)
-					{
-						textureCoords.push_back(tempTextureCoords[faceIndex.textureCoord - 1]);
-					}
-					else
-					{
-						textureCoords.push_back(CVector2f());
-					}
-					if (faceIndex.normal != 0)
-					{
-						normals.push_back(tempNormals[faceIndex.normal - 1]);
-					}
-					else
-					{
-						normals.push_back(CVector3f());
-					}
-					indexes.push_back(static_cast<int>(vertices.size() - 1));
-					faces[index3] = static_cast<unsigned>(vertices.size() - 1);
-				}
-			}
+			meshes.push_back(mesh);
 		}
-		if (type == "mtllib") //Load materials file
+	};
+	auto applyStatement = [&](sStatement const& statement) {
+		if (statement.type == eStatement::MaterialLibrary) //Load materials file
 		{
-			std::string mtlPath;
-			iFile >> mtlPath;
+			std::string mtlPath = statement.value;
 			if (mtlPath.size() > 2 && mtlPath.front() == '.')
 			{
 				mtlPath = mtlPath.substr(2);
 			}
 			materialManager.InsertMaterials(LoadMTL(AppendPath(parentPath, make_path(mtlPath))));
 		}
-		if (type == "usemtl") //apply material
+		else if (statement.type == eStatement::UseMaterial) //apply material
 		{
-			iFile >> mesh.materialName;
-			mesh.begin = indexes.size();
-			if (!meshes.empty() && mesh.begin == meshes.back().begin)
+			mesh.materialName = statement.value;
+			addMesh();
+		}
+		else if (statement.type == eStatement::Group)
+		{
+			mesh.name = statement.value;
+			addMesh();
+		}
+	};
+	size_t offsets[3] = {};
+	for (auto& chunk : chunks)
+	{
+		auto statement = chunk.statements.begin();
+		for (size_t i = 0; i < chunk.faces.size(); ++i)
+		{
+			for (; statement != chunk.statements.end() && statement->position <= i; ++statement)
 			{
-				meshes.back() = mesh;
+				applyStatement(*statement);
 			}
-			else
+			const sFaceVertex& face = chunk.faces[i];
+			sVertexKey key;
+			key.vertex = ResolveIndex(face, 0, offsets[0], tempVertices.size());
+			key.textureCoord = ResolveIndex(face, 1, offsets[1], tempTextureCoords.size());
+			key.normal = ResolveIndex(face, 2, offsets[2], tempNormals.size());
+			if (key.vertex < 0)
 			{
-				meshes.push_back(mesh);
+				throw std::runtime_error("OBJ face vertex has no position");
 			}
-		}
-		if (type == "g") //apply material
-		{
-			std::string name;
-			iFile.get();
-			std::getline(iFile, name);
-			if (!name.empty())
+			auto inserted = faces.emplace(key, static_cast<unsigned>(vertices.size()));
+			if (inserted.second) //new vertex/texcoord/normal
 			{
-				mesh.name = name;
-				mesh.begin = indexes.size();
-				if (!meshes.empty() && mesh.begin == meshes.back().begin)
-				{
-					meshes.back() = mesh;
-				}
-				else
-				{
-					meshes.push_back(mesh);
-				}
+				vertices.push_back(tempVertices[key.vertex]);
+				textureCoords.push_back(key.textureCoord >= 0 ? tempTextureCoords[key.textureCoord] : CVector2f());
+				normals.push_back(key.normal >= 0 ? tempNormals[key.normal] : CVector3f());
 			}
+			indexes.push_back(inserted.first->second);
 		}
+		for (; statement != chunk.statements.end(); ++statement)
+		{
+			applyStatement(*statement);
+		}
+		offsets[0] += chunk.vertices.size();
+		offsets[1] += chunk.textureCoords.size();
+		offsets[2] += chunk.normals.size();
 	}
-	if (!useNormals)
-	{
-		tempNormals.clear();
-	}
-	if (!useUVs)
-	{
-		tempTextureCoords.clear();
-	}
-	if (!useFaces)
+	if (facesCount == 0)
 	{
 		vertices.swap(tempVertices);
 		textureCoords.swap(tempTextureCoords);
@@ -288,10 +453,12 @@ std::unique_ptr<C3DModel> CObjModelFactory::LoadModel(unsigned char* data, size_
 
 bool CObjModelFactory::ModelIsSupported(unsigned char* /*data*/, size_t /*size*/, const Path& filePath) const
 {
-	size_t dotCoord = filePath.find_last_of('.') + 1;
-	Path extension = filePath.substr(dotCoord, filePath.length() - dotCoord);
-	std::transform(extension.begin(), extension.end(), extension.begin(), std::towlower);
-	return extension == make_path(L"obj");
+	return GetExtension(filePath) == make_path(L"obj");
+}
+
+void CObjModelFactory::SetThreadPool(ThreadPool& threadPool)
+{
+	m_threadPool = &threadPool;
 }
 }
 }
\ No newline at end of file
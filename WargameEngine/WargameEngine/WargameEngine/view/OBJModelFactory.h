@@ -10,6 +10,11 @@ class CObjModelFactory : public IModelReader
 public:
 	bool ModelIsSupported(unsigned char* data, size_t size, const Path& filePath) const override;
 	std::unique_ptr<C3DModel> LoadModel(unsigned char* data, size_t size, C3DModel const& dummyModel, const Path& filePath) override;
+	//Large files are split into chunks of lines that are parsed in parallel
+	void SetThreadPool(ThreadPool& threadPool) override;
+
+private:
+	ThreadPool* m_threadPool = nullptr;
 };
 }
 }
\ No newline at end of file
@@ -1,10 +1,17 @@
 #include "PerfomanceMeter.h"
+#include <algorithm>
 #include <fstream>
 
 namespace wargameEngine
 {
 namespace view
 {
+namespace
+{
+//Weight of the last frame in rolling averages
+const double ZONE_AVERAGE_WEIGHT = 0.05;
+}
+
 std::unique_ptr<PerfomanceMeter> PerfomanceMeter::m_instance;
 
 void PerfomanceMeter::ReportFrameEnd()
@@ -17,6 +24,7 @@ void PerfomanceMeter::ReportFrameEnd()
 	{
 		instance->m_fpsHistory.push_back(instance->m_fps);
 	}
+	instance->UpdateZoneStats();
 }
 
 size_t GetPolygons(size_t verticesCount, IRenderer::RenderMode mode)
@@ -49,6 +57,13 @@ void PerfomanceMeter::Reset()
 	instance->m_drawCalls = 0;
 	instance->m_verticesDrawn = 0;
 	instance->m_polygonsDrawn = 0;
+	instance->m_frameAllocations = 0;
+	instance->m_streamedBytes = 0;
+	instance->m_streamStalls = 0;
+	for (auto& time : instance->m_stageTimes)
+	{
+		time = std::chrono::high_resolution_clock::duration::zero();
+	}
 }
 
 long long PerfomanceMeter::GetVerticesDrawn()
@@ -66,11 +81,112 @@ long long PerfomanceMeter::GetDrawCalls()
 	return GetInstance()->m_drawCalls;
 }
 
+void PerfomanceMeter::ReportFrameAllocations(size_t count)
+{
+	GetInstance()->m_frameAllocations += count;
+}
+
+long long PerfomanceMeter::GetFrameAllocations()
+{
+	return GetInstance()->m_frameAllocations;
+}
+
+void PerfomanceMeter::ReportStreamUpload(size_t bytes)
+{
+	GetInstance()->m_streamedBytes += bytes;
+}
+
+void PerfomanceMeter::ReportStreamStall()
+{
+	++GetInstance()->m_streamStalls;
+}
+
+long long PerfomanceMeter::GetStreamedBytes()
+{
+	return GetInstance()->m_streamedBytes;
+}
+
+long long PerfomanceMeter::GetStreamStalls()
+{
+	return GetInstance()->m_streamStalls;
+}
+
 size_t PerfomanceMeter::GetFps()
 {
 	return static_cast<size_t>(fabs(GetInstance()->m_fps));
 }
 
+void PerfomanceMeter::ReportStageTime(Stage stage, std::chrono::high_resolution_clock::duration time)
+{
+	GetInstance()->m_stageTimes[static_cast<size_t>(stage)] += time;
+}
+
+double PerfomanceMeter::GetStageTime(Stage stage)
+{
+	return std::chrono::duration<double, std::milli>(GetInstance()->m_stageTimes[static_cast<size_t>(stage)]).count();
+}
+
+const char* PerfomanceMeter::GetStageName(Stage stage)
+{
+	static const char* names[] = { "controller", "collect", "sort", "instances", "render" };
+	return stage < Stage::Count ? names[static_cast<size_t>(stage)] : "";
+}
+
+PerfomanceMeter::StageTimer::StageTimer(Stage stage)
+	: m_zone(GetStageName(stage))
+	, m_stage(stage)
+	, m_start(std::chrono::high_resolution_clock::now())
+{
+}
+
+PerfomanceMeter::StageTimer::~StageTimer()
+{
+	ReportStageTime(m_stage, std::chrono::high_resolution_clock::now() - m_start);
+}
+
+void PerfomanceMeter::ShowProfilerOverlay(bool show)
+{
+	GetInstance()->m_profilerOverlay = show;
+}
+
+bool PerfomanceMeter::IsProfilerOverlayVisible()
+{
+	return GetInstance()->m_profilerOverlay;
+}
+
+std::vector<PerfomanceMeter::ZoneStats> const& PerfomanceMeter::GetZoneStats()
+{
+	return GetInstance()->m_zoneStats;
+}
+
+void PerfomanceMeter::UpdateZoneStats()
+{
+	const long long frameStart = m_zoneFrameStart;
+	m_zoneFrameStart = Profiler::GetTime();
+	for (auto& zone : m_zones)
+	{
+		zone.frameTime = 0;
+	}
+	Profiler::ReadNewEvents([this, frameStart](Profiler::Event const& event) {
+		auto it = std::find_if(m_zones.begin(), m_zones.end(), [&event](sZone const& zone) { return zone.stats.name == event.name; });
+		if (it == m_zones.end())
+		{
+			const long long order = event.start - frameStart;
+			it = std::upper_bound(m_zones.begin(), m_zones.end(), order, [](long long value, sZone const& zone) { return value < zone.order; });
+			it = m_zones.insert(it, { { event.name, event.depth, 0.0 }, order, 0 });
+		}
+		it->frameTime += event.end - event.start;
+		it->stats.depth = std::min(it->stats.depth, event.depth);
+	});
+	m_zoneStats.resize(m_zones.size());
+	for (size_t i = 0; i < m_zones.size(); ++i)
+	{
+		auto& stats = m_zones[i].stats;
+		stats.time += (m_zones[i].frameTime / 1000000.0 - stats.time) * ZONE_AVERAGE_WEIGHT;
+		m_zoneStats[i] = stats;
+	}
+}
+
 void PerfomanceMeter::StartBenchmark()
 {
 	GetInstance()->m_benchmark = true;
@@ -1,6 +1,9 @@
 #pragma once
 #include "IRenderer.h"
+#include "../Profiler.h"
 #include <chrono>
+#include <string>
+#include <vector>
 
 namespace wargameEngine
 {
@@ -9,27 +12,91 @@ namespace view
 class PerfomanceMeter
 {
 public:
+	enum class Stage
+	{
+		Controller,
+		Collect,
+		Sort,
+		Instances,
+		Render,
+		Count
+	};
+
+	//Adds CPU time from construction to destruction to the stage. Stage is a profiler zone too
+	class StageTimer
+	{
+	public:
+		explicit StageTimer(Stage stage);
+		~StageTimer();
+
+	private:
+		Profiler::Zone m_zone;
+		Stage m_stage;
+		std::chrono::high_resolution_clock::time_point m_start;
+	};
+
+	struct ZoneStats
+	{
+		const char* name;
+		//Smallest nesting level the zone was seen at
+		unsigned depth;
+		//Rolling average of milliseconds per frame summed over all threads
+		double time;
+	};
+
 	static void ReportFrameEnd();
 	static void ReportDraw(size_t verticesCount, IRenderer::RenderMode mode);
 	static void Reset();
 	static long long GetVerticesDrawn();
 	static long long GetPolygonsDrawn();
 	static long long GetDrawCalls();
+	//Heap allocations made by per-frame mesh storage. Should stay 0 in steady state
+	static void ReportFrameAllocations(size_t count);
+	static long long GetFrameAllocations();
+	//Vertex data written to stream buffer and waits for GPU to release it
+	static void ReportStreamUpload(size_t bytes);
+	static void ReportStreamStall();
+	static long long GetStreamedBytes();
+	static long long GetStreamStalls();
 	static size_t GetFps();
+	static void ReportStageTime(Stage stage, std::chrono::high_resolution_clock::duration time);
+	//Milliseconds spent in stage since last reset
+	static double GetStageTime(Stage stage);
+	static const char* GetStageName(Stage stage);
+	static void ShowProfilerOverlay(bool show);
+	static bool IsProfilerOverlayVisible();
+	//Averages of Profiler zones, updated by ReportFrameEnd. Zones are ordered as they first appeared in a frame, so nested zones follow their parents
+	static std::vector<ZoneStats> const& GetZoneStats();
 	static void StartBenchmark();
 	static void EndBenchmark(const Path& resultPath);
 
 private:
+	struct sZone
+	{
+		ZoneStats stats;
+		//Offset from frame start when zone first appeared
+		long long order;
+		long long frameTime;
+	};
 	static PerfomanceMeter* GetInstance();
+	void UpdateZoneStats();
 
 	static std::unique_ptr<PerfomanceMeter> m_instance;
 	std::chrono::high_resolution_clock::time_point m_lastFrameTime;
 	long long m_verticesDrawn = 0;
 	long long m_polygonsDrawn = 0;
 	long long m_drawCalls = 0;
+	long long m_frameAllocations = 0;
+	long long m_streamedBytes = 0;
+	long long m_streamStalls = 0;
+	std::chrono::high_resolution_clock::duration m_stageTimes[static_cast<size_t>(Stage::Count)] = {};
 	float m_fps = 0;
 	bool m_benchmark = false;
 	std::vector<float> m_fpsHistory;
+	std::vector<sZone> m_zones;
+	std::vector<ZoneStats> m_zoneStats;
+	long long m_zoneFrameStart = 0;
+	bool m_profilerOverlay = false;
 };
 }
 }
\ No newline at end of file
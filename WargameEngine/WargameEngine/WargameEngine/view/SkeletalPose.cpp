@@ -0,0 +1,456 @@
+#include "SkeletalPose.h"
+#include "3dModel.h"
+#include "../math/simd.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+namespace wargameEngine
+{
+namespace view
+{
+namespace
+{
+void AddAllChildren(std::vector<sAnimation> const& anims, size_t current, std::vector<size_t>& set)
+{
+	set.push_back(current);
+	for (size_t child : anims[current].children)
+	{
+		AddAllChildren(anims, child, set);
+	}
+}
+
+//Matrix is row-major. Shear is lost, reflection is stored as negative x scale
+void Decompose(const float* m, float* translation, float* rotation, float* scale)
+{
+	float r[3][3];
+	for (int column = 0; column < 3; ++column)
+	{
+		translation[column] = m[column * 4 + 3];
+		scale[column] = sqrtf(m[column] * m[column] + m[4 + column] * m[4 + column] + m[8 + column] * m[8 + column]);
+		for (int row = 0; row < 3; ++row)
+		{
+			r[row][column] = scale[column] > FLT_EPSILON ? m[row * 4 + column] / scale[column] : (row == column ? 1.0f : 0.0f);
+		}
+	}
+	const float determinant = r[0][0] * (r[1][1] * r[2][2] - r[1][2] * r[2][1]) - r[0][1] * (r[1][0] * r[2][2] - r[1][2] * r[2][0]) + r[0][2] * (r[1][0] * r[2][1] - r[1][1] * r[2][0]);
+	if (determinant < 0.0f)
+	{
+		scale[0] = -scale[0];
+		r[0][0] = -r[0][0];
+		r[1][0] = -r[1][0];
+		r[2][0] = -r[2][0];
+	}
+	const float trace = r[0][0] + r[1][1] + r[2][2];
+	float& x = rotation[0];
+	float& y = rotation[1];
+	float& z = rotation[2];
+	float& w = rotation[3];
+	if (trace > 0.0f)
+	{
+		const float s = sqrtf(trace + 1.0f) * 2.0f;
+		w = 0.25f * s;
+		x = (r[2][1] - r[1][2]) / s;
+		y = (r[0][2] - r[2][0]) / s;
+		z = (r[1][0] - r[0][1]) / s;
+	}
+	else if (r[0][0] > r[1][1] && r[0][0] > r[2][2])
+	{
+		const float s = sqrtf(1.0f + r[0][0] - r[1][1] - r[2][2]) * 2.0f;
+		w = (r[2][1] - r[1][2]) / s;
+		x = 0.25f * s;
+		y = (r[0][1] + r[1][0]) / s;
+		z = (r[0][2] + r[2][0]) / s;
+	}
+	else if (r[1][1] > r[2][2])
+	{
+		const float s = sqrtf(1.0f + r[1][1] - r[0][0] - r[2][2]) * 2.0f;
+		w = (r[0][2] - r[2][0]) / s;
+		x = (r[0][1] + r[1][0]) / s;
+		y = 0.25f * s;
+		z = (r[1][2] + r[2][1]) / s;
+	}
+	else
+	{
+		const float s = sqrtf(1.0f + r[2][2] - r[0][0] - r[1][1]) * 2.0f;
+		w = (r[1][0] - r[0][1]) / s;
+		x = (r[0][2] + r[2][0]) / s;
+		y = (r[1][2] + r[2][1]) / s;
+		z = 0.25f * s;
+	}
+}
+
+void Compose(const float* translation, const float* rotation, const float* scale, float* m)
+{
+	const float x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+	const float r[3][3] = {
+		{ 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - z * w), 2.0f * (x * z + y * w) },
+		{ 2.0f * (x * y + z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - x * w) },
+		{ 2.0f * (x * z - y * w), 2.0f * (y * z + x * w), 1.0f - 2.0f * (x * x + y * y) },
+	};
+	for (int row = 0; row < 3; ++row)
+	{
+		m[row * 4] = r[row][0] * scale[0];
+		m[row * 4 + 1] = r[row][1] * scale[1];
+		m[row * 4 + 2] = r[row][2] * scale[2];
+		m[row * 4 + 3] = translation[row];
+	}
+	m[12] = m[13] = m[14] = 0.0f;
+	m[15] = 1.0f;
+}
+
+void Slerp(const float* q1, const float* q2, float t, float* result)
+{
+	float dot = q1[0] * q2[0] + q1[1] * q2[1] + q1[2] * q2[2] + q1[3] * q2[3];
+	const float sign = dot < 0.0f ? -1.0f : 1.0f;
+	dot *= sign;
+	float k1 = 1.0f - t;
+	float k2 = t;
+	//fall back to normalized lerp for close rotations
+	if (dot < 0.9995f)
+	{
+		const float angle = acosf(dot);
+		const float sinAngle = sinf(angle);
+		k1 = sinf(k1 * angle) / sinAngle;
+		k2 = sinf(k2 * angle) / sinAngle;
+	}
+	k2 *= sign;
+	float length = 0.0f;
+	for (int i = 0; i < 4; ++i)
+	{
+		result[i] = q1[i] * k1 + q2[i] * k2;
+		length += result[i] * result[i];
+	}
+	length = sqrtf(length);
+	for (int i = 0; i < 4; ++i)
+	{
+		result[i] /= length;
+	}
+}
+}
+
+void PoseEvaluator::Init(std::vector<sJoint> const& skeleton, std::vector<sAnimation> const& animations)
+{
+	m_parents.resize(skeleton.size());
+	m_bindMatrices.resize(skeleton.size() * 16);
+	m_invBindMatrices.resize(skeleton.size() * 16);
+	for (size_t i = 0; i < skeleton.size(); ++i)
+	{
+		m_parents[i] = skeleton[i].parentIndex;
+		memcpy(&m_bindMatrices[i * 16], skeleton[i].matrix, sizeof(float) * 16);
+		memcpy(&m_invBindMatrices[i * 16], skeleton[i].invBindMatrix, sizeof(float) * 16);
+	}
+	//Decompose key matrices once, animations without keys (e.g. clips) only group their children
+	std::vector<size_t> trackIndices(animations.size(), SIZE_MAX);
+	m_tracks.clear();
+	for (size_t i = 0; i < animations.size(); ++i)
+	{
+		auto& anim = animations[i];
+		const size_t keys = std::min(anim.keyframes.size(), anim.matrices.size() / 16);
+		if (keys == 0 || anim.boneIndex >= skeleton.size())
+		{
+			continue;
+		}
+		sTrack track;
+		track.joint = anim.boneIndex;
+		track.keyframes.assign(anim.keyframes.begin(), anim.keyframes.begin() + keys);
+		track.transforms.resize(keys);
+		for (size_t k = 0; k < keys; ++k)
+		{
+			auto& transform = track.transforms[k];
+			Decompose(&anim.matrices[k * 16], transform.translation, transform.rotation, transform.scale);
+		}
+		trackIndices[i] = m_tracks.size();
+		m_tracks.push_back(std::move(track));
+	}
+	m_clips.clear();
+	m_clipIndices.clear();
+	std::vector<size_t> children;
+	for (size_t i = 0; i < animations.size(); ++i)
+	{
+		children.clear();
+		AddAllChildren(animations, i, children);
+		sClip clip;
+		clip.duration = animations[i].duration;
+		for (size_t child : children)
+		{
+			if (trackIndices[child] != SIZE_MAX)
+			{
+				clip.tracks.push_back(trackIndices[child]);
+			}
+		}
+		m_clips.push_back(std::move(clip));
+		m_clipIndices.emplace(animations[i].id, static_cast<int>(i));
+	}
+}
+
+int PoseEvaluator::FindAnimation(std::string const& id) const
+{
+	if (id.empty())
+	{
+		return NO_ANIMATION;
+	}
+	auto it = m_clipIndices.find(id);
+	return it == m_clipIndices.end() ? NO_ANIMATION : it->second;
+}
+
+bool PoseEvaluator::WrapTime(int animation, model::AnimationLoop loop, float& time) const
+{
+	if (animation == NO_ANIMATION)
+	{
+		return true;
+	}
+	const float duration = m_clips[animation].duration;
+	if (time > duration)
+	{
+		if (loop == model::AnimationLoop::Looping)
+		{
+			time = duration > 0.0f ? fmod(time, duration) : 0.0f;
+		}
+		else if (loop == model::AnimationLoop::HoldEnd)
+		{
+			time = duration;
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t PoseEvaluator::GetPaletteSize() const
+{
+	return m_bindMatrices.size();
+}
+
+void PoseEvaluator::SampleTrack(sTrack const& track, float time, float* matrix) const
+{
+	auto& keys = track.keyframes;
+	const size_t next = std::lower_bound(keys.begin(), keys.end(), time) - keys.begin();
+	if (next == 0 || next == keys.size())
+	{
+		auto& transform = track.transforms[next == 0 ? 0 : next - 1];
+		Compose(transform.translation, transform.rotation, transform.scale, matrix);
+		return;
+	}
+	auto& from = track.transforms[next - 1];
+	auto& to = track.transforms[next];
+	const float t = (time - keys[next - 1]) / (keys[next] - keys[next - 1]);
+	sTransform transform;
+	for (int i = 0; i < 3; ++i)
+	{
+		transform.translation[i] = from.translation[i] + (to.translation[i] - from.translation[i]) * t;
+		transform.scale[i] = from.scale[i] + (to.scale[i] - from.scale[i]) * t;
+	}
+	Slerp(from.rotation, to.rotation, t, transform.rotation);
+	Compose(transform.translation, transform.rotation, transform.scale, matrix);
+}
+
+void PoseEvaluator::Evaluate(int animation, float time, float* palette) const
+{
+	memcpy(palette, m_bindMatrices.data(), sizeof(float) * m_bindMatrices.size());
+	if (animation != NO_ANIMATION)
+	{
+		for (size_t track : m_clips[animation].tracks)
+		{
+			SampleTrack(m_tracks[track], time, &palette[m_tracks[track].joint * 16]);
+		}
+	}
+	//parents always go before their children
+	const size_t jointsCount = m_parents.size();
+	for (size_t i = 0; i < jointsCount; ++i)
+	{
+		if (m_parents[i] != -1)
+		{
+			math::MultiplyMatrices(&palette[m_parents[i] * 16], &palette[i * 16], &palette[i * 16]);
+		}
+	}
+	for (size_t i = 0; i < jointsCount; ++i)
+	{
+		math::MultiplyMatrices(&palette[i * 16], &m_invBindMatrices[i * 16], &palette[i * 16]);
+	}
+}
+
+void PoseEvaluator::GetSkinMatrices(const float* palette, float* skinMatrices) const
+{
+	float m[16];
+	for (size_t i = 0; i < m_parents.size(); ++i)
+	{
+		math::MultiplyMatrices(&palette[i * 16], &m_invBindMatrices[i * 16], m);
+		//SkinVertices needs columns of row-major matrix
+		float* result = &skinMatrices[i * 16];
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int column = 0; column < 4; ++column)
+			{
+				result[column * 4 + row] = m[row * 4 + column];
+			}
+		}
+	}
+}
+
+void SkinVertices(const float* skinMatrices, const CVector3f* vertices, const CVector3f* normals, const unsigned* weightsOffsets, const unsigned* weightsIndexes,
+	const float* weights, size_t begin, size_t end, CVector3f* resultVertices, CVector3f* resultNormals)
+{
+	//Weighted columns of joint matrices are summed first, so each vertex is transformed only once
+	for (size_t i = begin; i < end; ++i)
+	{
+		const CVector3f& vertex = vertices[i];
+#if defined(WARGAME_SIMD_SSE)
+		__m128 c0 = _mm_setzero_ps(), c1 = _mm_setzero_ps(), c2 = _mm_setzero_ps(), c3 = _mm_setzero_ps();
+		for (unsigned k = weightsOffsets[i]; k < weightsOffsets[i + 1]; ++k)
+		{
+			const float* m = &skinMatrices[weightsIndexes[k] * 16];
+			const __m128 weight = _mm_set1_ps(weights[k]);
+			c0 = _mm_add_ps(c0, _mm_mul_ps(_mm_loadu_ps(m), weight));
+			c1 = _mm_add_ps(c1, _mm_mul_ps(_mm_loadu_ps(m + 4), weight));
+			c2 = _mm_add_ps(c2, _mm_mul_ps(_mm_loadu_ps(m + 8), weight));
+			c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(m + 12), weight));
+		}
+		__m128 direction = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(vertex.x)), _mm_mul_ps(c1, _mm_set1_ps(vertex.y))), _mm_mul_ps(c2, _mm_set1_ps(vertex.z)));
+		__m128 point = _mm_add_ps(direction, c3);
+		_mm_storel_pi(reinterpret_cast<__m64*>(&resultVertices[i].x), point);
+		_mm_store_ss(&resultVertices[i].z, _mm_movehl_ps(point, point));
+		if (normals)
+		{
+			const CVector3f& normal = normals[i];
+			direction = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(normal.x)), _mm_mul_ps(c1, _mm_set1_ps(normal.y))), _mm_mul_ps(c2, _mm_set1_ps(normal.z)));
+			_mm_storel_pi(reinterpret_cast<__m64*>(&resultNormals[i].x), direction);
+			_mm_store_ss(&resultNormals[i].z, _mm_movehl_ps(direction, direction));
+		}
+#elif defined(WARGAME_SIMD_NEON)
+		float32x4_t c0 = vdupq_n_f32(0.0f), c1 = c0, c2 = c0, c3 = c0;
+		for (unsigned k = weightsOffsets[i]; k < weightsOffsets[i + 1]; ++k)
+		{
+			const float* m = &skinMatrices[weightsIndexes[k] * 16];
+			c0 = vmlaq_n_f32(c0, vld1q_f32(m), weights[k]);
+			c1 = vmlaq_n_f32(c1, vld1q_f32(m + 4), weights[k]);
+			c2 = vmlaq_n_f32(c2, vld1q_f32(m + 8), weights[k]);
+			c3 = vmlaq_n_f32(c3, vld1q_f32(m + 12), weights[k]);
+		}
+		float32x4_t point = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(c3, c0, vertex.x), c1, vertex.y), c2, vertex.z);
+		vst1_f32(&resultVertices[i].x, vget_low_f32(point));
+		resultVertices[i].z = vgetq_lane_f32(point, 2);
+		if (normals)
+		{
+			const CVector3f& normal = normals[i];
+			float32x4_t direction = vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(c0, normal.x), c1, normal.y), c2, normal.z);
+			vst1_f32(&resultNormals[i].x, vget_low_f32(direction));
+			resultNormals[i].z = vgetq_lane_f32(direction, 2);
+		}
+#else
+		float c[16] = {};
+		for (unsigned k = weightsOffsets[i]; k < weightsOffsets[i + 1]; ++k)
+		{
+			const float* m = &skinMatrices[weightsIndexes[k] * 16];
+			for (int j = 0; j < 16; ++j)
+			{
+				c[j] += m[j] * weights[k];
+			}
+		}
+		for (int j = 0; j < 3; ++j)
+		{
+			(&resultVertices[i].x)[j] = c[j] * vertex.x + c[4 + j] * vertex.y + c[8 + j] * vertex.z + c[12 + j];
+			if (normals)
+			{
+				(&resultNormals[i].x)[j] = c[j] * normals[i].x + c[4 + j] * normals[i].y + c[8 + j] * normals[i].z;
+			}
+		}
+#endif
+	}
+}
+
+PoseCache::PoseCache(float timeStep)
+	: m_timeStep(timeStep)
+{
+}
+
+const float* PoseCache::GetPose(PoseEvaluator const& evaluator, int animation, float time)
+{
+	if (animation == PoseEvaluator::NO_ANIMATION)
+	{
+		time = 0.0f;
+	}
+	else if (m_timeStep > 0.0f)
+	{
+		time = floor(time / m_timeStep + 0.5f) * m_timeStep;
+	}
+	size_t hash = std::hash<const void*>()(&evaluator);
+	hash ^= (std::hash<float>()(time) * 31 + std::hash<int>()(animation)) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	sShard& shard = m_shards[hash % SHARDS_COUNT];
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	if ((shard.count + 1) * 2 > shard.entries.size())
+	{
+		Grow(shard);
+	}
+	const size_t mask = shard.entries.size() - 1;
+	size_t index = (hash / SHARDS_COUNT) & mask;
+	for (; shard.entries[index].frame == m_frame; index = (index + 1) & mask)
+	{
+		auto& entry = shard.entries[index];
+		if (entry.hash == hash && entry.evaluator == &evaluator && entry.animation == animation && entry.time == time)
+		{
+			return entry.palette;
+		}
+	}
+	//Other threads that need this shard wait, which is still cheaper than evaluating the same pose twice
+	float* palette = shard.arena.Allocate<float>(evaluator.GetPaletteSize());
+	evaluator.Evaluate(animation, time, palette);
+	shard.entries[index] = { &evaluator, animation, time, hash, palette, m_frame };
+	++shard.count;
+	return palette;
+}
+
+void PoseCache::Grow(sShard& shard)
+{
+	std::vector<sEntry> entries(std::max<size_t>(64, shard.entries.size() * 2));
+	++shard.heapAllocations;
+	const size_t mask = entries.size() - 1;
+	for (auto& entry : shard.entries)
+	{
+		if (entry.frame == m_frame)
+		{
+			size_t index = (entry.hash / SHARDS_COUNT) & mask;
+			while (entries[index].frame == m_frame)
+			{
+				index = (index + 1) & mask;
+			}
+			entries[index] = entry;
+		}
+	}
+	shard.entries.swap(entries);
+}
+
+void PoseCache::Reset()
+{
+	if (++m_frame == 0)
+	{
+		//stamps of old entries can match the new frame after overflow
+		for (auto& shard : m_shards)
+		{
+			shard.entries.assign(shard.entries.size(), sEntry());
+		}
+		m_frame = 1;
+	}
+	for (auto& shard : m_shards)
+	{
+		shard.count = 0;
+		shard.heapAllocations = 0;
+		shard.arena.Reset();
+	}
+}
+
+size_t PoseCache::GetHeapAllocations() const
+{
+	size_t result = 0;
+	for (auto& shard : m_shards)
+	{
+		result += shard.heapAllocations + shard.arena.GetHeapAllocations();
+	}
+	return result;
+}
+}
+}
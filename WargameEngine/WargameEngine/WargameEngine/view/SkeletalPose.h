@@ -0,0 +1,108 @@
+#pragma once
+#include "../model/Animation.h"
+#include "FrameArena.h"
+#include "Vector3.h"
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wargameEngine
+{
+namespace view
+{
+struct sJoint;
+struct sAnimation;
+
+//Evaluates skinning palettes (row-major joint matrices multiplied by inverse bind matrices). Animation tracks are stored as translation, rotation and scale keys
+class PoseEvaluator
+{
+public:
+	static const int NO_ANIMATION = -1;
+
+	void Init(std::vector<sJoint> const& skeleton, std::vector<sAnimation> const& animations);
+	//Returns NO_ANIMATION if there is no animation with such id
+	int FindAnimation(std::string const& id) const;
+	//Applies loop mode to time. Returns false if animation is over and bind pose must be used
+	bool WrapTime(int animation, model::AnimationLoop loop, float& time) const;
+	//Number of floats in palette
+	size_t GetPaletteSize() const;
+	void Evaluate(int animation, float time, float* palette) const;
+	//Converts palette to matrices for SkinVertices. Inverse bind matrices are applied to vertices before palette, as CPU skinning always did
+	void GetSkinMatrices(const float* palette, float* skinMatrices) const;
+
+private:
+	struct sTransform
+	{
+		float translation[3];
+		float rotation[4];
+		float scale[3];
+	};
+	struct sTrack
+	{
+		size_t joint;
+		std::vector<float> keyframes;
+		std::vector<sTransform> transforms;
+	};
+	struct sClip
+	{
+		float duration;
+		std::vector<size_t> tracks;
+	};
+
+	void SampleTrack(sTrack const& track, float time, float* matrix) const;
+
+	std::vector<int> m_parents;
+	std::vector<float> m_bindMatrices;
+	std::vector<float> m_invBindMatrices;
+	std::vector<sTrack> m_tracks;
+	std::vector<sClip> m_clips;
+	std::unordered_map<std::string, int> m_clipIndices;
+};
+
+//Skins vertices [begin, end) with matrices from PoseEvaluator::GetSkinMatrices. Weights of vertex i are [weightsOffsets[i], weightsOffsets[i + 1]).
+//Normals are optional and are not affected by translation
+void SkinVertices(const float* skinMatrices, const CVector3f* vertices, const CVector3f* normals, const unsigned* weightsOffsets, const unsigned* weightsIndexes,
+	const float* weights, size_t begin, size_t end, CVector3f* resultVertices, CVector3f* resultNormals);
+
+//Palettes of the current frame shared by all objects that play the same animation at the same moment. Poses are keyed on exact time unless
+//timeStep is positive, then time is quantized to it so objects with nearly equal animation time get the same pose.
+//Can be used from several threads at once, Reset must be called every frame
+class PoseCache
+{
+public:
+	PoseCache(float timeStep = 0.0f);
+
+	const float* GetPose(PoseEvaluator const& evaluator, int animation, float time);
+	void Reset();
+	//Returns number of heap allocations made since last Reset
+	size_t GetHeapAllocations() const;
+
+private:
+	struct sEntry
+	{
+		const PoseEvaluator* evaluator;
+		int animation;
+		float time;
+		size_t hash;
+		const float* palette;
+		unsigned frame = 0;
+	};
+	struct sShard
+	{
+		std::mutex mutex;
+		std::vector<sEntry> entries;
+		size_t count = 0;
+		size_t heapAllocations = 0;
+		FrameArena arena;
+	};
+	static const size_t SHARDS_COUNT = 16;
+
+	void Grow(sShard& shard);
+
+	sShard m_shards[SHARDS_COUNT];
+	float m_timeStep;
+	unsigned m_frame = 1;
+};
+}
+}
@@ -0,0 +1,201 @@
+#include "Teamcolor.h"
+#include "../MemoryStream.h"
+#include "../OSSpecific.h"
+#include "../Utils.h"
+#include "../math/simd.h"
+#include "Image.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace wargameEngine
+{
+namespace view
+{
+namespace
+{
+const char CACHE_MAGIC[4] = { 'W', 'T', 'C', 'C' };
+const uint32_t CACHE_VERSION = 1;
+
+struct sCacheHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t key;
+	uint32_t width;
+	uint32_t height;
+	uint32_t bpp;
+	int32_t flags;
+};
+
+//dst = round((dst * (255 - weight) + color * weight) / 255). Gives the same result on every platform, so cached textures do not depend on CPU
+void BlendBytes(unsigned char* dst, const unsigned char* color, const unsigned char* weight, size_t count)
+{
+	size_t i = 0;
+#if defined(WARGAME_SIMD_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi16(255);
+	const __m128i half = _mm_set1_epi16(128);
+	auto blend = [&](__m128i d, __m128i c, __m128i w) {
+		__m128i t = _mm_add_epi16(_mm_mullo_epi16(d, _mm_sub_epi16(full, w)), _mm_mullo_epi16(c, w));
+		t = _mm_add_epi16(t, half);
+		return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+	};
+	for (; i + 16 <= count; i += 16)
+	{
+		const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+		const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(color + i));
+		const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weight + i));
+		const __m128i low = blend(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(w, zero));
+		const __m128i high = blend(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(w, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(low, high));
+	}
+#elif defined(WARGAME_SIMD_NEON)
+	for (; i + 16 <= count; i += 16)
+	{
+		const uint8x16_t d = vld1q_u8(dst + i);
+		const uint8x16_t c = vld1q_u8(color + i);
+		const uint8x16_t w = vld1q_u8(weight + i);
+		const uint8x16_t inverse = vmvnq_u8(w);
+		uint16x8_t low = vmull_u8(vget_low_u8(d), vget_low_u8(inverse));
+		low = vmlal_u8(low, vget_low_u8(c), vget_low_u8(w));
+		uint16x8_t high = vmull_u8(vget_high_u8(d), vget_high_u8(inverse));
+		high = vmlal_u8(high, vget_high_u8(c), vget_high_u8(w));
+		vst1q_u8(dst + i, vcombine_u8(vraddhn_u16(low, vrshrq_n_u16(low, 8)), vraddhn_u16(high, vrshrq_n_u16(high, 8))));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		const unsigned t = dst[i] * (255u - weight[i]) + color[i] * weight[i] + 128u;
+		dst[i] = static_cast<unsigned char>((t + (t >> 8)) >> 8);
+	}
+}
+
+Path GetCachePath(const Path& directory, uint64_t key)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.tex", static_cast<unsigned long long>(key));
+	return directory + make_path(L"/") + make_path(std::string(name));
+}
+}
+
+bool ApplyTeamcolor(Image& image, std::vector<char> const& maskData, const unsigned char* color)
+{
+	const size_t bytesPerPixel = image.GetBPP() / 8;
+	if (image.IsCompressed() || (bytesPerPixel != 3 && bytesPerPixel != 4) || maskData.size() < 54 || maskData[0] != 'B' || maskData[1] != 'M')
+	{
+		return false;
+	}
+	ReadMemoryStream stream(maskData.data(), maskData.size());
+	stream.Seek(0x0A);
+	const size_t dataOffset = stream.ReadUnsigned();
+	stream.Seek(0x12);
+	const int maskWidth = stream.ReadInt();
+	int maskHeight = stream.ReadInt();
+	stream.ReadShort();//planes
+	const short maskBpp = stream.ReadShort();
+	const bool topDown = maskHeight < 0;
+	maskHeight = abs(maskHeight);
+	//Rows are aligned to 4 bytes
+	const size_t maskStride = (static_cast<size_t>(maskWidth) + 3) & ~static_cast<size_t>(3);
+	if (maskBpp != 8 || maskWidth <= 0 || maskHeight == 0 || dataOffset > maskData.size() || maskStride * maskHeight > maskData.size() - dataOffset)
+	{
+		return false;
+	}
+	image.StoreData();
+	const size_t width = image.GetWidth();
+	const size_t height = image.GetHeight();
+	const size_t rowSize = width * bytesPerPixel;
+	const bool bgr = (image.GetFlags() & TEXTURE_BGRA) != 0;
+	std::vector<unsigned char> colorRow(rowSize);
+	std::vector<unsigned char> weightRow(rowSize, 0);
+	std::vector<size_t> maskColumns(width);
+	for (size_t x = 0; x < width; ++x)
+	{
+		colorRow[x * bytesPerPixel] = color[bgr ? 2 : 0];
+		colorRow[x * bytesPerPixel + 1] = color[1];
+		colorRow[x * bytesPerPixel + 2] = color[bgr ? 0 : 2];
+		maskColumns[x] = x * maskWidth / width;
+	}
+	const unsigned char* maskPixels = reinterpret_cast<const unsigned char*>(maskData.data() + dataOffset);
+	unsigned char* data = image.GetData();
+	for (size_t y = 0; y < height; ++y)
+	{
+		size_t maskRow = y * maskHeight / height;
+		if (topDown)
+		{
+			maskRow = maskHeight - 1 - maskRow;
+		}
+		const unsigned char* maskLine = maskPixels + maskRow * maskStride;
+		unsigned char any = 0;
+		for (size_t x = 0; x < width; ++x)
+		{
+			const unsigned char weight = maskLine[maskColumns[x]];
+			unsigned char* pixelWeight = &weightRow[x * bytesPerPixel];
+			pixelWeight[0] = pixelWeight[1] = pixelWeight[2] = weight;//alpha weight stays 0
+			any |= weight;
+		}
+		//Masks are mostly black, such rows are not changed
+		if (any)
+		{
+			BlendBytes(data + y * rowSize, colorRow.data(), weightRow.data(), rowSize);
+		}
+	}
+	return true;
+}
+
+bool LoadTeamcolorCache(const Path& directory, uint64_t key, Image& image)
+{
+	std::ifstream file(GetCachePath(directory, key), std::ios::binary | std::ios::in);
+	if (!file)
+	{
+		return false;
+	}
+	sCacheHeader header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file || memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION || header.key != key || (header.bpp != 24 && header.bpp != 32))
+	{
+		return false;
+	}
+	std::vector<unsigned char> data(static_cast<size_t>(header.width) * header.height * header.bpp / 8);
+	file.read(reinterpret_cast<char*>(data.data()), data.size());
+	if (!file)
+	{
+		return false;
+	}
+	image = Image(std::move(data), header.width, header.height, static_cast<unsigned short>(header.bpp), header.flags);
+	return true;
+}
+
+void StoreTeamcolorCache(const Path& directory, uint64_t key, Image const& image)
+{
+	if (image.IsCompressed() || !MakeDir(directory))
+	{
+		return;
+	}
+	sCacheHeader header;
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	header.key = key;
+	header.width = static_cast<uint32_t>(image.GetWidth());
+	header.height = static_cast<uint32_t>(image.GetHeight());
+	header.bpp = image.GetBPP();
+	header.flags = image.GetFlags();
+	//Written under temporary name, so other instance or crash never leaves half written texture
+	const Path path = GetCachePath(directory, key);
+	const Path tempPath = path + make_path(L".tmp");
+	bool written = false;
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::out);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(image.GetData()), image.GetWidth() * image.GetHeight() * image.GetBPP() / 8);
+		written = !!file;
+	}
+	if (!written || !AtomicReplaceFile(tempPath, path))
+	{
+		RemoveFile(tempPath);
+	}
+}
+}
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "../Typedefs.h"
+#include <cstdint>
+#include <vector>
+
+namespace wargameEngine
+{
+namespace view
+{
+class Image;
+
+//Blends RGB color into uncompressed 24 or 32 bit image where 8 bit greyscale BMP mask is white. Mask is scaled to image size.
+//Returns false if image or mask is not supported
+bool ApplyTeamcolor(Image& image, std::vector<char> const& maskData, const unsigned char* color);
+
+//Composed teamcolor textures are kept on disk between launches, so warm starts skip decoding and compositing.
+//Key has to cover everything result depends on: source texture, masks and colors. Functions can be called from any thread
+bool LoadTeamcolorCache(const Path& directory, uint64_t key, Image& image);
+void StoreTeamcolorCache(const Path& directory, uint64_t key, Image const& image);
+}
+}
@@ -1,9 +1,9 @@
 #include "TextureManager.h"
 #include "../AsyncFileProvider.h"
 #include "../LogWriter.h"
-#include "../MemoryStream.h"
 #include "../Utils.h"
 #include "IImageReader.h"
+#include "Teamcolor.h"
 #include <algorithm>
 #include <iterator>
 
@@ -28,23 +28,92 @@ void TextureManager::UseTexture(Image const& img, ICachedTexture& texture, int a
 	}
 	m_helper.SetTextureAnisotropy(m_anisotropyLevel);
 }
-void ApplyTeamcolor(Image& image, const Path& maskFile, unsigned char* color, const Path& fileName);
+namespace
+{
+//Changes when compositing does, so textures cached by older versions are not used
+const uint64_t TEAMCOLOR_CACHE_SEED = 1;
 
-std::unique_ptr<ICachedTexture> TextureManager::LoadTexture(const Path& path, std::vector<model::TeamColor> const& teamcolor, bool now, int flags)
+Path GetMaskPath(const Path& texturePath, std::wstring const& suffix)
 {
-	std::unique_ptr<ICachedTexture> tex = m_helper.CreateEmptyTexture();
+	return texturePath.substr(0, texturePath.find_last_of('.')) + make_path(suffix) + make_path(L".bmp");
+}
+
+uint64_t GetTeamcolorCacheKey(const void* data, size_t size, std::vector<model::TeamColor> const& teamcolor, std::vector<std::vector<char>> const& masks, sReaderParameters const& params)
+{
+	const unsigned char paramBits = (params.flipBmp ? 1 : 0) | (params.force32bit ? 2 : 0) | (params.convertBgra ? 4 : 0);
+	uint64_t key = HashData(&paramBits, sizeof(paramBits), TEAMCOLOR_CACHE_SEED);
+	key = HashData(data, size, key);
+	for (size_t i = 0; i < teamcolor.size(); ++i)
+	{
+		key = HashData(masks[i].data(), masks[i].size(), key);
+		key = HashData(teamcolor[i].color, sizeof(teamcolor[i].color), key);
+	}
+	return key;
+}
+
+//Approximate video memory taken by uploaded image
+size_t GetTextureSize(Image const& img)
+{
+	size_t size = 0;
+	if (img.IsCompressed())
+	{
+		size = img.GetImageSize();
+		for (auto& mipmap : img.GetMipmaps())
+		{
+			size += mipmap.size;
+		}
+		return size;
+	}
+	const size_t bytesPerPixel = img.GetBPP() / 8;
+	size = img.GetWidth() * img.GetHeight() * bytesPerPixel;
+	if (img.GetMipmaps().empty())
+	{
+		return size + size / 3;//mipmaps are generated by driver
+	}
+	for (auto& mipmap : img.GetMipmaps())
+	{
+		size += mipmap.width * mipmap.height * bytesPerPixel;
+	}
+	return size;
+}
+}
+
+void TextureManager::LoadTexture(sTexture& entry, const Path& path, std::vector<model::TeamColor> const& teamcolor, bool now)
+{
+	entry.texture = m_helper.CreateEmptyTexture();
 	if (path.empty())
 	{
-		return tex;
+		return;
 	}
-	ICachedTexture& texRef = *tex;
+	//Entry is destroyed if Reset is called while texture is loading, so callback checks reset counter before using it
+	sTexture* entryPtr = &entry;
+	const size_t resetCount = m_resetCount;
+	const int flags = entry.flags;
 	sReaderParameters params;
 	params.flipBmp = m_helper.ForceFlipBMP();
 	params.force32bit = m_helper.Force32Bits();
 	params.convertBgra = m_helper.ConvertBgra();
 	std::shared_ptr<Image> img = std::make_shared<Image>();
+	const Path cacheDir = teamcolor.empty() || m_teamcolorCacheDir.empty() ? Path() : m_asyncFileProvider.GetAbsolutePath(m_teamcolorCacheDir);
 	m_asyncFileProvider.GetTextureAsync(path, [=](void* data, size_t size) {
 		unsigned char* charData = reinterpret_cast<unsigned char*>(data);
+		std::vector<Path> maskPaths;
+		std::vector<std::vector<char>> masks;
+		uint64_t cacheKey = 0;
+		if (!teamcolor.empty())
+		{
+			const Path absolutePath = m_asyncFileProvider.GetTextureAbsolutePath(path);
+			for (auto& color : teamcolor)
+			{
+				maskPaths.push_back(GetMaskPath(absolutePath, color.suffix));
+				masks.push_back(ReadFile(maskPaths.back()));
+			}
+			cacheKey = GetTeamcolorCacheKey(data, size, teamcolor, masks, params);
+			if (!cacheDir.empty() && LoadTeamcolorCache(cacheDir, cacheKey, *img))
+			{
+				return;
+			}
+		}
 		for (auto& reader : m_imageReaders)
 		{
 			if (reader->ImageIsSupported(charData, size, path))
@@ -52,11 +121,22 @@ std::unique_ptr<ICachedTexture> TextureManager::LoadTexture(const Path& path, st
 				try
 				{
 					*img = reader->ReadImage(charData, size, path, params);
-					if (!img->IsCompressed())
+					if (!teamcolor.empty() && !img->IsCompressed())
 					{
-						for (auto& color : teamcolor)
+						for (size_t i = 0; i < teamcolor.size(); ++i)
 						{
-							ApplyTeamcolor(*img, make_path(color.suffix), const_cast<unsigned char*>(color.color), m_asyncFileProvider.GetTextureAbsolutePath(path));
+							if (masks[i].empty())
+							{
+								LogWriter::WriteLine(L"Texture manager: Cannot open mask file " + to_wstring(maskPaths[i]));
+							}
+							else if (!ApplyTeamcolor(*img, masks[i], teamcolor[i].color))
+							{
+								LogWriter::WriteLine(L"Texture manager: Mask file is not 8 bit BMP or texture is not 24/32 bit " + to_wstring(maskPaths[i]));
+							}
+						}
+						if (!cacheDir.empty())
+						{
+							StoreTeamcolorCache(cacheDir, cacheKey, *img);
 						}
 					}
 					return;
@@ -66,12 +146,32 @@ std::unique_ptr<ICachedTexture> TextureManager::LoadTexture(const Path& path, st
 					LogWriter::WriteLine(e.what());
 				}
 			}
-		} }, [=, &texRef]() { UseTexture(*img, texRef, flags); }, [](std::exception const& e) { LogWriter::WriteLine(e.what()); }, now);
-	return tex;
+		} }, [=]() {
+			if (resetCount != m_resetCount)
+			{
+				return;
+			}
+			UseTexture(*img, *entryPtr->texture, flags);
+			entryPtr->size = GetTextureSize(*img);
+			m_residentBytes += entryPtr->size;
+			m_residentTextures.emplace(entryPtr->texture.get(), entryPtr);
+		}, [](std::exception const& e) { LogWriter::WriteLine(e.what()); }, now);
+}
+
+ICachedTexture* TextureManager::UseEntry(sTexture& entry, const Path& path, const std::vector<model::TeamColor>& teamcolor)
+{
+	if (!entry.texture)
+	{
+		LoadTexture(entry, path, teamcolor);
+		++m_frameReloads;
+	}
+	entry.lastUsedFrame = m_frame;
+	return entry.texture.get();
 }
 
 TextureManager::TextureManager(ITextureHelper& helper, AsyncFileProvider& asyncFileProvider)
-	: m_helper(helper)
+	: m_teamcolorCacheDir(make_path(L"cache"))
+	, m_helper(helper)
 	, m_asyncFileProvider(asyncFileProvider)
 {
 }
@@ -129,23 +229,43 @@ void TextureManager::SetAnisotropyLevel(float level)
 {
 	for (auto i = m_textures.begin(); i != m_textures.end(); ++i)
 	{
-		m_helper.SetTexture(*i->second);
-		m_helper.SetTextureAnisotropy(level);
+		if (i->second.texture)
+		{
+			m_helper.SetTexture(*i->second.texture);
+			m_helper.SetTextureAnisotropy(level);
+		}
 	}
 	m_anisotropyLevel = level;
 }
 
 void TextureManager::LoadTextureNow(const Path& path, int flags)
 {
-	if (m_textures.find(path) == m_textures.end())
+	auto result = m_textures.emplace(path, sTexture());
+	sTexture& entry = result.first->second;
+	if (result.second)
+	{
+		entry.flags = flags;
+	}
+	else if (entry.texture)
 	{
-		m_textures.emplace(std::make_pair(path,LoadTexture(path, std::vector<model::TeamColor>(), true, flags)));
+		return;
 	}
+	else
+	{
+		++m_frameReloads;
+	}
+	entry.lastUsedFrame = m_frame;
+	LoadTexture(entry, path, std::vector<model::TeamColor>(), true);
 }
 
 void TextureManager::Reset()
 {
 	m_textures.clear();
+	m_teamcolorTextures.clear();
+	m_residentTextures.clear();
+	m_residentBytes = 0;
+	++m_generation;
+	++m_resetCount;
 }
 
 void TextureManager::RegisterImageReader(std::unique_ptr<IImageReader>&& reader)
@@ -157,57 +277,111 @@ ICachedTexture* TextureManager::GetTexturePtr(const Path& texture, const std::ve
 {
 	if (teamcolor)
 	{
-		auto pair = std::pair<Path, std::vector<model::TeamColor>>(texture, *teamcolor);
-		auto it = m_teamcolorTextures.find(pair);
+		auto it = m_teamcolorTextures.find(TeamcolorKeyLess::KeyRef(&texture, teamcolor));
 		if (it == m_teamcolorTextures.end())
 		{
-			it = m_teamcolorTextures.emplace(std::make_pair(pair, LoadTexture(texture, pair.second, false, flags))).first;
+			it = m_teamcolorTextures.emplace(TeamcolorKey(texture, *teamcolor), sTexture()).first;
+			it->second.flags = flags;
+			LoadTexture(it->second, texture, *teamcolor);
 		}
-		return it->second.get();
+		return UseEntry(it->second, texture, *teamcolor);
 	}
 	auto it = m_textures.find(texture);
 	if (it == m_textures.end())
 	{
-		it = m_textures.emplace(texture, LoadTexture(texture, std::vector<model::TeamColor>(), false, flags)).first;
+		it = m_textures.emplace(texture, sTexture()).first;
+		it->second.flags = flags;
+		LoadTexture(it->second, texture, std::vector<model::TeamColor>());
 	}
-	return it->second.get();
+	return UseEntry(it->second, texture, std::vector<model::TeamColor>());
 }
 
-void ApplyTeamcolor(Image& image, const Path& maskFile, unsigned char* color, const Path& fileName)
+ICachedTexture* TextureManager::FindTexturePtr(const Path& texture, const std::vector<model::TeamColor>* teamcolor) const
 {
-	Path path = fileName.substr(0, fileName.find_last_of('.')) + maskFile + make_path(L".bmp");
-	std::vector<char> maskData = ReadFile(path);
-	if (maskData.empty())
+	if (teamcolor)
 	{
-		LogWriter::WriteLine(L"Texture manager: Cannot open mask file " + to_wstring(path));
-		return;
+		auto it = m_teamcolorTextures.find(TeamcolorKeyLess::KeyRef(&texture, teamcolor));
+		return it == m_teamcolorTextures.end() ? nullptr : it->second.texture.get();
 	}
-	ReadMemoryStream stream(maskData.data());
-	stream.Seek(0x12);
-	int maskHeight = stream.ReadInt();
-	int maskWidth = stream.ReadInt();
-	short maskbpp = stream.ReadShort();
-	if (image.GetFlags() & TEXTURE_HAS_ALPHA)
+	auto it = m_textures.find(texture);
+	return it == m_textures.end() ? nullptr : it->second.texture.get();
+}
+
+void TextureManager::SetTeamcolorCacheDirectory(const Path& directory)
+{
+	m_teamcolorCacheDir = directory;
+}
+
+void TextureManager::SetMemoryBudget(size_t bytes)
+{
+	m_budget = bytes;
+}
+
+void TextureManager::MarkUsed(ICachedTexture const& texture)
+{
+	auto it = m_residentTextures.find(&texture);
+	if (it != m_residentTextures.end())
 	{
-		std::swap(color[0], color[2]);
+		it->second->lastUsedFrame = m_frame;
 	}
-	if (maskbpp != 8)
+}
+
+void TextureManager::EndFrame()
+{
+	if (m_budget && m_residentBytes > m_budget)
 	{
-		LogWriter::WriteLine(L"Texture manager: Mask file is not greyscale " + to_wstring(path));
-		return;
+		Evict();
 	}
-	for (size_t x = 0; x < image.GetWidth(); ++x)
+	m_stats.residentBytes = m_residentBytes;
+	m_stats.residentTextures = m_residentTextures.size();
+	m_stats.budget = m_budget;
+	m_stats.evictions = m_frameEvictions;
+	m_stats.reloads = m_frameReloads;
+	m_frameEvictions = 0;
+	m_frameReloads = 0;
+	++m_frame;
+}
+
+void TextureManager::Evict()
+{
+	//Textures used in this frame are kept even if they do not fit, otherwise they would be reloaded every frame
+	m_evictionCandidates.clear();
+	for (auto& resident : m_residentTextures)
 	{
-		for (size_t y = 0; y < image.GetHeight(); ++y)
+		if (resident.second->lastUsedFrame != m_frame)
 		{
-			size_t pos = (x * image.GetHeight() + y) * image.GetBPP() / 8;
-			size_t maskPos = 54 + x * maskWidth / image.GetHeight() * maskHeight + y * maskHeight / image.GetHeight();
-			for (size_t i = 0; i < 3; ++i)
-			{
-				image.GetData()[pos + i] = static_cast<unsigned char>(image.GetData()[pos + i] * (1.0 - maskData[maskPos] / 255.0) + color[i] * (maskData[maskPos] / 255.0));
-			}
+			m_evictionCandidates.push_back(resident.second);
+		}
+	}
+	std::sort(m_evictionCandidates.begin(), m_evictionCandidates.end(), [](const sTexture* first, const sTexture* second) {
+		return first->lastUsedFrame < second->lastUsedFrame;
+	});
+	for (sTexture* entry : m_evictionCandidates)
+	{
+		if (m_residentBytes <= m_budget)
+		{
+			break;
 		}
+		m_residentTextures.erase(entry->texture.get());
+		m_residentBytes -= entry->size;
+		entry->size = 0;
+		entry->texture.reset();
+		++m_frameEvictions;
 	}
+	if (m_frameEvictions > 0)
+	{
+		++m_generation;
+	}
+}
+
+sTextureStats const& TextureManager::GetStats() const
+{
+	return m_stats;
+}
+
+unsigned TextureManager::GetGeneration() const
+{
+	return m_generation;
 }
 }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "../Typedefs.h"
 #include <unordered_map>
 #include <map>
+#include <tuple>
 #include <vector>
 #include "ITextureHelper.h"
 
@@ -14,6 +15,16 @@ namespace view
 class IImageReader;
 class Image;
 
+struct sTextureStats
+{
+	size_t residentBytes = 0;
+	size_t residentTextures = 0;
+	size_t budget = 0;
+	//Counted during the last finished frame
+	size_t evictions = 0;
+	size_t reloads = 0;
+};
+
 class TextureManager
 {
 public:
@@ -25,14 +36,61 @@ public:
 	void Reset();
 	void RegisterImageReader(std::unique_ptr<IImageReader>&& reader);
 	ICachedTexture* GetTexturePtr(const Path& texture, const std::vector<model::TeamColor>* teamcolor = nullptr, int flags = 0);
+	//Returns nullptr if texture is not created yet. Does not modify manager, so can be called from several threads while main thread does not create textures
+	ICachedTexture* FindTexturePtr(const Path& texture, const std::vector<model::TeamColor>* teamcolor = nullptr) const;
+	//Composed teamcolor textures are cached there. Relative path is relative to module folder, empty path disables cache
+	void SetTeamcolorCacheDirectory(const Path& directory);
+	//Least recently used textures are evicted at the end of frame when resident textures take more memory. 0 means no limit
+	void SetMemoryBudget(size_t bytes);
+	//Marks texture as used in current frame. Textures returned by GetTexturePtr are marked already
+	void MarkUsed(ICachedTexture const& texture);
+	//Evicts textures over budget and starts the next frame
+	void EndFrame();
+	sTextureStats const& GetStats() const;
+	//Changes every time textures are evicted. Pointers to textures cached outside of manager are only valid while generation is the same
+	unsigned GetGeneration() const;
 protected:
 	TextureManager(TextureManager const& other) = delete;
 private:
-	std::unique_ptr<ICachedTexture> LoadTexture(const Path& path, const std::vector<model::TeamColor>& teamcolor, bool now = false, int flags = 0);
+	struct sTexture
+	{
+		//Evicted textures keep their entry with empty texture, so they are reloaded with the same flags
+		std::unique_ptr<ICachedTexture> texture;
+		size_t size = 0;
+		unsigned lastUsedFrame = 0;
+		int flags = 0;
+	};
+	void LoadTexture(sTexture& entry, const Path& path, const std::vector<model::TeamColor>& teamcolor, bool now = false);
+	ICachedTexture* UseEntry(sTexture& entry, const Path& path, const std::vector<model::TeamColor>& teamcolor);
 	void UseTexture(Image const& img, ICachedTexture& texture, int additionalFlags);
+	void Evict();
+
+	std::unordered_map<Path, sTexture> m_textures;
+	typedef std::pair<Path, std::vector<model::TeamColor>> TeamcolorKey;
+	//Allows to search teamcolor textures without copying path and colors
+	struct TeamcolorKeyLess
+	{
+		typedef void is_transparent;
+		typedef std::pair<const Path*, const std::vector<model::TeamColor>*> KeyRef;
 
-	std::unordered_map<Path, std::unique_ptr<ICachedTexture>> m_textures;
-	std::map<std::pair<Path, std::vector<model::TeamColor>>, std::unique_ptr<ICachedTexture>> m_teamcolorTextures;
+		static std::tuple<const Path&, const std::vector<model::TeamColor>&> Tie(TeamcolorKey const& key) { return std::tie(key.first, key.second); }
+		static std::tuple<const Path&, const std::vector<model::TeamColor>&> Tie(KeyRef const& key) { return std::tie(*key.first, *key.second); }
+		template<class First, class Second>
+		bool operator()(First const& first, Second const& second) const { return Tie(first) < Tie(second); }
+	};
+	std::map<TeamcolorKey, sTexture, TeamcolorKeyLess> m_teamcolorTextures;
+	//Uploaded textures. Only they can be evicted, pending ones are still referenced by loading callbacks
+	std::unordered_map<const ICachedTexture*, sTexture*> m_residentTextures;
+	std::vector<sTexture*> m_evictionCandidates;
+	size_t m_budget = 0;
+	size_t m_residentBytes = 0;
+	size_t m_frameEvictions = 0;
+	size_t m_frameReloads = 0;
+	sTextureStats m_stats;
+	unsigned m_frame = 1;
+	unsigned m_generation = 1;
+	size_t m_resetCount = 0;
+	Path m_teamcolorCacheDir;
 	float m_anisotropyLevel = 1.0f;
 	ITextureHelper & m_helper;
 	AsyncFileProvider & m_asyncFileProvider;
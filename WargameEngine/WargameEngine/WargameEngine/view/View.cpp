@@ -1,10 +1,13 @@
 #include "View.h"
+#include "3dModel.h"
 #include "IWindow.h"
 #include "../controller/Controller.h"
+#include "../model/IBoundingBoxManager.h"
 #include "../model/ObjectGroup.h"
 #include "../LogWriter.h"
 #include "../ThreadPool.h"
 #include "../Module.h"
+#include "../Profiler.h"
 #include "../UI/UIElement.h"
 #include "../UI/UITheme.h"
 #include "IImageReader.h"
@@ -14,6 +17,8 @@
 #include "ISoundPlayer.h"
 #include "Material.h"
 #include "PerfomanceMeter.h"
+#include <numeric>
+#include <string.h>
 
 using namespace std;
 using namespace placeholders;
@@ -24,6 +29,10 @@ namespace view
 {
 
 static const string g_controllerTag = "controller";
+//Splitting smaller scenes between threads costs more than it saves
+static const size_t MIN_INSTANCES_PER_CHUNK = 16;
+static const size_t SKINNED_VERTICES_PER_CHUNK = 4096;
+static const string g_instanceMatrixAttributes[] = { "instanceModelMatrix0", "instanceModelMatrix1", "instanceModelMatrix2", "instanceModelMatrix3" };
 
 View::View(IWindow& window, ISoundPlayer& soundPlayer, ITextWriter& textWriter, ThreadPool& threadPool, AsyncFileProvider& asyncFileProvider,
 	vector<unique_ptr<IImageReader>>& imageReaders, vector<unique_ptr<IModelReader>>& modelReaders, model::IBoundingBoxManager & boundingManager)
@@ -38,14 +47,18 @@ View::View(IWindow& window, ISoundPlayer& soundPlayer, ITextWriter& textWriter,
 	, m_ui(m_textWriter)
 	, m_modelManager(m_boundingManager, asyncFileProvider)
 	, m_textureManager(m_viewHelper, asyncFileProvider)
+	, m_meshCollections(threadPool.GetWorkersCount() + 1)
 {
 	m_viewHelper.SetTextureManager(m_textureManager);
+	m_jointsUniform = m_viewHelper.GetShaderManager().GetUniformHandle("joints");
+	m_viewPosUniform = m_viewHelper.GetShaderManager().GetUniformHandle("viewPos");
 	for (auto& reader : imageReaders)
 	{
 		m_textureManager.RegisterImageReader(std::move(reader));
 	}
 	for (auto& reader : modelReaders)
 	{
+		reader->SetThreadPool(threadPool);
 		m_modelManager.RegisterModelReader(std::move(reader));
 	}
 	setlocale(LC_ALL, "");
@@ -87,6 +100,7 @@ void View::Init(model::Model& model, controller::Controller& controller)
 	m_controller = &controller;
 	
 	ClearResources();
+	InitCulling();
 	InitLandscape();
 	InitInput();
 	m_viewports.front()->GetCamera().AttachToKeyboardMouse();
@@ -287,17 +301,36 @@ void View::DrawBoundingBox()
 
 void View::Update()
 {
+	Profiler::Zone zone("View::Update");
 	PerfomanceMeter::Reset();
-	m_threadPool.Update();
-	m_controller->Update();
-	auto& defaultCamera = m_viewports.front()->GetCamera();
-	m_soundPlayer.SetListenerPosition(defaultCamera.GetPosition(), defaultCamera.GetDirection());
-	m_soundPlayer.Update();
-	CollectMeshes();
-	SortMeshes();
+	{
+		PerfomanceMeter::StageTimer timer(PerfomanceMeter::Stage::Controller);
+		m_threadPool.Update();
+		m_controller->Update();
+	}
+	{
+		Profiler::Zone soundZone("Sound");
+		auto& defaultCamera = m_viewports.front()->GetCamera();
+		m_soundPlayer.SetListenerPosition(defaultCamera.GetPosition(), defaultCamera.GetDirection());
+		m_soundPlayer.Update();
+	}
+	{
+		PerfomanceMeter::StageTimer timer(PerfomanceMeter::Stage::Collect);
+		CollectMeshes();
+	}
+	{
+		PerfomanceMeter::StageTimer timer(PerfomanceMeter::Stage::Sort);
+		SortMeshes();
+	}
+	{
+		PerfomanceMeter::StageTimer timer(PerfomanceMeter::Stage::Instances);
+		PrepareInstances();
+	}
+	PerfomanceMeter::StageTimer renderTimer(PerfomanceMeter::Stage::Render);
 	for (auto it = m_viewports.rbegin(); it != m_viewports.rend(); ++it)
 	{
 		auto& viewport = **it;
+		Profiler::Zone viewportZone("Viewport");
 		viewport.Bind();
 		m_viewHelper.EnableDepthTest(false, false);
 		if (m_skybox && !viewport.IsDepthOnly())
@@ -317,20 +350,36 @@ void View::Update()
 		}
 		if (viewport.DrawUI())
 		{
+			Profiler::Zone uiZone("UI");
 			DrawUI();
 		}
 		m_viewHelper.EnableDepthTest(true, true);
 		viewport.Unbind();
 	}
 	m_viewHelper.DrawIn2D([this] {
+		Profiler::Zone overlayZone("Overlay");
 		PerfomanceMeter::ReportFrameEnd();
 		m_renderer.SetColor(255, 255, 0);
 		m_textWriter.PrintText(m_renderer, 1, 16, "times.ttf", 16, L"FPS" + std::to_wstring(PerfomanceMeter::GetFps()));
 		m_textWriter.PrintText(m_renderer, 1, 34, "times.ttf", 16, L"V" + std::to_wstring(PerfomanceMeter::GetVerticesDrawn()));
 		m_textWriter.PrintText(m_renderer, 1, 52, "times.ttf", 16, L"P" + std::to_wstring(PerfomanceMeter::GetPolygonsDrawn()));
 		m_textWriter.PrintText(m_renderer, 1, 70, "times.ttf", 16, L"DC" + std::to_wstring(PerfomanceMeter::GetDrawCalls()));
+		m_textWriter.PrintText(m_renderer, 1, 88, "times.ttf", 16, L"A" + std::to_wstring(PerfomanceMeter::GetFrameAllocations()));
+		auto& textureStats = m_textureManager.GetStats();
+		m_textWriter.PrintText(m_renderer, 1, 106, "times.ttf", 16, L"T" + std::to_wstring(textureStats.residentBytes >> 20) + L"MB E" + std::to_wstring(textureStats.evictions) + L" R" + std::to_wstring(textureStats.reloads));
+		m_textWriter.PrintText(m_renderer, 1, 124, "times.ttf", 16, L"S" + std::to_wstring(PerfomanceMeter::GetStreamedBytes() >> 10) + L"KB W" + std::to_wstring(PerfomanceMeter::GetStreamStalls()));
+		if (PerfomanceMeter::IsProfilerOverlayVisible())
+		{
+			int y = 142;
+			for (auto& zoneStats : PerfomanceMeter::GetZoneStats())
+			{
+				m_textWriter.PrintText(m_renderer, 1 + 12 * static_cast<int>(zoneStats.depth), y, "times.ttf", 16, Utf8ToWstring(zoneStats.name) + L" " + ToWstring(zoneStats.time, 2) + L"ms");
+				y += 18;
+			}
+		}
 		m_renderer.SetColor(0, 0, 0);
 	});
+	m_textureManager.EndFrame();
 }
 
 void View::DrawRuler(IViewport& viewport, IViewHelper& renderer)
@@ -345,49 +394,318 @@ void View::DrawRuler(IViewport& viewport, IViewHelper& renderer)
 	}
 }
 
-bool IsOutsideFrustum(IViewHelper& viewHelper, IViewport& viewport, const model::IBaseObject* obj)
+bool GetLocalBounds(model::Bounding const& bounding, AxisAlignedBox& box)
 {
-	int x(-1), y(-1);
-	viewHelper.WorldCoordsToWindowCoords(viewport, obj->GetCoords(), x, y);
-	return x < viewport.GetX() || x > viewport.GetX() + viewport.GetWidth() ||
-		y < viewport.GetY() || y > viewport.GetY() + viewport.GetHeight();
+	if (bounding.type == model::Bounding::eType::Box)
+	{
+		box = { bounding.GetBox().min, bounding.GetBox().max };
+		return true;
+	}
+	bool found = false;
+	if (bounding.type == model::Bounding::eType::Compound)
+	{
+		for (auto& item : bounding.GetCompound().items)
+		{
+			AxisAlignedBox itemBox;
+			if (GetLocalBounds(item, itemBox))
+			{
+				box = found ? box.Union(itemBox) : itemBox;
+				found = true;
+			}
+		}
+	}
+	return found;
 }
 
-void View::CollectMeshes()
+bool View::GetWorldBounds(model::IBaseObject& object, AxisAlignedBox& box)
 {
-	m_meshesToDraw.clear();
-	m_nonDepthTestMeshes.clear();
-	CollectTableMeshes();
-	auto notVisibleInFrustum = [this](const model::IBaseObject* obj) {
-		for (auto& viewport : m_viewports)
+	auto bounding = m_boundingManager.GetBounding(object.GetPathToModel());
+	if (!GetLocalBounds(bounding, box))
+	{
+		return false;
+	}
+	box = box.Transform(object.GetCoords(), object.GetRotations(), bounding.scale);
+	return true;
+}
+
+void View::InitCulling()
+{
+	m_cullingTree.Clear();
+	m_cullingProxies.clear();
+	m_dirtyCullingObjects.clear();
+	m_staticCullingProxies.clear();
+	m_unboundedObjects.clear();
+	m_unboundedStaticObjects.clear();
+	m_objectCreationConnection = m_model->DoOnObjectCreation([this](model::IObject* object) {
+		AddToCullingTree(object);
+	});
+	m_objectRemoveConnection = m_model->DoOnObjectRemove([this](model::IObject* object) {
+		RemoveFromCullingTree(object);
+		m_skinnedVertices.erase(object);
+	});
+	for (size_t i = 0; i < m_model->GetObjectCount(); ++i)
+	{
+		AddToCullingTree(m_model->Get3DObject(i).get());
+	}
+}
+
+void View::AddToCullingTree(model::IBaseObject* object)
+{
+	if (m_cullingProxies.find(object) != m_cullingProxies.end() || std::find(m_unboundedObjects.begin(), m_unboundedObjects.end(), object) != m_unboundedObjects.end())
+	{
+		return;
+	}
+	AxisAlignedBox box;
+	if (!GetWorldBounds(*object, box))
+	{
+		m_unboundedObjects.push_back(object);
+		return;
+	}
+	auto markDirty = [this, object](const CVector3f&, const CVector3f&) {
+		auto it = m_cullingProxies.find(object);
+		if (it != m_cullingProxies.end() && !it->second.dirty)
+		{
+			it->second.dirty = true;
+			m_dirtyCullingObjects.push_back(object);
+		}
+	};
+	sCullingProxy& proxy = m_cullingProxies[object];
+	proxy.proxy = m_cullingTree.Insert(box, object);
+	proxy.dirty = false;
+	proxy.coordsConnection = object->DoOnCoordsChange(markDirty);
+	proxy.rotationConnection = object->DoOnRotationChange(markDirty);
+}
+
+void View::RemoveFromCullingTree(model::IBaseObject* object)
+{
+	auto it = m_cullingProxies.find(object);
+	if (it != m_cullingProxies.end())
+	{
+		m_cullingTree.Remove(it->second.proxy);
+		m_cullingProxies.erase(it);
+	}
+	m_unboundedObjects.erase(std::remove(m_unboundedObjects.begin(), m_unboundedObjects.end(), object), m_unboundedObjects.end());
+}
+
+void View::UpdateCullingTree()
+{
+	for (auto object : m_dirtyCullingObjects)
+	{
+		auto it = m_cullingProxies.find(object);
+		if (it != m_cullingProxies.end() && it->second.dirty)
+		{
+			it->second.dirty = false;
+			AxisAlignedBox box;
+			GetWorldBounds(*object, box);
+			m_cullingTree.Update(it->second.proxy, box);
+		}
+	}
+	m_dirtyCullingObjects.clear();
+	if (m_staticCullingProxies.size() + m_unboundedStaticObjects.size() != m_model->GetStaticObjectCount())
+	{
+		for (auto proxy : m_staticCullingProxies)
 		{
-			if (!viewport->NeedsFrustumCulling() || !IsOutsideFrustum(m_viewHelper, *viewport, obj))
+			m_cullingTree.Remove(proxy);
+		}
+		m_staticCullingProxies.clear();
+		m_unboundedStaticObjects.clear();
+		for (size_t i = 0; i < m_model->GetStaticObjectCount(); ++i)
+		{
+			auto& object = m_model->GetStaticObject(i);
+			AxisAlignedBox box;
+			if (GetWorldBounds(object, box))
+			{
+				m_staticCullingProxies.push_back(m_cullingTree.Insert(box, &object));
+			}
+			else
 			{
-				return false;
+				m_unboundedStaticObjects.push_back(&object);
 			}
 		}
-		return true;
-	};
-	std::vector<model::IBaseObject*> objects = m_model->GetAllBaseObjects();
-	m_meshesToDraw.reserve(objects.size() * 10);
-	objects.erase(std::remove_if(objects.begin(), objects.end(), notVisibleInFrustum), objects.end());
-	for (auto* object : objects)
+	}
+}
+
+void View::CollectVisibleObjects()
+{
+	m_visibleObjects.clear();
+	for (auto& viewport : m_viewports)
+	{
+		if (!viewport->NeedsFrustumCulling())
+		{
+			for (size_t i = 0; i < m_model->GetObjectCount(); ++i)
+			{
+				m_visibleObjects.push_back(m_model->Get3DObject(i).get());
+			}
+			for (size_t i = 0; i < m_model->GetStaticObjectCount(); ++i)
+			{
+				m_visibleObjects.push_back(&m_model->GetStaticObject(i));
+			}
+			for (size_t i = 0; i < m_model->GetProjectileCount(); ++i)
+			{
+				m_visibleObjects.push_back(&m_model->GetProjectile(i));
+			}
+			return;
+		}
+	}
+	UpdateCullingTree();
+	auto& frustums = m_frustums;
+	frustums.clear();
+	for (auto& viewport : m_viewports)
+	{
+		frustums.emplace_back(viewport->GetProjectionMatrix(), viewport->GetViewMatrix());
+		m_cullingTree.Query(frustums.back(), m_visibleObjects);
+	}
+	if (frustums.size() > 1)
+	{
+		std::sort(m_visibleObjects.begin(), m_visibleObjects.end());
+		m_visibleObjects.erase(std::unique(m_visibleObjects.begin(), m_visibleObjects.end()), m_visibleObjects.end());
+	}
+	m_visibleObjects.insert(m_visibleObjects.end(), m_unboundedObjects.begin(), m_unboundedObjects.end());
+	m_visibleObjects.insert(m_visibleObjects.end(), m_unboundedStaticObjects.begin(), m_unboundedStaticObjects.end());
+	//Projectiles move every frame, so it is cheaper to test them directly
+	for (size_t i = 0; i < m_model->GetProjectileCount(); ++i)
+	{
+		auto& projectile = m_model->GetProjectile(i);
+		AxisAlignedBox box;
+		if (!GetWorldBounds(projectile, box) || std::any_of(frustums.begin(), frustums.end(), [&box](Frustum const& frustum) { return frustum.Test(box) != Frustum::eTestResult::Outside; }))
+		{
+			m_visibleObjects.push_back(&projectile);
+		}
+	}
+}
+
+void View::CollectMeshes()
+{
+	const size_t storageCapacity = GetMeshStorageCapacity();
+	m_meshesToDraw.clear();
+	m_nonDepthTestMeshes.clear();
+	m_frameArena.Reset();
+	m_modelManager.BeginFrame();
+	CollectTableMeshes();
+	CollectVisibleObjects();
+	//Models are loaded and their buffers are created on the main thread, everything else is done by workers
+	m_meshInstances.clear();
+	const size_t skinnedObjects = m_skinnedVertices.size();
+	size_t heapAllocations = 0;
+	for (auto* object : m_visibleObjects)
 	{
 		m_renderer.PushMatrix();
 		m_renderer.Translate(object->GetCoords());
 		m_renderer.Rotate(object->GetRotations());
+		const Matrix4F objectMatrix = m_renderer.GetModelMatrix();
+		m_renderer.PopMatrix();
 		model::IObject* fullObject = object->GetFullObject();
-		m_modelManager.GetModelMeshes(object->GetPathToModel(), m_renderer, m_textureManager, fullObject, m_meshesToDraw);
+		C3DModel* model = m_modelManager.PrepareModel(object->GetPathToModel(), m_renderer, m_textureManager);
+		SkinnedVertices* skinned = nullptr;
+		if (fullObject && model->IsSkinned() && !m_modelManager.IsGPUSkinningEnabled())
+		{
+			skinned = &m_skinnedVertices[fullObject];
+			if (model->PrepareSkinnedVertices(*skinned))
+			{
+				++heapAllocations;
+			}
+		}
+		m_meshInstances.push_back({ model, objectMatrix, fullObject, skinned });
 		if (fullObject)
 		{
 			size_t secondaryModels = fullObject->GetSecondaryModelsCount();
 			for (size_t j = 0; j < secondaryModels; ++j)
 			{
-				m_modelManager.GetModelMeshes(fullObject->GetSecondaryModel(j), m_renderer, m_textureManager, nullptr, m_meshesToDraw);
+				m_meshInstances.push_back({ m_modelManager.PrepareModel(fullObject->GetSecondaryModel(j), m_renderer, m_textureManager), objectMatrix, nullptr, nullptr });
 			}
 		}
-		m_renderer.PopMatrix();
 	}
+	//Each chunk writes to its own collection, so the result does not depend on which thread processed it
+	const size_t collections = m_meshCollections.size();
+	const size_t grainSize = std::max(MIN_INSTANCES_PER_CHUNK, (m_meshInstances.size() + collections - 1) / collections);
+	const size_t chunks = (m_meshInstances.size() + grainSize - 1) / grainSize;
+	for (size_t i = 0; i < chunks; ++i)
+	{
+		m_meshCollections[i].Reset();
+	}
+	m_threadPool.ParallelFor(0, m_meshInstances.size(), [this, grainSize](size_t begin, size_t end) {
+		MeshCollection& collection = m_meshCollections[begin / grainSize];
+		for (size_t i = begin; i < end; ++i)
+		{
+			auto& instance = m_meshInstances[i];
+			m_modelManager.GetModelMeshes(*instance.model, instance.matrix, m_textureManager, instance.object, collection, instance.skinned);
+		}
+	}, grainSize);
+	SkinVertices(chunks);
+	size_t total = m_meshesToDraw.size();
+	heapAllocations += m_frameArena.GetHeapAllocations() + m_modelManager.GetFrameHeapAllocations();
+	if (m_skinnedVertices.size() != skinnedObjects)
+	{
+		++heapAllocations;
+	}
+	for (size_t i = 0; i < chunks; ++i)
+	{
+		total += m_meshCollections[i].meshes.size();
+		heapAllocations += m_meshCollections[i].arena.GetHeapAllocations();
+	}
+	m_meshesToDraw.reserve(total);
+	for (size_t i = 0; i < chunks; ++i)
+	{
+		auto& collection = m_meshCollections[i];
+		const size_t offset = m_meshesToDraw.size();
+		std::move(collection.meshes.begin(), collection.meshes.end(), std::back_inserter(m_meshesToDraw));
+		//Textures can only be created on the main thread
+		for (auto& unresolved : collection.unresolvedTextures)
+		{
+			ICachedTexture* texture = m_textureManager.GetTexturePtr(*unresolved.texture, unresolved.teamcolor);
+			m_meshesToDraw[offset + unresolved.meshIndex].texturePtr = texture;
+			if (!unresolved.teamcolor && unresolved.material && unresolved.texture == &unresolved.material->texture)
+			{
+				unresolved.material->texturePtr = texture;
+				unresolved.material->texturePtrGeneration = m_textureManager.GetGeneration();
+			}
+		}
+	}
+	//Lists are only reallocated when they grow
+	if (GetMeshStorageCapacity() != storageCapacity)
+	{
+		++heapAllocations;
+	}
+	PerfomanceMeter::ReportFrameAllocations(heapAllocations);
+}
+
+void View::SkinVertices(size_t collections)
+{
+	m_skinningJobs.clear();
+	m_skinningOffsets.clear();
+	size_t totalVertices = 0;
+	for (size_t i = 0; i < collections; ++i)
+	{
+		for (auto& job : m_meshCollections[i].skinningJobs)
+		{
+			m_skinningJobs.push_back(job);
+			m_skinningOffsets.push_back(totalVertices);
+			totalVertices += job.model->GetSkinnedVerticesCount();
+		}
+	}
+	//Vertices of all objects are split into equal chunks, so a single big model does not stall the whole pool
+	m_threadPool.ParallelFor(0, totalVertices, [this](size_t begin, size_t end) {
+		size_t job = std::upper_bound(m_skinningOffsets.begin(), m_skinningOffsets.end(), begin) - m_skinningOffsets.begin() - 1;
+		for (; begin < end; ++job)
+		{
+			auto& skinningJob = m_skinningJobs[job];
+			const size_t offset = m_skinningOffsets[job];
+			const size_t jobEnd = std::min(end, offset + skinningJob.model->GetSkinnedVerticesCount());
+			skinningJob.model->SkinVertices(skinningJob.skinMatrices, begin - offset, jobEnd - offset, *skinningJob.output);
+			begin = jobEnd;
+		}
+	}, SKINNED_VERTICES_PER_CHUNK);
+}
+
+size_t View::GetMeshStorageCapacity() const
+{
+	size_t capacity = m_meshesToDraw.capacity() + m_nonDepthTestMeshes.capacity() + m_meshInstances.capacity() + m_visibleObjects.capacity() + m_frustums.capacity()
+		+ m_skinningJobs.capacity() + m_skinningOffsets.capacity();
+	for (auto& collection : m_meshCollections)
+	{
+		capacity += collection.meshes.capacity() + collection.unresolvedTextures.capacity() + collection.skinningJobs.capacity();
+	}
+	return capacity;
 }
 
 void View::DrawMeshes(IViewHelper& renderer, Viewport& currentViewport)
@@ -395,9 +713,7 @@ void View::DrawMeshes(IViewHelper& renderer, Viewport& currentViewport)
 	const bool shadowOnly = currentViewport.IsDepthOnly();
 	renderer.EnableDepthTest(true, true);
 	auto& shaderManager = renderer.GetShaderManager();
-	if (currentViewport.GetShaderProgram()) shaderManager.PushProgram(*currentViewport.GetShaderProgram());
-	if (!shadowOnly)
-	{
+	auto setUpLights = [&] {
 		currentViewport.SetUpShadowMap();
 		auto& lights = m_model->GetLights();
 		size_t lightsCount = lights.size();
@@ -407,9 +723,19 @@ void View::DrawMeshes(IViewHelper& renderer, Viewport& currentViewport)
 			auto& light = lights[i];
 			renderer.SetUpLight(i, light.GetPosition(), light.GetAmbient(), light.GetDiffuse(), light.GetSpecular());
 		}
-		static const std::string eyePosKey = "viewPos";
 		CVector3f viewPos = currentViewport.GetCamera().GetPosition();
-		shaderManager.SetUniformValue(eyePosKey, 3, 1, viewPos.ptr());
+		shaderManager.SetUniformValue(m_viewPosUniform, 3, 1, viewPos.ptr());
+	};
+	if (!shadowOnly && !m_instancedMeshes.blocks.empty())
+	{
+		shaderManager.PushProgram(*m_instancingProgram);
+		setUpLights();
+		shaderManager.PopProgram();
+	}
+	if (currentViewport.GetShaderProgram()) shaderManager.PushProgram(*currentViewport.GetShaderProgram());
+	if (!shadowOnly)
+	{
+		setUpLights();
 	}
 
 	//Draw
@@ -465,14 +791,23 @@ void View::DrawMeshesList(IViewHelper &renderer, const std::vector<DrawableMesh>
 	ICachedTexture* texture = nullptr;
 	Material* material = nullptr;
 	Matrix4F prevMatrix;
+	//Buffer over CPU generated vertices is reused by consecutive meshes of the same object
+	std::unique_ptr<IVertexBuffer> tempBuffer;
+	const TempMeshBuffer* tempBufferSource = nullptr;
 
 	static std::vector<IRenderer::IndirectDraw> multiDrawList;
+	//Instanced blocks are found for meshes to draw only. Shadows are drawn by viewport program
+	auto instancedBlock = m_instancedMeshes.blocks.cbegin();
+	const auto instancedBlocksEnd = (&list == &m_meshesToDraw && !shadowOnly) ? m_instancedMeshes.blocks.cend() : instancedBlock;
 
 	for (auto it = list.begin(); it != list.end(); ++it)
 	{
 		const DrawableMesh& mesh = *it;
 		const auto next = it + 1;
-		if (next != list.cend() && next->buffer == mesh.buffer && next->texturePtr == mesh.texturePtr && next->material == mesh.material && !next->tempBuffer && next->modelMatrix == mesh.modelMatrix)
+		const size_t index = static_cast<size_t>(it - list.begin());
+		const bool instanced = instancedBlock != instancedBlocksEnd && instancedBlock->begin == index;
+		const bool nextInstanced = instancedBlock != instancedBlocksEnd && instancedBlock->begin == index + 1;
+		if (!instanced && !nextInstanced && next != list.cend() && next->buffer == mesh.buffer && next->texturePtr == mesh.texturePtr && next->material == mesh.material && !next->tempBuffer && next->modelMatrix == mesh.modelMatrix)
 		{
 			multiDrawList.push_back({ mesh.start, mesh.count, 1 });
 			continue;
@@ -488,6 +823,7 @@ void View::DrawMeshesList(IViewHelper &renderer, const std::vector<DrawableMesh>
 			if (texture)
 			{
 				renderer.SetTexture(*texture);
+				m_textureManager.MarkUsed(*texture);
 			}
 		}
 		if (material != mesh.material && !shadowOnly)
@@ -516,6 +852,18 @@ void View::DrawMeshesList(IViewHelper &renderer, const std::vector<DrawableMesh>
 		{
 			m_renderer.SetColor(mesh.material->diffuse);
 		}
+		if (instanced)
+		{
+			DrawInstances(renderer, *instancedBlock);
+			prevMatrix = Matrix4F();
+			it += instancedBlock->end - instancedBlock->begin - 1;
+			++instancedBlock;
+			if (!texture && mesh.material)
+			{
+				m_renderer.SetColor(0, 0, 0);
+			}
+			continue;
+		}
 		if (mesh.modelMatrix != prevMatrix)
 		{
 			m_renderer.SetModelMatrix(mesh.modelMatrix);
@@ -523,17 +871,20 @@ void View::DrawMeshesList(IViewHelper &renderer, const std::vector<DrawableMesh>
 		}
 		if (mesh.skeleton && !shadowOnly)
 		{
-			shaderManager.SetUniformValue("joints", 16, mesh.skeleton->size() / 16, mesh.skeleton->data());
+			shaderManager.SetUniformValue(m_jointsUniform, 16, mesh.skeletonSize / 16, mesh.skeleton);
 		}
 
 		auto buffer = mesh.buffer;
-		std::unique_ptr<IVertexBuffer> tempBuffer;
 		if (!buffer && mesh.tempBuffer)
 		{
-			tempBuffer = renderer.CreateVertexBuffer((const float*)mesh.tempBuffer->vertices.data(), (const float*)mesh.tempBuffer->normals.data(), (const float*)mesh.tempBuffer->texCoords, mesh.tempBuffer->vertices.size());
-			if (mesh.tempBuffer->indexes && mesh.tempBuffer->indexesCount > 0 && mesh.indexed)
+			if (tempBufferSource != mesh.tempBuffer)
 			{
-				renderer.SetIndexBuffer(*tempBuffer, mesh.tempBuffer->indexes, mesh.tempBuffer->indexesCount);
+				tempBuffer = renderer.CreateVertexBuffer((const float*)mesh.tempBuffer->vertices, (const float*)mesh.tempBuffer->normals, (const float*)mesh.tempBuffer->texCoords, mesh.tempBuffer->verticesCount, true);
+				if (mesh.tempBuffer->indexes && mesh.tempBuffer->indexesCount > 0 && mesh.indexed)
+				{
+					renderer.SetIndexBuffer(*tempBuffer, mesh.tempBuffer->indexes, mesh.tempBuffer->indexesCount);
+				}
+				tempBufferSource = mesh.tempBuffer;
 			}
 			buffer = tempBuffer.get();
 		}
@@ -563,7 +914,7 @@ void View::DrawMeshesList(IViewHelper &renderer, const std::vector<DrawableMesh>
 
 		if (mesh.skeleton)
 		{
-			shaderManager.SetUniformValue("joints", 16, 0, (const float*)nullptr);
+			shaderManager.SetUniformValue(m_jointsUniform, 16, 0, (const float*)nullptr);
 		}
 		if (mesh.shader && !shadowOnly)
 		{
@@ -574,6 +925,194 @@ void View::DrawMeshesList(IViewHelper &renderer, const std::vector<DrawableMesh>
 	multiDrawList.clear();
 }
 
+namespace
+{
+bool IsInstanceable(const DrawableMesh& mesh)
+{
+	return mesh.buffer && !mesh.tempBuffer && !mesh.skeleton && !mesh.shader;
+}
+
+bool IsSameBlock(const DrawableMesh& first, const DrawableMesh& second)
+{
+	return first.shader == second.shader && first.texturePtr == second.texturePtr && first.buffer == second.buffer && first.tempBuffer == second.tempBuffer && first.material == second.material;
+}
+
+//Compares meshes drawn for two objects of the same block
+int CompareObjectMeshes(const MeshList& list, std::pair<size_t, size_t> const& first, std::pair<size_t, size_t> const& second)
+{
+	const size_t firstCount = first.second - first.first;
+	const size_t secondCount = second.second - second.first;
+	if (firstCount != secondCount)
+	{
+		return firstCount < secondCount ? -1 : 1;
+	}
+	for (size_t i = 0; i < firstCount; ++i)
+	{
+		const DrawableMesh& firstMesh = list[first.first + i];
+		const DrawableMesh& secondMesh = list[second.first + i];
+		if (std::tie(firstMesh.start, firstMesh.count, firstMesh.indexed) != std::tie(secondMesh.start, secondMesh.count, secondMesh.indexed))
+		{
+			return std::tie(firstMesh.start, firstMesh.count, firstMesh.indexed) < std::tie(secondMesh.start, secondMesh.count, secondMesh.indexed) ? -1 : 1;
+		}
+	}
+	return 0;
+}
+}
+
+void View::PrepareInstances()
+{
+	auto& instanced = m_instancedMeshes;
+	instanced.Reset();
+	if (!m_instancingProgram || !m_renderer.SupportsFeature(IRenderer::Feature::Instancing))
+	{
+		return;
+	}
+	const MeshList& list = m_meshesToDraw;
+	for (size_t begin = 0, end = 0; begin < list.size(); begin = end)
+	{
+		bool instanceable = true;
+		for (end = begin; end < list.size() && IsSameBlock(list[begin], list[end]); ++end)
+		{
+			instanceable = instanceable && IsInstanceable(list[end]) && list[end].indexed == list[begin].indexed;
+		}
+		if (!instanceable || end - begin < 2)
+		{
+			continue;
+		}
+		//Sorted meshes of one object are consecutive
+		instanced.objects.clear();
+		for (size_t i = begin; i < end; ++i)
+		{
+			if (i == begin || !(list[i].modelMatrix == list[i - 1].modelMatrix))
+			{
+				instanced.objects.push_back({ i, i + 1 });
+			}
+			else
+			{
+				instanced.objects.back().second = i + 1;
+			}
+		}
+		if (instanced.objects.size() < 2)
+		{
+			continue;
+		}
+		instanced.order.resize(instanced.objects.size());
+		std::iota(instanced.order.begin(), instanced.order.end(), 0);
+		std::stable_sort(instanced.order.begin(), instanced.order.end(), [&](size_t first, size_t second) {
+			return CompareObjectMeshes(list, instanced.objects[first], instanced.objects[second]) < 0;
+		});
+		InstancedMeshes::Block block{ begin, end, instanced.groups.size(), instanced.groups.size() };
+		size_t maxInstances = 0;
+		for (size_t groupBegin = 0, groupEnd = 0; groupBegin < instanced.order.size(); groupBegin = groupEnd)
+		{
+			auto& firstObject = instanced.objects[instanced.order[groupBegin]];
+			for (groupEnd = groupBegin + 1; groupEnd < instanced.order.size() && CompareObjectMeshes(list, firstObject, instanced.objects[instanced.order[groupEnd]]) == 0; ++groupEnd);
+			InstancedMeshes::Group group{ instanced.matrices.size(), groupEnd - groupBegin, instanced.draws.size(), instanced.draws.size() };
+			for (size_t i = groupBegin; i < groupEnd; ++i)
+			{
+				instanced.matrices.push_back(&list[instanced.objects[instanced.order[i]].first].modelMatrix);
+			}
+			for (size_t i = firstObject.first; i < firstObject.second; ++i)
+			{
+				instanced.draws.push_back({ list[i].start, list[i].count, group.instances });
+			}
+			group.drawsEnd = instanced.draws.size();
+			instanced.groups.push_back(group);
+			maxInstances = std::max(maxInstances, group.instances);
+		}
+		if (maxInstances < 2)
+		{
+			//Nothing to save, meshes are drawn as usual
+			instanced.draws.resize(instanced.groups[block.groupsBegin].drawsBegin);
+			instanced.matrices.resize(instanced.groups[block.groupsBegin].firstInstance);
+			instanced.groups.resize(block.groupsBegin);
+			continue;
+		}
+		block.groupsEnd = instanced.groups.size();
+		instanced.blocks.push_back(block);
+	}
+	if (instanced.blocks.empty())
+	{
+		return;
+	}
+	auto& shaderManager = m_renderer.GetShaderManager();
+	const size_t instancesCount = instanced.matrices.size();
+	const bool grow = !instanced.buffer || instancesCount > instanced.capacity;
+	if (grow)
+	{
+		//Grows by half, so a few more objects on the next frames do not create a buffer again
+		instanced.capacity = std::max(instancesCount, instanced.capacity + instanced.capacity / 2);
+		instanced.columns.assign(instanced.capacity * 16, 0.0f);
+	}
+	const size_t capacity = instanced.capacity;
+	size_t changedBegin = instancesCount;
+	size_t changedEnd = 0;
+	for (size_t i = 0; i < instancesCount; ++i)
+	{
+		const float* matrix = *instanced.matrices[i];
+		for (size_t column = 0; column < 4; ++column)
+		{
+			float* stored = &instanced.columns[(column * capacity + i) * 4];
+			if (memcmp(stored, matrix + column * 4, sizeof(float) * 4) != 0)
+			{
+				memcpy(stored, matrix + column * 4, sizeof(float) * 4);
+				changedBegin = std::min(changedBegin, i);
+				changedEnd = i + 1;
+			}
+		}
+	}
+	if (grow)
+	{
+		instanced.buffer = shaderManager.CreateVertexAttribCache(instanced.columns.size() * sizeof(float), instanced.columns.data(), true);
+	}
+	else if (changedBegin < changedEnd)
+	{
+		for (size_t column = 0; column < 4; ++column)
+		{
+			shaderManager.UpdateVertexAttribCache(*instanced.buffer, instanced.columns.data(), (column * capacity + changedBegin) * 4 * sizeof(float), (changedEnd - changedBegin) * 4 * sizeof(float));
+		}
+	}
+}
+
+void View::DrawInstances(IViewHelper& renderer, InstancedMeshes::Block const& block)
+{
+	auto& shaderManager = renderer.GetShaderManager();
+	auto& instanced = m_instancedMeshes;
+	const DrawableMesh& firstMesh = m_meshesToDraw[block.begin];
+	IVertexBuffer& buffer = *firstMesh.buffer;
+	const size_t capacity = instanced.capacity;
+	shaderManager.PushProgram(*m_instancingProgram);
+	renderer.SetModelMatrix(Matrix4F());
+	for (size_t i = block.groupsBegin; i < block.groupsEnd; ++i)
+	{
+		auto& group = instanced.groups[i];
+		for (size_t column = 0; column < 4; ++column)
+		{
+			renderer.AddVertexAttribute(buffer, g_instanceMatrixAttributes[column], 4, *instanced.buffer, IShaderManager::Format::Float32, true, (column * capacity + group.firstInstance) * 4 * sizeof(float));
+		}
+		if (group.drawsEnd - group.drawsBegin > 1)
+		{
+			renderer.DrawIndirect(buffer, array_view<IRenderer::IndirectDraw>(instanced.draws.data() + group.drawsBegin, group.drawsEnd - group.drawsBegin), firstMesh.indexed);
+		}
+		else if (firstMesh.indexed)
+		{
+			auto& draw = instanced.draws[group.drawsBegin];
+			renderer.DrawIndexed(buffer, draw.count, draw.start, draw.instances);
+		}
+		else
+		{
+			auto& draw = instanced.draws[group.drawsBegin];
+			renderer.Draw(buffer, draw.count, draw.start, draw.instances);
+		}
+	}
+	static const float empty[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (auto& attribute : g_instanceMatrixAttributes)
+	{
+		shaderManager.DisableVertexAttribute(attribute, 4, empty);
+	}
+	shaderManager.PopProgram();
+}
+
 void View::CollectTableMeshes()
 {
 	if (!m_tableBuffer)
@@ -621,7 +1160,7 @@ void View::CollectTableMeshes()
 		m_tableBufferSize = vertex.size();
 	}
 	model::Landscape const& landscape = m_model->GetLandscape();
-	m_meshesToDraw.push_back({nullptr, m_textureManager.GetTexturePtr(landscape.GetTexture()), nullptr, m_tableBuffer.get(), Matrix4F(), nullptr, nullptr, 0, m_tableBufferSize, false});
+	m_meshesToDraw.push_back({nullptr, m_textureManager.GetTexturePtr(landscape.GetTexture()), nullptr, m_tableBuffer.get(), Matrix4F(), nullptr, nullptr, 0, 0, m_tableBufferSize, false});
 
 	for (size_t i = 0; i < landscape.GetNumberOfDecals(); ++i)
 	{
@@ -632,17 +1171,16 @@ void View::CollectTableMeshes()
 		m_renderer.Rotate(decal.rotation, CVector3f(0.0f, 0.0f, 1.0f));
 		Matrix4F mat = m_renderer.GetModelMatrix();
 		m_renderer.PopMatrix();
-		std::vector<CVector3f> vertices = {
-			CVector3f(-decal.width / 2, -decal.depth / 2, landscape.GetHeight(decal.x - decal.width / 2, decal.y - decal.depth / 2) + 0.001f),
-			{ -decal.width / 2, decal.depth / 2, landscape.GetHeight(decal.x - decal.width / 2, decal.y + decal.depth / 2) + 0.001f },
-			{ decal.width / 2, -decal.depth / 2, landscape.GetHeight(decal.x + decal.width / 2, decal.y - decal.depth / 2) + 0.001f },
-			{ -decal.width / 2, decal.depth / 2, landscape.GetHeight(decal.x - decal.width / 2, decal.y + decal.depth / 2) + 0.001f },
-			{ decal.width / 2, -decal.depth / 2, landscape.GetHeight(decal.x + decal.width / 2, decal.y - decal.depth / 2) + 0.001f },
-			{ decal.width / 2, decal.depth / 2, landscape.GetHeight(decal.x + decal.width / 2, decal.y + decal.depth / 2) + 0.001f }
-		};
+		CVector3f* vertices = m_frameArena.Allocate<CVector3f>(6);
+		vertices[0] = CVector3f(-decal.width / 2, -decal.depth / 2, landscape.GetHeight(decal.x - decal.width / 2, decal.y - decal.depth / 2) + 0.001f);
+		vertices[1] = CVector3f(-decal.width / 2, decal.depth / 2, landscape.GetHeight(decal.x - decal.width / 2, decal.y + decal.depth / 2) + 0.001f);
+		vertices[2] = CVector3f(decal.width / 2, -decal.depth / 2, landscape.GetHeight(decal.x + decal.width / 2, decal.y - decal.depth / 2) + 0.001f);
+		vertices[3] = CVector3f(-decal.width / 2, decal.depth / 2, landscape.GetHeight(decal.x - decal.width / 2, decal.y + decal.depth / 2) + 0.001f);
+		vertices[4] = CVector3f(decal.width / 2, -decal.depth / 2, landscape.GetHeight(decal.x + decal.width / 2, decal.y - decal.depth / 2) + 0.001f);
+		vertices[5] = CVector3f(decal.width / 2, decal.depth / 2, landscape.GetHeight(decal.x + decal.width / 2, decal.y + decal.depth / 2) + 0.001f);
 		static const CVector2f texCoords[] = { CVector2f(0.0f, 0.0f), { 0.0f, 1.0f }, { 1.0f, 0.0f }, { 0.0f, 1.0f },{ 1.0f, 0.0f },{ 1.0f, 1.0f } };
-		auto temp = std::make_shared<TempMeshBuffer>(TempMeshBuffer{ vertices, std::vector<CVector3f>(), texCoords, nullptr, 0 });
-		m_nonDepthTestMeshes.push_back(DrawableMesh{nullptr, m_textureManager.GetTexturePtr(decal.texture), nullptr, nullptr, mat, std::move(temp), nullptr, 0, 6, false});
+		auto temp = m_frameArena.New<TempMeshBuffer>(TempMeshBuffer{ vertices, nullptr, 6, texCoords, nullptr, 0 });
+		m_nonDepthTestMeshes.push_back(DrawableMesh{nullptr, m_textureManager.GetTexturePtr(decal.texture), nullptr, nullptr, mat, temp, nullptr, 0, 0, 6, false});
 	}
 }
 
@@ -727,11 +1265,23 @@ void View::SetAnisotropyLevel(float level)
 	m_textureManager.SetAnisotropyLevel(level);
 }
 
+void View::SetTextureMemoryBudget(size_t bytes)
+{
+	m_textureManager.SetMemoryBudget(bytes);
+}
+
+sTextureStats const& View::GetTextureStats() const
+{
+	return m_textureManager.GetStats();
+}
+
 void View::ClearResources()
 {
 	m_modelManager.Reset();
 	m_textureManager.Reset();
 	m_tableBuffer.reset();
+	m_instancedMeshes.buffer.reset();
+	m_instancedMeshes.capacity = 0;
 }
 
 void View::SetWindowTitle(wstring const& title)
@@ -840,6 +1390,23 @@ void View::SetSkyboxShaders(const Path& vertex, const Path& fragment)
 	m_skybox->SetShaders(vertex, fragment, m_renderer.GetShaderManager());
 }
 
+void View::SetInstancingShaders(const Path& vertex, const Path& fragment)
+{
+	if (vertex.empty() && fragment.empty())
+	{
+		m_instancingProgram.reset();
+	}
+	else
+	{
+		m_instancingProgram = m_renderer.GetShaderManager().NewProgram(vertex, fragment);
+	}
+}
+
+const IShaderProgram* View::GetInstancingProgram() const
+{
+	return m_instancingProgram.get();
+}
+
 void View::PreloadModel(const Path& model)
 {
 	m_modelManager.LoadIfNotExist(model, m_textureManager);
@@ -894,9 +1461,11 @@ void View::RunOcclusionQueries(std::vector<model::IBaseObject *> objects, Viewpo
 {
 	renderer.EnableColorWrite(false, false);
 	renderer.UnbindTexture();
+	Frustum frustum(currentViewport.GetProjectionMatrix(), currentViewport.GetViewMatrix());
 	for (auto object : objects)
 	{
-		if (IsOutsideFrustum(renderer, currentViewport, object))
+		AxisAlignedBox box;
+		if (GetWorldBounds(*object, box) && frustum.Test(box) == Frustum::eTestResult::Outside)
 			continue;
 		auto& query = currentViewport.GetOcclusionQuery(object);
 		auto it = m_boundingCache.find(object->GetPathToModel());
@@ -919,8 +1488,9 @@ void View::RunOcclusionQueries(std::vector<model::IBaseObject *> objects, Viewpo
 }
 
 bool MeshComparator(const DrawableMesh& first, const DrawableMesh& second) {
-	return std::tie(first.shader, first.texturePtr, first.buffer, first.material)
-		< std::tie(second.shader, second.texturePtr, second.buffer, second.material);
+	//Meshes of the same object stay together, ordered by position, so instances of different objects are found in the same order
+	return std::tie(first.shader, first.texturePtr, first.buffer, first.tempBuffer, first.material, first.modelMatrix[12], first.modelMatrix[13], first.modelMatrix[14], first.start)
+		< std::tie(second.shader, second.texturePtr, second.buffer, second.tempBuffer, second.material, second.modelMatrix[12], second.modelMatrix[13], second.modelMatrix[14], second.start);
 };
 
 void View::SortMeshes()
@@ -1,5 +1,7 @@
 #pragma once
 #include "../UI/UIElement.h"
+#include "../Signal.h"
+#include "CullingTree.h"
 #include "ModelManager.h"
 #include "ParticleSystem.h"
 #include "Ruler.h"
@@ -62,12 +64,18 @@ public:
 	void EnableMSAA(bool enable, int level = 1.0f);
 	float GetMaxAnisotropy() const;
 	void SetAnisotropyLevel(float level);
+	//Least recently used textures are unloaded when they take more memory. 0 means no limit
+	void SetTextureMemoryBudget(size_t bytes);
+	sTextureStats const& GetTextureStats() const;
 	void ClearResources();
 	void SetWindowTitle(std::wstring const& title);
 	void Preload(const Path& image);
 	bool EnableVRMode(bool enable, bool mirrorToScreen = true);
 	void AddParticleEffect(const Path& effectPath, CVector3f const& position, float scale, size_t maxParticles = 1000u);
 	void SetSkyboxShaders(const Path& vertex, const Path& fragment);
+	//Copies of the same mesh are drawn with one instanced draw using this program. Empty paths disable instancing
+	void SetInstancingShaders(const Path& vertex, const Path& fragment);
+	const IShaderProgram* GetInstancingProgram() const;
 	void PreloadModel(const Path& model);
 
 private:
@@ -76,7 +84,20 @@ private:
 	void Update();
 	void DrawRuler(IViewport& viewport, IViewHelper& renderer);
 	void CollectMeshes();
+	void InitCulling();
+	void AddToCullingTree(model::IBaseObject* object);
+	void RemoveFromCullingTree(model::IBaseObject* object);
+	void UpdateCullingTree();
+	void CollectVisibleObjects();
+	//Executes skinning jobs recorded by first collections
+	void SkinVertices(size_t collections);
+	size_t GetMeshStorageCapacity() const;
+	//Returns false if model has no bounding
+	bool GetWorldBounds(model::IBaseObject& object, AxisAlignedBox& box);
 	void SortMeshes();
+	//Finds groups of meshes that can be drawn instanced and uploads their model matrices
+	void PrepareInstances();
+	void DrawInstances(IViewHelper& renderer, InstancedMeshes::Block const& block);
 	void DrawMeshes(IViewHelper& renderer, Viewport& currentViewport);
 	void DrawMeshesList(IViewHelper &renderer, const MeshList& list, bool shadowOnly);
 	void RunOcclusionQueries(std::vector<model::IBaseObject *> objects, Viewport &currentViewport, IViewHelper& renderer);
@@ -113,7 +134,46 @@ private:
 	size_t m_tableBufferSize = 0;
 	MeshList m_meshesToDraw;
 	MeshList m_nonDepthTestMeshes;
+	std::unique_ptr<IShaderProgram> m_instancingProgram;
+	UniformHandle m_jointsUniform;
+	UniformHandle m_viewPosUniform;
+	InstancedMeshes m_instancedMeshes;
+	struct sMeshInstance
+	{
+		C3DModel* model;
+		Matrix4F matrix;
+		model::IObject* object;
+		SkinnedVertices* skinned;
+	};
+	std::vector<sMeshInstance> m_meshInstances;
+	std::vector<MeshCollection> m_meshCollections;
+	std::unordered_map<model::IObject*, SkinnedVertices> m_skinnedVertices;
+	std::vector<SkinningJob> m_skinningJobs;
+	//Index of the first vertex of each job among all vertices skinned this frame
+	std::vector<size_t> m_skinningOffsets;
+	//Data for meshes collected on the main thread
+	FrameArena m_frameArena;
 	std::unordered_map<Path, std::pair<std::unique_ptr<IVertexBuffer>, size_t>> m_boundingCache;
+
+	struct sCullingProxy
+	{
+		CullingTree::ProxyId proxy;
+		bool dirty;
+		signals::ScopedConnection coordsConnection;
+		signals::ScopedConnection rotationConnection;
+	};
+	CullingTree m_cullingTree;
+	std::unordered_map<model::IBaseObject*, sCullingProxy> m_cullingProxies;
+	std::vector<model::IBaseObject*> m_dirtyCullingObjects;
+	//Static objects are stored by value in model, so their proxies are rebuilt when count changes
+	std::vector<CullingTree::ProxyId> m_staticCullingProxies;
+	//Objects without bounding may be of any size, so they are never culled
+	std::vector<model::IBaseObject*> m_unboundedObjects;
+	std::vector<model::IBaseObject*> m_unboundedStaticObjects;
+	std::vector<model::IBaseObject*> m_visibleObjects;
+	std::vector<Frustum> m_frustums;
+	signals::ScopedConnection m_objectCreationConnection;
+	signals::ScopedConnection m_objectRemoveConnection;
 };
 }
 }
\ No newline at end of file
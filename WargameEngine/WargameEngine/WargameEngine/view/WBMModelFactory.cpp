@@ -4,7 +4,8 @@
 #include "3dModel.h"
 #include <algorithm>
 #include <cstring>
-#include <cwctype>
+#include <fstream>
+#include <stdexcept>
 #include <unordered_map>
 #include <string>
 #include <vector>
@@ -13,7 +14,131 @@ namespace wargameEngine
 {
 namespace view
 {
-std::unique_ptr<C3DModel> CWBMModelFactory::LoadModel(unsigned char* data, size_t /*size*/, C3DModel const& dummyModel, const Path& /*filePath*/)
+namespace
+{
+//First files were written with zero version
+const uint32_t VERSION_1 = 0;
+const uint32_t VERSION_2 = 2;
+const char MAGIC[4] = { 'W', 'B', 'M', '2' };
+const size_t ALIGNMENT = 16;
+//Smallest serialized descriptions: strings are prefixed with 32-bit size, counts and indexes are varints of at least one byte
+const size_t MIN_MESH_SIZE = 2 * sizeof(uint32_t) + 1 + 16 * sizeof(float);
+const size_t MIN_JOINT_SIZE = 2 * sizeof(uint32_t) + 1 + 32 * sizeof(float);
+const size_t MIN_ANIMATION_SIZE = sizeof(uint32_t) + 1 + sizeof(float) + 3;
+
+enum eBlock
+{
+	BLOCK_POSITIONS,
+	BLOCK_NORMALS,
+	BLOCK_TEXCOORDS,
+	BLOCK_COLORS,
+	BLOCK_INDEXES,
+	BLOCK_WEIGHTS_COUNT,
+	BLOCK_WEIGHTS_INDEXES,
+	BLOCK_WEIGHTS,
+	BLOCK_GPU_WEIGHTS,
+	BLOCK_GPU_WEIGHTS_INDEXES,
+	BLOCK_DESCRIPTION,
+	BLOCKS_COUNT
+};
+
+struct sBlock
+{
+	uint32_t offset;
+	uint32_t size;
+};
+
+struct sHeader
+{
+	uint32_t version;
+	char magic[4];
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	float boundsMin[3];
+	float boundsMax[3];
+	sBlock blocks[BLOCKS_COUNT];
+};
+static_assert(sizeof(sHeader) % ALIGNMENT == 0, "First block must be aligned");
+
+void Check(bool condition)
+{
+	if (!condition)
+	{
+		throw std::runtime_error("WBM file is corrupted");
+	}
+}
+
+//Empty block means there is no such attribute
+template<class T>
+void ReadBlock(const unsigned char* data, sBlock const& block, size_t count, std::vector<T>& result)
+{
+	if (block.size == 0)
+		return;
+	Check(block.size / sizeof(T) == count && block.size % sizeof(T) == 0);
+	result.resize(count);
+	memcpy(result.data(), data + block.offset, block.size);
+}
+
+//Counts come from the file, so they are checked against the bytes left before anything is allocated
+size_t ReadCount(ReadMemoryStream& stream, size_t minItemSize)
+{
+	const size_t count = stream.ReadVarint();
+	Check(count <= stream.GetRemaining() / minItemSize);
+	return count;
+}
+
+//Arrays of the first version are stored as size in bytes followed by data
+template<class T>
+void ReadArrayV1(ReadMemoryStream& stream, std::vector<T>& result)
+{
+	const size_t size = stream.ReadSizeT();
+	Check(size % sizeof(T) == 0 && size <= stream.GetRemaining());
+	result.resize(size / sizeof(T));
+	if (size)
+	{
+		stream.ReadData(result.data(), size);
+	}
+}
+
+void ReadFloats(ReadMemoryStream& stream, std::vector<float>& result)
+{
+	const size_t count = stream.ReadVarint();
+	Check(count <= stream.GetRemaining() / sizeof(float));
+	result.resize(count);
+	if (count)
+	{
+		stream.ReadData(result.data(), count * sizeof(float));
+	}
+}
+
+void WriteFloats(WriteMemoryStream& stream, const float* values, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		stream.WriteFloat(values[i]);
+	}
+}
+
+void WriteFloats(WriteMemoryStream& stream, std::vector<float> const& values)
+{
+	stream.WriteVarint(static_cast<uint32_t>(values.size()));
+	WriteFloats(stream, values.data(), values.size());
+}
+
+//Recursive evaluation of animation children would never end on a cycle
+bool HasCycle(std::vector<sAnimation> const& animations, size_t current, std::vector<char>& state)
+{
+	state[current] = 1;
+	for (size_t child : animations[current].children)
+	{
+		if (state[child] == 1 || (state[child] == 0 && HasCycle(animations, child, state)))
+			return true;
+	}
+	state[current] = 2;
+	return false;
+}
+
+std::unique_ptr<C3DModel> LoadModelV1(unsigned char* data, size_t dataSize, C3DModel const& dummyModel)
 {
 	std::vector<CVector3f> vertices;
 	std::vector<CVector2f> textureCoords;
@@ -27,21 +152,13 @@ std::unique_ptr<C3DModel> CWBMModelFactory::LoadModel(unsigned char* data, size_
 	std::vector<sJoint> joints;
 	std::vector<sAnimation> animations;
 
-	ReadMemoryStream stream(reinterpret_cast<char*>(data));
+	ReadMemoryStream stream(reinterpret_cast<char*>(data), dataSize);
 	std::unordered_map<std::string, Material> materials;
 	stream.ReadUnsigned(); //version
-	size_t size = stream.ReadSizeT();
-	vertices.resize(size / sizeof(CVector3f));
-	stream.ReadData(vertices.data(), size);
-	size = stream.ReadSizeT();
-	textureCoords.resize(size / sizeof(CVector2f));
-	stream.ReadData(textureCoords.data(), size);
-	size = stream.ReadSizeT();
-	normals.resize(size / sizeof(CVector3f));
-	stream.ReadData(normals.data(), size);
-	size = stream.ReadSizeT();
-	indexes.resize(size / sizeof(unsigned int));
-	stream.ReadData(indexes.data(), size);
+	ReadArrayV1(stream, vertices);
+	ReadArrayV1(stream, textureCoords);
+	ReadArrayV1(stream, normals);
+	ReadArrayV1(stream, indexes);
 	size_t count = stream.ReadSizeT();
 	for (size_t i = 0; i < count; ++i)
 	{
@@ -68,12 +185,264 @@ std::unique_ptr<C3DModel> CWBMModelFactory::LoadModel(unsigned char* data, size_
 	return result;
 }
 
+std::unique_ptr<C3DModel> LoadModelV2(unsigned char* data, size_t dataSize, C3DModel const& dummyModel)
+{
+	Check(dataSize >= sizeof(sHeader));
+	sHeader header;
+	memcpy(&header, data, sizeof(header));
+	Check(memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0);
+	for (auto& block : header.blocks)
+	{
+		Check(block.size == 0 || (block.offset % ALIGNMENT == 0 && block.offset >= sizeof(sHeader) && block.size <= dataSize && block.offset <= dataSize - block.size));
+	}
+	const size_t vertexCount = header.vertexCount;
+	const size_t indexCount = header.indexCount;
+	std::vector<CVector3f> vertices;
+	std::vector<CVector2f> textureCoords;
+	std::vector<CVector3f> normals;
+	std::vector<math::vec4> colors;
+	std::vector<unsigned int> indexes;
+	std::vector<unsigned int> weightsCount;
+	std::vector<unsigned int> weightsIndexes;
+	std::vector<float> weights;
+	std::vector<float> gpuWeights;
+	std::vector<int> gpuWeightIndexes;
+	Check(header.blocks[BLOCK_POSITIONS].size / sizeof(CVector3f) == vertexCount);
+	ReadBlock(data, header.blocks[BLOCK_POSITIONS], vertexCount, vertices);
+	ReadBlock(data, header.blocks[BLOCK_NORMALS], vertexCount, normals);
+	ReadBlock(data, header.blocks[BLOCK_TEXCOORDS], vertexCount, textureCoords);
+	ReadBlock(data, header.blocks[BLOCK_COLORS], vertexCount, colors);
+	ReadBlock(data, header.blocks[BLOCK_INDEXES], indexCount, indexes);
+	Check(indexes.size() == indexCount);
+	for (unsigned int index : indexes)
+	{
+		Check(index < vertexCount);
+	}
+	auto& weightsCountBlock = header.blocks[BLOCK_WEIGHTS_COUNT];
+	ReadBlock(data, weightsCountBlock, weightsCountBlock.size / sizeof(unsigned int), weightsCount);
+	Check(weightsCount.size() <= vertexCount);
+	size_t weightsTotal = 0;
+	for (unsigned int count : weightsCount)
+	{
+		weightsTotal += count;
+	}
+	ReadBlock(data, header.blocks[BLOCK_WEIGHTS_INDEXES], weightsTotal, weightsIndexes);
+	ReadBlock(data, header.blocks[BLOCK_WEIGHTS], weightsTotal, weights);
+	Check(weightsIndexes.size() == weightsTotal && weights.size() == weightsTotal);
+	ReadBlock(data, header.blocks[BLOCK_GPU_WEIGHTS], vertexCount * 4, gpuWeights);
+	ReadBlock(data, header.blocks[BLOCK_GPU_WEIGHTS_INDEXES], vertexCount * 4, gpuWeightIndexes);
+	Check(gpuWeights.size() == gpuWeightIndexes.size() && (gpuWeights.empty() || !weightsCount.empty()));
+
+	auto& description = header.blocks[BLOCK_DESCRIPTION];
+	ReadMemoryStream stream(reinterpret_cast<char*>(data) + description.offset, description.size);
+	std::vector<sMesh> meshes(ReadCount(stream, MIN_MESH_SIZE));
+	size_t previousBegin = 0;
+	for (auto& mesh : meshes)
+	{
+		mesh.name = stream.ReadString();
+		mesh.materialName = stream.ReadString();
+		mesh.begin = stream.ReadVarint();
+		Check(mesh.begin >= previousBegin && mesh.begin <= (indexes.empty() ? vertexCount : indexCount));
+		previousBegin = mesh.begin;
+		stream.ReadData(static_cast<float*>(mesh.meshTransform), sizeof(float) * 16);
+	}
+	std::unordered_map<std::string, Material> materials;
+	const size_t materialsCount = stream.ReadVarint();
+	for (size_t i = 0; i < materialsCount; ++i)
+	{
+		Material& material = materials[stream.ReadString()];
+		stream.ReadData(material.ambient, sizeof(material.ambient));
+		stream.ReadData(material.diffuse, sizeof(material.diffuse));
+		stream.ReadData(material.specular, sizeof(material.specular));
+		material.shininess = stream.ReadFloat();
+		material.texture = make_path(stream.ReadString());
+		material.specularMap = make_path(stream.ReadString());
+		material.bumpMap = make_path(stream.ReadString());
+	}
+	std::vector<sJoint> joints(ReadCount(stream, MIN_JOINT_SIZE));
+	for (size_t i = 0; i < joints.size(); ++i)
+	{
+		sJoint& joint = joints[i];
+		joint.bone = stream.ReadString();
+		joint.id = stream.ReadString();
+		joint.parentIndex = stream.ReadSignedVarint();
+		Check(joint.parentIndex >= -1 && joint.parentIndex < static_cast<int>(i));
+		stream.ReadData(joint.matrix, sizeof(joint.matrix));
+		stream.ReadData(joint.invBindMatrix, sizeof(joint.invBindMatrix));
+	}
+	//Empty GPU weights are zeroes with zero index, so they are valid even without joints
+	const unsigned int jointsCount = static_cast<unsigned int>(std::max<size_t>(joints.size(), 1));
+	for (unsigned int index : weightsIndexes)
+	{
+		Check(index < jointsCount);
+	}
+	for (int index : gpuWeightIndexes)
+	{
+		Check(index >= 0 && static_cast<unsigned int>(index) < jointsCount);
+	}
+	std::vector<sAnimation> animations(ReadCount(stream, MIN_ANIMATION_SIZE));
+	for (auto& animation : animations)
+	{
+		animation.id = stream.ReadString();
+		//Animations that do not move a joint refer to joints count
+		animation.boneIndex = stream.ReadVarint();
+		animation.duration = stream.ReadFloat();
+		ReadFloats(stream, animation.keyframes);
+		ReadFloats(stream, animation.matrices);
+		animation.children.resize(ReadCount(stream, 1));
+		for (auto& child : animation.children)
+		{
+			child = stream.ReadVarint();
+			Check(child < animations.size());
+		}
+	}
+	std::vector<char> state(animations.size(), 0);
+	for (size_t i = 0; i < animations.size(); ++i)
+	{
+		Check(state[i] != 0 || !HasCycle(animations, i, state));
+	}
+
+	MaterialManager materialManager(materials);
+	const CVector3f bounds[2] = { CVector3f(header.boundsMin), CVector3f(header.boundsMax) };
+	auto result = std::make_unique<C3DModel>(dummyModel.GetScale(), dummyModel.GetRotation());
+	result->SetModel(vertices, textureCoords, normals, indexes, materialManager, meshes, bounds);
+	result->SetAnimation(weightsCount, weightsIndexes, weights, joints, animations);
+	result->SetGPUWeights(gpuWeights, gpuWeightIndexes);
+	if (!colors.empty())
+	{
+		result->SetVertexColors(std::move(colors));
+	}
+	return result;
+}
+}
+
+std::unique_ptr<C3DModel> CWBMModelFactory::LoadModel(unsigned char* data, size_t dataSize, C3DModel const& dummyModel, const Path& /*filePath*/)
+{
+	uint32_t version;
+	if (dataSize < sizeof(version))
+	{
+		throw std::runtime_error("WBM file is corrupted");
+	}
+	memcpy(&version, data, sizeof(version));
+	if (version == VERSION_1)
+	{
+		return LoadModelV1(data, dataSize, dummyModel);
+	}
+	if (version == VERSION_2)
+	{
+		return LoadModelV2(data, dataSize, dummyModel);
+	}
+	throw std::runtime_error("Unsupported WBM version " + std::to_string(version));
+}
+
 bool CWBMModelFactory::ModelIsSupported(unsigned char* /*data*/, size_t /*size*/, const Path& filePath) const
 {
-	size_t dotCoord = filePath.find_last_of('.') + 1;
-	Path extension = filePath.substr(dotCoord, filePath.length() - dotCoord);
-	std::transform(extension.begin(), extension.end(), extension.begin(), std::towlower);
-	return extension == make_path(L"wbm");
+	return GetExtension(filePath) == make_path(L"wbm");
+}
+
+std::vector<char> SerializeWBMModel(C3DModel const& model)
+{
+	WriteMemoryStream description;
+	description.WriteVarint(static_cast<uint32_t>(model.m_meshes.size()));
+	for (auto& mesh : model.m_meshes)
+	{
+		description.WriteString(mesh.name);
+		description.WriteString(mesh.materialName);
+		description.WriteVarint(static_cast<uint32_t>(mesh.begin));
+		WriteFloats(description, mesh.meshTransform, 16);
+	}
+	//Sorted, so the same model is always saved to the same file
+	auto& materials = model.m_materials.GetMaterials();
+	std::vector<std::string> materialNames;
+	for (auto& pair : materials)
+	{
+		materialNames.push_back(pair.first);
+	}
+	std::sort(materialNames.begin(), materialNames.end());
+	description.WriteVarint(static_cast<uint32_t>(materialNames.size()));
+	for (auto& name : materialNames)
+	{
+		const Material& material = materials.at(name);
+		description.WriteString(name);
+		WriteFloats(description, material.ambient, 4);
+		WriteFloats(description, material.diffuse, 4);
+		WriteFloats(description, material.specular, 4);
+		description.WriteFloat(material.shininess);
+		description.WriteString(to_string(material.texture));
+		description.WriteString(to_string(material.specularMap));
+		description.WriteString(to_string(material.bumpMap));
+	}
+	description.WriteVarint(static_cast<uint32_t>(model.m_skeleton.size()));
+	for (auto& joint : model.m_skeleton)
+	{
+		description.WriteString(joint.bone);
+		description.WriteString(joint.id);
+		description.WriteSignedVarint(joint.parentIndex);
+		WriteFloats(description, joint.matrix, 16);
+		WriteFloats(description, joint.invBindMatrix, 16);
+	}
+	description.WriteVarint(static_cast<uint32_t>(model.m_animations.size()));
+	for (auto& animation : model.m_animations)
+	{
+		description.WriteString(animation.id);
+		description.WriteVarint(static_cast<uint32_t>(std::min(animation.boneIndex, model.m_skeleton.size())));
+		description.WriteFloat(animation.duration);
+		WriteFloats(description, animation.keyframes);
+		WriteFloats(description, animation.matrices);
+		description.WriteVarint(static_cast<uint32_t>(animation.children.size()));
+		for (size_t child : animation.children)
+		{
+			description.WriteVarint(static_cast<uint32_t>(child));
+		}
+	}
+
+	std::vector<float> gpuWeights;
+	std::vector<int> gpuWeightIndexes;
+	if (!model.m_weightsCount.empty())
+	{
+		model.CalculateGPUWeights(gpuWeights, gpuWeightIndexes);
+	}
+	sHeader header = {};
+	header.version = VERSION_2;
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.vertexCount = static_cast<uint32_t>(model.m_vertices.size());
+	header.indexCount = static_cast<uint32_t>(model.m_indexes.size());
+	memcpy(header.boundsMin, &model.m_boundsMin, sizeof(header.boundsMin));
+	memcpy(header.boundsMax, &model.m_boundsMax, sizeof(header.boundsMax));
+	std::vector<char> result(sizeof(sHeader));
+	auto addBlock = [&](eBlock block, const void* blockData, size_t size) {
+		result.resize((result.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+		if (result.size() + size > UINT32_MAX)
+		{
+			throw std::runtime_error("Model is too big for WBM file");
+		}
+		header.blocks[block] = { static_cast<uint32_t>(result.size()), static_cast<uint32_t>(size) };
+		result.insert(result.end(), static_cast<const char*>(blockData), static_cast<const char*>(blockData) + size);
+	};
+	addBlock(BLOCK_POSITIONS, model.m_vertices.data(), model.m_vertices.size() * sizeof(CVector3f));
+	addBlock(BLOCK_NORMALS, model.m_normals.data(), model.m_normals.size() * sizeof(CVector3f));
+	addBlock(BLOCK_TEXCOORDS, model.m_textureCoords.data(), model.m_textureCoords.size() * sizeof(CVector2f));
+	addBlock(BLOCK_COLORS, model.m_vertexColors.data(), model.m_vertexColors.size() * sizeof(math::vec4));
+	addBlock(BLOCK_INDEXES, model.m_indexes.data(), model.m_indexes.size() * sizeof(unsigned int));
+	addBlock(BLOCK_WEIGHTS_COUNT, model.m_weightsCount.data(), model.m_weightsCount.size() * sizeof(unsigned int));
+	addBlock(BLOCK_WEIGHTS_INDEXES, model.m_weightsIndexes.data(), model.m_weightsIndexes.size() * sizeof(unsigned int));
+	addBlock(BLOCK_WEIGHTS, model.m_weights.data(), model.m_weights.size() * sizeof(float));
+	addBlock(BLOCK_GPU_WEIGHTS, gpuWeights.data(), gpuWeights.size() * sizeof(float));
+	addBlock(BLOCK_GPU_WEIGHTS_INDEXES, gpuWeightIndexes.data(), gpuWeightIndexes.size() * sizeof(int));
+	addBlock(BLOCK_DESCRIPTION, description.GetData(), description.GetSize());
+	memcpy(result.data(), &header, sizeof(header));
+	return result;
+}
+
+void SaveWBMModel(C3DModel const& model, const Path& path)
+{
+	std::vector<char> result = SerializeWBMModel(model);
+	std::ofstream file(path, std::ios::binary | std::ios::out);
+	file.write(result.data(), result.size());
+	if (!file)
+	{
+		throw std::runtime_error("Cannot write " + to_string(path));
+	}
 }
 }
 }
\ No newline at end of file
@@ -1,15 +1,23 @@
 #pragma once
 #include "IModelReader.h"
+#include <vector>
 
 namespace wargameEngine
 {
 namespace view
 {
+//Reads version 1 (geometry and materials) and version 2 files. Version 2 is a header with 16 byte aligned blocks of vertex attributes,
+//indexes and skin weights, so every block can be passed to renderer as is. Meshes, materials, skeleton and animations are stored in description block
 class CWBMModelFactory : public IModelReader
 {
 public:
 	bool ModelIsSupported(unsigned char* data, size_t size, const Path& filePath) const override;
 	std::unique_ptr<C3DModel> LoadModel(unsigned char* data, size_t size, C3DModel const& dummyModel, const Path& filePath) override;
 };
+
+//Returns model as WBM version 2 file contents
+std::vector<char> SerializeWBMModel(C3DModel const& model);
+//Saves model as WBM version 2. Throws std::runtime_error if file cannot be written
+void SaveWBMModel(C3DModel const& model, const Path& path);
 }
 }
\ No newline at end of file